@@ -380,6 +380,10 @@
 #	include <sys/un.h>
 #endif
 
+#ifdef HAVE_POLL_H
+#	include <poll.h>
+#endif
+
 #ifdef HAVE_PROCINFO_H
 #	undef T_NULL /* to solve definition conflict */
 #	include <procinfo.h>
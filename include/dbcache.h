@@ -77,6 +77,7 @@ extern int	CONFIG_JAVAPOLLER_FORKS;
 extern int	CONFIG_PINGER_FORKS;
 extern int	CONFIG_UNREACHABLE_PERIOD;
 extern int	CONFIG_UNREACHABLE_DELAY;
+extern int	CONFIG_AGENT_BATCH_MAX_ITEMS;
 extern int	CONFIG_PROXYCONFIG_FREQUENCY;
 extern int	CONFIG_PROXYDATA_FREQUENCY;
 extern int	CONFIG_HISTORYPOLLER_FORKS;
@@ -221,6 +222,7 @@ typedef struct
 	zbx_uint64_t	functionid;
 	zbx_uint64_t	triggerid;
 	zbx_uint64_t	itemid;
+	zbx_uint64_t	canonicalid;	/* the same for functions with equal item, name and parameters */
 	char		*function;
 	char		*parameter;
 	unsigned char	type;
@@ -724,6 +726,7 @@ void	DCconfig_get_hosts_by_itemids(DC_HOST *hosts, const zbx_uint64_t *itemids,
 void	DCconfig_get_hosts_by_hostids(DC_HOST *hosts, const zbx_uint64_t *hostids, int *errcodes, int num);
 void	DCconfig_get_items_by_keys(DC_ITEM *items, zbx_host_key_t *keys, int *errcodes, size_t num);
 void	DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes, size_t num);
+int	zbx_dc_get_item_name(zbx_uint64_t itemid, char **name);
 void	DCconfig_get_items_by_itemids_partial(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes, int num,
 		unsigned int mode);
 void	DCconfig_get_preprocessable_items(zbx_hashset_t *items, int *timestamp);
@@ -874,6 +877,9 @@ void	zbx_dc_correlation_rules_get(zbx_correlation_rules_t *rules);
 
 void	zbx_dc_get_nested_hostgroupids(zbx_uint64_t *groupids, int groupids_num, zbx_vector_uint64_t *nested_groupids);
 void	zbx_dc_get_hostids_by_group_name(const char *name, zbx_vector_uint64_t *hostids);
+int	zbx_dc_check_trigger_hostgroup(zbx_uint64_t triggerid, zbx_uint64_t groupid);
+void	zbx_dc_get_hostgroup_triggerids(zbx_uint64_t groupid, const zbx_vector_uint64_t *triggerids,
+		zbx_vector_uint64_t *group_triggerids);
 
 #define ZBX_HC_ITEM_STATUS_NORMAL	0
 #define ZBX_HC_ITEM_STATUS_BUSY		1
@@ -1030,10 +1036,43 @@ void	zbx_dc_get_item_tags(zbx_uint64_t itemid, zbx_vector_ptr_t *item_tags);
 void	zbx_dc_get_item_tags_by_functionids(const zbx_uint64_t *functionids, size_t functionids_num,
 		zbx_vector_ptr_t *item_tags);
 
+/* item and host data for history and trends export */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	char			*name;
+	zbx_vector_tags_t	tags;
+}
+zbx_dc_item_export_t;
+
+typedef struct
+{
+	zbx_uint64_t		hostid;
+	zbx_vector_str_t	groups;
+}
+zbx_dc_host_export_t;
+
+void	zbx_dc_get_export_info(zbx_vector_ptr_t *items, zbx_vector_ptr_t *hosts);
+
 const char	*zbx_dc_get_instanceid(void);
 
 /* diagnostic data */
 void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num);
+
+/* history storage flush statistics */
+typedef struct
+{
+	zbx_uint64_t	flushes;
+	zbx_uint64_t	requests;
+	zbx_uint64_t	bytes;
+	zbx_uint64_t	bytes_sent;
+	double		time;
+	double		time_max;
+}
+zbx_hc_storage_stats_t;
+
+void	zbx_hc_update_storage_stats(const zbx_hc_storage_stats_t *stats);
+void	zbx_hc_get_storage_stats(zbx_hc_storage_stats_t *stats);
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index);
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items);
 
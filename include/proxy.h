@@ -72,6 +72,15 @@ void	zbx_update_proxy_data(DC_PROXY *proxy, int version, int lastaccess, int com
 int	process_proxy_history_data(const DC_PROXY *proxy, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
 int	process_agent_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
 int	process_sender_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
+
+typedef struct zbx_history_stream	zbx_history_stream_t;
+
+zbx_history_stream_t	*zbx_history_stream_create(zbx_socket_t *sock, const zbx_timespec_t *ts);
+size_t			zbx_history_stream_parse(zbx_history_stream_t *stream, const char *data, size_t len, int last);
+int			zbx_history_stream_started(const zbx_history_stream_t *stream);
+const char		*zbx_history_stream_request(const zbx_history_stream_t *stream);
+int			zbx_history_stream_finish(zbx_history_stream_t *stream, char **info);
+void			zbx_history_stream_free(zbx_history_stream_t *stream);
 int	process_proxy_data(const DC_PROXY *proxy, struct zbx_json_parse *jp, zbx_timespec_t *ts,
 		unsigned char proxy_status, int *more, char **error);
 int	zbx_check_protocol_version(DC_PROXY *proxy, int version);
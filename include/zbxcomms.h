@@ -84,6 +84,8 @@ typedef struct
 	/* TLS connection may be shut down at any time and it will not be possible to get peer IP address anymore. */
 	char				peer[ZBX_MAX_DNSNAME_LEN + 1];
 	int				protocol;
+	zbx_uint64_t			reserved;		/* reserved header field of the last received */
+								/* uncompressed message */
 }
 zbx_socket_t;
 
@@ -130,7 +132,14 @@ int	zbx_tcp_listen(zbx_socket_t *s, const char *listen_ip, unsigned short listen
 void	zbx_tcp_unlisten(zbx_socket_t *s);
 
 int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept);
+int	zbx_tcp_accept_handshake(zbx_socket_t *s, unsigned int tls_accept, short *event);
 void	zbx_tcp_unaccept(zbx_socket_t *s);
+int	zbx_tcp_wait_request(zbx_socket_t *s, int timeout);
+
+#ifndef _WINDOWS
+int	zbx_socket_set_nonblocking(ZBX_SOCKET s, unsigned char nonblocking);
+int	zbx_tcp_accept_async(zbx_socket_t *s, ZBX_SOCKET listen_socket, short *event);
+#endif
 
 #define ZBX_TCP_READ_UNTIL_CLOSE 0x01
 
@@ -139,7 +148,36 @@ void	zbx_tcp_unaccept(zbx_socket_t *s);
 #define	zbx_tcp_recv_to(s, timeout)		SUCCEED_OR_FAIL(zbx_tcp_recv_ext(s, timeout, 0))
 #define	zbx_tcp_recv_raw(s)			SUCCEED_OR_FAIL(zbx_tcp_recv_raw_ext(s, 0))
 
+/* callback consuming data of a message received in chunks, returns number of bytes consumed or FAIL, */
+/* size is the total message size including protocol header                                          */
+typedef ssize_t	(*zbx_tcp_recv_stream_func_t)(const char *data, size_t len, zbx_uint64_t size, int last,
+		void *arg);
+
+/* state of partially received message, allows to continue receiving when more data arrives */
+typedef struct
+{
+	size_t				buf_dyn_bytes;
+	size_t				buf_stat_bytes;
+	size_t				offset;
+	zbx_uint64_t			expected_len;
+	zbx_uint64_t			reserved;
+	zbx_uint64_t			max_len;
+	unsigned char			expect;
+	unsigned char			flags;
+	int				protocol_version;
+
+	/* optional streaming of large uncompressed messages through buffer of chunk_size bytes */
+	size_t				chunk_size;
+	zbx_tcp_recv_stream_func_t	stream_func;
+	void				*stream_arg;
+}
+zbx_tcp_recv_context_t;
+
+void		zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *context, unsigned char flags);
+ssize_t		zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, short *events);
 ssize_t		zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags);
+ssize_t		zbx_tcp_recv_stream(zbx_socket_t *s, int timeout, unsigned char flags, size_t chunk_size,
+		zbx_tcp_recv_stream_func_t stream_func, void *stream_arg);
 ssize_t		zbx_tcp_recv_raw_ext(zbx_socket_t *s, int timeout);
 const char	*zbx_tcp_recv_line(zbx_socket_t *s);
 
@@ -101,6 +101,14 @@ zbx_err_codes_t	zbx_db_last_errcode(void);
 #ifdef HAVE_POSTGRESQL
 int	zbx_tsdb_get_version(void);
 #define ZBX_DB_TSDB_V1	(20000 > zbx_tsdb_get_version())
+
+int	zbx_db_copy_from(const char *sql, const char *data, size_t data_len);
+
+int	zbx_db_async_connect(char *host, char *user, char *password, char *dbname, char *dbschema, char *dbsocket,
+		int port, char *tls_connect, char *cert, char *key, char *ca, char *cipher, char *cipher_13);
+void	zbx_db_async_close(void);
+int	zbx_db_async_send(const char *sql);
+int	zbx_db_async_wait(void);
 #endif
 
 #ifdef HAVE_ORACLE
@@ -130,6 +138,7 @@ int		zbx_db_statement_execute(int iters);
 int		zbx_db_vexecute(const char *fmt, va_list args);
 DB_RESULT	zbx_db_vselect(const char *fmt, va_list args);
 DB_RESULT	zbx_db_select_n(const char *query, int n);
+DB_RESULT	zbx_db_select_prepared(const char *sql, int params_num, const char *const *params);
 
 DB_ROW		zbx_db_fetch(DB_RESULT result);
 void		DBfree_result(DB_RESULT result);
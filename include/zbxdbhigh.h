@@ -423,6 +423,12 @@ int		DBexecute_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselect_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselect(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselectN(const char *query, int n);
+DB_RESULT	DBselect_prepared(const char *sql, int params_num, const char *const *params);
+
+#ifdef HAVE_POSTGRESQL
+int	DBasync_execute(const char *sql);
+int	DBasync_wait(void);
+#endif
 DB_ROW		DBfetch(DB_RESULT result);
 int		DBis_null(const char *field);
 void		DBbegin(void);
@@ -625,6 +631,9 @@ void	zbx_db_insert_prepare(zbx_db_insert_t *self, const char *table, ...);
 void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, const zbx_db_value_t **values, int values_num);
 void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...);
 int	zbx_db_insert_execute(zbx_db_insert_t *self);
+#ifdef HAVE_POSTGRESQL
+void	zbx_db_insert_format_sql(const zbx_db_insert_t *self, char **sql, size_t *sql_alloc, size_t *sql_offset);
+#endif
 void	zbx_db_insert_clean(zbx_db_insert_t *self);
 void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name);
 int	zbx_db_get_database_type(void);
@@ -21,11 +21,15 @@
 #define ZABBIX_EXPORT_H
 
 #include "zbxsysinc.h"
+#include "zbxtypes.h"
 
 #define ZBX_FLAG_EXPTYPE_EVENTS		1
 #define ZBX_FLAG_EXPTYPE_HISTORY	2
 #define ZBX_FLAG_EXPTYPE_TRENDS		4
 
+#define ZBX_EXPORT_FORMAT_NDJSON	0
+#define ZBX_EXPORT_FORMAT_BINARY	1
+
 int	zbx_validate_export_type(char *export_type, uint32_t *export_mask);
 int	zbx_is_export_enabled(uint32_t flags);
 int	zbx_export_init(char **error);
@@ -37,6 +41,9 @@ void	zbx_problems_export_flush(void);
 void	zbx_history_export_init(const char *process_name, int process_num);
 void	zbx_history_export_write(const char *buf, size_t count);
 void	zbx_history_export_flush(void);
+int	zbx_history_export_format(void);
+void	zbx_history_export_write_item(zbx_uint64_t itemid, const char *buf, size_t count);
+void	zbx_history_export_write_value(zbx_uint64_t itemid, const char *buf, size_t count);
 
 void	zbx_trends_export_init(const char *process_name, int process_num);
 void	zbx_trends_export_write(const char *buf, size_t count);
@@ -57,6 +57,7 @@ int	zbx_history_init(char **error);
 void	zbx_history_destroy(void);
 
 int	zbx_history_add_values(const zbx_vector_ptr_t *history, int *ret_flush);
+int	zbx_history_wait(void);
 int	zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int count, int end,
 		zbx_vector_history_record_t *values);
 
@@ -66,5 +67,6 @@ void	zbx_history_check_version(struct zbx_json *json);
 #define FLUSH_SUCCEED		0
 #define FLUSH_FAIL		-1
 #define FLUSH_DUPL_REJECTED	-2
+#define FLUSH_ASYNC		-3
 
 #endif
@@ -194,11 +194,16 @@
 #define ZBX_PROTO_TAG_PROXY_NAME		"proxy_name"
 #define ZBX_PROTO_TAG_PROXY_NAMES		"proxy_names"
 #define ZBX_PROTO_TAG_PROXY_HOSTIDS		"proxy_hostids"
+#define ZBX_PROTO_TAG_ITEMIDS			"itemids"
+#define ZBX_PROTO_TAG_TIME_FROM			"time_from"
+#define ZBX_PROTO_TAG_TIME_TILL			"time_till"
+#define ZBX_PROTO_TAG_VALUES			"values"
 
 #define ZBX_PROTO_VALUE_FAILED		"failed"
 #define ZBX_PROTO_VALUE_SUCCESS		"success"
 
 #define ZBX_PROTO_VALUE_GET_ACTIVE_CHECKS	"active checks"
+#define ZBX_PROTO_VALUE_GET_PASSIVE_CHECKS	"passive checks"
 #define ZBX_PROTO_VALUE_PROXY_CONFIG		"proxy config"
 #define ZBX_PROTO_VALUE_PROXY_HEARTBEAT		"proxy heartbeat"
 #define ZBX_PROTO_VALUE_SENDER_DATA		"sender data"
@@ -231,6 +236,7 @@
 #define ZBX_PROTO_VALUE_PROXY_UPLOAD_DISABLED	"disabled"
 
 #define ZBX_PROTO_VALUE_REPORT_TEST		"report.test"
+#define ZBX_PROTO_VALUE_HISTORY_GET		"history.get"
 
 typedef enum
 {
@@ -1317,6 +1317,8 @@ const char	*get_process_type_string(unsigned char proc_type)
 			return "ha manager";
 		case ZBX_PROCESS_TYPE_ODBCPOLLER:
 			return "odbc poller";
+		case ZBX_PROCESS_TYPE_SNMPTRAPWORKER:
+			return "snmp trap worker";
 		case ZBX_PROCESS_TYPE_MAIN:
 			return "main";
 	}
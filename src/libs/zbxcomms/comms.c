@@ -1373,6 +1373,101 @@ void	zbx_tcp_unlisten(zbx_socket_t *s)
 		zbx_socket_close(s->sockets[i]);
 }
 
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+static int	zbx_tcp_accept_tls(zbx_socket_t *s, unsigned int tls_accept, short *event)
+{
+	char	*error = NULL;
+
+	if (SUCCEED != zbx_tls_accept(s, tls_accept, event, &error))
+	{
+		if (NULL != error)
+		{
+			zbx_set_socket_strerror("from %s: %s", s->peer, error);
+			zbx_free(error);
+		}
+
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: detects type of accepted connection and performs TLS handshake    *
+ *          for encrypted connections                                         *
+ *                                                                            *
+ * Parameters: s          - [IN] socket with accepted connection              *
+ *             tls_accept - [IN] allowed connection types                     *
+ *             event      - [OUT] optional socket event to wait for before    *
+ *                                calling the function again when the socket  *
+ *                                is in non-blocking mode (NULL - blocking    *
+ *                                mode)                                       *
+ *                                                                            *
+ * Return value: SUCCEED - connection is ready for data exchange              *
+ *               FAIL - an error occurred or, if event was set, the           *
+ *                      handshake is not finished yet                         *
+ *                                                                            *
+ * Comments: In non-blocking mode the connection type is determined only when *
+ *           the first byte of data has arrived. TLS handshake in progress is *
+ *           continued on subsequent calls.                                   *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept_handshake(zbx_socket_t *s, unsigned int tls_accept, short *event)
+{
+	ssize_t		res;
+	unsigned char	buf;	/* 1 byte buffer */
+
+	if (NULL != event)
+		*event = 0;
+
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (NULL != s->tls_ctx)		/* TLS handshake was started by previous call */
+		return zbx_tcp_accept_tls(s, tls_accept, event);
+#endif
+	if (ZBX_SOCKET_ERROR == (res = recv(s->socket, &buf, 1, MSG_PEEK)))
+	{
+#ifndef _WINDOWS
+		if (NULL != event && (EAGAIN == zbx_socket_last_error() || EWOULDBLOCK == zbx_socket_last_error()))
+		{
+			*event = POLLIN;
+			return FAIL;
+		}
+#endif
+		zbx_set_socket_strerror("from %s: reading first byte from connection failed: %s", s->peer,
+				strerror_from_system(zbx_socket_last_error()));
+		return FAIL;
+	}
+
+	/* if the 1st byte is 0x16 then assume it's a TLS connection */
+	if (1 == res && '\x16' == buf)
+	{
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+		if (0 != (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
+			return zbx_tcp_accept_tls(s, tls_accept, event);
+
+		zbx_set_socket_strerror("from %s: TLS connections are not allowed", s->peer);
+		return FAIL;
+#else
+		zbx_set_socket_strerror("from %s: support for TLS was not compiled in", s->peer);
+		return FAIL;
+#endif
+	}
+	else
+	{
+		if (0 == (tls_accept & ZBX_TCP_SEC_UNENCRYPTED))
+		{
+			zbx_set_socket_strerror("from %s: unencrypted connections are not allowed", s->peer);
+			return FAIL;
+		}
+
+		s->connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: permits an incoming connection attempt on a socket                *
@@ -1388,8 +1483,6 @@ int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept)
 	ZBX_SOCKET	accepted_socket;
 	ZBX_SOCKLEN_T	nlen;
 	int		i, n = 0, ret = FAIL;
-	ssize_t		res;
-	unsigned char	buf;	/* 1 byte buffer */
 
 	zbx_tcp_unaccept(s);
 
@@ -1439,60 +1532,108 @@ int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept)
 
 	zbx_socket_timeout_set(s, CONFIG_TIMEOUT);
 
-	if (ZBX_SOCKET_ERROR == (res = recv(s->socket, &buf, 1, MSG_PEEK)))
+	if (SUCCEED != zbx_tcp_accept_handshake(s, tls_accept, NULL))
 	{
-		zbx_set_socket_strerror("from %s: reading first byte from connection failed: %s", s->peer,
-				strerror_from_system(zbx_socket_last_error()));
 		zbx_tcp_unaccept(s);
 		goto out;
 	}
 
-	/* if the 1st byte is 0x16 then assume it's a TLS connection */
-	if (1 == res && '\x16' == buf)
+	ret = SUCCEED;
+out:
+	zbx_socket_timeout_cleanup(s);
+
+	return ret;
+}
+
+#ifndef _WINDOWS
+/******************************************************************************
+ *                                                                            *
+ * Purpose: switches socket between blocking and non-blocking modes           *
+ *                                                                            *
+ * Parameters: s           - [IN] the socket                                  *
+ *             nonblocking - [IN] 1 - set non-blocking mode, 0 - blocking     *
+ *                                                                            *
+ * Return value: SUCCEED - the mode was changed                               *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_socket_set_nonblocking(ZBX_SOCKET s, unsigned char nonblocking)
+{
+	int	flags;
+
+	if (-1 == (flags = fcntl(s, F_GETFL, 0)))
 	{
-#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-		if (0 != (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
-		{
-			char	*error = NULL;
+		zbx_set_socket_strerror("cannot get socket flags: %s", zbx_strerror(errno));
+		return FAIL;
+	}
 
-			if (SUCCEED != zbx_tls_accept(s, tls_accept, &error))
-			{
-				zbx_set_socket_strerror("from %s: %s", s->peer, error);
-				zbx_tcp_unaccept(s);
-				zbx_free(error);
-				goto out;
-			}
-		}
-		else
-		{
-			zbx_set_socket_strerror("from %s: TLS connections are not allowed", s->peer);
-			zbx_tcp_unaccept(s);
-			goto out;
-		}
-#else
-		zbx_set_socket_strerror("from %s: support for TLS was not compiled in", s->peer);
-		zbx_tcp_unaccept(s);
-		goto out;
-#endif
+	flags = (0 != nonblocking ? flags | O_NONBLOCK : flags & ~O_NONBLOCK);
+
+	if (-1 == fcntl(s, F_SETFL, flags))
+	{
+		zbx_set_socket_strerror("cannot set socket flags: %s", zbx_strerror(errno));
+		return FAIL;
 	}
-	else
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: accepts pending connection on non-blocking listening socket       *
+ *                                                                            *
+ * Parameters: s             - [OUT] socket for the accepted connection       *
+ *             listen_socket - [IN] the listening socket                      *
+ *             event         - [OUT] socket event to wait for before calling  *
+ *                                   the function again, 0 on error           *
+ *                                                                            *
+ * Return value: SUCCEED - connection was accepted and switched to            *
+ *                         non-blocking mode                                  *
+ *               FAIL - there are no pending connections (event is set) or    *
+ *                      an error occurred                                     *
+ *                                                                            *
+ * Comments: The accepted connection must be completed with                   *
+ *           zbx_tcp_accept_handshake() and closed with zbx_tcp_unaccept().   *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept_async(zbx_socket_t *s, ZBX_SOCKET listen_socket, short *event)
+{
+	ZBX_SOCKADDR	serv_addr;
+	ZBX_SOCKET	accepted_socket;
+	ZBX_SOCKLEN_T	nlen = sizeof(serv_addr);
+
+	*event = 0;
+
+	if (ZBX_SOCKET_ERROR == (accepted_socket = (ZBX_SOCKET)accept(listen_socket, (struct sockaddr *)&serv_addr,
+			&nlen)))
 	{
-		if (0 == (tls_accept & ZBX_TCP_SEC_UNENCRYPTED))
+		/* the connection might have been accepted by other process listening on the same socket */
+		if (EAGAIN == zbx_socket_last_error() || EWOULDBLOCK == zbx_socket_last_error() ||
+				EINTR == zbx_socket_last_error() || ECONNABORTED == zbx_socket_last_error())
 		{
-			zbx_set_socket_strerror("from %s: unencrypted connections are not allowed", s->peer);
-			zbx_tcp_unaccept(s);
-			goto out;
+			*event = POLLIN;
 		}
+		else
+			zbx_set_socket_strerror("accept() failed: %s", strerror_from_system(zbx_socket_last_error()));
 
-		s->connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+		return FAIL;
 	}
 
-	ret = SUCCEED;
-out:
-	zbx_socket_timeout_cleanup(s);
+	zbx_socket_clean(s);
 
-	return ret;
+	s->socket = accepted_socket;
+	s->socket_orig = ZBX_SOCKET_ERROR;
+	s->accepted = 1;
+
+	if (SUCCEED != zbx_socket_peer_ip_save(s) || SUCCEED != zbx_socket_set_nonblocking(s->socket, 1))
+	{
+		zbx_tcp_unaccept(s);
+		return FAIL;
+	}
+
+	return SUCCEED;
 }
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -1516,6 +1657,57 @@ void	zbx_tcp_unaccept(zbx_socket_t *s)
 	s->accepted = 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for the next request on accepted connection while watching *
+ *          listening sockets for new connections                             *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket with accepted connection             *
+ *             timeout - [IN] the maximum time to wait in seconds             *
+ *                                                                            *
+ * Return value: SUCCEED - data is available on the accepted connection       *
+ *               FAIL - timeout, a new connection is waiting to be accepted   *
+ *                      or an error occurred                                  *
+ *                                                                            *
+ * Comments: Used to keep idle persistent connection only as long as no other *
+ *           clients are waiting, so idle connections do not block them.      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_wait_request(zbx_socket_t *s, int timeout)
+{
+	fd_set		sock_set;
+	struct timeval	tv;
+	int		i, n = 0, ret;
+
+	FD_ZERO(&sock_set);
+	FD_SET(s->socket, &sock_set);
+#ifndef _WINDOWS
+	n = s->socket;
+#endif
+	for (i = 0; i < s->num_socks; i++)
+	{
+		FD_SET(s->sockets[i], &sock_set);
+#ifndef _WINDOWS
+		if (s->sockets[i] > n)
+			n = s->sockets[i];
+#endif
+	}
+
+	tv.tv_sec = timeout;
+	tv.tv_usec = 0;
+
+	if (ZBX_PROTO_ERROR == (ret = select(n + 1, &sock_set, NULL, NULL, &tv)))
+	{
+		zbx_set_socket_strerror("select() failed: %s", strerror_from_system(zbx_socket_last_error()));
+		return FAIL;
+	}
+
+	if (0 == ret || !FD_ISSET(s->socket, &sock_set))
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: finds the next line in socket data buffer                         *
@@ -1673,7 +1865,23 @@ out:
 	return line;
 }
 
-static ssize_t	zbx_tcp_read(zbx_socket_t *s, char *buf, size_t len)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads data from socket                                            *
+ *                                                                            *
+ * Parameters: s      - [IN] the socket                                       *
+ *             buf    - [OUT] the buffer for read data                        *
+ *             len    - [IN] the buffer size                                  *
+ *             events - [OUT] optional socket event to wait for before        *
+ *                            calling the function again when the socket is   *
+ *                            in non-blocking mode (NULL - blocking mode)     *
+ *                                                                            *
+ * Return value: number of bytes read - success,                              *
+ *               ZBX_PROTO_ERROR - an error occurred or, if events was set,   *
+ *                                 no data is available yet                   *
+ *                                                                            *
+ ******************************************************************************/
+static ssize_t	zbx_tcp_read(zbx_socket_t *s, char *buf, size_t len, short *events)
 {
 	ssize_t	res;
 	int	err;
@@ -1685,7 +1893,7 @@ static ssize_t	zbx_tcp_read(zbx_socket_t *s, char *buf, size_t len)
 	{
 		char	*error = NULL;
 
-		if (ZBX_PROTO_ERROR == (res = zbx_tls_read(s, buf, len, &error)))
+		if (ZBX_PROTO_ERROR == (res = zbx_tls_read(s, buf, len, events, &error)) && NULL != error)
 		{
 			zbx_set_socket_strerror("%s", error);
 			zbx_free(error);
@@ -1714,68 +1922,196 @@ static ssize_t	zbx_tcp_read(zbx_socket_t *s, char *buf, size_t len)
 	while (ZBX_PROTO_ERROR == res && ZBX_PROTO_AGAIN == (err = zbx_socket_last_error()));
 
 	if (ZBX_PROTO_ERROR == res)
+	{
+#ifndef _WINDOWS
+		if (NULL != events && (EAGAIN == err || EWOULDBLOCK == err))
+		{
+			*events = POLLIN;
+			return res;
+		}
+#endif
 		zbx_set_socket_strerror("ZBX_TCP_READ() failed: %s", strerror_from_system(err));
+	}
 
 	return res;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: receive data                                                      *
- *                                                                            *
- * Return value: number of bytes received - success,                          *
- *               FAIL - an error occurred                                     *
- *                                                                            *
- ******************************************************************************/
-ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags)
-{
 #define ZBX_TCP_EXPECT_HEADER		1
 #define ZBX_TCP_EXPECT_VERSION		2
 #define ZBX_TCP_EXPECT_VERSION_VALIDATE	3
 #define ZBX_TCP_EXPECT_LENGTH		4
 #define ZBX_TCP_EXPECT_SIZE		5
 
-	ssize_t		nbytes;
-	size_t		buf_dyn_bytes = 0, buf_stat_bytes = 0, offset = 0;
-	zbx_uint64_t	expected_len = 16 * ZBX_MEBIBYTE, reserved = 0, max_len;
-	unsigned char	expect = ZBX_TCP_EXPECT_HEADER;
-	int		protocol_version;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes context for receiving data in several steps          *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [OUT] the receive context                            *
+ *             flags   - [IN] ZBX_TCP_* protocol flags                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *context, unsigned char flags)
+{
+	context->buf_dyn_bytes = 0;
+	context->buf_stat_bytes = 0;
+	context->offset = 0;
+	context->expected_len = 16 * ZBX_MEBIBYTE;
+	context->reserved = 0;
+	context->expect = ZBX_TCP_EXPECT_HEADER;
+	context->flags = flags;
+	context->protocol_version = 0;
+	context->chunk_size = 0;
+	context->stream_func = NULL;
+	context->stream_arg = NULL;
 #if defined(_WINDOWS)
-	max_len = ZBX_MAX_RECV_DATA_SIZE;
+	context->max_len = ZBX_MAX_RECV_DATA_SIZE;
 #else
-	max_len = 0 != (flags & ZBX_TCP_LARGE) ? ZBX_MAX_RECV_LARGE_DATA_SIZE : ZBX_MAX_RECV_DATA_SIZE;
+	context->max_len = 0 != (flags & ZBX_TCP_LARGE) ? ZBX_MAX_RECV_LARGE_DATA_SIZE : ZBX_MAX_RECV_DATA_SIZE;
 #endif
-
-	if (0 != timeout)
-		zbx_socket_timeout_set(s, timeout);
-
 	zbx_socket_free(s);
 
 	s->buf_type = ZBX_BUF_TYPE_STAT;
 	s->buffer = s->buf_stat;
+	s->reserved = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receives message payload in chunks passing them to stream         *
+ *          function instead of buffering the whole message                   *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [IN/OUT] the receive context with parsed header      *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ * Comments: The stream function is called each time the buffer is full and   *
+ *           after the whole message is received. Consumed bytes are removed  *
+ *           from the buffer. If nothing was consumed from full buffer, it is *
+ *           expanded, so in the worst case the whole message is buffered.    *
+ *           Unconsumed data is left in socket buffer after the last call.    *
+ *                                                                            *
+ ******************************************************************************/
+static ssize_t	zbx_tcp_recv_chunks(zbx_socket_t *s, zbx_tcp_recv_context_t *context)
+{
+	size_t		alloc, bytes;
+	zbx_uint64_t	left;
+	ssize_t		nbytes, consumed;
+
+	if ((bytes = context->buf_stat_bytes - context->offset) > context->expected_len)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is longer than expected " ZBX_FS_UI64
+				" bytes. Message ignored.", s->peer, context->expected_len);
+		return FAIL;
+	}
+
+	left = context->expected_len - bytes;
+	alloc = MAX(context->chunk_size, sizeof(s->buf_stat));
+
+	s->buf_type = ZBX_BUF_TYPE_DYN;
+	s->buffer = (char *)zbx_malloc(NULL, alloc + 1);
+	memcpy(s->buffer, s->buf_stat + context->offset, bytes);
+
+	while (0 != left)
+	{
+		if (bytes == alloc)
+		{
+			s->buffer[bytes] = '\0';
+
+			if (FAIL == (consumed = context->stream_func(s->buffer, bytes,
+					context->expected_len + context->offset, 0, context->stream_arg)))
+				return FAIL;
+
+			if (0 != consumed)
+			{
+				bytes -= (size_t)consumed;
+				memmove(s->buffer, s->buffer + consumed, bytes);
+			}
+			else
+			{
+				alloc = (size_t)MIN(alloc * 2, bytes + left);
+				s->buffer = (char *)zbx_realloc(s->buffer, alloc + 1);
+			}
+		}
+
+		if (ZBX_PROTO_ERROR == (nbytes = zbx_tcp_read(s, s->buffer + bytes, (size_t)MIN(alloc - bytes, left),
+				NULL)))
+		{
+			return FAIL;
+		}
+
+		if (0 == nbytes)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "Message from %s is shorter than expected " ZBX_FS_UI64
+					" bytes. Message ignored.", s->peer, context->expected_len);
+			return FAIL;
+		}
 
-	while (0 != (nbytes = zbx_tcp_read(s, s->buf_stat + buf_stat_bytes, sizeof(s->buf_stat) - buf_stat_bytes)))
+		bytes += (size_t)nbytes;
+		left -= (zbx_uint64_t)nbytes;
+	}
+
+	s->buffer[bytes] = '\0';
+
+	if (FAIL == (consumed = context->stream_func(s->buffer, bytes, context->expected_len + context->offset, 1,
+			context->stream_arg)))
+		return FAIL;
+
+	bytes -= (size_t)consumed;
+	memmove(s->buffer, s->buffer + consumed, bytes);
+	s->buffer[bytes] = '\0';
+	s->read_bytes = bytes;
+
+	return (ssize_t)(context->expected_len + context->offset);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receives data using receive context                               *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [IN/OUT] the receive context                         *
+ *             events  - [OUT] optional socket event to wait for before       *
+ *                             calling the function again when the socket is  *
+ *                             in non-blocking mode (NULL - blocking mode)    *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - an error occurred or, if events was set, the message  *
+ *                      is not received completely yet                        *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, short *events)
+{
+	ssize_t	nbytes;
+
+	if (NULL != events)
+		*events = 0;
+
+	while (0 != (nbytes = zbx_tcp_read(s, s->buf_stat + context->buf_stat_bytes,
+			sizeof(s->buf_stat) - context->buf_stat_bytes, events)))
 	{
 		if (ZBX_PROTO_ERROR == nbytes)
-			goto out;
+			return FAIL;
 
 		if (ZBX_BUF_TYPE_STAT == s->buf_type)
-			buf_stat_bytes += nbytes;
+			context->buf_stat_bytes += nbytes;
 		else
 		{
-			if (buf_dyn_bytes + nbytes <= expected_len)
-				memcpy(s->buffer + buf_dyn_bytes, s->buf_stat, nbytes);
-			buf_dyn_bytes += nbytes;
+			if (context->buf_dyn_bytes + nbytes <= context->expected_len)
+				memcpy(s->buffer + context->buf_dyn_bytes, s->buf_stat, nbytes);
+			context->buf_dyn_bytes += nbytes;
 		}
 
-		if (buf_stat_bytes + buf_dyn_bytes >= expected_len)
+		if (context->buf_stat_bytes + context->buf_dyn_bytes >= context->expected_len)
 			break;
 
-		if (ZBX_TCP_EXPECT_HEADER == expect)
+		if (ZBX_TCP_EXPECT_HEADER == context->expect)
 		{
-			if (ZBX_TCP_HEADER_LEN > buf_stat_bytes)
+			if (ZBX_TCP_HEADER_LEN > context->buf_stat_bytes)
 			{
-				if (0 == strncmp(s->buf_stat, ZBX_TCP_HEADER_DATA, buf_stat_bytes))
+				if (0 == strncmp(s->buf_stat, ZBX_TCP_HEADER_DATA, context->buf_stat_bytes))
 					continue;
 
 				break;
@@ -1788,127 +2124,130 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags)
 					break;
 				}
 
-				expect = ZBX_TCP_EXPECT_VERSION;
-				offset += ZBX_TCP_HEADER_LEN;
+				context->expect = ZBX_TCP_EXPECT_VERSION;
+				context->offset += ZBX_TCP_HEADER_LEN;
 			}
 		}
 
-		if (ZBX_TCP_EXPECT_VERSION == expect)
+		if (ZBX_TCP_EXPECT_VERSION == context->expect)
 		{
-			if (offset + 1 > buf_stat_bytes)
+			if (context->offset + 1 > context->buf_stat_bytes)
 				continue;
 
-			expect = ZBX_TCP_EXPECT_VERSION_VALIDATE;
-			protocol_version = s->buf_stat[ZBX_TCP_HEADER_LEN];
+			context->expect = ZBX_TCP_EXPECT_VERSION_VALIDATE;
+			context->protocol_version = s->buf_stat[ZBX_TCP_HEADER_LEN];
 
-			if (0 == (protocol_version & ZBX_TCP_PROTOCOL) ||
-					protocol_version > (ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | flags))
+			if (0 == (context->protocol_version & ZBX_TCP_PROTOCOL) ||
+					context->protocol_version > (ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | context->flags))
 			{
 				/* invalid protocol version, abort receiving */
 				break;
 			}
-			s->protocol = protocol_version;
-			expect = ZBX_TCP_EXPECT_LENGTH;
-			offset++;
+			s->protocol = context->protocol_version;
+			context->expect = ZBX_TCP_EXPECT_LENGTH;
+			context->offset++;
 		}
 
-		if (ZBX_TCP_EXPECT_LENGTH == expect)
+		if (ZBX_TCP_EXPECT_LENGTH == context->expect)
 		{
-			if (0 != (protocol_version & ZBX_TCP_LARGE))
+			if (0 != (context->protocol_version & ZBX_TCP_LARGE))
 			{
 				zbx_uint64_t	len64_le;
 
-				if (offset + 2 * sizeof(len64_le) > buf_stat_bytes)
+				if (context->offset + 2 * sizeof(len64_le) > context->buf_stat_bytes)
 					continue;
 
-				memcpy(&len64_le, s->buf_stat + offset, sizeof(len64_le));
-				offset += sizeof(len64_le);
-				expected_len = zbx_letoh_uint64(len64_le);
+				memcpy(&len64_le, s->buf_stat + context->offset, sizeof(len64_le));
+				context->offset += sizeof(len64_le);
+				context->expected_len = zbx_letoh_uint64(len64_le);
 
-				memcpy(&len64_le, s->buf_stat + offset, sizeof(len64_le));
-				offset += sizeof(len64_le);
-				reserved = zbx_letoh_uint64(len64_le);
+				memcpy(&len64_le, s->buf_stat + context->offset, sizeof(len64_le));
+				context->offset += sizeof(len64_le);
+				context->reserved = zbx_letoh_uint64(len64_le);
 			}
 			else
 			{
 				zbx_uint32_t	len32_le;
 
-				if (offset + 2 * sizeof(len32_le) > buf_stat_bytes)
+				if (context->offset + 2 * sizeof(len32_le) > context->buf_stat_bytes)
 					continue;
 
-				memcpy(&len32_le, s->buf_stat + offset, sizeof(len32_le));
-				offset += sizeof(len32_le);
-				expected_len = zbx_letoh_uint32(len32_le);
+				memcpy(&len32_le, s->buf_stat + context->offset, sizeof(len32_le));
+				context->offset += sizeof(len32_le);
+				context->expected_len = zbx_letoh_uint32(len32_le);
 
-				memcpy(&len32_le, s->buf_stat + offset, sizeof(len32_le));
-				offset += sizeof(len32_le);
-				reserved = zbx_letoh_uint32(len32_le);
+				memcpy(&len32_le, s->buf_stat + context->offset, sizeof(len32_le));
+				context->offset += sizeof(len32_le);
+				context->reserved = zbx_letoh_uint32(len32_le);
 			}
 
-			if (max_len < expected_len)
+			if (context->max_len < context->expected_len)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "Message size " ZBX_FS_UI64 " from %s exceeds the "
-						"maximum size " ZBX_FS_UI64 " bytes. Message ignored.", expected_len,
-						s->peer, max_len);
-				nbytes = ZBX_PROTO_ERROR;
-				goto out;
+						"maximum size " ZBX_FS_UI64 " bytes. Message ignored.",
+						context->expected_len, s->peer, context->max_len);
+				return FAIL;
 			}
 
 			/* compressed protocol stores uncompressed packet size in the reserved data */
-			if (max_len < reserved)
+			if (context->max_len < context->reserved)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "Uncompressed message size " ZBX_FS_UI64 " from %s"
 						" exceeds the maximum size " ZBX_FS_UI64 " bytes. Message ignored.",
-						reserved, s->peer, max_len);
-				nbytes = ZBX_PROTO_ERROR;
-				goto out;
+						context->reserved, s->peer, context->max_len);
+				return FAIL;
 			}
 
-			if (sizeof(s->buf_stat) > expected_len)
+			if (sizeof(s->buf_stat) > context->expected_len)
 			{
-				buf_stat_bytes -= offset;
-				memmove(s->buf_stat, s->buf_stat + offset, buf_stat_bytes);
+				context->buf_stat_bytes -= context->offset;
+				memmove(s->buf_stat, s->buf_stat + context->offset, context->buf_stat_bytes);
+			}
+			else if (NULL != context->stream_func && NULL == events &&
+					context->chunk_size < context->expected_len &&
+					0 == (context->protocol_version & ZBX_TCP_COMPRESS))
+			{
+				return zbx_tcp_recv_chunks(s, context);
 			}
 			else
 			{
 				s->buf_type = ZBX_BUF_TYPE_DYN;
-				s->buffer = (char *)zbx_malloc(NULL, expected_len + 1);
-				buf_dyn_bytes = buf_stat_bytes - offset;
-				buf_stat_bytes = 0;
-				memcpy(s->buffer, s->buf_stat + offset, buf_dyn_bytes);
+				s->buffer = (char *)zbx_malloc(NULL, context->expected_len + 1);
+				context->buf_dyn_bytes = context->buf_stat_bytes - context->offset;
+				context->buf_stat_bytes = 0;
+				memcpy(s->buffer, s->buf_stat + context->offset, context->buf_dyn_bytes);
 			}
 
-			expect = ZBX_TCP_EXPECT_SIZE;
+			context->expect = ZBX_TCP_EXPECT_SIZE;
 
-			if (buf_stat_bytes + buf_dyn_bytes >= expected_len)
+			if (context->buf_stat_bytes + context->buf_dyn_bytes >= context->expected_len)
 				break;
 		}
 	}
 
-	if (ZBX_TCP_EXPECT_SIZE == expect)
+	if (ZBX_TCP_EXPECT_SIZE == context->expect)
 	{
-		if (buf_stat_bytes + buf_dyn_bytes == expected_len)
+		if (context->buf_stat_bytes + context->buf_dyn_bytes == context->expected_len)
 		{
-			if (0 != (protocol_version & ZBX_TCP_COMPRESS))
+			if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
 			{
 				char	*out;
-				size_t	out_size = reserved;
+				size_t	out_size = context->reserved;
 
-				out = (char *)zbx_malloc(NULL, reserved + 1);
-				if (FAIL == zbx_uncompress(s->buffer, buf_stat_bytes + buf_dyn_bytes, out, &out_size))
+				out = (char *)zbx_malloc(NULL, context->reserved + 1);
+				if (FAIL == zbx_uncompress(s->buffer, context->buf_stat_bytes + context->buf_dyn_bytes, out,
+						&out_size))
 				{
 					zbx_free(out);
 					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
-					nbytes = ZBX_PROTO_ERROR;
-					goto out;
+					return FAIL;
 				}
 
-				if (out_size != reserved)
+				if (out_size != context->reserved)
 				{
 					zbx_free(out);
 					zbx_set_socket_strerror("size of uncompressed data is less than expected");
-					nbytes = ZBX_PROTO_ERROR;
-					goto out;
+					return FAIL;
 				}
 
 				if (ZBX_BUF_TYPE_DYN == s->buf_type)
@@ -1916,71 +2255,141 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags)
 
 				s->buf_type = ZBX_BUF_TYPE_DYN;
 				s->buffer = out;
-				s->read_bytes = reserved;
+				s->read_bytes = context->reserved;
 
 				zabbix_log(LOG_LEVEL_TRACE, "%s(): received " ZBX_FS_SIZE_T " bytes with"
 						" compression ratio %.1f", __func__,
-						(zbx_fs_size_t)(buf_stat_bytes + buf_dyn_bytes),
-						(double)reserved / (buf_stat_bytes + buf_dyn_bytes));
+						(zbx_fs_size_t)(context->buf_stat_bytes + context->buf_dyn_bytes),
+						(double)context->reserved /
+						(context->buf_stat_bytes + context->buf_dyn_bytes));
 			}
 			else
-				s->read_bytes = buf_stat_bytes + buf_dyn_bytes;
+			{
+				s->read_bytes = context->buf_stat_bytes + context->buf_dyn_bytes;
+				s->reserved = context->reserved;
+			}
 
 			s->buffer[s->read_bytes] = '\0';
 		}
 		else
 		{
-			if (buf_stat_bytes + buf_dyn_bytes < expected_len)
+			if (context->buf_stat_bytes + context->buf_dyn_bytes < context->expected_len)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "Message from %s is shorter than expected " ZBX_FS_UI64
-						" bytes. Message ignored.", s->peer, (zbx_uint64_t)expected_len);
+						" bytes. Message ignored.", s->peer, (zbx_uint64_t)context->expected_len);
 			}
 			else
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "Message from %s is longer than expected " ZBX_FS_UI64
-						" bytes. Message ignored.", s->peer, (zbx_uint64_t)expected_len);
+						" bytes. Message ignored.", s->peer, (zbx_uint64_t)context->expected_len);
 			}
 
-			nbytes = ZBX_PROTO_ERROR;
+			return FAIL;
 		}
 	}
-	else if (ZBX_TCP_EXPECT_LENGTH == expect)
+	else if (ZBX_TCP_EXPECT_LENGTH == context->expect)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is missing data length. Message ignored.", s->peer);
-		nbytes = ZBX_PROTO_ERROR;
+		return FAIL;
 	}
-	else if (ZBX_TCP_EXPECT_VERSION == expect)
+	else if (ZBX_TCP_EXPECT_VERSION == context->expect)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is missing protocol version. Message ignored.",
 				s->peer);
-		nbytes = ZBX_PROTO_ERROR;
+		return FAIL;
 	}
-	else if (ZBX_TCP_EXPECT_VERSION_VALIDATE == expect)
+	else if (ZBX_TCP_EXPECT_VERSION_VALIDATE == context->expect)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is using unsupported protocol version \"%d\"."
-				" Message ignored.", s->peer, protocol_version);
-		nbytes = ZBX_PROTO_ERROR;
+				" Message ignored.", s->peer, context->protocol_version);
+		return FAIL;
 	}
-	else if (0 != buf_stat_bytes)
+	else if (0 != context->buf_stat_bytes)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is missing header. Message ignored.", s->peer);
-		nbytes = ZBX_PROTO_ERROR;
+		return FAIL;
 	}
 	else
 	{
 		s->read_bytes = 0;
 		s->buffer[s->read_bytes] = '\0';
 	}
-out:
+
+	return (ssize_t)(s->read_bytes + context->offset);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive data                                                      *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags)
+{
+	zbx_tcp_recv_context_t	context;
+	ssize_t			ret;
+
+	if (0 != timeout)
+		zbx_socket_timeout_set(s, timeout);
+
+	zbx_tcp_recv_context_init(s, &context, flags);
+	ret = zbx_tcp_recv_context(s, &context, NULL);
+
 	if (0 != timeout)
 		zbx_socket_timeout_cleanup(s);
 
-	return (ZBX_PROTO_ERROR == nbytes ? FAIL : (ssize_t)(s->read_bytes + offset));
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive data, passing large uncompressed messages to stream       *
+ *          function in chunks                                                *
+ *                                                                            *
+ * Parameters: s           - [IN] the socket                                  *
+ *             timeout     - [IN] the receive timeout, 0 - use current        *
+ *             flags       - [IN] ZBX_TCP_* protocol flags                    *
+ *             chunk_size  - [IN] the buffer size for streamed messages       *
+ *             stream_func - [IN] the function consuming received data        *
+ *             stream_arg  - [IN] the stream function argument                *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ * Comments: Messages not larger than chunk_size and compressed messages are  *
+ *           received the same way as with zbx_tcp_recv_ext() without calling *
+ *           the stream function.                                             *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tcp_recv_stream(zbx_socket_t *s, int timeout, unsigned char flags, size_t chunk_size,
+		zbx_tcp_recv_stream_func_t stream_func, void *stream_arg)
+{
+	zbx_tcp_recv_context_t	context;
+	ssize_t			ret;
+
+	if (0 != timeout)
+		zbx_socket_timeout_set(s, timeout);
+
+	zbx_tcp_recv_context_init(s, &context, flags);
+	context.chunk_size = chunk_size;
+	context.stream_func = stream_func;
+	context.stream_arg = stream_arg;
+
+	ret = zbx_tcp_recv_context(s, &context, NULL);
+
+	if (0 != timeout)
+		zbx_socket_timeout_cleanup(s);
+
+	return ret;
+}
 
 #undef ZBX_TCP_EXPECT_HEADER
+#undef ZBX_TCP_EXPECT_VERSION
+#undef ZBX_TCP_EXPECT_VERSION_VALIDATE
 #undef ZBX_TCP_EXPECT_LENGTH
 #undef ZBX_TCP_EXPECT_SIZE
-}
 
 /******************************************************************************
  *                                                                            *
@@ -2004,7 +2413,8 @@ ssize_t	zbx_tcp_recv_raw_ext(zbx_socket_t *s, int timeout)
 	s->buf_type = ZBX_BUF_TYPE_STAT;
 	s->buffer = s->buf_stat;
 
-	while (0 != (nbytes = zbx_tcp_read(s, s->buf_stat + buf_stat_bytes, sizeof(s->buf_stat) - buf_stat_bytes)))
+	while (0 != (nbytes = zbx_tcp_read(s, s->buf_stat + buf_stat_bytes, sizeof(s->buf_stat) - buf_stat_bytes,
+			NULL)))
 	{
 		if (ZBX_PROTO_ERROR == nbytes)
 			goto out;
@@ -137,7 +137,12 @@ struct zbx_tls_context
 	gnutls_psk_server_credentials_t	psk_server_creds;
 #elif defined(HAVE_OPENSSL)
 	SSL				*ctx;
+#if defined(HAVE_OPENSSL_WITH_PSK)
+	char				psk_identity[PSK_MAX_IDENTITY_LEN + 1];	/* PSK identity of incoming */
+										/* connection */
+#endif
 #endif
+	unsigned int			psk_usage;	/* ZBX_PSK_FOR_* flags of PSK found for incoming connection */
 };
 
 extern unsigned int			configured_tls_connect_mode;
@@ -178,9 +183,6 @@ static ZBX_THREAD_LOCAL size_t		my_psk_len		= 0;
 /* but other components (e.g. agent) do not link dbconfig.o. */
 size_t	(*find_psk_in_cache)(const unsigned char *, unsigned char *, unsigned int *) = NULL;
 
-/* variable for passing information from callback functions if PSK was found among host PSKs or autoregistration PSK */
-static unsigned int	psk_usage;
-
 #if defined(HAVE_GNUTLS)
 static ZBX_THREAD_LOCAL gnutls_certificate_credentials_t	my_cert_creds		= NULL;
 static ZBX_THREAD_LOCAL gnutls_psk_client_credentials_t		my_psk_client_creds	= NULL;
@@ -202,11 +204,6 @@ static ZBX_THREAD_LOCAL char			*psk_for_cb		= NULL;
 static ZBX_THREAD_LOCAL size_t			psk_len_for_cb		= 0;
 #endif
 static int					init_done 		= 0;
-#ifdef HAVE_OPENSSL_WITH_PSK
-/* variables for capturing PSK identity from server callback function */
-static ZBX_THREAD_LOCAL int			incoming_connection_has_psk = 0;
-static ZBX_THREAD_LOCAL char			incoming_connection_psk_id[PSK_MAX_IDENTITY_LEN + 1];
-#endif
 /* buffer for messages produced by zbx_openssl_info_cb() */
 ZBX_THREAD_LOCAL char				info_buf[256];
 #endif
@@ -983,7 +980,7 @@ static void	zbx_psk_warn_misconfig(const char *psk_identity)
  *     find and set the requested pre-shared key upon GnuTLS request          *
  *                                                                            *
  * Parameters:                                                                *
- *     session      - [IN] not used                                           *
+ *     session      - [IN] TLS session of incoming connection                 *
  *     psk_identity - [IN] PSK identity for which the PSK should be searched  *
  *                         and set                                            *
  *     key          - [OUT pre-shared key allocated and set                   *
@@ -999,21 +996,22 @@ static void	zbx_psk_warn_misconfig(const char *psk_identity)
  ******************************************************************************/
 static int	zbx_psk_cb(gnutls_session_t session, const char *psk_identity, gnutls_datum_t *key)
 {
-	char		*psk;
-	size_t		psk_len = 0;
-	int		psk_bin_len;
-	unsigned char	tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
+	char			*psk;
+	size_t			psk_len = 0;
+	int			psk_bin_len;
+	unsigned char		tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
+	zbx_tls_context_t	*tls_ctx;
 
-	ZBX_UNUSED(session);
+	tls_ctx = (zbx_tls_context_t *)gnutls_session_get_ptr(session);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() requested PSK identity \"%s\"", __func__, psk_identity);
 
-	psk_usage = 0;
+	tls_ctx->psk_usage = 0;
 
 	if (0 != (program_type & (ZBX_PROGRAM_TYPE_PROXY | ZBX_PROGRAM_TYPE_SERVER)))
 	{
 		/* call the function DCget_psk_by_identity() by pointer */
-		if (0 < find_psk_in_cache((const unsigned char *)psk_identity, tls_psk_hex, &psk_usage))
+		if (0 < find_psk_in_cache((const unsigned char *)psk_identity, tls_psk_hex, &tls_ctx->psk_usage))
 		{
 			/* The PSK is in configuration cache. Convert PSK to binary form. */
 			if (0 >= (psk_bin_len = zbx_hex2bin(tls_psk_hex, psk_buf, sizeof(psk_buf))))
@@ -1033,13 +1031,13 @@ static int	zbx_psk_cb(gnutls_session_t session, const char *psk_identity, gnutls
 				0 == strcmp(my_psk_identity, psk_identity))
 		{
 			/* the PSK is in proxy configuration file */
-			psk_usage |= ZBX_PSK_FOR_PROXY;
+			tls_ctx->psk_usage |= ZBX_PSK_FOR_PROXY;
 
 			if (0 < psk_len && (psk_len != my_psk_len || 0 != memcmp(psk, my_psk, psk_len)))
 			{
 				/* PSK was also found in configuration cache but with different value */
 				zbx_psk_warn_misconfig(psk_identity);
-				psk_usage &= ~(unsigned int)ZBX_PSK_FOR_AUTOREG;
+				tls_ctx->psk_usage &= ~(unsigned int)ZBX_PSK_FOR_AUTOREG;
 			}
 
 			psk = my_psk;	/* prefer PSK from proxy configuration file */
@@ -1148,7 +1146,7 @@ static unsigned int	zbx_psk_client_cb(SSL *ssl, const char *hint, char *identity
  *     set pre-shared key for incoming TLS connection upon OpenSSL request    *
  *                                                                            *
  * Parameters:                                                                *
- *     ssl              - [IN] not used                                       *
+ *     ssl              - [IN] TLS connection context                         *
  *     identity         - [IN] PSK identity sent by client                    *
  *     psk              - [OUT] buffer to write PSK into                      *
  *     max_psk_len      - [IN] size of the 'psk' buffer                       *
@@ -1165,22 +1163,22 @@ static unsigned int	zbx_psk_client_cb(SSL *ssl, const char *hint, char *identity
 static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned char *psk,
 		unsigned int max_psk_len)
 {
-	char		*psk_loc;
-	size_t		psk_len = 0;
-	int		psk_bin_len;
-	unsigned char	tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
+	char			*psk_loc;
+	size_t			psk_len = 0;
+	int			psk_bin_len;
+	unsigned char		tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
+	zbx_tls_context_t	*tls_ctx;
 
-	ZBX_UNUSED(ssl);
+	tls_ctx = (zbx_tls_context_t *)SSL_get_app_data(ssl);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() requested PSK identity \"%s\"", __func__, identity);
 
-	incoming_connection_has_psk = 1;
-	psk_usage = 0;
+	tls_ctx->psk_usage = 0;
 
 	if (0 != (program_type & (ZBX_PROGRAM_TYPE_PROXY | ZBX_PROGRAM_TYPE_SERVER)))
 	{
 		/* call the function DCget_psk_by_identity() by pointer */
-		if (0 < find_psk_in_cache((const unsigned char *)identity, tls_psk_hex, &psk_usage))
+		if (0 < find_psk_in_cache((const unsigned char *)identity, tls_psk_hex, &tls_ctx->psk_usage))
 		{
 			/* The PSK is in configuration cache. Convert PSK to binary form. */
 			if (0 >= (psk_bin_len = zbx_hex2bin(tls_psk_hex, psk_buf, sizeof(psk_buf))))
@@ -1200,13 +1198,13 @@ static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned c
 				0 == strcmp(my_psk_identity, identity))
 		{
 			/* the PSK is in proxy configuration file */
-			psk_usage |= ZBX_PSK_FOR_PROXY;
+			tls_ctx->psk_usage |= ZBX_PSK_FOR_PROXY;
 
 			if (0 < psk_len && (psk_len != my_psk_len || 0 != memcmp(psk_loc, my_psk, psk_len)))
 			{
 				/* PSK was also found in configuration cache but with different value */
 				zbx_psk_warn_misconfig(identity);
-				psk_usage &= ~(unsigned int)ZBX_PSK_FOR_AUTOREG;
+				tls_ctx->psk_usage &= ~(unsigned int)ZBX_PSK_FOR_AUTOREG;
 			}
 
 			psk_loc = my_psk;	/* prefer PSK from proxy configuration file */
@@ -1247,12 +1245,12 @@ static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned c
 		}
 
 		memcpy(psk, psk_loc, psk_len);
-		zbx_strlcpy(incoming_connection_psk_id, identity, sizeof(incoming_connection_psk_id));
+		zbx_strlcpy(tls_ctx->psk_identity, identity, sizeof(tls_ctx->psk_identity));
 
 		return (unsigned int)psk_len;	/* success */
 	}
 fail:
-	incoming_connection_psk_id[0] = '\0';
+	tls_ctx->psk_identity[0] = '\0';
 	return 0;	/* PSK not found */
 }
 #endif
@@ -3713,31 +3711,74 @@ out1:
 }
 #endif
 
+#if !defined(_WINDOWS)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if TLS operation on non-blocking socket must be repeated    *
+ *          when the socket becomes ready                                     *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     ctx   - [IN] TLS session                                               *
+ *     res   - [IN] result code returned by TLS library function             *
+ *     event - [OUT] socket event to wait for (POLLIN or POLLOUT)             *
+ *                                                                            *
+ * Return value:                                                              *
+ *     SUCCEED - the operation would block and must be repeated               *
+ *     FAIL    - otherwise                                                    *
+ *                                                                            *
+ ******************************************************************************/
+#if defined(HAVE_GNUTLS)
+static int	zbx_tls_socket_event(gnutls_session_t ctx, int res, short *event)
+{
+	if (GNUTLS_E_AGAIN != res)
+		return FAIL;
+
+	*event = (0 == gnutls_record_get_direction(ctx) ? POLLIN : POLLOUT);
+
+	return SUCCEED;
+}
+#elif defined(HAVE_OPENSSL)
+static int	zbx_tls_socket_event(SSL *ctx, int res, short *event)
+{
+	switch (SSL_get_error(ctx, res))
+	{
+		case SSL_ERROR_WANT_READ:
+			*event = POLLIN;
+			return SUCCEED;
+		case SSL_ERROR_WANT_WRITE:
+			*event = POLLOUT;
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+#endif
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: establish a TLS connection over an accepted TCP connection        *
  *                                                                            *
  * Parameters:                                                                *
  *     s          - [IN] socket with opened connection                        *
- *     error      - [OUT] dynamically allocated memory with error message     *
  *     tls_accept - [IN] type of connection to accept. Can be be either       *
  *                       ZBX_TCP_SEC_TLS_CERT or ZBX_TCP_SEC_TLS_PSK, or      *
  *                       a bitwise 'OR' of both.                              *
+ *     event      - [OUT] optional socket event to wait for before calling    *
+ *                        the function again when the socket is in            *
+ *                        non-blocking mode (NULL - blocking handshake)       *
+ *     error      - [OUT] dynamically allocated memory with error message     *
  *                                                                            *
  * Return value:                                                              *
  *     SUCCEED - successful TLS handshake with a valid certificate or PSK     *
- *     FAIL - an error occurred                                               *
+ *     FAIL - an error occurred or, if event was set, the handshake is not    *
+ *            finished yet                                                    *
  *                                                                            *
  ******************************************************************************/
 #if defined(HAVE_GNUTLS)
-int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
+static int	zbx_tls_accept_init(zbx_socket_t *s, unsigned int tls_accept, char **error)
 {
-	int				ret = FAIL, res;
-	gnutls_credentials_type_t	creds;
-#if defined(_WINDOWS)
-	double				sec;
-#endif
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	int	res;
 
 	/* set up TLS context */
 
@@ -3745,6 +3786,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	s->tls_ctx->ctx = NULL;
 	s->tls_ctx->psk_client_creds = NULL;
 	s->tls_ctx->psk_server_creds = NULL;
+	s->tls_ctx->psk_usage = 0;
 
 	if (GNUTLS_E_SUCCESS != (res = gnutls_init(&s->tls_ctx->ctx, GNUTLS_SERVER)))
 	{
@@ -3868,6 +3910,38 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 
 	gnutls_transport_set_int(s->tls_ctx->ctx, ZBX_SOCKET_TO_INT(s->socket));
 
+	/* make TLS context available to PSK callback function */
+	gnutls_session_set_ptr(s->tls_ctx->ctx, s->tls_ctx);
+
+	return SUCCEED;
+out:
+	if (NULL != s->tls_ctx->ctx)
+	{
+		gnutls_credentials_clear(s->tls_ctx->ctx);
+		gnutls_deinit(s->tls_ctx->ctx);
+	}
+
+	if (NULL != s->tls_ctx->psk_server_creds)
+		gnutls_psk_free_server_credentials(s->tls_ctx->psk_server_creds);
+
+	zbx_free(s->tls_ctx);
+
+	return FAIL;
+}
+
+int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, short *event, char **error)
+{
+	int				ret = FAIL, res;
+	gnutls_credentials_type_t	creds;
+#if defined(_WINDOWS)
+	double				sec;
+#endif
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	/* non-blocking handshake is continued with already initialized TLS context */
+	if (NULL == s->tls_ctx && SUCCEED != zbx_tls_accept_init(s, tls_accept, error))
+		goto out1;
+
 	/* TLS handshake */
 
 #if defined(_WINDOWS)
@@ -3888,6 +3962,13 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 
 		if (GNUTLS_E_INTERRUPTED == res || GNUTLS_E_AGAIN == res)
 		{
+#if !defined(_WINDOWS)
+			if (NULL != event && SUCCEED == zbx_tls_socket_event(s->tls_ctx->ctx, res, event))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "End of %s():FAIL handshake in progress", __func__);
+				return FAIL;
+			}
+#endif
 			continue;
 		}
 		else if (GNUTLS_E_WARNING_ALERT_RECEIVED == res || GNUTLS_E_FATAL_ALERT_RECEIVED == res ||
@@ -4001,25 +4082,18 @@ out1:
 	return ret;
 }
 #elif defined(HAVE_OPENSSL)
-int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
+static int	zbx_tls_accept_init(zbx_socket_t *s, unsigned int tls_accept, char **error)
 {
-	const char	*cipher_name;
-	int		ret = FAIL, res;
-	size_t		error_alloc = 0, error_offset = 0;
-	long		verify_result;
-#if defined(_WINDOWS)
-	double		sec;
-#endif
+	size_t	error_alloc = 0, error_offset = 0;
 #if OPENSSL_VERSION_NUMBER >= 0x1010100fL	/* OpenSSL 1.1.1 or newer, or LibreSSL */
 	const unsigned char	session_id_context[] = {'Z', 'b', 'x'};
 #endif
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
-
 	s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
 	s->tls_ctx->ctx = NULL;
+	s->tls_ctx->psk_usage = 0;
 
 #if defined(HAVE_OPENSSL_WITH_PSK)
-	incoming_connection_has_psk = 0;	/* assume certificate-based connection by default */
+	s->tls_ctx->psk_identity[0] = '\0';	/* assume certificate-based connection by default */
 #endif
 	if ((ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK) == (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
 	{
@@ -4141,6 +4215,34 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		goto out;
 	}
 
+	/* make TLS context available to PSK callback function */
+	SSL_set_app_data(s->tls_ctx->ctx, s->tls_ctx);
+
+	return SUCCEED;
+out:
+	if (NULL != s->tls_ctx->ctx)
+		SSL_free(s->tls_ctx->ctx);
+
+	zbx_free(s->tls_ctx);
+
+	return FAIL;
+}
+
+int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, short *event, char **error)
+{
+	const char	*cipher_name;
+	int		ret = FAIL, res;
+	size_t		error_alloc = 0, error_offset = 0;
+	long		verify_result;
+#if defined(_WINDOWS)
+	double		sec;
+#endif
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	/* non-blocking handshake is continued with already initialized TLS context */
+	if (NULL == s->tls_ctx && SUCCEED != zbx_tls_accept_init(s, tls_accept, error))
+		goto out1;
+
 	/* TLS handshake */
 
 	info_buf[0] = '\0';	/* empty buffer for zbx_openssl_info_cb() messages */
@@ -4155,6 +4257,12 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 #if defined(_WINDOWS)
 		if (s->timeout < zbx_time() - sec)
 			zbx_alarm_flag_set();
+#else
+		if (NULL != event && SUCCEED == zbx_tls_socket_event(s->tls_ctx->ctx, res, event))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "End of %s():FAIL handshake in progress", __func__);
+			return FAIL;
+		}
 #endif
 		if (SUCCEED == zbx_alarm_timed_out())
 		{
@@ -4195,7 +4303,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	cipher_name = SSL_get_cipher(s->tls_ctx->ctx);
 
 #if defined(HAVE_OPENSSL_WITH_PSK)
-	if (1 == incoming_connection_has_psk)
+	if ('\0' != s->tls_ctx->psk_identity[0])
 	{
 		s->connection_type = ZBX_TCP_SEC_TLS_PSK;
 	}
@@ -4311,7 +4419,7 @@ ssize_t	zbx_tls_write(zbx_socket_t *s, const char *buf, size_t len, char **error
 	return (ssize_t)res;
 }
 
-ssize_t	zbx_tls_read(zbx_socket_t *s, char *buf, size_t len, char **error)
+ssize_t	zbx_tls_read(zbx_socket_t *s, char *buf, size_t len, short *event, char **error)
 {
 #if defined(HAVE_GNUTLS)
 	ssize_t	res;
@@ -4331,6 +4439,10 @@ ssize_t	zbx_tls_read(zbx_socket_t *s, char *buf, size_t len, char **error)
 			*error = zbx_strdup(*error, ZBX_TLS_READ_FUNC_NAME "() timed out");
 			return ZBX_PROTO_ERROR;
 		}
+
+		/* non-blocking read must be repeated when the socket becomes ready, leave error unset */
+		if (NULL != event && 0 >= res && SUCCEED == zbx_tls_socket_event(s->tls_ctx->ctx, (int)res, event))
+			return ZBX_PROTO_ERROR;
 #endif
 	}
 	while (SUCCEED == ZBX_TLS_WANT_READ(res));
@@ -4550,14 +4662,12 @@ int	zbx_tls_get_attr_psk(const zbx_socket_t *s, zbx_tls_conn_attr_t *attr)
 #elif defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK)
 int	zbx_tls_get_attr_psk(const zbx_socket_t *s, zbx_tls_conn_attr_t *attr)
 {
-	ZBX_UNUSED(s);
-
 	/* SSL_get_psk_identity() is not used here. It works with TLS 1.2, */
 	/* but returns NULL with TLS 1.3 in OpenSSL 1.1.1 */
-	if ('\0' == incoming_connection_psk_id[0])
+	if ('\0' == s->tls_ctx->psk_identity[0])
 		return FAIL;
 
-	attr->psk_identity = incoming_connection_psk_id;
+	attr->psk_identity = s->tls_ctx->psk_identity;
 	attr->psk_identity_len = strlen(attr->psk_identity);
 	return SUCCEED;
 }
@@ -4617,8 +4727,8 @@ void	zbx_tls_take_vars(ZBX_THREAD_SENDVAL_TLS_ARGS *args)
 }
 #endif
 
-unsigned int	zbx_tls_get_psk_usage(void)
+unsigned int	zbx_tls_get_psk_usage(const zbx_socket_t *s)
 {
-	return	psk_usage;
+	return	s->tls_ctx->psk_usage;
 }
 #endif
@@ -33,7 +33,7 @@ zbx_tls_conn_attr_t;
 int		zbx_tls_get_attr_cert(const zbx_socket_t *s, zbx_tls_conn_attr_t *attr);
 int		zbx_tls_get_attr_psk(const zbx_socket_t *s, zbx_tls_conn_attr_t *attr);
 int		zbx_check_server_issuer_subject(zbx_socket_t *sock, char **error);
-unsigned int	zbx_tls_get_psk_usage(void);
+unsigned int	zbx_tls_get_psk_usage(const zbx_socket_t *s);
 #endif
 
 #endif	/* ZABBIX_TLS_TCP_ACTIVE_H */
@@ -71,6 +71,7 @@ static int	txn_end_error = ZBX_DB_OK;	/* transaction result */
 static char	*last_db_strerror = NULL;	/* last database error message */
 
 extern int	CONFIG_LOG_SLOW_QUERIES;
+extern int	CONFIG_DB_PREPARED_STATEMENTS;
 
 static int	db_auto_increment;
 
@@ -102,11 +103,30 @@ static ub4	OCI_DBserver_status(void);
 #define ORA_ERR_UNIQ_CONSTRAINT	-1
 
 #elif defined(HAVE_POSTGRESQL)
+#include "zbxalgo.h"
+
+#define ZBX_PG_STATEMENTS_MAX	1000	/* maximum number of prepared statements per connection */
+
+/* server side prepared statement */
+typedef struct
+{
+	char	*sql;
+	char	name[32];
+}
+zbx_pg_statement_t;
+
 static PGconn			*conn = NULL;
 static unsigned int		ZBX_PG_BYTEAOID = 0;
 static int			ZBX_TSDB_VERSION = -1;
 static zbx_uint32_t		ZBX_PG_SVERSION = ZBX_DBVERSION_UNDEFINED;
 char				ZBX_PG_ESCAPE_BACKSLASH = 1;
+
+/* prepared statements of the current connection, indexed by statement text */
+static zbx_hashset_t		pg_statements;
+static zbx_uint64_t		pg_statements_next = 0;
+
+/* additional connection for statements sent without waiting for their results */
+static PGconn			*async_conn = NULL;
 #elif defined(HAVE_SQLITE3)
 static sqlite3			*conn = NULL;
 static zbx_mutex_t		sqlite_access = ZBX_MUTEX_NULL;
@@ -354,6 +374,46 @@ static int	is_recoverable_postgresql_error(const PGconn *pg_conn, const PGresult
 
 	return FAIL;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check result of PostgreSQL statement execution                    *
+ *                                                                            *
+ * Parameters: result - [IN] the statement execution result                   *
+ *             status - [IN] the expected result status                       *
+ *             sql    - [IN] the executed statement (for logging)             *
+ *                                                                            *
+ * Return value: ZBX_DB_OK   - the result has expected status                 *
+ *               ZBX_DB_FAIL - the statement has failed                       *
+ *               ZBX_DB_DOWN - the statement has failed, but can be retried   *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pg_check_result(const PGresult *result, ExecStatusType status, const char *sql)
+{
+	zbx_err_codes_t	errcode;
+	char		*error = NULL;
+
+	if (NULL == result)
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	if (status == PQresultStatus(result))
+		return ZBX_DB_OK;
+
+	zbx_postgresql_error(&error, result);
+
+	if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), "23505"))
+		errcode = ERR_Z3008;
+	else
+		errcode = ERR_Z3005;
+
+	zbx_db_errlog(errcode, 0, error, sql);
+	zbx_free(error);
+
+	return SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+}
 #endif
 
 /******************************************************************************
@@ -1002,6 +1062,10 @@ void	zbx_db_close(void)
 		PQfinish(conn);
 		conn = NULL;
 	}
+
+	/* prepared statements do not survive the connection */
+	if (NULL != pg_statements.slots)
+		zbx_hashset_clear(&pg_statements);
 #elif defined(HAVE_SQLITE3)
 	if (NULL != conn)
 	{
@@ -1428,7 +1492,6 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 	sword		err = OCI_SUCCESS;
 #elif defined(HAVE_POSTGRESQL)
 	PGresult	*result;
-	char		*error = NULL;
 #elif defined(HAVE_SQLITE3)
 	int		err;
 	char		*error = NULL;
@@ -1510,29 +1573,7 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 #elif defined(HAVE_POSTGRESQL)
 	result = PQexec(conn,sql);
 
-	if (NULL == result)
-	{
-		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
-		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
-	}
-	else if (PGRES_COMMAND_OK != PQresultStatus(result))
-	{
-		zbx_err_codes_t	errcode;
-
-		zbx_postgresql_error(&error, result);
-
-		if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), "23505"))
-			errcode = ERR_Z3008;
-		else
-			errcode = ERR_Z3005;
-
-		zbx_db_errlog(errcode, 0, error, sql);
-		zbx_free(error);
-
-		ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
-	}
-
-	if (ZBX_DB_OK == ret)
+	if (ZBX_DB_OK == (ret = zbx_db_pg_check_result(result, PGRES_COMMAND_OK, sql)))
 		ret = atoi(PQcmdTuples(result));
 
 	PQclear(result);
@@ -1590,6 +1631,258 @@ clean:
 	return ret;
 }
 
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: load rows into table with COPY FROM STDIN statement               *
+ *                                                                            *
+ * Parameters: sql      - [IN] the COPY statement                             *
+ *             data     - [IN] the rows in COPY text format                   *
+ *             data_len - [IN] the data length                                *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows copied (on success)                        *
+ *                                                                            *
+ * Comments: Rows are streamed to server without being parsed as part of SQL  *
+ *           statement, which is considerably cheaper for large batches.      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy_from(const char *sql, const char *data, size_t data_len)
+{
+	PGresult	*result;
+	int		ret;
+	double		sec = 0;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] data size:" ZBX_FS_SIZE_T, txn_level, sql,
+			(zbx_fs_size_t)data_len);
+
+	result = PQexec(conn, sql);
+
+	if (ZBX_DB_OK != (ret = zbx_db_pg_check_result(result, PGRES_COPY_IN, sql)))
+		goto out;
+
+	PQclear(result);
+	result = NULL;
+
+	if (1 != PQputCopyData(conn, data, (int)data_len) || 1 != PQputCopyEnd(conn, NULL))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	result = PQgetResult(conn);
+
+	if (ZBX_DB_OK == (ret = zbx_db_pg_check_result(result, PGRES_COMMAND_OK, sql)))
+		ret = atoi(PQcmdTuples(result));
+out:
+	PQclear(result);
+
+	/* consume the remaining results to return connection into idle state */
+	while (NULL != (result = PQgetResult(conn)))
+		PQclear(result);
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+}
+#endif
+
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: open the asynchronous statement connection                        *
+ *                                                                            *
+ * Return value: ZBX_DB_OK - successfully connected                           *
+ *               ZBX_DB_DOWN - database is down                               *
+ *               ZBX_DB_FAIL - failed to connect                              *
+ *                                                                            *
+ * Comments: The connection is opened with the same parameters and session    *
+ *           settings as the main connection, which is left intact.           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_async_connect(char *host, char *user, char *password, char *dbname, char *dbschema, char *dbsocket,
+		int port, char *tls_connect, char *cert, char *key, char *ca, char *cipher, char *cipher_13)
+{
+	PGconn		*main_conn = conn;
+	zbx_hashset_t	main_statements = pg_statements;
+	int		ret;
+
+	zbx_db_async_close();
+
+	conn = NULL;
+	memset(&pg_statements, 0, sizeof(pg_statements));
+
+	if (ZBX_DB_OK == (ret = zbx_db_connect(host, user, password, dbname, dbschema, dbsocket, port, tls_connect,
+			cert, key, ca, cipher, cipher_13)))
+	{
+		async_conn = conn;
+	}
+
+	conn = main_conn;
+	pg_statements = main_statements;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: close the asynchronous statement connection                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_async_close(void)
+{
+	if (NULL != async_conn)
+	{
+		PQfinish(async_conn);
+		async_conn = NULL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send statements to database without waiting for the result        *
+ *                                                                            *
+ * Parameters: sql - [IN] the statements separated by semicolons              *
+ *                                                                            *
+ * Return value: ZBX_DB_OK   - the statements were sent                       *
+ *               ZBX_DB_FAIL - failed to send the statements                  *
+ *               ZBX_DB_DOWN - the connection is not available                *
+ *                                                                            *
+ * Comments: The statements are executed in a single implicit transaction.    *
+ *           The results must be collected with zbx_db_async_wait() before    *
+ *           sending the next statements.                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_async_send(const char *sql)
+{
+	if (NULL == async_conn || CONNECTION_OK != PQstatus(async_conn))
+		return ZBX_DB_DOWN;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "async query [%s]", sql);
+
+	if (1 != PQsendQuery(async_conn, sql))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(async_conn), sql);
+		return CONNECTION_OK == PQstatus(async_conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	return ZBX_DB_OK;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: wait for the results of statements sent with zbx_db_async_send()  *
+ *                                                                            *
+ * Return value: ZBX_DB_OK   - all statements were executed successfully      *
+ *               ZBX_DB_FAIL - the statements have failed                     *
+ *               ZBX_DB_DOWN - the statements have failed, but can be resent  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_async_wait(void)
+{
+	PGresult	*result;
+	int		ret = ZBX_DB_OK;
+	char		*error = NULL;
+
+	if (NULL == async_conn)
+		return ZBX_DB_DOWN;
+
+	while (NULL != (result = PQgetResult(async_conn)))
+	{
+		if (ZBX_DB_OK == ret && PGRES_COMMAND_OK != PQresultStatus(result))
+		{
+			zbx_postgresql_error(&error, result);
+			zbx_db_errlog(ERR_Z3005, 0, error, "async query");
+			zbx_free(error);
+
+			ret = (SUCCEED == is_recoverable_postgresql_error(async_conn, result) ? ZBX_DB_DOWN :
+					ZBX_DB_FAIL);
+		}
+
+		PQclear(result);
+	}
+
+	if (ZBX_DB_OK == ret && CONNECTION_OK != PQstatus(async_conn))
+		ret = ZBX_DB_DOWN;
+
+	return ret;
+}
+#endif
+
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create select statement result from PostgreSQL result             *
+ *                                                                            *
+ * Parameters: pg_result - [IN] the PostgreSQL result                         *
+ *             sql       - [IN] the executed statement (for logging)          *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (DB_RESULT)ZBX_DB_DOWN              *
+ *                                                                            *
+ ******************************************************************************/
+static DB_RESULT	zbx_db_pg_result(PGresult *pg_result, const char *sql)
+{
+	DB_RESULT	result;
+	char		*error = NULL;
+
+	result = zbx_malloc(NULL, sizeof(struct zbx_db_result));
+	result->pg_result = pg_result;
+	result->values = NULL;
+	result->cursor = 0;
+	result->row_num = 0;
+
+	if (NULL == result->pg_result)
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+
+	if (PGRES_TUPLES_OK != PQresultStatus(result->pg_result))
+	{
+		zbx_postgresql_error(&error, result->pg_result);
+		zbx_db_errlog(ERR_Z3005, 0, error, sql);
+		zbx_free(error);
+
+		if (SUCCEED == is_recoverable_postgresql_error(conn, result->pg_result))
+		{
+			DBfree_result(result);
+			result = (DB_RESULT)ZBX_DB_DOWN;
+		}
+		else
+		{
+			DBfree_result(result);
+			result = NULL;
+		}
+	}
+	else	/* init rownum */
+		result->row_num = PQntuples(result->pg_result);
+
+	return result;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement                                        *
@@ -1607,8 +1900,6 @@ DB_RESULT	zbx_db_vselect(const char *fmt, va_list args)
 	ub4		prefetch_rows = 200, counter;
 
 	ZBX_UNUSED(counter);
-#elif defined(HAVE_POSTGRESQL)
-	char		*error = NULL;
 #elif defined(HAVE_SQLITE3)
 	int		ret = FAIL;
 	char		*error = NULL;
@@ -1800,34 +2091,7 @@ error:
 		result = (ZBX_DB_DOWN == server_status ? (DB_RESULT)(intptr_t)server_status : NULL);
 	}
 #elif defined(HAVE_POSTGRESQL)
-	result = zbx_malloc(NULL, sizeof(struct zbx_db_result));
-	result->pg_result = PQexec(conn, sql);
-	result->values = NULL;
-	result->cursor = 0;
-	result->row_num = 0;
-
-	if (NULL == result->pg_result)
-		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
-
-	if (PGRES_TUPLES_OK != PQresultStatus(result->pg_result))
-	{
-		zbx_postgresql_error(&error, result->pg_result);
-		zbx_db_errlog(ERR_Z3005, 0, error, sql);
-		zbx_free(error);
-
-		if (SUCCEED == is_recoverable_postgresql_error(conn, result->pg_result))
-		{
-			DBfree_result(result);
-			result = (DB_RESULT)ZBX_DB_DOWN;
-		}
-		else
-		{
-			DBfree_result(result);
-			result = NULL;
-		}
-	}
-	else	/* init rownum */
-		result->row_num = PQntuples(result->pg_result);
+	result = zbx_db_pg_result(PQexec(conn, sql), sql);
 #elif defined(HAVE_SQLITE3)
 	if (0 == txn_level)
 		zbx_mutex_lock(sqlite_access);
@@ -1881,6 +2145,265 @@ clean:
 	return result;
 }
 
+#ifdef HAVE_POSTGRESQL
+static zbx_hash_t	pg_statement_hash(const void *data)
+{
+	const zbx_pg_statement_t	*stmt = (const zbx_pg_statement_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(stmt->sql);
+}
+
+static int	pg_statement_compare(const void *d1, const void *d2)
+{
+	const zbx_pg_statement_t	*stmt1 = (const zbx_pg_statement_t *)d1;
+	const zbx_pg_statement_t	*stmt2 = (const zbx_pg_statement_t *)d2;
+
+	return strcmp(stmt1->sql, stmt2->sql);
+}
+
+static void	pg_statement_clear(void *data)
+{
+	zbx_pg_statement_t	*stmt = (zbx_pg_statement_t *)data;
+
+	zbx_free(stmt->sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get prepared statement for the SQL text, preparing it if needed   *
+ *                                                                            *
+ * Parameters: sql  - [IN] the statement text with $1..$N parameters          *
+ *             stmt - [OUT] the prepared statement                            *
+ *                                                                            *
+ * Return value: ZBX_DB_OK   - the statement was prepared                     *
+ *               ZBX_DB_FAIL - failed to prepare statement                    *
+ *               ZBX_DB_DOWN - failed to prepare statement, can be retried    *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pg_prepare(const char *sql, const zbx_pg_statement_t **stmt)
+{
+	zbx_pg_statement_t	stmt_local, *pstmt;
+	PGresult		*result;
+	int			ret;
+
+	if (NULL == pg_statements.slots)
+	{
+		zbx_hashset_create_ext(&pg_statements, 0, pg_statement_hash, pg_statement_compare,
+				pg_statement_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	stmt_local.sql = (char *)sql;
+
+	if (NULL != (*stmt = (zbx_pg_statement_t *)zbx_hashset_search(&pg_statements, &stmt_local)))
+		return ZBX_DB_OK;
+
+	/* statements are not expected to be generated dynamically, but limit server side resources anyway */
+	if (ZBX_PG_STATEMENTS_MAX <= pg_statements.num_data)
+	{
+		if (ZBX_DB_OK > (ret = zbx_db_execute("deallocate all")))
+			return ret;
+
+		zbx_hashset_clear(&pg_statements);
+	}
+
+	zbx_snprintf(stmt_local.name, sizeof(stmt_local.name), "zbx_stmt_" ZBX_FS_UI64, pg_statements_next++);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "prepare [txnlev:%d] [%s] [%s]", txn_level, stmt_local.name, sql);
+
+	result = PQprepare(conn, stmt_local.name, sql, 0, NULL);
+	ret = zbx_db_pg_check_result(result, PGRES_COMMAND_OK, sql);
+	PQclear(result);
+
+	if (ZBX_DB_OK != ret)
+		return ret;
+
+	stmt_local.sql = zbx_strdup(NULL, sql);
+	pstmt = (zbx_pg_statement_t *)zbx_hashset_insert(&pg_statements, &stmt_local, sizeof(stmt_local));
+	*stmt = pstmt;
+
+	return ZBX_DB_OK;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if prepared statement was not found on the server, for      *
+ *          example when connection pooler switched the server connection     *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pg_statement_missing(const PGresult *result)
+{
+	if (NULL == result || PGRES_FATAL_ERROR != PQresultStatus(result))
+		return FAIL;
+
+	if (0 != zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), "26000"))
+		return FAIL;
+
+	return SUCCEED;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: substitute $1..$N parameters in statement text                    *
+ *                                                                            *
+ * Parameters: sql        - [IN] the statement text                           *
+ *             params_num - [IN] the number of parameters                     *
+ *             params     - [IN] the parameter values                         *
+ *                                                                            *
+ * Return value: the statement text with parameter values                     *
+ *                                                                            *
+ ******************************************************************************/
+static char	*zbx_db_substitute_params(const char *sql, int params_num, const char *const *params)
+{
+	char		*text = NULL;
+	size_t		text_alloc = 0, text_offset = 0;
+	const char	*ptr;
+	int		index;
+
+	for (ptr = sql; '\0' != *ptr; ptr++)
+	{
+		if ('$' == *ptr && 0 != isdigit((unsigned char)ptr[1]))
+		{
+			for (index = 0; 0 != isdigit((unsigned char)ptr[1]); ptr++)
+				index = index * 10 + ptr[1] - '0';
+
+			if (0 < index && index <= params_num)
+			{
+				zbx_strcpy_alloc(&text, &text_alloc, &text_offset, NULL != params[index - 1] ?
+						params[index - 1] : "null");
+				continue;
+			}
+
+			THIS_SHOULD_NEVER_HAPPEN;
+		}
+
+		zbx_chrcpy_alloc(&text, &text_alloc, &text_offset, *ptr);
+	}
+
+	if (NULL == text)
+		text = zbx_strdup(NULL, "");
+
+	return text;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement with parameters substituted into text  *
+ *                                                                            *
+ ******************************************************************************/
+static DB_RESULT	zbx_db_select_substituted(const char *sql, int params_num, const char *const *params)
+{
+	char		*text;
+	DB_RESULT	result;
+
+	text = zbx_db_substitute_params(sql, params_num, params);
+	result = zbx_db_select("%s", text);
+	zbx_free(text);
+
+	return result;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement with parameters                        *
+ *                                                                            *
+ * Parameters: sql        - [IN] the statement text with $1..$N parameters    *
+ *             params_num - [IN] the number of parameters                     *
+ *             params     - [IN] the parameter values, NULL for null value    *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (DB_RESULT)ZBX_DB_DOWN              *
+ *                                                                            *
+ * Comments: On PostgreSQL with DBPreparedStatements enabled the statement    *
+ *           is prepared once per connection and executed with parameters, so *
+ *           it is parsed and planned only once. Otherwise the parameters are *
+ *           substituted into statement text as is, so only numeric           *
+ *           parameters can be used.                                          *
+ *                                                                            *
+ ******************************************************************************/
+DB_RESULT	zbx_db_select_prepared(const char *sql, int params_num, const char *const *params)
+{
+#ifdef HAVE_POSTGRESQL
+	DB_RESULT			result = NULL;
+	double				sec = 0;
+	const zbx_pg_statement_t	*stmt;
+	PGresult			*pg_result;
+	int				ret;
+
+	/* named prepared statements do not work with transaction pooling connection poolers */
+	if (0 == CONFIG_DB_PREPARED_STATEMENTS)
+		return zbx_db_select_substituted(sql, params_num, params);
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
+		return NULL;
+	}
+
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+	{
+		char	*str = NULL;
+		size_t	str_alloc = 0, str_offset = 0;
+		int	i;
+
+		for (i = 0; i < params_num; i++)
+		{
+			zbx_snprintf_alloc(&str, &str_alloc, &str_offset, "%s$%d=%s", 0 == i ? "" : ",", i + 1,
+					ZBX_NULL2STR(params[i]));
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] [%s]", txn_level, sql, ZBX_NULL2EMPTY_STR(str));
+		zbx_free(str);
+	}
+
+	if (ZBX_DB_OK != (ret = zbx_db_pg_prepare(sql, &stmt)))
+	{
+		if (ZBX_DB_DOWN == ret)
+			return (DB_RESULT)ZBX_DB_DOWN;
+
+		goto out;
+	}
+
+	pg_result = PQexecPrepared(conn, stmt->name, params_num, params, NULL, NULL, 0);
+
+	if (SUCCEED == zbx_db_pg_statement_missing(pg_result))
+	{
+		/* the statement will be prepared again on the next execution */
+		zbx_hashset_remove_direct(&pg_statements, (void *)stmt);
+
+		if (0 == txn_level)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "prepared statement for query \"%s\" was not found,"
+					" executing query without preparing", sql);
+			PQclear(pg_result);
+			return zbx_db_select_substituted(sql, params_num, params);
+		}
+	}
+
+	result = zbx_db_pg_result(pg_result, sql);
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+out:
+	if (NULL == result && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return result;
+#else
+	return zbx_db_select_substituted(sql, params_num, params);
+#endif
+}
+
 /*
  * Execute SQL statement. For select statements only.
  */
@@ -124,6 +124,8 @@ typedef struct
 
 	zbx_hc_proxyqueue_t	proxyqueue;
 	int			proxy_history_count;
+
+	zbx_hc_storage_stats_t	storage_stats;
 }
 ZBX_DC_CACHE;
 
@@ -182,9 +184,6 @@ static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
 static int	hc_queue_get_size(void);
 static int	hc_get_history_compression_age(void);
 
-ZBX_PTR_VECTOR_DECL(item_tag, zbx_tag_t)
-ZBX_PTR_VECTOR_IMPL(item_tag, zbx_tag_t)
-
 ZBX_PTR_VECTOR_IMPL(tags, zbx_tag_t*)
 
 /******************************************************************************
@@ -373,6 +372,101 @@ static void	DCupdate_trends(zbx_vector_uint64_pair_t *trends_diff)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+#ifndef HAVE_ORACLE
+/******************************************************************************
+ *                                                                            *
+ * Purpose: merge trends into database, combining them with the trends of the *
+ *          same hour that are already stored                                 *
+ *                                                                            *
+ * Comments: A helper function for DCflush trends. The trends are merged by   *
+ *           database with bulk insert statements, so the existing trends do  *
+ *           not have to be selected and updated one by one.                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_merge_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigned char value_type,
+		const char *table_name, int clock)
+{
+	ZBX_DC_TREND	*trend;
+	int		i;
+	size_t		sql_offset = 0;
+	char		*merge = NULL;
+	size_t		merge_alloc = 0, merge_offset = 0;
+
+	/* the average must be calculated before the number of values is updated, */
+	/* as MySQL uses already updated column values in the next assignments     */
+#ifdef HAVE_MYSQL
+	zbx_strcpy_alloc(&merge, &merge_alloc, &merge_offset,
+			" on duplicate key update"
+			" value_avg=value_avg/(num+values(num))*num+values(value_avg)/(num+values(num))*values(num),"
+			"value_min=least(value_min,values(value_min)),"
+			"value_max=greatest(value_max,values(value_max)),"
+			"num=num+values(num)");
+#else
+	zbx_snprintf_alloc(&merge, &merge_alloc, &merge_offset,
+			" on conflict (itemid,clock) do update set"
+			" value_avg=%s.value_avg/(%s.num+excluded.num)*%s.num"
+				"+excluded.value_avg/(%s.num+excluded.num)*excluded.num,"
+			"value_min=least(%s.value_min,excluded.value_min),"
+			"value_max=greatest(%s.value_max,excluded.value_max),"
+			"num=%s.num+excluded.num",
+			table_name, table_name, table_name, table_name, table_name, table_name, table_name);
+#endif
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid)
+			continue;
+
+		if (clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		if (0 == sql_offset)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"insert into %s (itemid,clock,num,value_min,value_avg,value_max) values ",
+					table_name);
+		}
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_DBL64_SQL
+					"," ZBX_FS_DBL64_SQL "," ZBX_FS_DBL64_SQL ")", trend->itemid, trend->clock,
+					trend->num, trend->value_min.dbl, trend->value_avg.dbl, trend->value_max.dbl);
+		}
+		else
+		{
+			zbx_uint128_t	avg;
+
+			/* calculate the trend average value */
+			zbx_udiv128_64(&avg, &trend->value_avg.ui64, trend->num);
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_UI64 ","
+					ZBX_FS_UI64 "," ZBX_FS_UI64 ")", trend->itemid, trend->clock, trend->num,
+					trend->value_min.ui64, avg.lo, trend->value_max.ui64);
+		}
+
+		trend->itemid = 0;
+
+		if (ZBX_MAX_SQL_SIZE < sql_offset)
+		{
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, merge);
+			DBexecute("%s", sql);
+			sql_offset = 0;
+		}
+	}
+
+	if (0 != sql_offset)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, merge);
+		DBexecute("%s", sql);
+	}
+
+	zbx_free(merge);
+}
+#else
 /******************************************************************************
  *                                                                            *
  * Purpose: helper function for DCflush trends                                *
@@ -636,6 +730,7 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 	if (sql_offset > 16)	/* In ORACLE always present begin..end; */
 		DBexecute("%s", sql);
 }
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -644,11 +739,14 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
  ******************************************************************************/
 static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint64_pair_t *trends_diff)
 {
-	int		num, i, clock, inserts_num = 0, itemids_alloc, itemids_num = 0, trends_to = *trends_num;
+	int		num, i, clock;
 	unsigned char	value_type;
+	const char	*table_name;
+#ifdef HAVE_ORACLE
+	int		inserts_num = 0, itemids_alloc, itemids_num = 0, trends_to = *trends_num;
 	zbx_uint64_t	*itemids = NULL;
 	ZBX_DC_TREND	*trend = NULL;
-	const char	*table_name;
+#endif
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() trends_num:%d", __func__, *trends_num);
 
@@ -667,6 +765,11 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 			assert(0);
 	}
 
+#ifndef HAVE_ORACLE
+	ZBX_UNUSED(trends_diff);
+
+	dc_merge_trends_in_db(trends, *trends_num, value_type, table_name, clock);
+#else
 	itemids_alloc = MIN(ZBX_HC_SYNC_MAX, *trends_num);
 	itemids = (zbx_uint64_t *)zbx_malloc(itemids, itemids_alloc * sizeof(zbx_uint64_t));
 
@@ -743,7 +846,7 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 
 	if (0 != inserts_num)
 		dc_insert_trends_in_db(trends, trends_to, value_type, table_name, clock);
-
+#endif
 	/* clean trends */
 	for (i = 0, num = 0; i < *trends_num; i++)
 	{
@@ -934,197 +1037,206 @@ static void	DBmass_update_trends(const ZBX_DC_TREND *trends, int trends_num,
 	}
 }
 
+#define ZBX_EXPORT_INFO_CACHE_MAX	50000
+
+/* cached item or host export data */
+typedef struct
+{
+	zbx_uint64_t	objectid;
+	void		*data;		/* zbx_dc_item_export_t or zbx_dc_host_export_t */
+	int		sync_ts;	/* the configuration cache sync time when data was updated */
+	int		lastaccess;
+}
+zbx_export_info_t;
+
+/* item names, item tags and host groups of recently exported items, kept by each history syncer */
+static zbx_hashset_t	export_item_cache, export_host_cache;
+static int		export_info_initialized = 0;
+
 typedef struct
 {
-	zbx_uint64_t		hostid;
-	zbx_vector_ptr_t	groups;
+	zbx_uint64_t			itemid;
+	const DC_ITEM			*item;
+	const zbx_dc_item_export_t	*info;
+	const zbx_dc_host_export_t	*host;
 }
-zbx_host_info_t;
+zbx_export_item_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees resources allocated to store host groups names              *
- *                                                                            *
- * Parameters: host_info - [IN] host information                              *
+ * Purpose: frees resources allocated to store item name and tags             *
  *                                                                            *
  ******************************************************************************/
-static void	zbx_host_info_clean(zbx_host_info_t *host_info)
+static void	export_item_info_clean(zbx_export_info_t *info)
 {
-	zbx_vector_ptr_clear_ext(&host_info->groups, zbx_ptr_free);
-	zbx_vector_ptr_destroy(&host_info->groups);
+	zbx_dc_item_export_t	*item = (zbx_dc_item_export_t *)info->data;
+
+	zbx_free(item->name);
+	zbx_vector_tags_clear_ext(&item->tags, zbx_free_tag);
+	zbx_vector_tags_destroy(&item->tags);
+	zbx_free(item);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get hosts groups names                                            *
- *                                                                            *
- * Parameters: hosts_info - [IN/OUT] output names of host groups for a host   *
- *             hostids    - [IN] hosts identifiers                            *
+ * Purpose: frees resources allocated to store host groups names              *
  *                                                                            *
  ******************************************************************************/
-static void	db_get_hosts_info_by_hostid(zbx_hashset_t *hosts_info, const zbx_vector_uint64_t *hostids)
+static void	export_host_info_clean(zbx_export_info_t *info)
 {
-	int		i;
-	size_t		sql_offset = 0;
-	DB_RESULT	result;
-	DB_ROW		row;
+	zbx_dc_host_export_t	*host = (zbx_dc_host_export_t *)info->data;
 
-	for (i = 0; i < hostids->values_num; i++)
-	{
-		zbx_host_info_t	host_info = {.hostid = hostids->values[i]};
-
-		zbx_vector_ptr_create(&host_info.groups);
-		zbx_hashset_insert(hosts_info, &host_info, sizeof(host_info));
-	}
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-				"select distinct hg.hostid,g.name"
-				" from hstgrp g,hosts_groups hg"
-				" where g.groupid=hg.groupid"
-					" and");
-
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "hg.hostid", hostids->values, hostids->values_num);
-
-	result = DBselect("%s", sql);
-
-	while (NULL != (row = DBfetch(result)))
-	{
-		zbx_uint64_t	hostid;
-		zbx_host_info_t	*host_info;
-
-		ZBX_DBROW2UINT64(hostid, row[0]);
-
-		if (NULL == (host_info = (zbx_host_info_t *)zbx_hashset_search(hosts_info, &hostid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			continue;
-		}
-
-		zbx_vector_ptr_append(&host_info->groups, zbx_strdup(NULL, row[1]));
-	}
-	DBfree_result(result);
+	zbx_vector_str_clear_ext(&host->groups, zbx_str_free);
+	zbx_vector_str_destroy(&host->groups);
+	zbx_free(host);
 }
 
-typedef struct
+static int	export_lastaccess_compare(const void *d1, const void *d2)
 {
-	zbx_uint64_t		itemid;
-	char			*name;
-	DC_ITEM			*item;
-	zbx_vector_item_tag_t	item_tags;
+	const zbx_export_info_t	*i1 = *(const zbx_export_info_t * const *)d1;
+	const zbx_export_info_t	*i2 = *(const zbx_export_info_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(i1->lastaccess, i2->lastaccess);
+
+	return 0;
 }
-zbx_item_info_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get items name and item tags                                      *
- *                                                                            *
- * Parameters: items_info - [IN/OUT] output item name and item tags           *
- *             itemids    - [IN] the item identifiers                         *
+ * Purpose: drop least recently used quarter of export data cache entries     *
+ *          when the cache exceeds its size limit                             *
  *                                                                            *
  ******************************************************************************/
-static void	db_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vector_uint64_t *itemids)
+static void	export_info_trim(zbx_hashset_t *cache)
 {
-	size_t		sql_offset = 0;
-	DB_RESULT	result;
-	DB_ROW		row;
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select itemid,name from items where");
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids->values, itemids->values_num);
-
-	result = DBselect("%s", sql);
-
-	while (NULL != (row = DBfetch(result)))
-	{
-		zbx_uint64_t	itemid;
-		zbx_item_info_t	*item_info;
-
-		ZBX_DBROW2UINT64(itemid, row[0]);
-
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &itemid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			continue;
-		}
-
-		item_info->name = zbx_strdup(item_info->name, row[1]);
-	}
-	DBfree_result(result);
+	zbx_hashset_iter_t	iter;
+	zbx_export_info_t	*info;
+	zbx_vector_ptr_t	infos;
+	int			i;
 
-	sql_offset = 0;
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select itemid,tag,value from item_tag where");
+	if (ZBX_EXPORT_INFO_CACHE_MAX >= cache->num_data)
+		return;
 
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids->values, itemids->values_num);
+	zbx_vector_ptr_create(&infos);
+	zbx_vector_ptr_reserve(&infos, (size_t)cache->num_data);
 
-	result = DBselect("%s", sql);
+	zbx_hashset_iter_reset(cache, &iter);
 
-	while (NULL != (row = DBfetch(result)))
-	{
-		zbx_uint64_t	itemid;
-		zbx_item_info_t	*item_info;
-		zbx_tag_t	item_tag;
+	while (NULL != (info = (zbx_export_info_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_ptr_append(&infos, info);
 
-		ZBX_DBROW2UINT64(itemid, row[0]);
+	zbx_vector_ptr_sort(&infos, export_lastaccess_compare);
 
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &itemid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			continue;
-		}
+	for (i = 0; i < infos.values_num / 4; i++)
+		zbx_hashset_remove_direct(cache, infos.values[i]);
 
-		item_tag.tag = zbx_strdup(NULL, row[1]);
-		item_tag.value = zbx_strdup(NULL, row[2]);
-		zbx_vector_item_tag_append(&item_info->item_tags, item_tag);
-	}
-	DBfree_result(result);
+	zbx_vector_ptr_destroy(&infos);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees resources allocated to store item tag                       *
+ * Purpose: get cached item name and tags                                     *
+ *                                                                            *
+ * Parameters: itemid  - [IN] the item identifier                             *
+ *             sync_ts - [IN] the last configuration cache sync time          *
+ *             now     - [IN] the current time                                *
+ *             updates - [OUT] the items to be updated from configuration     *
+ *                             cache                                          *
  *                                                                            *
- * Parameters: item_tag - [IN] item tag                                       *
+ * Return value: the cached item data                                         *
  *                                                                            *
  ******************************************************************************/
-static void	item_tag_free(zbx_tag_t item_tag)
+static const zbx_dc_item_export_t	*export_item_info_get(zbx_uint64_t itemid, int sync_ts, int now,
+		zbx_vector_ptr_t *updates)
 {
-	zbx_free(item_tag.tag);
-	zbx_free(item_tag.value);
+	zbx_export_info_t	*info, info_local;
+
+	if (NULL == (info = (zbx_export_info_t *)zbx_hashset_search(&export_item_cache, &itemid)))
+	{
+		zbx_dc_item_export_t	*item;
+
+		item = (zbx_dc_item_export_t *)zbx_malloc(NULL, sizeof(zbx_dc_item_export_t));
+		item->itemid = itemid;
+		item->name = NULL;
+		zbx_vector_tags_create(&item->tags);
+
+		info_local.objectid = itemid;
+		info_local.data = item;
+		info_local.sync_ts = sync_ts;
+		info = (zbx_export_info_t *)zbx_hashset_insert(&export_item_cache, &info_local, sizeof(info_local));
+		zbx_vector_ptr_append(updates, info->data);
+	}
+	else if (info->sync_ts != sync_ts)
+	{
+		info->sync_ts = sync_ts;
+		zbx_vector_ptr_append(updates, info->data);
+	}
+
+	info->lastaccess = now;
+
+	return (const zbx_dc_item_export_t *)info->data;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees resources allocated to store item tags and name             *
+ * Purpose: get cached host groups names                                      *
  *                                                                            *
- * Parameters: item_info - [IN] item information                              *
+ * Parameters: hostid  - [IN] the host identifier                             *
+ *             sync_ts - [IN] the last configuration cache sync time          *
+ *             now     - [IN] the current time                                *
+ *             updates - [OUT] the hosts to be updated from configuration     *
+ *                             cache                                          *
+ *                                                                            *
+ * Return value: the cached host data                                         *
  *                                                                            *
  ******************************************************************************/
-static void	zbx_item_info_clean(zbx_item_info_t *item_info)
+static const zbx_dc_host_export_t	*export_host_info_get(zbx_uint64_t hostid, int sync_ts, int now,
+		zbx_vector_ptr_t *updates)
 {
-	zbx_vector_item_tag_clear_ext(&item_info->item_tags, item_tag_free);
-	zbx_vector_item_tag_destroy(&item_info->item_tags);
-	zbx_free(item_info->name);
+	zbx_export_info_t	*info, info_local;
+
+	if (NULL == (info = (zbx_export_info_t *)zbx_hashset_search(&export_host_cache, &hostid)))
+	{
+		zbx_dc_host_export_t	*host;
+
+		host = (zbx_dc_host_export_t *)zbx_malloc(NULL, sizeof(zbx_dc_host_export_t));
+		host->hostid = hostid;
+		zbx_vector_str_create(&host->groups);
+
+		info_local.objectid = hostid;
+		info_local.data = host;
+		info_local.sync_ts = sync_ts;
+		info = (zbx_export_info_t *)zbx_hashset_insert(&export_host_cache, &info_local, sizeof(info_local));
+		zbx_vector_ptr_append(updates, info->data);
+	}
+	else if (info->sync_ts != sync_ts)
+	{
+		info->sync_ts = sync_ts;
+		zbx_vector_ptr_append(updates, info->data);
+	}
+
+	info->lastaccess = now;
+
+	return (const zbx_dc_host_export_t *)info->data;
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: export trends                                                     *
  *                                                                            *
- * Parameters: trends     - [IN] trends from cache                            *
- *             trends_num - [IN] number of trends                             *
- *             hosts_info - [IN] hosts groups names                           *
- *             items_info - [IN] item names and tags                          *
+ * Parameters: trends       - [IN] trends from cache                          *
+ *             trends_num   - [IN] number of trends                           *
+ *             export_items - [IN] the exported items with host groups names, *
+ *                            item names and tags                             *
  *                                                                            *
  ******************************************************************************/
-static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hashset_t *hosts_info,
-		zbx_hashset_t *items_info)
+static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hashset_t *export_items)
 {
 	struct zbx_json		json;
 	const ZBX_DC_TREND	*trend = NULL;
 	int			i, j;
 	const DC_ITEM		*item;
-	zbx_host_info_t		*host_info;
-	zbx_item_info_t		*item_info;
+	const zbx_export_item_t	*export_item;
 	zbx_uint128_t		avg;	/* calculate the trend average value */
 
 	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
@@ -1133,16 +1245,10 @@ static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hash
 	{
 		trend = &trends[i];
 
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &trend->itemid)))
+		if (NULL == (export_item = (const zbx_export_item_t *)zbx_hashset_search(export_items, &trend->itemid)))
 			continue;
 
-		item = item_info->item;
-
-		if (NULL == (host_info = (zbx_host_info_t *)zbx_hashset_search(hosts_info, &item->host.hostid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			continue;
-		}
+		item = export_item->item;
 
 		zbx_json_clean(&json);
 
@@ -1153,28 +1259,28 @@ static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hash
 
 		zbx_json_addarray(&json, ZBX_PROTO_TAG_GROUPS);
 
-		for (j = 0; j < host_info->groups.values_num; j++)
-			zbx_json_addstring(&json, NULL, host_info->groups.values[j], ZBX_JSON_TYPE_STRING);
+		for (j = 0; j < export_item->host->groups.values_num; j++)
+			zbx_json_addstring(&json, NULL, export_item->host->groups.values[j], ZBX_JSON_TYPE_STRING);
 
 		zbx_json_close(&json);
 
 		zbx_json_addarray(&json, ZBX_PROTO_TAG_ITEM_TAGS);
 
-		for (j = 0; j < item_info->item_tags.values_num; j++)
+		for (j = 0; j < export_item->info->tags.values_num; j++)
 		{
-			zbx_tag_t	item_tag = item_info->item_tags.values[j];
+			const zbx_tag_t	*item_tag = export_item->info->tags.values[j];
 
 			zbx_json_addobject(&json, NULL);
-			zbx_json_addstring(&json, ZBX_PROTO_TAG_TAG, item_tag.tag, ZBX_JSON_TYPE_STRING);
-			zbx_json_addstring(&json, ZBX_PROTO_TAG_VALUE, item_tag.value, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_TAG, item_tag->tag, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_VALUE, item_tag->value, ZBX_JSON_TYPE_STRING);
 			zbx_json_close(&json);
 		}
 
 		zbx_json_close(&json);
 		zbx_json_adduint64(&json, ZBX_PROTO_TAG_ITEMID, item->itemid);
 
-		if (NULL != item_info->name)
-			zbx_json_addstring(&json, ZBX_PROTO_TAG_NAME, item_info->name, ZBX_JSON_TYPE_STRING);
+		if (NULL != export_item->info->name)
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_NAME, export_item->info->name, ZBX_JSON_TYPE_STRING);
 
 		zbx_json_addint64(&json, ZBX_PROTO_TAG_CLOCK, trend->clock);
 		zbx_json_addint64(&json, ZBX_PROTO_TAG_COUNT, trend->num);
@@ -1208,20 +1314,18 @@ static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hash
  *                                                                            *
  * Purpose: export history                                                    *
  *                                                                            *
- * Parameters: history     - [IN/OUT] array of history data                   *
- *             history_num - [IN] number of history structures                *
- *             hosts_info  - [IN] hosts groups names                          *
- *             items_info  - [IN] item names and tags                         *
+ * Parameters: history      - [IN/OUT] array of history data                  *
+ *             history_num  - [IN] number of history structures               *
+ *             export_items - [IN] the exported items with host groups names, *
+ *                            item names and tags                             *
  *                                                                            *
  ******************************************************************************/
-static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx_hashset_t *hosts_info,
-		zbx_hashset_t *items_info)
+static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx_hashset_t *export_items)
 {
 	const ZBX_DC_HISTORY	*h;
 	const DC_ITEM		*item;
 	int			i, j;
-	zbx_host_info_t		*host_info;
-	zbx_item_info_t		*item_info;
+	const zbx_export_item_t	*export_item;
 	struct zbx_json		json;
 
 	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
@@ -1233,19 +1337,13 @@ static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx
 		if (0 != (ZBX_DC_FLAGS_NOT_FOR_MODULES & h->flags))
 			continue;
 
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &h->itemid)))
+		if (NULL == (export_item = (const zbx_export_item_t *)zbx_hashset_search(export_items, &h->itemid)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			continue;
 		}
 
-		item = item_info->item;
-
-		if (NULL == (host_info = (zbx_host_info_t *)zbx_hashset_search(hosts_info, &item->host.hostid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			continue;
-		}
+		item = export_item->item;
 
 		zbx_json_clean(&json);
 
@@ -1256,28 +1354,28 @@ static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx
 
 		zbx_json_addarray(&json, ZBX_PROTO_TAG_GROUPS);
 
-		for (j = 0; j < host_info->groups.values_num; j++)
-			zbx_json_addstring(&json, NULL, host_info->groups.values[j], ZBX_JSON_TYPE_STRING);
+		for (j = 0; j < export_item->host->groups.values_num; j++)
+			zbx_json_addstring(&json, NULL, export_item->host->groups.values[j], ZBX_JSON_TYPE_STRING);
 
 		zbx_json_close(&json);
 
 		zbx_json_addarray(&json, ZBX_PROTO_TAG_ITEM_TAGS);
 
-		for (j = 0; j < item_info->item_tags.values_num; j++)
+		for (j = 0; j < export_item->info->tags.values_num; j++)
 		{
-			zbx_tag_t	item_tag = item_info->item_tags.values[j];
+			const zbx_tag_t	*item_tag = export_item->info->tags.values[j];
 
 			zbx_json_addobject(&json, NULL);
-			zbx_json_addstring(&json, ZBX_PROTO_TAG_TAG, item_tag.tag, ZBX_JSON_TYPE_STRING);
-			zbx_json_addstring(&json, ZBX_PROTO_TAG_VALUE, item_tag.value, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_TAG, item_tag->tag, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_VALUE, item_tag->value, ZBX_JSON_TYPE_STRING);
 			zbx_json_close(&json);
 		}
 
 		zbx_json_close(&json);
 		zbx_json_adduint64(&json, ZBX_PROTO_TAG_ITEMID, item->itemid);
 
-		if (NULL != item_info->name)
-			zbx_json_addstring(&json, ZBX_PROTO_TAG_NAME, item_info->name, ZBX_JSON_TYPE_STRING);
+		if (NULL != export_item->info->name)
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_NAME, export_item->info->name, ZBX_JSON_TYPE_STRING);
 
 		zbx_json_addint64(&json, ZBX_PROTO_TAG_CLOCK, h->ts.sec);
 		zbx_json_addint64(&json, ZBX_PROTO_TAG_NS, h->ts.ns);
@@ -1317,6 +1415,156 @@ static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx
 	zbx_json_free(&json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append data to binary export record                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_export_serialize(char **buf, size_t *buf_alloc, size_t *buf_offset, const void *data, size_t size)
+{
+	if (*buf_offset + size > *buf_alloc)
+	{
+		while (*buf_offset + size > *buf_alloc)
+			*buf_alloc = (0 == *buf_alloc ? ZBX_KIBIBYTE : *buf_alloc * 2);
+
+		*buf = (char *)zbx_realloc(*buf, *buf_alloc);
+	}
+
+	memcpy(*buf + *buf_offset, data, size);
+	*buf_offset += size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append string prefixed with its length to binary export record    *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_export_serialize_str(char **buf, size_t *buf_alloc, size_t *buf_offset, const char *str)
+{
+	zbx_uint32_t	len;
+
+	len = (zbx_uint32_t)strlen(ZBX_NULL2EMPTY_STR(str));
+	dc_export_serialize(buf, buf_alloc, buf_offset, &len, sizeof(len));
+	dc_export_serialize(buf, buf_alloc, buf_offset, ZBX_NULL2EMPTY_STR(str), len);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: export history in binary format                                   *
+ *                                                                            *
+ * Parameters: history      - [IN/OUT] array of history data                  *
+ *             history_num  - [IN] number of history structures               *
+ *             export_items - [IN] the exported items with host groups names, *
+ *                            item names and tags                             *
+ *                                                                            *
+ * Comments: Item description record:                                         *
+ *             uint64 itemid, string host, string host name, string name,     *
+ *             uint32 groups_num, string group[groups_num],                   *
+ *             uint32 tags_num, (string tag, string value)[tags_num]          *
+ *           Value record:                                                    *
+ *             uint64 itemid, int32 clock, int32 ns, uint8 value_type, value  *
+ *           Values are stored as double (float), uint64 (unsigned), string   *
+ *           (character, text) and int32 timestamp, string source, int32      *
+ *           severity, int32 logeventid, string value (log). Strings are      *
+ *           prefixed with uint32 length. All numbers use host byte order.    *
+ *                                                                            *
+ ******************************************************************************/
+static void	DCexport_history_binary(const ZBX_DC_HISTORY *history, int history_num,
+		zbx_hashset_t *export_items)
+{
+	const ZBX_DC_HISTORY	*h;
+	zbx_hashset_iter_t	iter;
+	const zbx_export_item_t	*export_item;
+	char			*buf = NULL;
+	size_t			buf_alloc = 0, buf_offset;
+	zbx_uint32_t		num;
+	int			i;
+
+	zbx_hashset_iter_reset(export_items, &iter);
+
+	while (NULL != (export_item = (const zbx_export_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		const DC_ITEM			*item = export_item->item;
+		const zbx_dc_host_export_t	*host = export_item->host;
+		const zbx_dc_item_export_t	*info = export_item->info;
+
+		buf_offset = 0;
+		dc_export_serialize(&buf, &buf_alloc, &buf_offset, &item->itemid, sizeof(item->itemid));
+		dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, item->host.host);
+		dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, item->host.name);
+		dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, info->name);
+
+		num = (zbx_uint32_t)host->groups.values_num;
+		dc_export_serialize(&buf, &buf_alloc, &buf_offset, &num, sizeof(num));
+
+		for (i = 0; i < host->groups.values_num; i++)
+			dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, host->groups.values[i]);
+
+		num = (zbx_uint32_t)info->tags.values_num;
+		dc_export_serialize(&buf, &buf_alloc, &buf_offset, &num, sizeof(num));
+
+		for (i = 0; i < info->tags.values_num; i++)
+		{
+			dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, info->tags.values[i]->tag);
+			dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, info->tags.values[i]->value);
+		}
+
+		zbx_history_export_write_item(item->itemid, buf, buf_offset);
+	}
+
+	for (i = 0; i < history_num; i++)
+	{
+		h = &history[i];
+
+		if (0 != (ZBX_DC_FLAGS_NOT_FOR_MODULES & h->flags))
+			continue;
+
+		if (NULL == zbx_hashset_search(export_items, &h->itemid))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			continue;
+		}
+
+		buf_offset = 0;
+		dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->itemid, sizeof(h->itemid));
+		dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->ts.sec, sizeof(h->ts.sec));
+		dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->ts.ns, sizeof(h->ts.ns));
+		dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->value_type, sizeof(h->value_type));
+
+		switch (h->value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+				dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->value.dbl, sizeof(h->value.dbl));
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->value.ui64, sizeof(h->value.ui64));
+				break;
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+				dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, h->value.str);
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->value.log->timestamp,
+						sizeof(h->value.log->timestamp));
+				dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, h->value.log->source);
+				dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->value.log->severity,
+						sizeof(h->value.log->severity));
+				dc_export_serialize(&buf, &buf_alloc, &buf_offset, &h->value.log->logeventid,
+						sizeof(h->value.log->logeventid));
+				dc_export_serialize_str(&buf, &buf_alloc, &buf_offset, h->value.log->value);
+				break;
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				continue;
+		}
+
+		zbx_history_export_write_value(h->itemid, buf, buf_offset);
+	}
+
+	zbx_history_export_flush();
+	zbx_free(buf);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: export history and trends                                         *
@@ -1335,19 +1583,37 @@ static void	DCexport_history_and_trends(const ZBX_DC_HISTORY *history, int histo
 		const zbx_vector_uint64_t *itemids, DC_ITEM *items, const int *errcodes, const ZBX_DC_TREND *trends,
 		int trends_num)
 {
-	int			i, index;
-	zbx_vector_uint64_t	hostids, item_info_ids;
-	zbx_hashset_t		hosts_info, items_info;
+	int			i, index, now, sync_ts;
+	zbx_vector_ptr_t	item_updates, host_updates;
+	zbx_hashset_t		export_items;
 	DC_ITEM			*item;
-	zbx_item_info_t		item_info;
+	zbx_export_item_t	export_item;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d trends_num:%d", __func__, history_num, trends_num);
 
-	zbx_vector_uint64_create(&hostids);
-	zbx_vector_uint64_create(&item_info_ids);
-	zbx_hashset_create_ext(&items_info, itemids->values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)zbx_item_info_clean,
-			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	if (0 == export_info_initialized)
+	{
+		zbx_hashset_create_ext(&export_item_cache, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)export_item_info_clean,
+				ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+		zbx_hashset_create_ext(&export_host_cache, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)export_host_info_clean,
+				ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+		export_info_initialized = 1;
+	}
+	else
+	{
+		export_info_trim(&export_item_cache);
+		export_info_trim(&export_host_cache);
+	}
+
+	now = (int)time(NULL);
+	sync_ts = DCconfig_get_last_sync_time();
+
+	zbx_vector_ptr_create(&item_updates);
+	zbx_vector_ptr_create(&host_updates);
+	zbx_hashset_create(&export_items, (size_t)itemids->values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	for (i = 0; i < history_num; i++)
 	{
@@ -1367,14 +1633,14 @@ static void	DCexport_history_and_trends(const ZBX_DC_HISTORY *history, int histo
 
 		item = &items[index];
 
-		zbx_vector_uint64_append(&hostids, item->host.hostid);
-		zbx_vector_uint64_append(&item_info_ids, item->itemid);
+		if (NULL != zbx_hashset_search(&export_items, &item->itemid))
+			continue;
 
-		item_info.itemid = item->itemid;
-		item_info.name = NULL;
-		item_info.item = item;
-		zbx_vector_item_tag_create(&item_info.item_tags);
-		zbx_hashset_insert(&items_info, &item_info, sizeof(item_info));
+		export_item.itemid = item->itemid;
+		export_item.item = item;
+		export_item.info = export_item_info_get(item->itemid, sync_ts, now, &item_updates);
+		export_item.host = export_host_info_get(item->host.hostid, sync_ts, now, &host_updates);
+		zbx_hashset_insert(&export_items, &export_item, sizeof(export_item));
 	}
 
 	if (0 == history_num)
@@ -1395,43 +1661,38 @@ static void	DCexport_history_and_trends(const ZBX_DC_HISTORY *history, int histo
 
 			item = &items[index];
 
-			zbx_vector_uint64_append(&hostids, item->host.hostid);
-			zbx_vector_uint64_append(&item_info_ids, item->itemid);
+			if (NULL != zbx_hashset_search(&export_items, &item->itemid))
+				continue;
 
-			item_info.itemid = item->itemid;
-			item_info.name = NULL;
-			item_info.item = item;
-			zbx_vector_item_tag_create(&item_info.item_tags);
-			zbx_hashset_insert(&items_info, &item_info, sizeof(item_info));
+			export_item.itemid = item->itemid;
+			export_item.item = item;
+			export_item.info = export_item_info_get(item->itemid, sync_ts, now, &item_updates);
+			export_item.host = export_host_info_get(item->host.hostid, sync_ts, now, &host_updates);
+			zbx_hashset_insert(&export_items, &export_item, sizeof(export_item));
 		}
 	}
 
-	if (0 == item_info_ids.values_num)
+	if (0 == export_items.num_data)
 		goto clean;
 
-	zbx_vector_uint64_sort(&item_info_ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-	zbx_vector_uint64_sort(&hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-	zbx_vector_uint64_uniq(&hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	zbx_hashset_create_ext(&hosts_info, hostids.values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)zbx_host_info_clean,
-			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
-
-	db_get_hosts_info_by_hostid(&hosts_info, &hostids);
-
-	db_get_items_info_by_itemid(&items_info, &item_info_ids);
+	/* refresh names and tags cached before the last configuration cache sync */
+	if (0 != item_updates.values_num || 0 != host_updates.values_num)
+		zbx_dc_get_export_info(&item_updates, &host_updates);
 
 	if (0 != history_num)
-		DCexport_history(history, history_num, &hosts_info, &items_info);
+	{
+		if (ZBX_EXPORT_FORMAT_BINARY == zbx_history_export_format())
+			DCexport_history_binary(history, history_num, &export_items);
+		else
+			DCexport_history(history, history_num, &export_items);
+	}
 
 	if (0 != trends_num)
-		DCexport_trends(trends, trends_num, &hosts_info, &items_info);
-
-	zbx_hashset_destroy(&hosts_info);
+		DCexport_trends(trends, trends_num, &export_items);
 clean:
-	zbx_hashset_destroy(&items_info);
-	zbx_vector_uint64_destroy(&item_info_ids);
-	zbx_vector_uint64_destroy(&hostids);
+	zbx_hashset_destroy(&export_items);
+	zbx_vector_ptr_destroy(&host_updates);
+	zbx_vector_ptr_destroy(&item_updates);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -2252,9 +2513,9 @@ static void	remove_history_duplicates(zbx_vector_ptr_t *history)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
-static int	add_history(ZBX_DC_HISTORY *history, int history_num, zbx_vector_ptr_t *history_values, int *ret_flush)
+static void	get_history_values(ZBX_DC_HISTORY *history, int history_num, zbx_vector_ptr_t *history_values)
 {
-	int	i, ret = SUCCEED;
+	int	i;
 
 	for (i = 0; i < history_num; i++)
 	{
@@ -2265,6 +2526,13 @@ static int	add_history(ZBX_DC_HISTORY *history, int history_num, zbx_vector_ptr_
 
 		zbx_vector_ptr_append(history_values, h);
 	}
+}
+
+static int	add_history(ZBX_DC_HISTORY *history, int history_num, zbx_vector_ptr_t *history_values, int *ret_flush)
+{
+	int	ret = SUCCEED;
+
+	get_history_values(history, history_num, history_values);
 
 	if (0 != history_values->values_num)
 		ret = zbx_vc_add_values(history_values, ret_flush);
@@ -2278,11 +2546,16 @@ static int	add_history(ZBX_DC_HISTORY *history, int history_num, zbx_vector_ptr_
  *                                                                            *
  * Parameters: history     - array of history data                            *
  *             history_num - number of history structures                     *
+ *             ret_flush   - [OUT] FLUSH_ASYNC if history is being written in *
+ *                                 background                                 *
+ *                                                                            *
+ * Comments: Values written in background are not added to value cache until  *
+ *           DBmass_wait_history() is called.                                 *
  *                                                                            *
  ******************************************************************************/
-static int	DBmass_add_history(ZBX_DC_HISTORY *history, int history_num)
+static int	DBmass_add_history(ZBX_DC_HISTORY *history, int history_num, int *ret_flush)
 {
-	int			ret, ret_flush = FLUSH_SUCCEED, num;
+	int			ret, num;
 	zbx_vector_ptr_t	history_values;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -2290,14 +2563,16 @@ static int	DBmass_add_history(ZBX_DC_HISTORY *history, int history_num)
 	zbx_vector_ptr_create(&history_values);
 	zbx_vector_ptr_reserve(&history_values, history_num);
 
-	if (FAIL == (ret = add_history(history, history_num, &history_values, &ret_flush)) &&
-			FLUSH_DUPL_REJECTED == ret_flush)
+	*ret_flush = FLUSH_SUCCEED;
+
+	if (FAIL == (ret = add_history(history, history_num, &history_values, ret_flush)) &&
+			FLUSH_DUPL_REJECTED == *ret_flush)
 	{
 		num = history_values.values_num;
 		remove_history_duplicates(&history_values);
 		zbx_vector_ptr_clear(&history_values);
 
-		if (SUCCEED == (ret = add_history(history, history_num, &history_values, &ret_flush)))
+		if (SUCCEED == (ret = add_history(history, history_num, &history_values, ret_flush)))
 			zabbix_log(LOG_LEVEL_WARNING, "skipped %d duplicates", num - history_values.values_num);
 	}
 
@@ -2308,6 +2583,36 @@ static int	DBmass_add_history(ZBX_DC_HISTORY *history, int history_num)
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits until history written in background is stored and adds the  *
+ *          values to value cache                                             *
+ *                                                                            *
+ * Parameters: history     - array of history data                            *
+ *             history_num - number of history structures                     *
+ *                                                                            *
+ * Return value: SUCCEED - the history was stored                             *
+ *               FAIL    - failed to store history                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBmass_wait_history(ZBX_DC_HISTORY *history, int history_num)
+{
+	zbx_vector_ptr_t	history_values;
+
+	if (SUCCEED != zbx_history_wait())
+		return FAIL;
+
+	zbx_vector_ptr_create(&history_values);
+	zbx_vector_ptr_reserve(&history_values, history_num);
+
+	get_history_values(history, history_num, &history_values);
+	zbx_vc_cache_values(&history_values);
+
+	zbx_vector_ptr_destroy(&history_values);
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: helper function for DCmass_proxy_add_history()                    *
@@ -3154,7 +3459,7 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 	do
 	{
 		DC_ITEM			*items;
-		int			*errcodes, trends_num = 0, timers_num = 0, ret = SUCCEED;
+		int			*errcodes, trends_num = 0, timers_num = 0, ret = SUCCEED, ret_flush;
 		zbx_vector_uint64_t	itemids;
 		ZBX_DC_TREND		*trends = NULL;
 
@@ -3203,24 +3508,44 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 			DCmass_prepare_history(history, &itemids, items, errcodes, history_num, &item_diff,
 					&inventory_values, compression_age, &proxy_subscribtions);
 
-			if (FAIL != (ret = DBmass_add_history(history, history_num)))
+			if (FAIL != (ret = DBmass_add_history(history, history_num, &ret_flush)))
 			{
-				DCconfig_items_apply_changes(&item_diff);
-				DCmass_update_trends(history, history_num, &trends, &trends_num, compression_age);
-
-				if (0 != trends_num)
-					zbx_tfc_invalidate_trends(trends, trends_num);
+				int	caches_updated = FAIL;
 
 				do
 				{
 					DBbegin();
 
 					DBmass_update_items(&item_diff, &inventory_values);
-					DBmass_update_trends(trends, trends_num, &trends_diff);
 
 					/* process internal events generated by DCmass_prepare_history() */
 					zbx_process_events(NULL, NULL);
 
+					if (SUCCEED != caches_updated)
+					{
+						/* history might be still being written in background - caches must   */
+						/* not get values and item changes must not be committed before values */
+						/* are stored                                                           */
+						if (FLUSH_ASYNC == ret_flush &&
+								SUCCEED != (ret = DBmass_wait_history(history, history_num)))
+						{
+							DBrollback();
+							zbx_reset_event_recovery();
+							break;
+						}
+
+						DCconfig_items_apply_changes(&item_diff);
+						DCmass_update_trends(history, history_num, &trends, &trends_num,
+								compression_age);
+
+						if (0 != trends_num)
+							zbx_tfc_invalidate_trends(trends, trends_num);
+
+						caches_updated = SUCCEED;
+					}
+
+					DBmass_update_trends(trends, trends_num, &trends_diff);
+
 					if (ZBX_DB_OK == (txn_error = DBcommit()))
 						DCupdate_trends(&trends_diff);
 					else
@@ -4820,6 +5145,41 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add history storage flush statistics                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hc_update_storage_stats(const zbx_hc_storage_stats_t *stats)
+{
+	LOCK_CACHE;
+
+	cache->storage_stats.flushes += stats->flushes;
+	cache->storage_stats.requests += stats->requests;
+	cache->storage_stats.bytes += stats->bytes;
+	cache->storage_stats.bytes_sent += stats->bytes_sent;
+	cache->storage_stats.time += stats->time;
+
+	if (cache->storage_stats.time_max < stats->time_max)
+		cache->storage_stats.time_max = stats->time_max;
+
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get history storage flush statistics                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hc_get_storage_stats(zbx_hc_storage_stats_t *stats)
+{
+	LOCK_CACHE;
+
+	*stats = cache->storage_stats;
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get shared memory allocator statistics                            *
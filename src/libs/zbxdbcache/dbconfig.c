@@ -306,6 +306,10 @@ static zbx_uint64_t	get_item_nextcheck_seed(zbx_uint64_t itemid, zbx_uint64_t in
 	if (ITEM_TYPE_JMX == type)
 		return interfaceid;
 
+	/* align nextchecks of agent items on the same interface so they can be requested in one batch */
+	if (ITEM_TYPE_ZABBIX == type && 1 < CONFIG_AGENT_BATCH_MAX_ITEMS)
+		return interfaceid;
+
 	if (ITEM_TYPE_SNMP == type)
 	{
 		ZBX_DC_SNMPINTERFACE	*snmp;
@@ -2226,6 +2230,8 @@ static void	DCsync_items(zbx_dbsync_t *sync, int flags, zbx_synced_new_config_t
 		if (SUCCEED == dc_strpool_replace(found, &item->key, row[5]))
 			flags |= ZBX_ITEM_KEY_CHANGED;
 
+		dc_strpool_replace(found, &item->name, row[50]);
+
 		if (0 == found)
 		{
 			item->triggers = NULL;
@@ -2915,6 +2921,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, int flags, zbx_synced_new_config_t
 			zbx_binary_heap_remove_direct(&config->queues[item->poller_type], item->itemid);
 
 		dc_strpool_release(item->key);
+		dc_strpool_release(item->name);
 		dc_strpool_release(item->error);
 		dc_strpool_release(item->delay);
 		dc_strpool_release(item->history_period);
@@ -3531,6 +3538,219 @@ static void	dc_trigger_timer_free(zbx_trigger_timer_t *timer)
 	__config_shmem_free_func(timer);
 }
 
+static int	dc_trigger_timer_compare(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+
+	const zbx_trigger_timer_t	*t1 = (const zbx_trigger_timer_t *)e1->data;
+	const zbx_trigger_timer_t	*t2 = (const zbx_trigger_timer_t *)e2->data;
+
+	int				ret;
+
+	if (0 != (ret = zbx_timespec_compare(&t1->check_ts, &t2->check_ts)))
+		return ret;
+
+	ZBX_RETURN_IF_NOT_EQUAL(t1->triggerid, t2->triggerid);
+
+	return zbx_timespec_compare(&t1->eval_ts, &t2->eval_ts);
+}
+
+static void	dc_timer_wheel_init(zbx_dc_timer_wheel_t *wheel, int now)
+{
+	int	i;
+
+	for (i = 0; i < ZBX_TIMER_WHEEL_SLOTS; i++)
+	{
+		zbx_vector_ptr_create_ext(&wheel->slots[i], __config_shmem_malloc_func, __config_shmem_realloc_func,
+				__config_shmem_free_func);
+	}
+
+	zbx_vector_ptr_create_ext(&wheel->overflow, __config_shmem_malloc_func, __config_shmem_realloc_func,
+			__config_shmem_free_func);
+	zbx_binary_heap_create_ext(&wheel->due, dc_trigger_timer_compare, ZBX_BINARY_HEAP_OPTION_EMPTY,
+			__config_shmem_malloc_func, __config_shmem_realloc_func, __config_shmem_free_func);
+
+	wheel->time = now;
+	wheel->timers_num = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: put timer in the due heap, wheel slot or overflow list depending  *
+ *          on its check time                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_timer_wheel_due_insert(zbx_dc_timer_wheel_t *wheel, zbx_trigger_timer_t *timer)
+{
+	zbx_binary_heap_elem_t	elem;
+
+	elem.key = 0;
+	elem.data = (void *)timer;
+	zbx_binary_heap_insert(&wheel->due, &elem);
+}
+
+static void	dc_timer_wheel_place(zbx_dc_timer_wheel_t *wheel, zbx_trigger_timer_t *timer)
+{
+	if (timer->check_ts.sec <= wheel->time)
+		dc_timer_wheel_due_insert(wheel, timer);
+	else if (timer->check_ts.sec - wheel->time < ZBX_TIMER_WHEEL_SLOTS)
+		zbx_vector_ptr_append(&wheel->slots[timer->check_ts.sec & (ZBX_TIMER_WHEEL_SLOTS - 1)], timer);
+	else
+		zbx_vector_ptr_append(&wheel->overflow, timer);
+}
+
+static void	dc_timer_wheel_insert(zbx_dc_timer_wheel_t *wheel, zbx_trigger_timer_t *timer)
+{
+	dc_timer_wheel_place(wheel, timer);
+	wheel->timers_num++;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move overflow timers that fit in the wheel to the wheel slots     *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_timer_wheel_cascade(zbx_dc_timer_wheel_t *wheel)
+{
+	int	i, num = 0;
+
+	for (i = 0; i < wheel->overflow.values_num; i++)
+	{
+		zbx_trigger_timer_t	*timer = (zbx_trigger_timer_t *)wheel->overflow.values[i];
+
+		if (timer->check_ts.sec - wheel->time < ZBX_TIMER_WHEEL_SLOTS)
+			dc_timer_wheel_place(wheel, timer);
+		else
+			wheel->overflow.values[num++] = timer;
+	}
+
+	wheel->overflow.values_num = num;
+}
+
+static void	dc_timer_wheel_expire_slot(zbx_dc_timer_wheel_t *wheel, int slot)
+{
+	zbx_vector_ptr_t	*timers = &wheel->slots[slot];
+	int			i;
+
+	for (i = 0; i < timers->values_num; i++)
+		dc_timer_wheel_due_insert(wheel, (zbx_trigger_timer_t *)timers->values[i]);
+
+	zbx_vector_ptr_clear(timers);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: advance wheel time, moving timers of the passed slots to the due  *
+ *          heap                                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_timer_wheel_advance(zbx_dc_timer_wheel_t *wheel, int now)
+{
+	int	i;
+
+	if (now - wheel->time >= ZBX_TIMER_WHEEL_SLOTS)
+	{
+		/* all slots have passed */
+		for (i = 0; i < ZBX_TIMER_WHEEL_SLOTS; i++)
+			dc_timer_wheel_expire_slot(wheel, i);
+
+		wheel->time = now;
+		dc_timer_wheel_cascade(wheel);
+
+		return;
+	}
+
+	while (wheel->time < now)
+	{
+		wheel->time++;
+
+		if (0 == (wheel->time & (ZBX_TIMER_WHEEL_SLOTS - 1)))
+			dc_timer_wheel_cascade(wheel);
+
+		dc_timer_wheel_expire_slot(wheel, wheel->time & (ZBX_TIMER_WHEEL_SLOTS - 1));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if the wheel has timers to process at the specified time    *
+ *                                                                            *
+ * Comments: This function does not change the wheel and can be called with  *
+ *           read lock.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_timer_wheel_has_due(const zbx_dc_timer_wheel_t *wheel, int now)
+{
+	int	sec;
+
+	if (0 != wheel->due.elems_num)
+		return SUCCEED;
+
+	if (now - wheel->time >= ZBX_TIMER_WHEEL_SLOTS)
+		return SUCCEED;
+
+	for (sec = wheel->time + 1; sec <= now; sec++)
+	{
+		if (0 != wheel->slots[sec & (ZBX_TIMER_WHEEL_SLOTS - 1)].values_num)
+			return SUCCEED;
+
+		/* overflow timers are cascaded at the start of each revolution */
+		if (0 == (sec & (ZBX_TIMER_WHEEL_SLOTS - 1)) && 0 != wheel->overflow.values_num)
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the next timer to process without removing it from wheel      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_trigger_timer_t	*dc_timer_wheel_due_peek(zbx_dc_timer_wheel_t *wheel)
+{
+	if (SUCCEED == zbx_binary_heap_empty(&wheel->due))
+		return NULL;
+
+	return (zbx_trigger_timer_t *)zbx_binary_heap_find_min(&wheel->due)->data;
+}
+
+static void	dc_timer_wheel_due_pop(zbx_dc_timer_wheel_t *wheel)
+{
+	zbx_binary_heap_remove_min(&wheel->due);
+	wheel->timers_num--;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove all timers from wheel                                      *
+ *                                                                            *
+ * Parameters: wheel  - [IN] the timer wheel                                  *
+ *             timers - [OUT] the removed timers                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_timer_wheel_clear(zbx_dc_timer_wheel_t *wheel, zbx_vector_ptr_t *timers)
+{
+	int	i;
+
+	for (i = 0; i < ZBX_TIMER_WHEEL_SLOTS; i++)
+	{
+		zbx_vector_ptr_append_array(timers, wheel->slots[i].values, wheel->slots[i].values_num);
+		zbx_vector_ptr_clear(&wheel->slots[i]);
+	}
+
+	zbx_vector_ptr_append_array(timers, wheel->overflow.values, wheel->overflow.values_num);
+	zbx_vector_ptr_clear(&wheel->overflow);
+
+	for (i = 0; i < wheel->due.elems_num; i++)
+		zbx_vector_ptr_append(timers, (void *)wheel->due.elems[i].data);
+
+	zbx_binary_heap_clear(&wheel->due);
+
+	wheel->timers_num = 0;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: schedule trigger timer to be executed at the specified time       *
@@ -3545,8 +3765,6 @@ static void	dc_trigger_timer_free(zbx_trigger_timer_t *timer)
 static void	dc_schedule_trigger_timer(zbx_trigger_timer_t *timer, int now, const zbx_timespec_t *eval_ts,
 		const zbx_timespec_t *exec_ts)
 {
-	zbx_binary_heap_elem_t	elem;
-
 	if (NULL == eval_ts)
 		timer->eval_ts = *exec_ts;
 	else
@@ -3556,9 +3774,7 @@ static void	dc_schedule_trigger_timer(zbx_trigger_timer_t *timer, int now, const
 	timer->check_ts.sec = MIN(exec_ts->sec, now + ZBX_TRIGGER_POLL_INTERVAL);
 	timer->check_ts.ns = 0;
 
-	elem.key = 0;
-	elem.data = (void *)timer;
-	zbx_binary_heap_insert(&config->trigger_queue, &elem);
+	dc_timer_wheel_insert(&config->trigger_queue, timer);
 }
 
 /******************************************************************************
@@ -3650,14 +3866,146 @@ static void	dc_schedule_trigger_timers(zbx_hashset_t *trend_queue, int now)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: normalize function parameters                                     *
+ *                                                                            *
+ * Parameters: parameter - [IN] the function parameters                       *
+ *                                                                            *
+ * Return value: The normalized parameters, each parameter is quoted and      *
+ *               leading whitespace is dropped. The returned value must be    *
+ *               freed by the caller.                                         *
+ *                                                                            *
+ * Comments: Parameters with arrays or escape sequences are returned as is,  *
+ *           so normalization never changes the parsed parameter values.      *
+ *                                                                            *
+ ******************************************************************************/
+static char	*dc_function_normalize_parameter(const char *parameter)
+{
+	const char	*ptr;
+	char		*out = NULL;
+	size_t		out_alloc = 0, out_offset = 0, sep_pos, param_pos, param_len;
+
+	if ('\0' == *parameter || NULL != strchr(parameter, '[') || NULL != strchr(parameter, '\\'))
+		return zbx_strdup(NULL, parameter);
+
+	for (ptr = parameter;; ptr += sep_pos + 1)
+	{
+		char	*param;
+		int	quoted;
+
+		zbx_function_param_parse(ptr, &param_pos, &param_len, &sep_pos);
+
+		param = zbx_function_param_unquote_dyn(ptr + param_pos, param_len, &quoted);
+
+		if (SUCCEED != zbx_function_param_quote(&param, 1))
+		{
+			zbx_free(param);
+			zbx_free(out);
+
+			return zbx_strdup(NULL, parameter);
+		}
+
+		if (0 != out_offset)
+			zbx_chrcpy_alloc(&out, &out_alloc, &out_offset, ',');
+
+		zbx_strcpy_alloc(&out, &out_alloc, &out_offset, param);
+		zbx_free(param);
+
+		if ('\0' == ptr[sep_pos])
+			break;
+	}
+
+	return out;
+}
+
+static zbx_hash_t	dc_function_canonical_hash(const void *data)
+{
+	const zbx_dc_function_canonical_t	*canonical = (const zbx_dc_function_canonical_t *)data;
+	zbx_hash_t				hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&canonical->itemid);
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(canonical->function, strlen(canonical->function), hash);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(canonical->parameter, strlen(canonical->parameter), hash);
+}
+
+static int	dc_function_canonical_compare(const void *d1, const void *d2)
+{
+	const zbx_dc_function_canonical_t	*canonical1 = (const zbx_dc_function_canonical_t *)d1;
+	const zbx_dc_function_canonical_t	*canonical2 = (const zbx_dc_function_canonical_t *)d2;
+	int					ret;
+
+	ZBX_RETURN_IF_NOT_EQUAL(canonical1->itemid, canonical2->itemid);
+
+	if (canonical1->function != canonical2->function &&
+			0 != (ret = strcmp(canonical1->function, canonical2->function)))
+	{
+		return ret;
+	}
+
+	return canonical1->parameter == canonical2->parameter ? 0 :
+			strcmp(canonical1->parameter, canonical2->parameter);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get canonical function for the function item, name and parameters *
+ *                                                                            *
+ * Parameters: function - [IN] the function                                   *
+ *                                                                            *
+ * Return value: The canonical function with increased reference counter.     *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_dc_function_canonical_t	*dc_function_canonical_acquire(const ZBX_DC_FUNCTION *function)
+{
+	zbx_dc_function_canonical_t	*canonical, canonical_local;
+	char				*parameter;
+
+	parameter = dc_function_normalize_parameter(function->parameter);
+
+	canonical_local.itemid = function->itemid;
+	canonical_local.function = function->function;
+	canonical_local.parameter = parameter;
+
+	if (NULL == (canonical = (zbx_dc_function_canonical_t *)zbx_hashset_search(&config->functions_canonical,
+			&canonical_local)))
+	{
+		canonical_local.function = dc_strpool_acquire(function->function);
+		canonical_local.parameter = dc_strpool_intern(parameter);
+		canonical_local.canonicalid = ++config->function_canonicalid;
+		canonical_local.refcount = 0;
+
+		canonical = (zbx_dc_function_canonical_t *)zbx_hashset_insert(&config->functions_canonical,
+				&canonical_local, sizeof(canonical_local));
+	}
+
+	zbx_free(parameter);
+	canonical->refcount++;
+
+	return canonical;
+}
+
+static void	dc_function_canonical_release(zbx_dc_function_canonical_t *canonical)
+{
+	if (0 != --canonical->refcount)
+		return;
+
+	dc_strpool_release(canonical->function);
+	dc_strpool_release(canonical->parameter);
+
+	zbx_hashset_remove_direct(&config->functions_canonical, canonical);
+}
+
 static void	DCsync_functions(zbx_dbsync_t *sync)
 {
 	char		**row;
 	zbx_uint64_t	rowid;
 	unsigned char	tag;
 
-	ZBX_DC_ITEM	*item;
-	ZBX_DC_FUNCTION	*function;
+	ZBX_DC_ITEM			*item;
+	ZBX_DC_FUNCTION			*function;
+	zbx_dc_function_canonical_t	*canonical;
 
 	int		found, ret;
 	zbx_uint64_t	itemid, functionid, triggerid;
@@ -3710,6 +4058,14 @@ static void	DCsync_functions(zbx_dbsync_t *sync)
 		function->type = zbx_get_function_type(function->function);
 		function->revision = config->sync_start_ts;
 
+		/* acquire the new canonical function before releasing the old one, as they can match */
+		canonical = dc_function_canonical_acquire(function);
+
+		if (1 == found)
+			dc_function_canonical_release(function->canonical);
+
+		function->canonical = canonical;
+
 		dc_item_reset_triggers(item, NULL);
 	}
 
@@ -3721,6 +4077,7 @@ static void	DCsync_functions(zbx_dbsync_t *sync)
 		if (NULL != (item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &function->itemid)))
 			dc_item_reset_triggers(item, NULL);
 
+		dc_function_canonical_release(function->canonical);
 		dc_strpool_release(function->function);
 		dc_strpool_release(function->parameter);
 
@@ -6111,6 +6468,8 @@ void	DCsync_configuration(unsigned char mode, zbx_synced_new_config_t synced)
 				config->scriptitems.num_data, config->scriptitems.num_slots);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() functions  : %d (%d slots)", __func__,
 				config->functions.num_data, config->functions.num_slots);
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() canonical functions : %d (%d slots)", __func__,
+				config->functions_canonical.num_data, config->functions_canonical.num_slots);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() triggers   : %d (%d slots)", __func__,
 				config->triggers.num_data, config->triggers.num_slots);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() trigdeps   : %d (%d slots)", __func__,
@@ -6152,8 +6511,9 @@ void	DCsync_configuration(unsigned char mode, zbx_synced_new_config_t synced)
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() pqueue     : %d (%d allocated)", __func__,
 				config->pqueue.elems_num, config->pqueue.elems_alloc);
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() timer queue: %d (%d allocated)", __func__,
-				config->trigger_queue.elems_num, config->trigger_queue.elems_alloc);
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() timer queue: %d (%d due, %d overflow)", __func__,
+				config->trigger_queue.timers_num, config->trigger_queue.due.elems_num,
+				config->trigger_queue.overflow.values_num);
 
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() configfree : " ZBX_FS_DBL "%%", __func__,
 				100 * ((double)config_mem->free_size / config_mem->orig_size));
@@ -6340,6 +6700,14 @@ static int	__config_snmp_item_compare(const ZBX_DC_ITEM *i1, const ZBX_DC_ITEM *
 	return 0;
 }
 
+static int	__config_agent_item_compare(const ZBX_DC_ITEM *i1, const ZBX_DC_ITEM *i2)
+{
+	ZBX_RETURN_IF_NOT_EQUAL(i1->interfaceid, i2->interfaceid);
+	ZBX_RETURN_IF_NOT_EQUAL(i1->type, i2->type);
+
+	return 0;
+}
+
 static int	__config_heap_elem_compare(const void *d1, const void *d2)
 {
 	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
@@ -6354,7 +6722,16 @@ static int	__config_heap_elem_compare(const void *d1, const void *d2)
 	if (ITEM_TYPE_SNMP != i1->type)
 	{
 		if (ITEM_TYPE_SNMP != i2->type)
-			return 0;
+		{
+			/* keep agent items of the same interface together for batched requests */
+			if (ITEM_TYPE_ZABBIX != i1->type)
+				return ITEM_TYPE_ZABBIX != i2->type ? 0 : +1;
+
+			if (ITEM_TYPE_ZABBIX != i2->type)
+				return -1;
+
+			return __config_agent_item_compare(i1, i2);
+		}
 
 		return -1;
 	}
@@ -6462,27 +6839,6 @@ static int	__config_psk_compare(const void *d1, const void *d2)
 }
 #endif
 
-static int	__config_timer_compare(const void *d1, const void *d2)
-{
-	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
-	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
-
-	const zbx_trigger_timer_t	*t1 = (const zbx_trigger_timer_t *)e1->data;
-	const zbx_trigger_timer_t	*t2 = (const zbx_trigger_timer_t *)e2->data;
-
-	int	ret;
-
-	if (0 != (ret = zbx_timespec_compare(&t1->check_ts, &t2->check_ts)))
-		return ret;
-
-	ZBX_RETURN_IF_NOT_EQUAL(t1->triggerid, t2->triggerid);
-
-	if (0 != (ret = zbx_timespec_compare(&t1->eval_ts, &t2->eval_ts)))
-		return ret;
-
-	return 0;
-}
-
 static zbx_hash_t	__config_data_session_hash(const void *data)
 {
 	const zbx_data_session_t	*session = (const zbx_data_session_t *)data;
@@ -6555,6 +6911,8 @@ int	init_configuration_cache(char **error)
 	CREATE_HASHSET(config->item_discovery, 0);
 	CREATE_HASHSET(config->prototype_items, 0);
 	CREATE_HASHSET(config->functions, 100);
+	CREATE_HASHSET_EXT(config->functions_canonical, 100, dc_function_canonical_hash,
+			dc_function_canonical_compare);
 	CREATE_HASHSET(config->triggers, 100);
 	CREATE_HASHSET(config->trigdeps, 0);
 	CREATE_HASHSET(config->hosts, 10);
@@ -6645,12 +7003,7 @@ int	init_configuration_cache(char **error)
 					__config_shmem_realloc_func,
 					__config_shmem_free_func);
 
-	zbx_binary_heap_create_ext(&config->trigger_queue,
-					__config_timer_compare,
-					ZBX_BINARY_HEAP_OPTION_EMPTY,
-					__config_shmem_malloc_func,
-					__config_shmem_realloc_func,
-					__config_shmem_free_func);
+	dc_timer_wheel_init(&config->trigger_queue, (int)time(NULL));
 
 	CREATE_HASHSET_EXT(config->data_sessions, 0, __config_data_session_hash, __config_data_session_compare);
 
@@ -6663,6 +7016,7 @@ int	init_configuration_cache(char **error)
 	config->sync_ts = 0;
 	config->item_sync_ts = 0;
 	config->sync_start_ts = 0;
+	config->function_canonicalid = 0;
 
 	config->internal_actions = 0;
 
@@ -7498,6 +7852,7 @@ static void	DCget_function(DC_FUNCTION *dst_function, const ZBX_DC_FUNCTION *src
 	dst_function->functionid = src_function->functionid;
 	dst_function->triggerid = src_function->triggerid;
 	dst_function->itemid = src_function->itemid;
+	dst_function->canonicalid = src_function->canonical->canonicalid;
 	dst_function->type = src_function->type;
 
 	sz_function = strlen(src_function->function) + 1;
@@ -7703,6 +8058,35 @@ void	DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids,
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item name from configuration cache                            *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item identifier                              *
+ *             name   - [OUT] the item name                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the item was found                                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dc_get_item_name(zbx_uint64_t itemid, char **name)
+{
+	const ZBX_DC_ITEM	*dc_item;
+	int			ret = FAIL;
+
+	RDLOCK_CACHE;
+
+	if (NULL != (dc_item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemid)))
+	{
+		*name = zbx_strdup(NULL, dc_item->name);
+		ret = SUCCEED;
+	}
+
+	UNLOCK_CACHE;
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: convert item history/trends housekeeping period to numeric values *
@@ -8540,34 +8924,23 @@ static void	dc_remove_invalid_timer(zbx_trigger_timer_t *timer)
 void	zbx_dc_get_trigger_timers(zbx_vector_ptr_t *timers, int now, int soft_limit, int hard_limit)
 {
 	zbx_trigger_timer_t	*first_timer = NULL, *timer;
-	int			found = 0;
-	zbx_binary_heap_elem_t	*elem;
+	int			found;
 
 	RDLOCK_CACHE;
-
-	if (SUCCEED != zbx_binary_heap_empty(&config->trigger_queue))
-	{
-		elem = zbx_binary_heap_find_min(&config->trigger_queue);
-		timer = (zbx_trigger_timer_t *)elem->data;
-
-		if (timer->check_ts.sec <= now)
-			found = 1;
-	}
-
+	found = dc_timer_wheel_has_due(&config->trigger_queue, now);
 	UNLOCK_CACHE;
 
-	if (0 == found)
+	if (SUCCEED != found)
 		return;
 
 	WRLOCK_CACHE;
 
-	while (SUCCEED != zbx_binary_heap_empty(&config->trigger_queue) && timers->values_num < hard_limit)
+	dc_timer_wheel_advance(&config->trigger_queue, now);
+
+	while (NULL != (timer = dc_timer_wheel_due_peek(&config->trigger_queue)) && timers->values_num < hard_limit)
 	{
 		ZBX_DC_TRIGGER	*dc_trigger;
 
-		elem = zbx_binary_heap_find_min(&config->trigger_queue);
-		timer = (zbx_trigger_timer_t *)elem->data;
-
 		if (timer->check_ts.sec > now)
 			break;
 
@@ -8584,7 +8957,7 @@ void	zbx_dc_get_trigger_timers(zbx_vector_ptr_t *timers, int now, int soft_limit
 		if (timers->values_num >= soft_limit && NULL == first_timer)
 			break;
 
-		zbx_binary_heap_remove_min(&config->trigger_queue);
+		dc_timer_wheel_due_pop(&config->trigger_queue);
 
 		if (SUCCEED != trigger_timer_validate(timer, &dc_trigger))
 		{
@@ -8702,16 +9075,20 @@ void	zbx_dc_reschedule_trigger_timers(zbx_vector_ptr_t *timers, int now)
  ******************************************************************************/
 void	zbx_dc_clear_timer_queue(zbx_vector_ptr_t *timers)
 {
-	ZBX_DC_FUNCTION	*function;
-	int		i;
+	ZBX_DC_FUNCTION		*function;
+	int			i;
+	zbx_vector_ptr_t	queue;
 
-	zbx_vector_ptr_reserve(timers, config->trigger_queue.elems_num);
+	zbx_vector_ptr_create(&queue);
 
 	WRLOCK_CACHE;
 
-	for (i = 0; i < config->trigger_queue.elems_num; i++)
+	zbx_vector_ptr_reserve(&queue, (size_t)config->trigger_queue.timers_num);
+	dc_timer_wheel_clear(&config->trigger_queue, &queue);
+
+	for (i = 0; i < queue.values_num; i++)
 	{
-		zbx_trigger_timer_t	*timer = (zbx_trigger_timer_t *)config->trigger_queue.elems[i].data;
+		zbx_trigger_timer_t	*timer = (zbx_trigger_timer_t *)queue.values[i];
 
 		if (ZBX_TRIGGER_TIMER_FUNCTION_TREND == timer->type &&
 				NULL != (function = (ZBX_DC_FUNCTION *)zbx_hashset_search(&config->functions,
@@ -8724,9 +9101,9 @@ void	zbx_dc_clear_timer_queue(zbx_vector_ptr_t *timers)
 			dc_trigger_timer_free(timer);
 	}
 
-	zbx_binary_heap_clear(&config->trigger_queue);
-
 	UNLOCK_CACHE;
+
+	zbx_vector_ptr_destroy(&queue);
 }
 
 void	zbx_dc_free_timers(zbx_vector_ptr_t *timers)
@@ -9086,6 +9463,11 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM **items)
 				if (0 != __config_java_item_compare(dc_item_prev, dc_item))
 					break;
 			}
+			else if (ITEM_TYPE_ZABBIX == dc_item_prev->type)
+			{
+				if (0 != __config_agent_item_compare(dc_item_prev, dc_item))
+					break;
+			}
 		}
 
 		zbx_binary_heap_remove_min(queue);
@@ -9150,6 +9532,8 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM **items)
 					max_items = DCconfig_get_suggested_snmp_vars_nolock(dc_item->interfaceid, NULL);
 				}
 			}
+			else if (ZBX_POLLER_TYPE_NORMAL == poller_type && ITEM_TYPE_ZABBIX == dc_item->type)
+				max_items = CONFIG_AGENT_BATCH_MAX_ITEMS;
 
 			if (1 < max_items)
 				*items = zbx_malloc(NULL, sizeof(DC_ITEM) * max_items);
@@ -12055,6 +12439,112 @@ void	zbx_dc_get_hostids_by_group_name(const char *name, zbx_vector_uint64_t *hos
 	zbx_vector_uint64_uniq(hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if trigger items belong to any of the specified groups     *
+ *                                                                            *
+ * Parameter: triggerid - [IN] the trigger identifier                         *
+ *            groupids  - [IN] the host group identifiers                     *
+ *                                                                            *
+ * Return value: SUCCEED - at least one trigger item host is in the groups    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_check_trigger_hostgroups(zbx_uint64_t triggerid, const zbx_vector_uint64_t *groupids)
+{
+	int			i;
+	const ZBX_DC_TRIGGER	*trigger;
+	const ZBX_DC_ITEM	*item;
+	zbx_dc_hostgroup_t	*group;
+	const zbx_uint64_t	*itemid;
+
+	if (NULL == (trigger = (const ZBX_DC_TRIGGER *)zbx_hashset_search(&config->triggers, &triggerid)) ||
+			NULL == trigger->itemids)
+	{
+		return FAIL;
+	}
+
+	for (itemid = trigger->itemids; 0 != *itemid; itemid++)
+	{
+		if (NULL == (item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, itemid)))
+			continue;
+
+		for (i = 0; i < groupids->values_num; i++)
+		{
+			if (NULL == (group = (zbx_dc_hostgroup_t *)zbx_hashset_search(&config->hostgroups,
+					&groupids->values[i])))
+			{
+				continue;
+			}
+
+			if (NULL != zbx_hashset_search(&group->hostids, &item->hostid))
+				return SUCCEED;
+		}
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if trigger items belong to the host group or its nested    *
+ *          groups                                                            *
+ *                                                                            *
+ * Parameter: triggerid - [IN] the trigger identifier                         *
+ *            groupid   - [IN] the host group identifier                      *
+ *                                                                            *
+ * Return value: SUCCEED - at least one trigger item host is in the group     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dc_check_trigger_hostgroup(zbx_uint64_t triggerid, zbx_uint64_t groupid)
+{
+	int			ret;
+	zbx_vector_uint64_t	groupids;
+
+	zbx_vector_uint64_create(&groupids);
+	zbx_dc_get_nested_hostgroupids(&groupid, 1, &groupids);
+
+	RDLOCK_CACHE;
+	ret = dc_check_trigger_hostgroups(triggerid, &groupids);
+	UNLOCK_CACHE;
+
+	zbx_vector_uint64_destroy(&groupids);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets triggers having items in the host group or its nested groups *
+ *                                                                            *
+ * Parameter: groupid          - [IN] the host group identifier               *
+ *            triggerids       - [IN] the trigger identifiers to check        *
+ *            group_triggerids - [OUT] the triggers belonging to the group    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_hostgroup_triggerids(zbx_uint64_t groupid, const zbx_vector_uint64_t *triggerids,
+		zbx_vector_uint64_t *group_triggerids)
+{
+	int			i;
+	zbx_vector_uint64_t	groupids;
+
+	zbx_vector_uint64_create(&groupids);
+	zbx_dc_get_nested_hostgroupids(&groupid, 1, &groupids);
+
+	RDLOCK_CACHE;
+
+	for (i = 0; i < triggerids->values_num; i++)
+	{
+		if (SUCCEED == dc_check_trigger_hostgroups(triggerids->values[i], &groupids))
+			zbx_vector_uint64_append(group_triggerids, triggerids->values[i]);
+	}
+
+	UNLOCK_CACHE;
+
+	zbx_vector_uint64_destroy(&groupids);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: gets active proxy data by its name from configuration cache       *
@@ -12990,6 +13480,82 @@ void	zbx_dc_get_item_tags_by_functionids(const zbx_uint64_t *functionids, size_t
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item names, item tags and host group names for history and   *
+ *          trends export                                                     *
+ *                                                                            *
+ * Parameters: items - [IN/OUT] the items to update (zbx_dc_item_export_t)    *
+ *             hosts - [IN/OUT] the hosts to update (zbx_dc_host_export_t)    *
+ *                                                                            *
+ * Comments: Previous item names, tags and host groups are replaced. Only the *
+ *           tags defined on the item itself are returned, host groups are    *
+ *           returned in the order of their names.                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_export_info(zbx_vector_ptr_t *items, zbx_vector_ptr_t *hosts)
+{
+	int				i, j;
+	const ZBX_DC_ITEM		*dc_item;
+	const zbx_dc_hostgroup_t	*group;
+
+	for (i = 0; i < items->values_num; i++)
+	{
+		zbx_dc_item_export_t	*item = (zbx_dc_item_export_t *)items->values[i];
+
+		zbx_free(item->name);
+		zbx_vector_tags_clear_ext(&item->tags, zbx_free_tag);
+	}
+
+	for (i = 0; i < hosts->values_num; i++)
+	{
+		zbx_dc_host_export_t	*host = (zbx_dc_host_export_t *)hosts->values[i];
+
+		zbx_vector_str_clear_ext(&host->groups, zbx_str_free);
+	}
+
+	RDLOCK_CACHE;
+
+	for (i = 0; i < items->values_num; i++)
+	{
+		zbx_dc_item_export_t	*item = (zbx_dc_item_export_t *)items->values[i];
+
+		if (NULL == (dc_item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &item->itemid)))
+			continue;
+
+		item->name = zbx_strdup(NULL, dc_item->name);
+
+		for (j = 0; j < dc_item->tags.values_num; j++)
+		{
+			const zbx_dc_item_tag_t	*dc_tag = (const zbx_dc_item_tag_t *)dc_item->tags.values[j];
+			zbx_tag_t		*tag;
+
+			tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+			tag->tag = zbx_strdup(NULL, dc_tag->tag);
+			tag->value = zbx_strdup(NULL, dc_tag->value);
+			zbx_vector_tags_append(&item->tags, tag);
+		}
+	}
+
+	if (0 != hosts->values_num)
+	{
+		for (i = 0; i < config->hostgroups_name.values_num; i++)
+		{
+			group = (const zbx_dc_hostgroup_t *)config->hostgroups_name.values[i];
+
+			for (j = 0; j < hosts->values_num; j++)
+			{
+				zbx_dc_host_export_t	*host = (zbx_dc_host_export_t *)hosts->values[j];
+
+				if (NULL != zbx_hashset_search(&group->hostids, &host->hostid))
+					zbx_vector_str_append(&host->groups, zbx_strdup(NULL, group->name));
+			}
+		}
+	}
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves proxy suppress window data from the cache               *
@@ -13555,4 +14121,5 @@ static void	dc_reschedule_items(void)
 #ifdef HAVE_TESTS
 #	include "../../../tests/libs/zbxdbcache/dc_item_poller_type_update_test.c"
 #	include "../../../tests/libs/zbxdbcache/dc_function_calculate_nextcheck_test.c"
+#	include "../../../tests/libs/zbxdbcache/dc_timer_wheel_test.c"
 #endif
@@ -74,16 +74,28 @@ typedef struct zbx_dc_trigger_deplist
 }
 ZBX_DC_TRIGGER_DEPLIST;
 
+/* functions with the same item, name and normalized parameters share canonical function */
 typedef struct
 {
-	zbx_uint64_t	functionid;
-	zbx_uint64_t	triggerid;
 	zbx_uint64_t	itemid;
 	const char	*function;
-	const char	*parameter;
-	int		revision;
-	int		timer_revision;
-	unsigned char	type;
+	const char	*parameter;	/* normalized function parameters */
+	zbx_uint64_t	canonicalid;
+	zbx_uint32_t	refcount;
+}
+zbx_dc_function_canonical_t;
+
+typedef struct
+{
+	zbx_uint64_t			functionid;
+	zbx_uint64_t			triggerid;
+	zbx_uint64_t			itemid;
+	const char			*function;
+	const char			*parameter;
+	int				revision;
+	int				timer_revision;
+	unsigned char			type;
+	zbx_dc_function_canonical_t	*canonical;
 }
 ZBX_DC_FUNCTION;
 
@@ -95,6 +107,7 @@ typedef struct
 	zbx_uint64_t		lastlogsize;
 	zbx_uint64_t		valuemapid;
 	const char		*key;
+	const char		*name;
 	const char		*port;
 	const char		*error;
 	const char		*delay;
@@ -517,6 +530,23 @@ typedef struct
 }
 ZBX_DC_CONFIG_TABLE;
 
+/* the number of one second slots in trigger timer wheel, must be power of 2 */
+#define ZBX_TIMER_WHEEL_SLOTS	1024
+
+/* Trigger timers are kept in one second slots for the next ZBX_TIMER_WHEEL_SLOTS */
+/* seconds. Timers scheduled later are kept in overflow list and moved to slots   */
+/* every wheel revolution. When the wheel time advances, timers of the passed    */
+/* slots are moved to the due heap.                                               */
+typedef struct
+{
+	zbx_vector_ptr_t	slots[ZBX_TIMER_WHEEL_SLOTS];
+	zbx_vector_ptr_t	overflow;
+	zbx_binary_heap_t	due;		/* timers to process, ordered by check time */
+	int			time;		/* the wheel time, timers up to this time are in due list */
+	int			timers_num;
+}
+zbx_dc_timer_wheel_t;
+
 typedef struct
 {
 	zbx_uint64_t	hosts_monitored;		/* total number of enabled hosts */
@@ -760,6 +790,8 @@ typedef struct
 	int			item_sync_ts;
 	int			sync_start_ts;
 
+	zbx_uint64_t		function_canonicalid;	/* the last assigned canonical function identifier */
+
 	unsigned int		internal_actions;		/* number of enabled internal actions */
 
 	/* maintenance processing management */
@@ -792,6 +824,7 @@ typedef struct
 	zbx_hashset_t		httpitems;
 	zbx_hashset_t		scriptitems;
 	zbx_hashset_t		functions;
+	zbx_hashset_t		functions_canonical;	/* itemid, function, normalized parameters */
 	zbx_hashset_t		triggers;
 	zbx_hashset_t		trigdeps;
 	zbx_hashset_t		hosts;
@@ -839,7 +872,7 @@ typedef struct
 	zbx_hashset_t		data_sessions;
 	zbx_binary_heap_t	queues[ZBX_POLLER_TYPE_COUNT];
 	zbx_binary_heap_t	pqueue;
-	zbx_binary_heap_t	trigger_queue;
+	zbx_dc_timer_wheel_t	trigger_queue;
 	ZBX_DC_CONFIG_TABLE	*config;
 	ZBX_DC_STATUS		*status;
 	zbx_hashset_t		strpool;
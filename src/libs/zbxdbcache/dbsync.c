@@ -1410,6 +1410,9 @@ static int	dbsync_compare_item(const ZBX_DC_ITEM *item, const DB_ROW dbrow)
 	if (FAIL == dbsync_compare_uint64(dbrow[48], item->templateid))
 		return FAIL;
 
+	if (FAIL == dbsync_compare_str(dbrow[50], item->name))
+		return FAIL;
+
 	if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &item->hostid)))
 		return FAIL;
 
@@ -1796,7 +1799,7 @@ int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
 				"i.master_itemid,i.timeout,i.url,i.query_fields,i.posts,i.status_codes,"
 				"i.follow_redirects,i.post_type,i.http_proxy,i.headers,i.retrieve_mode,"
 				"i.request_method,i.output_format,i.ssl_cert_file,i.ssl_key_file,i.ssl_key_password,"
-				"i.verify_peer,i.verify_host,i.allow_traps,i.templateid,null"
+				"i.verify_peer,i.verify_host,i.allow_traps,i.templateid,null,i.name"
 			" from items i"
 			" inner join hosts h on i.hostid=h.hostid"
 			" join item_rtdata ir on i.itemid=ir.itemid"
@@ -1807,7 +1810,7 @@ int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 50, dbsync_item_preproc_row);
+	dbsync_prepare(sync, 51, dbsync_item_preproc_row);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -2155,8 +2158,8 @@ static int	dbsync_compare_trigger(const ZBX_DC_TRIGGER *trigger, const DB_ROW db
  * Comments: The row preprocessing can be used to expand user macros in       *
  *           some columns.                                                    *
  *           During preprocessing trigger expression/recovery expression are  *
- *           parsed, serialized and stored as base64 strings into 16,17       *
- *           columns.                                                         *
+ *           parsed, compiled, serialized and stored as base64 strings into   *
+ *           16,17 columns.                                                   *
  *                                                                            *
  ******************************************************************************/
 static char	**dbsync_trigger_preproc_row(char **row)
@@ -2179,6 +2182,8 @@ static char	**dbsync_trigger_preproc_row(char **row)
 	{
 		if (SUCCEED == zbx_eval_check_timer_functions(&ctx))
 			timer |= ZBX_TRIGGER_TIMER_EXPRESSION;
+
+		zbx_eval_compile(&ctx);
 	}
 
 	ZBX_STR2UCHAR(mode, row[10]);
@@ -2195,6 +2200,8 @@ static char	**dbsync_trigger_preproc_row(char **row)
 		{
 			if (SUCCEED == zbx_eval_check_timer_functions(&ctx_r))
 				timer |= ZBX_TRIGGER_TIMER_RECOVERY_EXPRESSION;
+
+			zbx_eval_compile(&ctx_r);
 		}
 	}
 
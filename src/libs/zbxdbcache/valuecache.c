@@ -178,6 +178,11 @@ typedef struct
 
 	/* the first (oldest) chunk of item history data              */
 	zbx_vc_chunk_t	*tail;
+
+	/* The item data revision, changed when item is added to      */
+	/* cache or a value older than the last cached value is       */
+	/* added. Used to validate data derived from cached values.   */
+	zbx_uint64_t	revision;
 }
 zbx_vc_item_t;
 
@@ -207,6 +212,9 @@ typedef struct
 
 	/* the string pool for str, text and log item values */
 	zbx_hashset_t	strpool;
+
+	/* the last assigned item data revision */
+	zbx_uint64_t	revision;
 }
 zbx_vc_cache_t;
 
@@ -1953,7 +1961,8 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 
 	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
 	{
-		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
+		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type,
+				.revision = ++vc_cache->revision};
 
 		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
 			goto out;
@@ -2062,7 +2071,8 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 
 	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
 	{
-		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
+		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type,
+				.revision = ++vc_cache->revision};
 
 		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
 			goto out;
@@ -2480,19 +2490,38 @@ void	zbx_vc_reset(void)
  * Return value: SUCCEED - the values were added successfully                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: If the values are written to history in background (FLUSH_ASYNC  *
+ *           returned in ret_flush) they are not cached, so                   *
+ *           zbx_vc_cache_values() must be called after they are stored.      *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
+{
+	if (SUCCEED != zbx_history_add_values(history, ret_flush))
+		return FAIL;
+
+	if (FLUSH_ASYNC != *ret_flush)
+		zbx_vc_cache_values(history);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item values already stored in history to value cache        *
+ *                                                                            *
+ * Parameters: history - [IN] item history values                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_cache_values(zbx_vector_ptr_t *history)
 {
 	zbx_vc_item_t		*item;
 	int			i;
 	ZBX_DC_HISTORY		*h;
 	time_t			expire_timestamp;
 
-	if (SUCCEED != zbx_history_add_values(history, ret_flush))
-		return FAIL;
-
 	if (ZBX_VC_DISABLED == vc_state)
-		return SUCCEED;
+		return;
 
 	expire_timestamp = time(NULL) - ZBX_VC_ITEM_EXPIRE_PERIOD;
 
@@ -2507,6 +2536,10 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 			zbx_history_record_t	record = {h->ts, h->value};
 			zbx_vc_chunk_t		*head = item->head;
 
+			/* values that are not newer than the last cached value change the cached data */
+			if (NULL != head && 0 <= zbx_timespec_compare(&head->slots[head->last_value].timestamp, &h->ts))
+				item->revision = ++vc_cache->revision;
+
 			/* If the new value type does not match the item's type in cache remove it, */
 			/* so it's cached with the correct type from correct tables when accessed   */
 			/* next time.                                                               */
@@ -2528,8 +2561,6 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 	}
 
 	UNLOCK_CACHE;
-
-	return SUCCEED;
 }
 
 /******************************************************************************
@@ -2650,6 +2681,90 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item data revision                                            *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             revision   - [OUT] the item data revision                      *
+ *                                                                            *
+ * Return value: SUCCEED - the item is cached, revision was returned          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The item revision is changed when item data is cached again or   *
+ *           a value not newer than the last cached value is added. While     *
+ *           revision is not changed only newer values are appended to item   *
+ *           data, so the results calculated from its values can be updated   *
+ *           with the new values instead of recalculating them.               *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_item_revision(zbx_uint64_t itemid, int value_type, zbx_uint64_t *revision)
+{
+	zbx_vc_item_t	*item;
+	int		ret = FAIL;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		return FAIL;
+
+	RDLOCK_CACHE;
+
+	if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)) &&
+			item->value_type == value_type)
+	{
+		*revision = item->revision;
+		ret = SUCCEED;
+	}
+
+	UNLOCK_CACHE;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the start of item history period held by value cache          *
+ *                                                                            *
+ * Parameters: itemid      - [IN] the item id                                 *
+ *             value_type  - [IN] the item value type                         *
+ *             cached_from - [OUT] the timestamp from which item values are   *
+ *                           guaranteed to be cached, 0 if all item values    *
+ *                           are cached                                       *
+ *                                                                            *
+ * Return value: SUCCEED - the item is cached, the period start was returned  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_item_cached_from(zbx_uint64_t itemid, int value_type, int *cached_from)
+{
+	zbx_vc_item_t	*item;
+	int		ret = FAIL;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		return FAIL;
+
+	RDLOCK_CACHE;
+
+	if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)) &&
+			item->value_type == value_type)
+	{
+		if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+		{
+			*cached_from = 0;
+			ret = SUCCEED;
+		}
+		else if (0 != item->db_cached_from)
+		{
+			*cached_from = item->db_cached_from;
+			ret = SUCCEED;
+		}
+	}
+
+	UNLOCK_CACHE;
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves usage cache statistics                                  *
@@ -221,6 +221,108 @@ int	DBconnect(int flag)
 	return err;
 }
 
+#ifdef HAVE_POSTGRESQL
+static const char	*async_sql = NULL;	/* statements sent over asynchronous connection */
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send statements over asynchronous connection, reconnecting if the *
+ *          connection is not available                                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBasync_send(const char *sql)
+{
+	int	rc;
+
+	while (ZBX_DB_DOWN == (rc = zbx_db_async_send(sql)))
+	{
+		while (ZBX_DB_OK != (rc = zbx_db_async_connect(CONFIG_DBHOST, CONFIG_DBUSER, CONFIG_DBPASSWORD,
+				CONFIG_DBNAME, CONFIG_DBSCHEMA, CONFIG_DBSOCKET, CONFIG_DBPORT, CONFIG_DB_TLS_CONNECT,
+				CONFIG_DB_TLS_CERT_FILE, CONFIG_DB_TLS_KEY_FILE, CONFIG_DB_TLS_CA_FILE,
+				CONFIG_DB_TLS_CIPHER, CONFIG_DB_TLS_CIPHER_13)))
+		{
+			if (ZBX_DB_FAIL == rc)
+				return rc;
+
+			zabbix_log(LOG_LEVEL_ERR, "database is down: reconnecting in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			zbx_sleep(ZBX_DB_WAIT_DOWN);
+		}
+
+		if (0 != connection_failure)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database connection re-established");
+			connection_failure = 0;
+		}
+	}
+
+	return rc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute statements without waiting for their completion          *
+ *                                                                            *
+ * Parameters: sql - [IN] the statements separated by semicolons              *
+ *                                                                            *
+ * Return value: ZBX_DB_OK   - the statements were sent                       *
+ *               ZBX_DB_FAIL - failed to send the statements                  *
+ *                                                                            *
+ * Comments: The statements are executed over a separate database connection  *
+ *           as a single transaction, so the caller can continue working      *
+ *           with the main connection meanwhile. The sql buffer must be kept  *
+ *           until DBasync_wait() is called, as the statements are resent if  *
+ *           the connection is lost. Only one batch can be in progress - the  *
+ *           previous batch is waited for before sending the next one.        *
+ *                                                                            *
+ ******************************************************************************/
+int	DBasync_execute(const char *sql)
+{
+	int	rc;
+
+	if (ZBX_DB_OK != DBasync_wait())
+		zabbix_log(LOG_LEVEL_WARNING, "previous asynchronous statements have failed");
+
+	if (ZBX_DB_OK == (rc = DBasync_send(sql)))
+		async_sql = sql;
+
+	return rc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: wait for completion of statements sent with DBasync_execute()     *
+ *                                                                            *
+ * Return value: ZBX_DB_OK   - the statements were executed successfully or   *
+ *                             there were no statements in progress           *
+ *               ZBX_DB_FAIL - the statements have failed                     *
+ *                                                                            *
+ ******************************************************************************/
+int	DBasync_wait(void)
+{
+	int	rc;
+
+	if (NULL == async_sql)
+		return ZBX_DB_OK;
+
+	while (ZBX_DB_DOWN == (rc = zbx_db_async_wait()))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+		connection_failure = 1;
+		zbx_sleep(ZBX_DB_WAIT_DOWN);
+
+		zbx_db_async_close();
+
+		if (ZBX_DB_OK != (rc = DBasync_send(async_sql)))
+			break;
+	}
+
+	async_sql = NULL;
+
+	return rc;
+}
+#endif
+
 int	DBinit(char **error)
 {
 	return zbx_db_init(CONFIG_DBNAME, db_schema, error);
@@ -482,6 +584,41 @@ DB_RESULT	DBselect(const char *fmt, ...)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement with parameters                        *
+ *                                                                            *
+ * Parameters: sql        - [IN] the statement text with $1..$N parameters    *
+ *             params_num - [IN] the number of parameters                     *
+ *             params     - [IN] the parameter values                         *
+ *                                                                            *
+ * Comments: Use for frequently executed statements which differ only by      *
+ *           numeric parameters - on PostgreSQL such statements are prepared  *
+ *           and parsed only once per connection.                             *
+ *                                                                            *
+ ******************************************************************************/
+DB_RESULT	DBselect_prepared(const char *sql, int params_num, const char *const *params)
+{
+	DB_RESULT	rc;
+
+	rc = zbx_db_select_prepared(sql, params_num, params);
+
+	while ((DB_RESULT)ZBX_DB_DOWN == rc)
+	{
+		DBclose();
+		DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+		if ((DB_RESULT)ZBX_DB_DOWN == (rc = zbx_db_select_prepared(sql, params_num, params)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement and get the first N entries            *
@@ -2740,7 +2877,8 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, const zbx_db_value_t **
 			case ZBX_TYPE_TEXT:
 			case ZBX_TYPE_SHORTTEXT:
 			case ZBX_TYPE_CUID:
-#ifdef HAVE_ORACLE
+#if defined(HAVE_ORACLE) || defined(HAVE_POSTGRESQL)
+				/* PostgreSQL strings are escaped when executing, depending on insert method */
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_OFF);
 #else
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
@@ -2821,6 +2959,263 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...)
 	zbx_vector_ptr_destroy(&values);
 }
 
+#ifdef HAVE_POSTGRESQL
+#define ZBX_DB_COPY_MIN_ROWS	16		/* use COPY statement for inserting at least this many rows */
+#define ZBX_DB_COPY_BUFFER_SIZE	ZBX_MEBIBYTE	/* the size of data sent with one COPY statement */
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: load rows into table with COPY statement                          *
+ *                                                                            *
+ * Parameters: sql      - [IN] the COPY FROM STDIN statement                  *
+ *             data     - [IN] the rows in COPY text format                   *
+ *             data_len - [IN] the data length                                *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or number of rows copied              *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBcopy_from(const char *sql, const char *data, size_t data_len)
+{
+	int	rc;
+
+	rc = zbx_db_copy_from(sql, data, data_len);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		DBclose();
+		DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_copy_from(sql, data, data_len)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append string to COPY text format data                            *
+ *                                                                            *
+ * Comments: Backslash and the characters used as column and row delimiters   *
+ *           must be escaped with backslash.                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_strcpy_alloc(char **data, size_t *data_alloc, size_t *data_offset, const char *str)
+{
+	const char	*ptr;
+
+	for (ptr = str; '\0' != *ptr; ptr++)
+	{
+		switch (*ptr)
+		{
+			case '\\':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\\\");
+				break;
+			case '\t':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\t");
+				break;
+			case '\n':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\n");
+				break;
+			case '\r':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\r");
+				break;
+			default:
+				zbx_chrcpy_alloc(data, data_alloc, data_offset, *ptr);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes the prepared database bulk insert operation with COPY    *
+ *          statement                                                         *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: Returns SUCCEED if the operation completed successfully or   *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ * Comments: COPY avoids building and parsing huge multi-row insert           *
+ *           statements. The rows are sent in text format, so the data does   *
+ *           not depend on exact column types in database schema.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_copy(zbx_db_insert_t *self)
+{
+	int		ret = SUCCEED, i, j;
+	const ZBX_FIELD	*field;
+	char		*sql = NULL, *data;
+	size_t		sql_alloc = 0, sql_offset = 0, data_alloc = ZBX_DB_COPY_BUFFER_SIZE, data_offset = 0;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "copy %s (", self->table->table);
+
+	for (i = 0; i < self->fields.values_num; i++)
+	{
+		field = (ZBX_FIELD *)self->fields.values[i];
+
+		if (0 != i)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, field->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin");
+
+	data = (char *)zbx_malloc(NULL, data_alloc);
+
+	for (i = 0; i < self->rows.values_num; i++)
+	{
+		zbx_db_value_t	*values = (zbx_db_value_t *)self->rows.values[i];
+
+		for (j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+
+			field = (const ZBX_FIELD *)self->fields.values[j];
+
+			if (0 != j)
+				zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\t');
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_SHORTTEXT:
+				case ZBX_TYPE_LONGTEXT:
+				case ZBX_TYPE_CUID:
+					db_copy_strcpy_alloc(&data, &data_alloc, &data_offset, value->str);
+					break;
+				case ZBX_TYPE_INT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_DBL64, value->dbl);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					if (0 == value->ui64)
+						zbx_strcpy_alloc(&data, &data_alloc, &data_offset, "\\N");
+					else
+						zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64,
+								value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+
+		zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\n');
+
+		if (ZBX_DB_COPY_BUFFER_SIZE < data_offset || i == self->rows.values_num - 1)
+		{
+			if (ZBX_DB_OK > DBcopy_from(sql, data, data_offset))
+			{
+				ret = FAIL;
+				break;
+			}
+
+			data_offset = 0;
+		}
+	}
+
+	zbx_free(data);
+	zbx_free(sql);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: formats the prepared database bulk insert operation as a single   *
+ *          multi-row insert statement                                        *
+ *                                                                            *
+ * Parameters: self       - [IN] the bulk insert data                         *
+ *             sql        - [IN/OUT] the sql buffer                           *
+ *             sql_alloc  - [IN/OUT] the sql buffer size                      *
+ *             sql_offset - [IN/OUT] the sql buffer offset                    *
+ *                                                                            *
+ * Comments: The statement is not terminated, so the caller can append        *
+ *           additional clauses. Auto increment fields are not supported.     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_insert_format_sql(const zbx_db_insert_t *self, char **sql, size_t *sql_alloc, size_t *sql_offset)
+{
+	int		i, j;
+	const ZBX_FIELD	*field;
+	char		*str_esc, delim[2] = {',', '('};
+
+	if (-1 != self->autoincrement)
+		THIS_SHOULD_NEVER_HAPPEN;
+
+	zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "insert into %s ", self->table->table);
+
+	for (i = 0; i < self->fields.values_num; i++)
+	{
+		field = (ZBX_FIELD *)self->fields.values[i];
+
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, delim[0 == i]);
+		zbx_strcpy_alloc(sql, sql_alloc, sql_offset, field->name);
+	}
+
+	zbx_strcpy_alloc(sql, sql_alloc, sql_offset, ") values ");
+
+	for (i = 0; i < self->rows.values_num; i++)
+	{
+		zbx_db_value_t	*values = (zbx_db_value_t *)self->rows.values[i];
+
+		if (0 != i)
+			zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ',');
+
+		for (j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+
+			field = (const ZBX_FIELD *)self->fields.values[j];
+
+			zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, delim[0 == j]);
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_SHORTTEXT:
+				case ZBX_TYPE_LONGTEXT:
+				case ZBX_TYPE_CUID:
+					str_esc = DBdyn_escape_string(value->str);
+					zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "'%s'", str_esc);
+					zbx_free(str_esc);
+					break;
+				case ZBX_TYPE_INT:
+					zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ZBX_FS_DBL64_SQL, value->dbl);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					zbx_strcpy_alloc(sql, sql_alloc, sql_offset, DBsql_id_ins(value->ui64));
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
+	}
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: executes the prepared database bulk insert operation              *
@@ -2830,6 +3225,8 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...)
  * Return value: Returns SUCCEED if the operation completed successfully or   *
  *               FAIL otherwise.                                              *
  *                                                                            *
+ * Comments: On PostgreSQL larger batches are loaded with COPY statement.     *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_db_insert_execute(zbx_db_insert_t *self)
 {
@@ -2846,6 +3243,9 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 	char		*sql_values = NULL;
 	size_t		sql_values_alloc = 0, sql_values_offset = 0;
 #	endif
+#	ifdef HAVE_POSTGRESQL
+	char		*str_esc;
+#	endif
 #else
 	zbx_db_bind_context_t	*contexts;
 	int			rc, tries = 0;
@@ -2869,6 +3269,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 		}
 	}
 
+#ifdef HAVE_POSTGRESQL
+	if (ZBX_DB_COPY_MIN_ROWS <= self->rows.values_num)
+		return db_insert_copy(self);
+#endif
+
 #ifndef HAVE_ORACLE
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 #endif
@@ -3004,7 +3409,13 @@ retry_oracle:
 				case ZBX_TYPE_LONGTEXT:
 				case ZBX_TYPE_CUID:
 					zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
+#	ifdef HAVE_POSTGRESQL
+					str_esc = DBdyn_escape_string(value->str);
+					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, str_esc);
+					zbx_free(str_esc);
+#	else
 					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value->str);
+#	endif
 					zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
 					break;
 				case ZBX_TYPE_INT:
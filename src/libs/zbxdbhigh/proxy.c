@@ -415,7 +415,7 @@ int	check_access_passive_proxy(zbx_socket_t *sock, int send_response, const char
 	}
 	else if (ZBX_TCP_SEC_TLS_PSK == sock->connection_type)
 	{
-		if (0 != (ZBX_PSK_FOR_PROXY & zbx_tls_get_psk_usage()))
+		if (0 != (ZBX_PSK_FOR_PROXY & zbx_tls_get_psk_usage(sock)))
 			return SUCCEED;
 
 		zabbix_log(LOG_LEVEL_WARNING, "%s from server \"%s\" is not allowed: it used PSK which is not"
@@ -3693,13 +3693,97 @@ static int	sender_item_validator(DC_ITEM *item, zbx_socket_t *sock, void *args,
 	return rights->value;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validates and processes a batch of item values identified by      *
+ *          host,key pairs                                                    *
+ *                                                                            *
+ * Parameters: sock           - [IN] the connection socket                    *
+ *             validator_func - [IN] the item validator callback function     *
+ *             validator_args - [IN] the user arguments passed to validator   *
+ *                                   function                                 *
+ *             token          - [IN] the data session token, can be NULL      *
+ *             items          - [IN] buffer for configuration cache items     *
+ *             hostkeys       - [IN] the host,key pairs of values             *
+ *             values         - [IN] the item values                          *
+ *             errcodes       - [IN] buffer for item error codes              *
+ *             values_num     - [IN] number of values                         *
+ *             last_hostid    - [IN/OUT] the host of the last data session    *
+ *             session        - [IN/OUT] the last data session                *
+ *                                                                            *
+ * Return value: the number of processed values                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_history_data_by_keys_batch(zbx_socket_t *sock, zbx_client_item_validator_t validator_func,
+		void *validator_args, const char *token, DC_ITEM *items, zbx_host_key_t *hostkeys,
+		zbx_agent_value_t *values, int *errcodes, int values_num, zbx_uint64_t *last_hostid,
+		zbx_data_session_t **session)
+{
+	int	i, processed_num;
+	char	*error = NULL;
+
+	DCconfig_get_items_by_keys(items, hostkeys, errcodes, values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot retrieve key \"%s\" on host \"%s\" from "
+					"configuration cache", hostkeys[i].key, hostkeys[i].host);
+			continue;
+		}
+
+		if (*last_hostid != items[i].host.hostid)
+		{
+			*last_hostid = items[i].host.hostid;
+
+			if (NULL != token)
+				*session = zbx_dc_get_or_create_data_session(*last_hostid, token);
+		}
+
+		/* check and discard if duplicate data */
+		if (NULL != *session && 0 != values[i].id && values[i].id <= (*session)->last_valueid)
+		{
+			DCconfig_clean_items(&items[i], &errcodes[i], 1);
+			errcodes[i] = FAIL;
+			continue;
+		}
+
+		if (SUCCEED != validator_func(&items[i], sock, validator_args, &error))
+		{
+			if (NULL != error)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "%s", error);
+				zbx_free(error);
+			}
+			else
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "unknown validation error for item \"%s\"",
+						(NULL == items[i].key) ? items[i].key_orig : items[i].key);
+			}
+
+			DCconfig_clean_items(&items[i], &errcodes[i], 1);
+			errcodes[i] = FAIL;
+		}
+
+		if (NULL != *session)
+			(*session)->last_valueid = values[i].id;
+	}
+
+	processed_num = process_history_data(items, values, errcodes, values_num, NULL);
+
+	DCconfig_clean_items(items, errcodes, values_num);
+	zbx_agent_values_clean(values, values_num);
+
+	return processed_num;
+}
+
 static void	process_history_data_by_keys(zbx_socket_t *sock, zbx_client_item_validator_t validator_func,
 		void *validator_args, char **info, struct zbx_json_parse *jp_data, const char *token)
 {
 	int			values_num, read_num, processed_num = 0, total_num = 0, i;
 	zbx_timespec_t		unique_shift = {0, 0};
 	const char		*pnext = NULL;
-	char			*error = NULL;
 	zbx_host_key_t		*hostkeys;
 	DC_ITEM			*items;
 	zbx_data_session_t	*session = NULL;
@@ -3717,60 +3801,10 @@ static void	process_history_data_by_keys(zbx_socket_t *sock, zbx_client_item_val
 	while (SUCCEED == parse_history_data(jp_data, &pnext, values, hostkeys, &values_num, &read_num,
 			&unique_shift) && 0 != values_num)
 	{
-		DCconfig_get_items_by_keys(items, hostkeys, errcodes, values_num);
-
-		for (i = 0; i < values_num; i++)
-		{
-			if (SUCCEED != errcodes[i])
-			{
-				zabbix_log(LOG_LEVEL_DEBUG, "cannot retrieve key \"%s\" on host \"%s\" from "
-						"configuration cache", hostkeys[i].key, hostkeys[i].host);
-				continue;
-			}
-
-			if (last_hostid != items[i].host.hostid)
-			{
-				last_hostid = items[i].host.hostid;
-
-				if (NULL != token)
-					session = zbx_dc_get_or_create_data_session(last_hostid, token);
-			}
-
-			/* check and discard if duplicate data */
-			if (NULL != session && 0 != values[i].id && values[i].id <= session->last_valueid)
-			{
-				DCconfig_clean_items(&items[i], &errcodes[i], 1);
-				errcodes[i] = FAIL;
-				continue;
-			}
-
-			if (SUCCEED != validator_func(&items[i], sock, validator_args, &error))
-			{
-				if (NULL != error)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "%s", error);
-					zbx_free(error);
-				}
-				else
-				{
-					zabbix_log(LOG_LEVEL_DEBUG, "unknown validation error for item \"%s\"",
-							(NULL == items[i].key) ? items[i].key_orig : items[i].key);
-				}
-
-				DCconfig_clean_items(&items[i], &errcodes[i], 1);
-				errcodes[i] = FAIL;
-			}
-
-			if (NULL != session)
-				session->last_valueid = values[i].id;
-		}
-
-		processed_num += process_history_data(items, values, errcodes, values_num, NULL);
+		processed_num += process_history_data_by_keys_batch(sock, validator_func, validator_args, token, items,
+				hostkeys, values, errcodes, values_num, &last_hostid, &session);
 		total_num += read_num;
 
-		DCconfig_clean_items(items, errcodes, values_num);
-		zbx_agent_values_clean(values, values_num);
-
 		if (NULL == pnext)
 			break;
 	}
@@ -3927,6 +3961,562 @@ int	process_sender_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, z
 	return ret;
 }
 
+#define ZBX_HISTORY_STREAM_HEADER	0
+#define ZBX_HISTORY_STREAM_DATA		1
+#define ZBX_HISTORY_STREAM_TRAILER	2
+#define ZBX_HISTORY_STREAM_DISABLED	3
+#define ZBX_HISTORY_STREAM_ERROR	4
+
+/* request fields are kept only for client time difference logging, ignore unexpectedly large ones */
+#define ZBX_HISTORY_STREAM_HEADER_MAX	(64 * ZBX_KIBIBYTE)
+
+/* incremental parser of agent/sender history data requests */
+struct zbx_history_stream
+{
+	zbx_socket_t			*sock;
+	zbx_timespec_t			ts;
+	unsigned char			state;
+	const char			*request;
+
+	/* request JSON without data array rows */
+	char				*header;
+	size_t				header_alloc;
+	size_t				header_offset;
+
+	char				*token;
+	zbx_client_item_validator_t	validator_func;
+	zbx_host_rights_t		rights;
+	unsigned char			user_macros;	/* validator uses user macros */
+
+	DC_ITEM				*items;
+	zbx_host_key_t			*hostkeys;
+	zbx_agent_value_t		*values;
+	int				*errcodes;
+	int				values_num;
+
+	zbx_data_session_t		*session;
+	zbx_uint64_t			last_hostid;
+	zbx_timespec_t			unique_shift;
+
+	int				processed_num;
+	int				total_num;
+	char				*error;
+	double				sec;
+};
+
+static const char	*history_stream_skip_whitespace(const char *p, const char *end)
+{
+	while (p < end && (' ' == *p || '\t' == *p || '\r' == *p || '\n' == *p))
+		p++;
+
+	return p;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds end of JSON value in partially received data                *
+ *                                                                            *
+ * Parameters: p   - [IN] the value start                                     *
+ *             end - [IN] the end of received data                            *
+ *                                                                            *
+ * Return value: pointer to the first character after the value or NULL if    *
+ *               the value is not received completely                         *
+ *                                                                            *
+ * Comments: Only the value boundaries are located, the value itself must be  *
+ *           validated with JSON parser.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*history_stream_value_end(const char *p, const char *end)
+{
+	int	level = 0;
+
+	for (; p < end; p++)
+	{
+		switch (*p)
+		{
+			case '"':
+				for (p++; p < end && '"' != *p; p++)
+				{
+					if ('\\' == *p && ++p == end)
+						return NULL;
+				}
+
+				if (p == end)
+					return NULL;
+
+				if (0 == level)
+					return p + 1;
+				break;
+			case '{':
+			case '[':
+				level++;
+				break;
+			case '}':
+			case ']':
+				if (0 == level)
+					return p;
+
+				if (0 == --level)
+					return p + 1;
+				break;
+			case ',':
+			case ' ':
+			case '\t':
+			case '\r':
+			case '\n':
+				if (0 == level)
+					return p;
+				break;
+		}
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes parsed values and releases them                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	history_stream_flush(zbx_history_stream_t *stream)
+{
+	zbx_dc_um_handle_t	*um_handle = NULL;
+
+	if (0 == stream->values_num)
+		return;
+
+	if (0 != stream->user_macros)
+		um_handle = zbx_dc_open_user_macros();
+
+	stream->processed_num += process_history_data_by_keys_batch(stream->sock, stream->validator_func,
+			&stream->rights, stream->token, stream->items, stream->hostkeys, stream->values,
+			stream->errcodes, stream->values_num, &stream->last_hostid, &stream->session);
+
+	if (NULL != um_handle)
+		zbx_dc_close_user_macros(um_handle);
+
+	stream->values_num = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks request fields preceding data array and prepares for       *
+ *          processing data rows                                              *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the history stream                           *
+ *             data   - [IN] the request data up to the data array            *
+ *             len    - [IN] the data length                                  *
+ *                                                                            *
+ * Comments: Requests that cannot be processed incrementally are left to the  *
+ *           regular processing after the whole request is received.          *
+ *                                                                            *
+ ******************************************************************************/
+static void	history_stream_start(zbx_history_stream_t *stream, const char *data, size_t len)
+{
+	struct zbx_json_parse	jp;
+	char			tmp[MAX_STRING_LEN], *header = NULL;
+	size_t			header_alloc = 0, header_offset = 0, token_alloc = 0;
+	int			version;
+
+	stream->state = ZBX_HISTORY_STREAM_DISABLED;
+
+	zbx_strncpy_alloc(&header, &header_alloc, &header_offset, data, len);
+	zbx_strcpy_alloc(&header, &header_alloc, &header_offset, "[]");
+
+	stream->header_offset = header_offset;
+	zbx_chrcpy_alloc(&header, &header_alloc, &header_offset, '}');
+
+	if (SUCCEED != zbx_json_open(header, &jp) ||
+			SUCCEED != zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_REQUEST, tmp, sizeof(tmp), NULL))
+	{
+		goto out;
+	}
+
+	if (0 == strcmp(tmp, ZBX_PROTO_VALUE_AGENT_DATA))
+	{
+		stream->request = ZBX_PROTO_VALUE_AGENT_DATA;
+		stream->validator_func = agent_item_validator;
+	}
+	else if (0 == strcmp(tmp, ZBX_PROTO_VALUE_SENDER_DATA))
+	{
+		stream->request = ZBX_PROTO_VALUE_SENDER_DATA;
+		stream->validator_func = sender_item_validator;
+		stream->user_macros = 1;
+	}
+	else
+		goto out;
+
+	/* values identified by item identifiers and invalid session tokens are handled by regular processing */
+	if (SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_VERSION, tmp, sizeof(tmp), NULL) &&
+			FAIL != (version = zbx_get_component_version(tmp)) &&
+			ZBX_COMPONENT_VERSION(4, 4) <= version &&
+			SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_HOST, tmp, sizeof(tmp), NULL))
+	{
+		goto out;
+	}
+
+	if (SUCCEED == zbx_json_value_by_name_dyn(&jp, ZBX_PROTO_TAG_SESSION, &stream->token, &token_alloc, NULL))
+	{
+		if (zbx_get_token_len() != strlen(stream->token))
+		{
+			zbx_free(stream->token);
+			goto out;
+		}
+	}
+	else if (ZBX_PROTO_VALUE_AGENT_DATA == stream->request)
+	{
+		/* session token sent after data (Zabbix agent 2) is not known before values are processed, */
+		/* so values could not be checked for duplicates                                            */
+		goto out;
+	}
+
+	stream->header = header;
+	stream->header_alloc = header_alloc;
+	header = NULL;
+
+	stream->items = (DC_ITEM *)zbx_malloc(NULL, sizeof(DC_ITEM) * ZBX_HISTORY_VALUES_MAX);
+	stream->hostkeys = (zbx_host_key_t *)zbx_malloc(NULL, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
+	memset(stream->hostkeys, 0, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
+	stream->values = (zbx_agent_value_t *)zbx_malloc(NULL, sizeof(zbx_agent_value_t) * ZBX_HISTORY_VALUES_MAX);
+	stream->errcodes = (int *)zbx_malloc(NULL, sizeof(int) * ZBX_HISTORY_VALUES_MAX);
+
+	stream->sec = zbx_time();
+	stream->state = ZBX_HISTORY_STREAM_DATA;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "processing \"%s\" request from \"%s\" incrementally", stream->request,
+			stream->sock->peer);
+out:
+	zbx_free(header);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses request fields up to the start of data array               *
+ *                                                                            *
+ * Return value: number of bytes consumed                                     *
+ *                                                                            *
+ * Comments: Nothing is consumed until the first data row is received, so     *
+ *           requests with rows not identified by host and key can be left to *
+ *           the regular processing.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	history_stream_parse_header(zbx_history_stream_t *stream, const char *data, size_t len)
+{
+	const char		*p, *end = data + len, *key, *row;
+	size_t			key_len;
+	struct zbx_json_parse	jp_row;
+
+	if ((p = history_stream_skip_whitespace(data, end)) == end)
+		return 0;
+
+	if ('{' != *p)
+	{
+		stream->state = ZBX_HISTORY_STREAM_DISABLED;
+		return 0;
+	}
+
+	for (p++;;)
+	{
+		if ((p = history_stream_skip_whitespace(p, end)) == end)
+			return 0;
+
+		if ('"' != *p)
+			break;
+
+		key = p + 1;
+
+		if (NULL == (p = history_stream_value_end(p, end)))
+			return 0;
+
+		key_len = (size_t)(p - key - 1);
+
+		if ((p = history_stream_skip_whitespace(p, end)) == end)
+			return 0;
+
+		if (':' != *p)
+			break;
+
+		if ((p = history_stream_skip_whitespace(p + 1, end)) == end)
+			return 0;
+
+		if (ZBX_CONST_STRLEN(ZBX_PROTO_TAG_DATA) == key_len &&
+				0 == strncmp(key, ZBX_PROTO_TAG_DATA, key_len))
+		{
+			if ('[' != *p)
+				break;
+
+			/* wait for the first row to check that values are identified by host and key */
+			if ((row = history_stream_skip_whitespace(p + 1, end)) == end ||
+					NULL == history_stream_value_end(row, end))
+			{
+				return 0;
+			}
+
+			if ('{' != *row || SUCCEED != zbx_json_brackets_open(row, &jp_row) ||
+					NULL == zbx_json_pair_by_name(&jp_row, ZBX_PROTO_TAG_HOST) ||
+					NULL == zbx_json_pair_by_name(&jp_row, ZBX_PROTO_TAG_KEY))
+			{
+				break;
+			}
+
+			history_stream_start(stream, data, (size_t)(p - data));
+
+			return ZBX_HISTORY_STREAM_DATA == stream->state ? (size_t)(p + 1 - data) : 0;
+		}
+
+		if (NULL == (p = history_stream_value_end(p, end)))
+			return 0;
+
+		if ((p = history_stream_skip_whitespace(p, end)) == end)
+			return 0;
+
+		if (',' != *p)
+			break;
+
+		p++;
+	}
+
+	stream->state = ZBX_HISTORY_STREAM_DISABLED;
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses complete data array rows and processes them in batches     *
+ *                                                                            *
+ * Return value: number of bytes consumed                                     *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	history_stream_parse_data(zbx_history_stream_t *stream, const char *data, size_t len)
+{
+	const char		*p = data, *end = data + len, *next;
+	struct zbx_json_parse	jp_row;
+	int			index;
+
+	for (;;)
+	{
+		if ((p = history_stream_skip_whitespace(p, end)) == end)
+			break;
+
+		if (',' == *p)
+		{
+			p++;
+			continue;
+		}
+
+		if (']' == *p)
+		{
+			stream->state = ZBX_HISTORY_STREAM_TRAILER;
+			return (size_t)(p + 1 - data);
+		}
+
+		if (NULL == (next = history_stream_value_end(p, end)))
+			break;
+
+		if ('{' != *p || FAIL == zbx_json_brackets_open(p, &jp_row))
+		{
+			stream->error = zbx_dsprintf(stream->error, "invalid history data row: %s",
+					'{' != *p ? "object expected" : zbx_json_strerror());
+			stream->state = ZBX_HISTORY_STREAM_ERROR;
+			return len;
+		}
+
+		p = next;
+		stream->total_num++;
+		index = stream->values_num;
+
+		if (SUCCEED != parse_history_data_row_hostkey(&jp_row, &stream->hostkeys[index]))
+			continue;
+
+		if (SUCCEED != parse_history_data_row_value(&jp_row, &stream->unique_shift, &stream->values[index]))
+			continue;
+
+		if (ZBX_HISTORY_VALUES_MAX == ++stream->values_num)
+			history_stream_flush(stream);
+	}
+
+	return (size_t)(p - data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates incremental parser for history data requests              *
+ *                                                                            *
+ * Parameters: sock - [IN] the connection socket                              *
+ *             ts   - [IN] the connection timestamp                           *
+ *                                                                            *
+ * Return value: the history stream, must be freed with                       *
+ *               zbx_history_stream_free()                                    *
+ *                                                                            *
+ ******************************************************************************/
+zbx_history_stream_t	*zbx_history_stream_create(zbx_socket_t *sock, const zbx_timespec_t *ts)
+{
+	zbx_history_stream_t	*stream;
+
+	stream = (zbx_history_stream_t *)zbx_malloc(NULL, sizeof(zbx_history_stream_t));
+	memset(stream, 0, sizeof(zbx_history_stream_t));
+
+	stream->sock = sock;
+	stream->ts = *ts;
+	stream->state = ZBX_HISTORY_STREAM_HEADER;
+
+	return stream;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses next part of received request                              *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the history stream                           *
+ *             data   - [IN] the received data not consumed yet               *
+ *             len    - [IN] the data length                                  *
+ *             last   - [IN] 1 - the rest of request is received, 0 - more    *
+ *                           data will follow                                 *
+ *                                                                            *
+ * Return value: number of bytes consumed                                     *
+ *                                                                            *
+ * Comments: Nothing is consumed from requests that cannot be parsed          *
+ *           incrementally, so they are received completely and must be       *
+ *           processed by regular means.                                      *
+ *                                                                            *
+ ******************************************************************************/
+size_t	zbx_history_stream_parse(zbx_history_stream_t *stream, const char *data, size_t len, int last)
+{
+	size_t	consumed = 0;
+
+	if (ZBX_HISTORY_STREAM_HEADER == stream->state)
+		consumed = history_stream_parse_header(stream, data, len);
+
+	if (ZBX_HISTORY_STREAM_DATA == stream->state)
+	{
+		consumed += history_stream_parse_data(stream, data + consumed, len - consumed);
+
+		if (0 != last && ZBX_HISTORY_STREAM_DATA == stream->state)
+		{
+			stream->error = zbx_strdup(stream->error, "unexpected end of history data");
+			stream->state = ZBX_HISTORY_STREAM_ERROR;
+		}
+	}
+
+	switch (stream->state)
+	{
+		case ZBX_HISTORY_STREAM_TRAILER:
+			if (ZBX_HISTORY_STREAM_HEADER_MAX >= stream->header_offset + len - consumed)
+			{
+				zbx_strncpy_alloc(&stream->header, &stream->header_alloc, &stream->header_offset,
+						data + consumed, len - consumed);
+			}
+			ZBX_FALLTHROUGH;
+		case ZBX_HISTORY_STREAM_ERROR:
+			consumed = len;
+			break;
+	}
+
+	return consumed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if request is being processed incrementally                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_history_stream_started(const zbx_history_stream_t *stream)
+{
+	switch (stream->state)
+	{
+		case ZBX_HISTORY_STREAM_DATA:
+		case ZBX_HISTORY_STREAM_TRAILER:
+		case ZBX_HISTORY_STREAM_ERROR:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns request type of incrementally processed request           *
+ *                                                                            *
+ ******************************************************************************/
+const char	*zbx_history_stream_request(const zbx_history_stream_t *stream)
+{
+	return stream->request;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes remaining values of fully received request              *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the history stream                           *
+ *             info   - [OUT] address of a pointer to the info string         *
+ *                            (should be freed by the caller)                 *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL - an error occurred                                    *
+ *                                                                            *
+ * Comments: Values are processed in batches while the request is received,   *
+ *           so batches preceding an invalid row are not rolled back. The     *
+ *           number of such values is reported in the error message. Values   *
+ *           of a request whose connection is lost before it is received      *
+ *           completely are kept in the same way.                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_history_stream_finish(zbx_history_stream_t *stream, char **info)
+{
+	struct zbx_json_parse	jp;
+
+	if (ZBX_HISTORY_STREAM_ERROR == stream->state)
+	{
+		zbx_agent_values_clean(stream->values, stream->values_num);
+		stream->values_num = 0;
+		*info = zbx_dsprintf(*info, "%s; processed before the error: %d", stream->error,
+				stream->processed_num);
+
+		return FAIL;
+	}
+
+	history_stream_flush(stream);
+
+	if (SUCCEED == zbx_json_open(stream->header, &jp))
+		log_client_timediff(LOG_LEVEL_DEBUG, &jp, &stream->ts);
+
+	*info = zbx_dsprintf(*info, "processed: %d; failed: %d; total: %d; seconds spent: " ZBX_FS_DBL,
+			stream->processed_num, stream->total_num - stream->processed_num, stream->total_num,
+			zbx_time() - stream->sec);
+
+	return SUCCEED;
+}
+
+void	zbx_history_stream_free(zbx_history_stream_t *stream)
+{
+	int	i;
+
+	if (NULL != stream->hostkeys)
+	{
+		for (i = 0; i < ZBX_HISTORY_VALUES_MAX; i++)
+		{
+			zbx_free(stream->hostkeys[i].host);
+			zbx_free(stream->hostkeys[i].key);
+		}
+
+		zbx_free(stream->hostkeys);
+	}
+
+	if (NULL != stream->values)
+	{
+		zbx_agent_values_clean(stream->values, stream->values_num);
+		zbx_free(stream->values);
+	}
+
+	zbx_free(stream->items);
+	zbx_free(stream->errcodes);
+	zbx_free(stream->header);
+	zbx_free(stream->token);
+	zbx_free(stream->error);
+	zbx_free(stream);
+}
+
 static void	zbx_drule_ip_free(zbx_drule_ip_t *ip)
 {
 	zbx_vector_ptr_clear_ext(&ip->services, zbx_ptr_free);
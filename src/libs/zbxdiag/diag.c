@@ -34,6 +34,7 @@
 #define ZBX_DIAG_HISTORYCACHE_VALUES		0x00000002
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_DATA	0x00000004
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX	0x00000008
+#define ZBX_DIAG_HISTORYCACHE_STORAGE		0x00000010
 
 #define ZBX_DIAG_HISTORYCACHE_SIMPLE	(ZBX_DIAG_HISTORYCACHE_ITEMS | \
 					ZBX_DIAG_HISTORYCACHE_VALUES)
@@ -262,12 +263,14 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 	double			time1, time2, time_total = 0;
 	zbx_uint64_t		fields;
 	zbx_diag_map_t		field_map[] = {
-					{"", ZBX_DIAG_HISTORYCACHE_SIMPLE | ZBX_DIAG_HISTORYCACHE_MEMORY},
+					{"", ZBX_DIAG_HISTORYCACHE_SIMPLE | ZBX_DIAG_HISTORYCACHE_MEMORY |
+							ZBX_DIAG_HISTORYCACHE_STORAGE},
 					{"items", ZBX_DIAG_HISTORYCACHE_ITEMS},
 					{"values", ZBX_DIAG_HISTORYCACHE_VALUES},
 					{"memory", ZBX_DIAG_HISTORYCACHE_MEMORY},
 					{"memory.data", ZBX_DIAG_HISTORYCACHE_MEMORY_DATA},
 					{"memory.index", ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX},
+					{"storage", ZBX_DIAG_HISTORYCACHE_STORAGE},
 					{NULL, 0}
 					};
 
@@ -312,6 +315,25 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 			zbx_json_close(json);
 		}
 
+		if (0 != (fields & ZBX_DIAG_HISTORYCACHE_STORAGE))
+		{
+			zbx_hc_storage_stats_t	storage;
+
+			time1 = zbx_time();
+			zbx_hc_get_storage_stats(&storage);
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			zbx_json_addobject(json, "storage");
+			zbx_json_adduint64(json, "flushes", storage.flushes);
+			zbx_json_adduint64(json, "requests", storage.requests);
+			zbx_json_adduint64(json, "bytes", storage.bytes);
+			zbx_json_adduint64(json, "bytes.sent", storage.bytes_sent);
+			zbx_json_addfloat(json, "time", storage.time);
+			zbx_json_addfloat(json, "time.max", storage.time_max);
+			zbx_json_close(json);
+		}
+
 		if (0 != tops.values_num)
 		{
 			zbx_json_addobject(json, "top");
@@ -786,7 +808,8 @@ static void	diag_log_top_view(struct zbx_json_parse *jp, const char *field, cons
  ******************************************************************************/
 static void	diag_log_history_cache(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
 {
-	char	*msg = NULL;
+	char			*msg = NULL;
+	struct zbx_json_parse	jp_storage;
 
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "== history cache diagnostic information ==");
 
@@ -797,6 +820,13 @@ static void	diag_log_history_cache(struct zbx_json_parse *jp, char **out, size_t
 	diag_log_memory_info(jp, "memory.data", "$.memory.data", out, out_alloc, out_offset);
 	diag_log_memory_info(jp, "memory.index", "$.memory.index", out, out_alloc, out_offset);
 
+	if (SUCCEED == zbx_json_open_path(jp, "$.storage", &jp_storage))
+	{
+		diag_get_simple_values(&jp_storage, &msg);
+		zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "storage: %s", msg);
+		zbx_free(msg);
+	}
+
 	diag_log_top_view(jp, "top.values", "$.top.values", out, out_alloc, out_offset);
 
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
@@ -48,6 +48,84 @@ typedef enum
 }
 zbx_function_trim_optype_t;
 
+/* built-in common functions */
+typedef enum
+{
+	FUNCTION_ID_UNKNOWN = 0,
+	FUNCTION_ID_MIN,
+	FUNCTION_ID_MAX,
+	FUNCTION_ID_SUM,
+	FUNCTION_ID_AVG,
+	FUNCTION_ID_ABS,
+	FUNCTION_ID_LENGTH,
+	FUNCTION_ID_DATE,
+	FUNCTION_ID_TIME,
+	FUNCTION_ID_NOW,
+	FUNCTION_ID_DAYOFWEEK,
+	FUNCTION_ID_DAYOFMONTH,
+	FUNCTION_ID_BITAND,
+	FUNCTION_ID_BITOR,
+	FUNCTION_ID_BITXOR,
+	FUNCTION_ID_BITLSHIFT,
+	FUNCTION_ID_BITRSHIFT,
+	FUNCTION_ID_BITNOT,
+	FUNCTION_ID_BETWEEN,
+	FUNCTION_ID_IN,
+	FUNCTION_ID_ASCII,
+	FUNCTION_ID_CHAR,
+	FUNCTION_ID_LEFT,
+	FUNCTION_ID_RIGHT,
+	FUNCTION_ID_MID,
+	FUNCTION_ID_BITLENGTH,
+	FUNCTION_ID_BYTELENGTH,
+	FUNCTION_ID_CONCAT,
+	FUNCTION_ID_INSERT,
+	FUNCTION_ID_REPLACE,
+	FUNCTION_ID_REPEAT,
+	FUNCTION_ID_LTRIM,
+	FUNCTION_ID_RTRIM,
+	FUNCTION_ID_TRIM,
+	FUNCTION_ID_CBRT,
+	FUNCTION_ID_CEIL,
+	FUNCTION_ID_EXP,
+	FUNCTION_ID_EXPM1,
+	FUNCTION_ID_FLOOR,
+	FUNCTION_ID_SIGNUM,
+	FUNCTION_ID_DEGREES,
+	FUNCTION_ID_RADIANS,
+	FUNCTION_ID_ACOS,
+	FUNCTION_ID_ASIN,
+	FUNCTION_ID_ATAN,
+	FUNCTION_ID_COS,
+	FUNCTION_ID_COSH,
+	FUNCTION_ID_COT,
+	FUNCTION_ID_SIN,
+	FUNCTION_ID_SINH,
+	FUNCTION_ID_TAN,
+	FUNCTION_ID_LOG,
+	FUNCTION_ID_LOG10,
+	FUNCTION_ID_SQRT,
+	FUNCTION_ID_POWER,
+	FUNCTION_ID_ROUND,
+	FUNCTION_ID_MOD,
+	FUNCTION_ID_TRUNCATE,
+	FUNCTION_ID_ATAN2,
+	FUNCTION_ID_PI,
+	FUNCTION_ID_E,
+	FUNCTION_ID_RAND,
+	FUNCTION_ID_KURTOSIS,
+	FUNCTION_ID_MAD,
+	FUNCTION_ID_SKEWNESS,
+	FUNCTION_ID_STDDEVPOP,
+	FUNCTION_ID_STDDEVSAMP,
+	FUNCTION_ID_SUMOFSQUARES,
+	FUNCTION_ID_VARPOP,
+	FUNCTION_ID_VARSAMP,
+	FUNCTION_ID_COUNT,
+	FUNCTION_ID_HISTOGRAM_QUANTILE
+}
+zbx_function_id_t;
+
 /******************************************************************************
  *                                                                            *
  * Purpose: convert variant string value containing suffixed number to        *
@@ -429,6 +507,30 @@ int	 eval_suffixed_number_parse(const char *value, char *suffix)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: convert numeric constant token to its value                       *
+ *                                                                            *
+ * Parameters: ctx   - [IN] the evaluation context                            *
+ *             token - [IN] the numeric constant token                        *
+ *             value - [OUT] the numeric value                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_parse_number(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token, zbx_variant_t *value)
+{
+	zbx_uint64_t	ui64;
+
+	if (SUCCEED == is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1, &ui64))
+	{
+		zbx_variant_set_ui64(value, ui64);
+	}
+	else
+	{
+		zbx_variant_set_dbl(value, atof(ctx->expression + token->loc.l) *
+				suffix2factor(ctx->expression[token->loc.r]));
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: push value in output stack                                        *
@@ -452,20 +554,7 @@ static int	eval_execute_push_value(const zbx_eval_context_t *ctx, const zbx_eval
 	if (ZBX_VARIANT_NONE == token->value.type)
 	{
 		if (ZBX_EVAL_TOKEN_VAR_NUM == token->type)
-		{
-			zbx_uint64_t	ui64;
-
-			if (SUCCEED == is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1,
-					&ui64))
-			{
-				zbx_variant_set_ui64(&value, ui64);
-			}
-			else
-			{
-				zbx_variant_set_dbl(&value, atof(ctx->expression + token->loc.l) *
-						suffix2factor(ctx->expression[token->loc.r]));
-			}
-		}
+			eval_parse_number(ctx, token, &value);
 		else
 		{
 			dst = zbx_malloc(NULL, token->loc.r - token->loc.l + 2);
@@ -2640,6 +2729,128 @@ static int	eval_execute_function_count(const zbx_eval_context_t *ctx, const zbx_
 	return SUCCEED;
 }
 
+typedef struct
+{
+	const char		*name;
+	zbx_function_id_t	id;
+}
+zbx_function_def_t;
+
+/* common function names, sorted for binary search */
+static const zbx_function_def_t	eval_functions[] = {
+	{"abs", FUNCTION_ID_ABS},
+	{"acos", FUNCTION_ID_ACOS},
+	{"ascii", FUNCTION_ID_ASCII},
+	{"asin", FUNCTION_ID_ASIN},
+	{"atan", FUNCTION_ID_ATAN},
+	{"atan2", FUNCTION_ID_ATAN2},
+	{"avg", FUNCTION_ID_AVG},
+	{"between", FUNCTION_ID_BETWEEN},
+	{"bitand", FUNCTION_ID_BITAND},
+	{"bitlength", FUNCTION_ID_BITLENGTH},
+	{"bitlshift", FUNCTION_ID_BITLSHIFT},
+	{"bitnot", FUNCTION_ID_BITNOT},
+	{"bitor", FUNCTION_ID_BITOR},
+	{"bitrshift", FUNCTION_ID_BITRSHIFT},
+	{"bitxor", FUNCTION_ID_BITXOR},
+	{"bytelength", FUNCTION_ID_BYTELENGTH},
+	{"cbrt", FUNCTION_ID_CBRT},
+	{"ceil", FUNCTION_ID_CEIL},
+	{"char", FUNCTION_ID_CHAR},
+	{"concat", FUNCTION_ID_CONCAT},
+	{"cos", FUNCTION_ID_COS},
+	{"cosh", FUNCTION_ID_COSH},
+	{"cot", FUNCTION_ID_COT},
+	{"count", FUNCTION_ID_COUNT},
+	{"date", FUNCTION_ID_DATE},
+	{"dayofmonth", FUNCTION_ID_DAYOFMONTH},
+	{"dayofweek", FUNCTION_ID_DAYOFWEEK},
+	{"degrees", FUNCTION_ID_DEGREES},
+	{"e", FUNCTION_ID_E},
+	{"exp", FUNCTION_ID_EXP},
+	{"expm1", FUNCTION_ID_EXPM1},
+	{"floor", FUNCTION_ID_FLOOR},
+	{"histogram_quantile", FUNCTION_ID_HISTOGRAM_QUANTILE},
+	{"in", FUNCTION_ID_IN},
+	{"insert", FUNCTION_ID_INSERT},
+	{"kurtosis", FUNCTION_ID_KURTOSIS},
+	{"left", FUNCTION_ID_LEFT},
+	{"length", FUNCTION_ID_LENGTH},
+	{"log", FUNCTION_ID_LOG},
+	{"log10", FUNCTION_ID_LOG10},
+	{"ltrim", FUNCTION_ID_LTRIM},
+	{"mad", FUNCTION_ID_MAD},
+	{"max", FUNCTION_ID_MAX},
+	{"mid", FUNCTION_ID_MID},
+	{"min", FUNCTION_ID_MIN},
+	{"mod", FUNCTION_ID_MOD},
+	{"now", FUNCTION_ID_NOW},
+	{"pi", FUNCTION_ID_PI},
+	{"power", FUNCTION_ID_POWER},
+	{"radians", FUNCTION_ID_RADIANS},
+	{"rand", FUNCTION_ID_RAND},
+	{"repeat", FUNCTION_ID_REPEAT},
+	{"replace", FUNCTION_ID_REPLACE},
+	{"right", FUNCTION_ID_RIGHT},
+	{"round", FUNCTION_ID_ROUND},
+	{"rtrim", FUNCTION_ID_RTRIM},
+	{"signum", FUNCTION_ID_SIGNUM},
+	{"sin", FUNCTION_ID_SIN},
+	{"sinh", FUNCTION_ID_SINH},
+	{"skewness", FUNCTION_ID_SKEWNESS},
+	{"sqrt", FUNCTION_ID_SQRT},
+	{"stddevpop", FUNCTION_ID_STDDEVPOP},
+	{"stddevsamp", FUNCTION_ID_STDDEVSAMP},
+	{"sum", FUNCTION_ID_SUM},
+	{"sumofsquares", FUNCTION_ID_SUMOFSQUARES},
+	{"tan", FUNCTION_ID_TAN},
+	{"time", FUNCTION_ID_TIME},
+	{"trim", FUNCTION_ID_TRIM},
+	{"truncate", FUNCTION_ID_TRUNCATE},
+	{"varpop", FUNCTION_ID_VARPOP},
+	{"varsamp", FUNCTION_ID_VARSAMP},
+};
+
+static int	eval_compare_function_def(const void *d1, const void *d2)
+{
+	const char			*name = (const char *)d1;
+	const zbx_function_def_t	*def = (const zbx_function_def_t *)d2;
+
+	return strcmp(name, def->name);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find common function identifier by its name                      *
+ *                                                                            *
+ * Parameters: ctx   - [IN] the evaluation context                            *
+ *             token - [IN] the function token                                *
+ *                                                                            *
+ * Return value: The function identifier or FUNCTION_ID_UNKNOWN if the        *
+ *               function is not a built-in function.                         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_function_id_t	eval_get_function_id(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token)
+{
+	char				name[32];
+	size_t				len;
+	const zbx_function_def_t	*def;
+
+	if (sizeof(name) <= (len = token->loc.r - token->loc.l + 1))
+		return FUNCTION_ID_UNKNOWN;
+
+	memcpy(name, ctx->expression + token->loc.l, len);
+	name[len] = '\0';
+
+	if (NULL == (def = (const zbx_function_def_t *)bsearch(name, eval_functions, ARRSIZE(eval_functions),
+			sizeof(zbx_function_def_t), eval_compare_function_def)))
+	{
+		return FUNCTION_ID_UNKNOWN;
+	}
+
+	return def->id;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate common function                                          *
@@ -2656,6 +2867,8 @@ static int	eval_execute_function_count(const zbx_eval_context_t *ctx, const zbx_
 static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
 		zbx_vector_var_t *output, char **error)
 {
+	zbx_function_id_t	function_id;
+
 	if ((zbx_uint32_t)output->values_num < token->opt)
 	{
 		*error = zbx_dsprintf(*error, "not enough arguments for function at \"%s\"",
@@ -2663,148 +2876,162 @@ static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx
 		return FAIL;
 	}
 
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "min", ZBX_CONST_STRLEN("min")))
-		return eval_execute_function_min(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "max", ZBX_CONST_STRLEN("max")))
-		return eval_execute_function_max(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sum", ZBX_CONST_STRLEN("sum")))
-		return eval_execute_function_sum(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "avg", ZBX_CONST_STRLEN("avg")))
-		return eval_execute_function_avg(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "abs", ZBX_CONST_STRLEN("abs")))
-		return eval_execute_function_abs(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "length", ZBX_CONST_STRLEN("length")))
-		return eval_execute_function_length(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "date", ZBX_CONST_STRLEN("date")))
-		return eval_execute_function_date(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "time", ZBX_CONST_STRLEN("time")))
-		return eval_execute_function_time(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "now", ZBX_CONST_STRLEN("now")))
-		return eval_execute_function_now(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "dayofweek", ZBX_CONST_STRLEN("dayofweek")))
-		return eval_execute_function_dayofweek(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "dayofmonth", ZBX_CONST_STRLEN("dayofmonth")))
-		return eval_execute_function_dayofmonth(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitand", ZBX_CONST_STRLEN("bitand")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_AND, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitor", ZBX_CONST_STRLEN("bitor")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_OR, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitxor", ZBX_CONST_STRLEN("bitxor")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_XOR, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitlshift", ZBX_CONST_STRLEN("bitlshift")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_LSHIFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitrshift", ZBX_CONST_STRLEN("bitrshift")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_RSHIFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitnot", ZBX_CONST_STRLEN("bitnot")))
-		return eval_execute_function_bitnot(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "between", ZBX_CONST_STRLEN("between")))
-		return eval_execute_function_between(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "in", ZBX_CONST_STRLEN("in")))
-		return eval_execute_function_in(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ascii", ZBX_CONST_STRLEN("ascii")))
-		return eval_execute_function_ascii(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "char", ZBX_CONST_STRLEN("char")))
-		return eval_execute_function_char(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "left", ZBX_CONST_STRLEN("left")))
-		return eval_execute_function_left(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "right", ZBX_CONST_STRLEN("right")))
-		return eval_execute_function_right(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mid", ZBX_CONST_STRLEN("mid")))
-		return eval_execute_function_mid(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitlength", ZBX_CONST_STRLEN("bitlength")))
-		return eval_execute_function_bitlength(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bytelength", ZBX_CONST_STRLEN("bytelength")))
-		return eval_execute_function_bytelength(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "concat", ZBX_CONST_STRLEN("concat")))
-		return eval_execute_function_concat(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "insert", ZBX_CONST_STRLEN("insert")))
-		return eval_execute_function_insert(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "replace", ZBX_CONST_STRLEN("replace")))
-		return eval_execute_function_replace(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "repeat", ZBX_CONST_STRLEN("repeat")))
-		return eval_execute_function_repeat(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ltrim", ZBX_CONST_STRLEN("ltrim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_LEFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "rtrim", ZBX_CONST_STRLEN("rtrim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_RIGHT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "trim", ZBX_CONST_STRLEN("trim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_ALL, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cbrt", ZBX_CONST_STRLEN("cbrt")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cbrt);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ceil", ZBX_CONST_STRLEN("ceil")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, ceil);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "exp", ZBX_CONST_STRLEN("exp")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, exp);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "expm1", ZBX_CONST_STRLEN("expm1")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, expm1);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "floor", ZBX_CONST_STRLEN("floor")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, floor);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "signum", ZBX_CONST_STRLEN("signum")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_signum);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "degrees", ZBX_CONST_STRLEN("degrees")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_degrees);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "radians", ZBX_CONST_STRLEN("radians")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_radians);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "acos", ZBX_CONST_STRLEN("acos")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, acos);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "asin", ZBX_CONST_STRLEN("asin")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, asin);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "atan", ZBX_CONST_STRLEN("atan")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, atan);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cos", ZBX_CONST_STRLEN("cos")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cos);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cosh", ZBX_CONST_STRLEN("cosh")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cosh);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cot", ZBX_CONST_STRLEN("cot")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_cot);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sin", ZBX_CONST_STRLEN("sin")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sin);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sinh", ZBX_CONST_STRLEN("sinh")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sinh);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "tan", ZBX_CONST_STRLEN("tan")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, tan);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "log", ZBX_CONST_STRLEN("log")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, log);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "log10", ZBX_CONST_STRLEN("log10")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, log10);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sqrt", ZBX_CONST_STRLEN("sqrt")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sqrt);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "power", ZBX_CONST_STRLEN("power")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, pow);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "round", ZBX_CONST_STRLEN("round")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_round);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mod", ZBX_CONST_STRLEN("mod")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, fmod);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "truncate", ZBX_CONST_STRLEN("truncate")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_truncate);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "atan2", ZBX_CONST_STRLEN("atan2")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, atan2);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "pi", ZBX_CONST_STRLEN("pi")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_PI);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "e", ZBX_CONST_STRLEN("e")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_E);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "rand", ZBX_CONST_STRLEN("rand")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_RANDOM);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "kurtosis", ZBX_CONST_STRLEN("kurtosis")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_kurtosis, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mad", ZBX_CONST_STRLEN("mad")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_mad, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "skewness", ZBX_CONST_STRLEN("skewness")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_skewness, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "stddevpop", ZBX_CONST_STRLEN("stddevpop")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevpop, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "stddevsamp", ZBX_CONST_STRLEN("stddevsamp")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevsamp, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sumofsquares", ZBX_CONST_STRLEN("sumofsquares")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_sumofsquares, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "varpop", ZBX_CONST_STRLEN("varpop")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varpop, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "varsamp", ZBX_CONST_STRLEN("varsamp")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varsamp, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "count", ZBX_CONST_STRLEN("count")))
-		return eval_execute_function_count(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "histogram_quantile", ZBX_CONST_STRLEN("histogram_quantile")))
-		return eval_execute_function_histogram_quantile(ctx, token, output, error);
+	if (ZBX_VARIANT_UI64 == token->value.type)
+		function_id = (zbx_function_id_t)token->value.data.ui64;
+	else
+		function_id = eval_get_function_id(ctx, token);
+
+	switch (function_id)
+	{
+		case FUNCTION_ID_MIN:
+			return eval_execute_function_min(ctx, token, output, error);
+		case FUNCTION_ID_MAX:
+			return eval_execute_function_max(ctx, token, output, error);
+		case FUNCTION_ID_SUM:
+			return eval_execute_function_sum(ctx, token, output, error);
+		case FUNCTION_ID_AVG:
+			return eval_execute_function_avg(ctx, token, output, error);
+		case FUNCTION_ID_ABS:
+			return eval_execute_function_abs(ctx, token, output, error);
+		case FUNCTION_ID_LENGTH:
+			return eval_execute_function_length(ctx, token, output, error);
+		case FUNCTION_ID_DATE:
+			return eval_execute_function_date(ctx, token, output, error);
+		case FUNCTION_ID_TIME:
+			return eval_execute_function_time(ctx, token, output, error);
+		case FUNCTION_ID_NOW:
+			return eval_execute_function_now(ctx, token, output, error);
+		case FUNCTION_ID_DAYOFWEEK:
+			return eval_execute_function_dayofweek(ctx, token, output, error);
+		case FUNCTION_ID_DAYOFMONTH:
+			return eval_execute_function_dayofmonth(ctx, token, output, error);
+		case FUNCTION_ID_BITAND:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_AND, output, error);
+		case FUNCTION_ID_BITOR:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_OR, output, error);
+		case FUNCTION_ID_BITXOR:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_XOR, output, error);
+		case FUNCTION_ID_BITLSHIFT:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_LSHIFT, output, error);
+		case FUNCTION_ID_BITRSHIFT:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_RSHIFT, output, error);
+		case FUNCTION_ID_BITNOT:
+			return eval_execute_function_bitnot(ctx, token, output, error);
+		case FUNCTION_ID_BETWEEN:
+			return eval_execute_function_between(ctx, token, output, error);
+		case FUNCTION_ID_IN:
+			return eval_execute_function_in(ctx, token, output, error);
+		case FUNCTION_ID_ASCII:
+			return eval_execute_function_ascii(ctx, token, output, error);
+		case FUNCTION_ID_CHAR:
+			return eval_execute_function_char(ctx, token, output, error);
+		case FUNCTION_ID_LEFT:
+			return eval_execute_function_left(ctx, token, output, error);
+		case FUNCTION_ID_RIGHT:
+			return eval_execute_function_right(ctx, token, output, error);
+		case FUNCTION_ID_MID:
+			return eval_execute_function_mid(ctx, token, output, error);
+		case FUNCTION_ID_BITLENGTH:
+			return eval_execute_function_bitlength(ctx, token, output, error);
+		case FUNCTION_ID_BYTELENGTH:
+			return eval_execute_function_bytelength(ctx, token, output, error);
+		case FUNCTION_ID_CONCAT:
+			return eval_execute_function_concat(ctx, token, output, error);
+		case FUNCTION_ID_INSERT:
+			return eval_execute_function_insert(ctx, token, output, error);
+		case FUNCTION_ID_REPLACE:
+			return eval_execute_function_replace(ctx, token, output, error);
+		case FUNCTION_ID_REPEAT:
+			return eval_execute_function_repeat(ctx, token, output, error);
+		case FUNCTION_ID_LTRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_LEFT, output, error);
+		case FUNCTION_ID_RTRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_RIGHT, output, error);
+		case FUNCTION_ID_TRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_ALL, output, error);
+		case FUNCTION_ID_CBRT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cbrt);
+		case FUNCTION_ID_CEIL:
+			return eval_execute_math_function_single_param(ctx, token, output, error, ceil);
+		case FUNCTION_ID_EXP:
+			return eval_execute_math_function_single_param(ctx, token, output, error, exp);
+		case FUNCTION_ID_EXPM1:
+			return eval_execute_math_function_single_param(ctx, token, output, error, expm1);
+		case FUNCTION_ID_FLOOR:
+			return eval_execute_math_function_single_param(ctx, token, output, error, floor);
+		case FUNCTION_ID_SIGNUM:
+			return eval_execute_math_function_single_param(ctx, token, output, error,
+					eval_math_func_signum);
+		case FUNCTION_ID_DEGREES:
+			return eval_execute_math_function_single_param(ctx, token, output, error,
+					eval_math_func_degrees);
+		case FUNCTION_ID_RADIANS:
+			return eval_execute_math_function_single_param(ctx, token, output, error,
+					eval_math_func_radians);
+		case FUNCTION_ID_ACOS:
+			return eval_execute_math_function_single_param(ctx, token, output, error, acos);
+		case FUNCTION_ID_ASIN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, asin);
+		case FUNCTION_ID_ATAN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, atan);
+		case FUNCTION_ID_COS:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cos);
+		case FUNCTION_ID_COSH:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cosh);
+		case FUNCTION_ID_COT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_cot);
+		case FUNCTION_ID_SIN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sin);
+		case FUNCTION_ID_SINH:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sinh);
+		case FUNCTION_ID_TAN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, tan);
+		case FUNCTION_ID_LOG:
+			return eval_execute_math_function_single_param(ctx, token, output, error, log);
+		case FUNCTION_ID_LOG10:
+			return eval_execute_math_function_single_param(ctx, token, output, error, log10);
+		case FUNCTION_ID_SQRT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sqrt);
+		case FUNCTION_ID_POWER:
+			return eval_execute_math_function_double_param(ctx, token, output, error, pow);
+		case FUNCTION_ID_ROUND:
+			return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_round);
+		case FUNCTION_ID_MOD:
+			return eval_execute_math_function_double_param(ctx, token, output, error, fmod);
+		case FUNCTION_ID_TRUNCATE:
+			return eval_execute_math_function_double_param(ctx, token, output, error,
+					eval_math_func_truncate);
+		case FUNCTION_ID_ATAN2:
+			return eval_execute_math_function_double_param(ctx, token, output, error, atan2);
+		case FUNCTION_ID_PI:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_PI);
+		case FUNCTION_ID_E:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_E);
+		case FUNCTION_ID_RAND:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_RANDOM);
+		case FUNCTION_ID_KURTOSIS:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_kurtosis, output, error);
+		case FUNCTION_ID_MAD:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_mad, output, error);
+		case FUNCTION_ID_SKEWNESS:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_skewness, output, error);
+		case FUNCTION_ID_STDDEVPOP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevpop, output, error);
+		case FUNCTION_ID_STDDEVSAMP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevsamp, output, error);
+		case FUNCTION_ID_SUMOFSQUARES:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_sumofsquares, output, error);
+		case FUNCTION_ID_VARPOP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varpop, output, error);
+		case FUNCTION_ID_VARSAMP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varsamp, output, error);
+		case FUNCTION_ID_COUNT:
+			return eval_execute_function_count(ctx, token, output, error);
+		case FUNCTION_ID_HISTOGRAM_QUANTILE:
+			return eval_execute_function_histogram_quantile(ctx, token, output, error);
+		default:
+			break;
+	}
 
 	if (NULL != ctx->common_func_cb)
 		return eval_execute_cb_function(ctx, token, ctx->common_func_cb, output, error);
@@ -3058,3 +3285,249 @@ int	zbx_eval_execute_ext(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, zbx_
 
 	return eval_execute(ctx, value, error);
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: extend folded constant location to include unbalanced            *
+ *          parentheses                                                       *
+ *                                                                            *
+ * Parameters: expression - [IN] the expression                               *
+ *             loc        - [IN/OUT] the folded constant location             *
+ *                                                                            *
+ * Comments: The location spans from the first to the last folded token and  *
+ *           can have grouping parentheses of some operands cut off, for      *
+ *           example '1)+(2' in '(1)+(2)'. Because expression is valid and    *
+ *           contains only numeric constants and operators in this range,     *
+ *           the missing parentheses are separated only by whitespace.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_compile_balance_loc(const char *expression, zbx_strloc_t *loc)
+{
+	size_t	i;
+	int	open = 0, close = 0;
+
+	for (i = loc->l; i <= loc->r; i++)
+	{
+		if ('(' == expression[i])
+		{
+			open++;
+		}
+		else if (')' == expression[i])
+		{
+			if (0 < open)
+				open--;
+			else
+				close++;
+		}
+	}
+
+	while (0 < close)
+	{
+		if ('(' == expression[--loc->l])
+			close--;
+	}
+
+	while (0 < open)
+	{
+		if (')' == expression[++loc->r])
+			open--;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replace operator with constant operands by its result             *
+ *                                                                            *
+ * Parameters: ctx      - [IN] the evaluation context                         *
+ *             token    - [IN/OUT] the operator token                         *
+ *             operands - [IN/OUT] the constant operand tokens                *
+ *             num      - [IN] the number of operands                         *
+ *                                                                            *
+ * Return value: SUCCEED - the operator was replaced with numeric constant    *
+ *               FAIL    - the operator cannot be calculated, it will be left *
+ *                         to report error during evaluation                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_compile_fold(const zbx_eval_context_t *ctx, zbx_eval_token_t *token, zbx_eval_token_t **operands,
+		int num)
+{
+	zbx_vector_var_t	output;
+	zbx_variant_t		value;
+	char			*error = NULL;
+	int			i, ret;
+
+	zbx_vector_var_create(&output);
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_variant_copy(&value, &operands[i]->value);
+		zbx_vector_var_append_ptr(&output, &value);
+	}
+
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		ret = eval_execute_op_unary(ctx, token, &output, &error);
+	else
+		ret = eval_execute_op_binary(ctx, token, &output, &error);
+
+	if (SUCCEED == ret)
+	{
+		token->type = ZBX_EVAL_TOKEN_VAR_NUM;
+		token->opt = 0;
+		token->value = output.values[0];
+		output.values_num = 0;
+
+		for (i = 0; i < num; i++)
+		{
+			if (operands[i]->loc.l < token->loc.l)
+				token->loc.l = operands[i]->loc.l;
+
+			if (operands[i]->loc.r > token->loc.r)
+				token->loc.r = operands[i]->loc.r;
+
+			zbx_variant_clear(&operands[i]->value);
+			operands[i]->type = ZBX_EVAL_TOKEN_NOP;
+		}
+
+		eval_compile_balance_loc(ctx->expression, &token->loc);
+	}
+	else
+		zbx_free(error);
+
+	for (i = 0; i < output.values_num; i++)
+		zbx_variant_clear(&output.values[i]);
+
+	zbx_vector_var_destroy(&output);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: track expression execution stack for constant folding            *
+ *                                                                            *
+ * Parameters: ctx   - [IN] the evaluation context                            *
+ *             token - [IN/OUT] the token                                     *
+ *             stack - [IN/OUT] the execution stack, containing numeric       *
+ *                              constant tokens or NULL for other values      *
+ *                                                                            *
+ * Return value: SUCCEED - the token was processed                            *
+ *               FAIL    - the token is not supported by constant folding     *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_compile_token(const zbx_eval_context_t *ctx, zbx_eval_token_t *token, zbx_vector_ptr_t *stack)
+{
+	int			i, num, constant = SUCCEED;
+	zbx_eval_token_t	**operands;
+
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+	{
+		num = 1;
+	}
+	else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+	{
+		num = 2;
+	}
+	else
+	{
+		switch (token->type)
+		{
+			case ZBX_EVAL_TOKEN_NOP:
+				return SUCCEED;
+			case ZBX_EVAL_TOKEN_VAR_NUM:
+				zbx_vector_ptr_append(stack, token);
+				return SUCCEED;
+			case ZBX_EVAL_TOKEN_FUNCTION:
+			case ZBX_EVAL_TOKEN_HIST_FUNCTION:
+				num = (int)token->opt;
+				constant = FAIL;
+				break;
+			default:
+				if (0 == (token->type & ZBX_EVAL_CLASS_OPERAND))
+					return FAIL;
+
+				zbx_vector_ptr_append(stack, NULL);
+				return SUCCEED;
+		}
+	}
+
+	if (stack->values_num < num)
+		return FAIL;
+
+	operands = (zbx_eval_token_t **)stack->values + stack->values_num - num;
+
+	for (i = 0; i < num && SUCCEED == constant; i++)
+	{
+		if (NULL == operands[i])
+			constant = FAIL;
+	}
+
+	if (SUCCEED == constant)
+		constant = eval_compile_fold(ctx, token, operands, num);
+
+	stack->values_num -= num;
+	zbx_vector_ptr_append(stack, SUCCEED == constant ? token : NULL);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepare parsed expression for repeated evaluation                 *
+ *                                                                            *
+ * Parameters: ctx - [IN/OUT] the evaluation context                          *
+ *                                                                            *
+ * Comments: Numeric constants are converted to values, built-in function     *
+ *           names are resolved to function identifiers and operators having  *
+ *           only numeric constant operands are replaced with their results.  *
+ *           Compiled context keeps the token stack format - it is evaluated *
+ *           by the same interpreter as parsed context and can be serialized  *
+ *           to store in configuration cache. There is no separate bytecode   *
+ *           format or virtual machine, and the serialized context is still   *
+ *           decoded before each evaluation.                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_eval_compile(zbx_eval_context_t *ctx)
+{
+	zbx_vector_ptr_t	stack;
+	int			i, j, fold = SUCCEED;
+	zbx_function_id_t	function_id;
+
+	zbx_vector_ptr_create(&stack);
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		zbx_eval_token_t	*token = &ctx->stack.values[i];
+
+		if (ZBX_VARIANT_NONE == token->value.type)
+		{
+			switch (token->type)
+			{
+				case ZBX_EVAL_TOKEN_VAR_NUM:
+					eval_parse_number(ctx, token, &token->value);
+					break;
+				case ZBX_EVAL_TOKEN_FUNCTION:
+					if (FUNCTION_ID_UNKNOWN != (function_id = eval_get_function_id(ctx, token)))
+						zbx_variant_set_ui64(&token->value, (zbx_uint64_t)function_id);
+					break;
+			}
+		}
+
+		if (SUCCEED == fold)
+			fold = eval_compile_token(ctx, token, &stack);
+	}
+
+	zbx_vector_ptr_destroy(&stack);
+
+	/* remove tokens of folded operands */
+	for (i = 0, j = 0; i < ctx->stack.values_num; i++)
+	{
+		if (ZBX_EVAL_TOKEN_NOP == ctx->stack.values[i].type)
+			continue;
+
+		if (i != j)
+			ctx->stack.values[j] = ctx->stack.values[i];
+		j++;
+	}
+
+	ctx->stack.values_num = j;
+}
@@ -367,8 +367,14 @@ void	zbx_eval_compose_expression(const zbx_eval_context_t *ctx, char **expressio
 
 	for (i = 0; i < ctx->stack.values_num; i++)
 	{
-		if (ZBX_VARIANT_NONE != ctx->stack.values[i].value.type)
-			zbx_vector_ptr_append(&tokens, &ctx->stack.values[i]);
+		if (ZBX_VARIANT_NONE == ctx->stack.values[i].value.type)
+			continue;
+
+		/* compiled function tokens have function identifiers as values */
+		if (ZBX_EVAL_TOKEN_FUNCTION == ctx->stack.values[i].type)
+			continue;
+
+		zbx_vector_ptr_append(&tokens, &ctx->stack.values[i]);
 	}
 
 	zbx_vector_ptr_sort(&tokens, compare_tokens_by_loc);
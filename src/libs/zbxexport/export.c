@@ -20,13 +20,27 @@
 #include "zbxexport.h"
 
 #include "log.h"
+#include "zbxalgo.h"
+
+#include <sys/mman.h>
 
 #define ZBX_OPTION_EXPTYPE_EVENTS	"events"
 #define ZBX_OPTION_EXPTYPE_HISTORY	"history"
 #define ZBX_OPTION_EXPTYPE_TRENDS	"trends"
 
+#define ZBX_OPTION_EXPFORMAT_NDJSON	"ndjson"
+#define ZBX_OPTION_EXPFORMAT_BINARY	"binary"
+
+/* binary export record types */
+#define ZBX_EXPORT_RECORD_ITEM		1
+#define ZBX_EXPORT_RECORD_VALUE		2
+
+/* binary export files are extended by this size to reserve disk space before writing */
+#define ZBX_EXPORT_MMAP_CHUNK		ZBX_MEBIBYTE
+
 extern char		*CONFIG_EXPORT_DIR;
 extern char		*CONFIG_EXPORT_TYPE;
+extern char		*CONFIG_EXPORT_FORMAT;
 extern zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE;
 
 typedef struct
@@ -37,11 +51,45 @@ typedef struct
 }
 zbx_export_file_t;
 
+/* Binary export file consists of records:                                   */
+/*   uint32 size - size of the following type and payload, 0 marks the end  */
+/*   uint8 type  - record type (ZBX_EXPORT_RECORD_*)                         */
+/*   payload     - record data                                               */
+/* Item records describe items (host, name, groups, tags) and are written    */
+/* before the first value of the item in each file and whenever the item    */
+/* description changes. The file is written through memory mapping and is   */
+/* extended in chunks, so readers must stop at record with zero size.        */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_hash_t	hash;
+	char		*data;		/* the serialized item description */
+	size_t		size;
+	unsigned char	used;		/* the item was exported since the current file was opened */
+	unsigned char	written;	/* the description was written to the current file */
+}
+zbx_export_item_t;
+
+typedef struct
+{
+	char		*name;
+	int		fd;
+	char		*data;
+	size_t		offset;		/* the end of written records */
+	size_t		size;		/* the file size */
+	size_t		map_size;
+	zbx_hashset_t	items;		/* the items described in the current file */
+}
+zbx_export_mmap_t;
+
 static zbx_export_file_t	*history_file;
 static zbx_export_file_t	*trends_file;
 static zbx_export_file_t	*problems_file;
 
+static zbx_export_mmap_t	*history_mmap;
+
 static char	*export_dir;
+static int	export_format = ZBX_EXPORT_FORMAT_NDJSON;
 
 /******************************************************************************
  *                                                                            *
@@ -159,6 +207,20 @@ int	zbx_export_init(char **error)
 		return SUCCEED;
 	}
 
+	if (NULL != CONFIG_EXPORT_FORMAT)
+	{
+		if (0 == strcmp(CONFIG_EXPORT_FORMAT, ZBX_OPTION_EXPFORMAT_BINARY))
+		{
+			export_format = ZBX_EXPORT_FORMAT_BINARY;
+		}
+		else if (0 != strcmp(CONFIG_EXPORT_FORMAT, ZBX_OPTION_EXPFORMAT_NDJSON))
+		{
+			*error = zbx_dsprintf(*error, "Invalid \"ExportFormat\" configuration parameter: '%s'.",
+					CONFIG_EXPORT_FORMAT);
+			return FAIL;
+		}
+	}
+
 	if (NULL == CONFIG_EXPORT_TYPE)
 	{
 		CONFIG_EXPORT_TYPE = zbx_dsprintf(CONFIG_EXPORT_TYPE, "%s,%s,%s", ZBX_OPTION_EXPTYPE_EVENTS,
@@ -224,9 +286,273 @@ static zbx_export_file_t	*export_init(zbx_export_file_t *file, const char *proce
 	return file;
 }
 
+static void	export_item_clean(zbx_export_item_t *item)
+{
+	zbx_free(item->data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepare item descriptions for a new binary export file            *
+ *                                                                            *
+ * Comments: Descriptions of items that were not exported since the previous  *
+ *           file was opened are dropped, others must be written again before *
+ *           the next item value.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_mmap_reset_items(zbx_export_mmap_t *file)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_export_item_t	*item;
+
+	zbx_hashset_iter_reset(&file->items, &iter);
+
+	while (NULL != (item = (zbx_export_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 == item->used)
+		{
+			zbx_hashset_iter_remove(&iter);
+			continue;
+		}
+
+		item->used = 0;
+		item->written = 0;
+	}
+}
+
+static int	export_mmap_open(zbx_export_mmap_t *file, char **error)
+{
+	zbx_stat_t	st;
+	zbx_uint32_t	size;
+
+	if (-1 == (file->fd = open(file->name, O_RDWR | O_CREAT, 0666)))
+	{
+		*error = zbx_dsprintf(*error, "cannot open export file '%s': %s", file->name, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 != zbx_fstat(file->fd, &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot stat export file '%s': %s", file->name, zbx_strerror(errno));
+		goto fail;
+	}
+
+	file->size = (size_t)st.st_size;
+	file->map_size = MAX((size_t)CONFIG_EXPORT_FILE_SIZE, file->size);
+
+	if (MAP_FAILED == (file->data = (char *)mmap(NULL, file->map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			file->fd, 0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot map export file '%s': %s", file->name, zbx_strerror(errno));
+		file->data = NULL;
+		goto fail;
+	}
+
+	/* find the end of records written by previous process instance */
+	for (file->offset = 0; file->offset + sizeof(size) <= file->size; file->offset += sizeof(size) + size)
+	{
+		memcpy(&size, file->data + file->offset, sizeof(size));
+
+		if (0 == size || file->offset + sizeof(size) + size > file->size)
+			break;
+	}
+
+	/* clear partially written record, if any */
+	memset(file->data + file->offset, 0, file->size - file->offset);
+
+	export_mmap_reset_items(file);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "successfully opened export file '%s'", file->name);
+
+	return SUCCEED;
+fail:
+	close(file->fd);
+	file->fd = -1;
+
+	return FAIL;
+}
+
+static void	export_mmap_close(zbx_export_mmap_t *file)
+{
+	if (NULL == file->data)
+		return;
+
+	munmap(file->data, file->map_size);
+	file->data = NULL;
+
+	/* drop the reserved space after the last record */
+	if (0 != ftruncate(file->fd, (off_t)file->offset))
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot truncate export file '%s': %s", file->name, zbx_strerror(errno));
+
+	if (0 != close(file->fd))
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot close export file '%s': %s", file->name, zbx_strerror(errno));
+
+	file->fd = -1;
+}
+
+static int	export_mmap_rotate(zbx_export_mmap_t *file, char **error)
+{
+	char	filename_old[MAX_STRING_LEN];
+
+	export_mmap_close(file);
+
+	strscpy(filename_old, file->name);
+	zbx_strlcat(filename_old, ".old", MAX_STRING_LEN);
+
+	if (0 == access(filename_old, F_OK) && 0 != remove(filename_old))
+	{
+		*error = zbx_dsprintf(*error, "cannot remove export file '%s': %s", filename_old,
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 != rename(file->name, filename_old))
+	{
+		*error = zbx_dsprintf(*error, "cannot rename export file '%s': %s", file->name, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	return export_mmap_open(file, error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: extend export file to fit the specified number of bytes after     *
+ *          the last record                                                   *
+ *                                                                            *
+ * Comments: The file is extended by writing zeros rather than truncating it, *
+ *           so the disk space is allocated before the mapped memory is       *
+ *           written.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	export_mmap_reserve(zbx_export_mmap_t *file, size_t count, char **error)
+{
+	static char	zeros[64 * ZBX_KIBIBYTE];
+	size_t		size;
+	ssize_t		n;
+
+	if (file->offset + count <= file->size)
+		return SUCCEED;
+
+	size = (file->offset + count + ZBX_EXPORT_MMAP_CHUNK - 1) / ZBX_EXPORT_MMAP_CHUNK * ZBX_EXPORT_MMAP_CHUNK;
+	size = MIN(size, file->map_size);
+
+	while (file->size < size)
+	{
+		if (-1 == (n = pwrite(file->fd, zeros, MIN(sizeof(zeros), size - file->size), (off_t)file->size)))
+		{
+			*error = zbx_dsprintf(*error, "cannot write to export file '%s': %s", file->name,
+					zbx_strerror(errno));
+			return FAIL;
+		}
+
+		file->size += (size_t)n;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: ensure there is space for records of the specified total size     *
+ *                                                                            *
+ ******************************************************************************/
+static int	export_mmap_prepare(zbx_export_mmap_t *file, size_t count, char **error)
+{
+	if (NULL == file->data && FAIL == export_mmap_open(file, error))
+		return FAIL;
+
+	if (file->offset + count > file->map_size)
+	{
+		if (FAIL == export_mmap_rotate(file, error))
+			return FAIL;
+
+		if (count > file->map_size)
+		{
+			*error = zbx_dsprintf(*error, "cannot write " ZBX_FS_SIZE_T " bytes record to export file"
+					" '%s': record exceeds maximum file size", (zbx_fs_size_t)count, file->name);
+			return FAIL;
+		}
+	}
+
+	return export_mmap_reserve(file, count, error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copy record to the export file prepared by export_mmap_prepare()  *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_mmap_put(zbx_export_mmap_t *file, unsigned char type, const char *buf, size_t count)
+{
+	zbx_uint32_t	size = (zbx_uint32_t)(count + 1);
+	char		*ptr = file->data + file->offset;
+
+	ptr[sizeof(size)] = (char)type;
+	memcpy(ptr + sizeof(size) + 1, buf, count);
+
+	/* the record size is written last, so readers never see partially written record */
+	memcpy(ptr, &size, sizeof(size));
+
+	file->offset += sizeof(size) + size;
+}
+
+static void	export_mmap_log_error(char *error)
+{
+#define ZBX_LOGGING_SUSPEND_TIME	10
+	static time_t	last_log_time = 0;
+	time_t		now;
+
+	now = time(NULL);
+
+	if (ZBX_LOGGING_SUSPEND_TIME < now - last_log_time)
+	{
+		zabbix_log(LOG_LEVEL_ERR, "%s", error);
+		last_log_time = now;
+	}
+#undef ZBX_LOGGING_SUSPEND_TIME
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reopen export file if it was removed                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_mmap_check(zbx_export_mmap_t *file)
+{
+	if (NULL != file->data && 0 != access(file->name, F_OK))
+		export_mmap_close(file);
+}
+
+static zbx_export_mmap_t	*export_mmap_init(const char *process_type, const char *process_name, int process_num)
+{
+	zbx_export_mmap_t	*file;
+	char			*error = NULL;
+
+	file = (zbx_export_mmap_t *)zbx_malloc(NULL, sizeof(zbx_export_mmap_t));
+	memset(file, 0, sizeof(zbx_export_mmap_t));
+	file->name = zbx_dsprintf(NULL, "%s/%s-%s-%d.bin", export_dir, process_type, process_name, process_num);
+	file->fd = -1;
+
+	zbx_hashset_create_ext(&file->items, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			(zbx_clean_func_t)export_item_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	if (FAIL == export_mmap_open(file, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "%s", error);
+		exit(EXIT_FAILURE);
+	}
+
+	return file;
+}
+
 void	zbx_history_export_init(const char *process_name, int process_num)
 {
-	history_file = export_init(history_file, "history", process_name, process_num);
+	if (ZBX_EXPORT_FORMAT_BINARY == export_format)
+		history_mmap = export_mmap_init("history", process_name, process_num);
+	else
+		history_file = export_init(history_file, "history", process_name, process_num);
 }
 
 void	zbx_trends_export_init(const char *process_name, int process_num)
@@ -367,6 +693,12 @@ void	zbx_problems_export_flush(void)
 
 void	zbx_history_export_flush(void)
 {
+	if (ZBX_EXPORT_FORMAT_BINARY == export_format)
+	{
+		export_mmap_check(history_mmap);
+		return;
+	}
+
 	if (NULL != history_file->file)
 		zbx_flush(history_file->file, history_file->name);
 }
@@ -376,3 +708,85 @@ void	zbx_trends_export_flush(void)
 	if (NULL != trends_file->file)
 		zbx_flush(trends_file->file, trends_file->name);
 }
+
+int	zbx_history_export_format(void)
+{
+	return export_format;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: register item description for binary history export              *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item identifier                              *
+ *             buf    - [IN] the serialized item description                  *
+ *             count  - [IN] the description size                             *
+ *                                                                            *
+ * Comments: The description is written to export file before the next item  *
+ *           value if it was not written to the current file yet or has       *
+ *           changed.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_history_export_write_item(zbx_uint64_t itemid, const char *buf, size_t count)
+{
+	zbx_export_item_t	*item, item_local;
+	zbx_hash_t		hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(buf, count, ZBX_DEFAULT_HASH_SEED);
+
+	if (NULL == (item = (zbx_export_item_t *)zbx_hashset_search(&history_mmap->items, &itemid)))
+	{
+		item_local.itemid = itemid;
+		item_local.data = NULL;
+		item = (zbx_export_item_t *)zbx_hashset_insert(&history_mmap->items, &item_local, sizeof(item_local));
+	}
+	else if (hash == item->hash && count == item->size && 0 == memcmp(item->data, buf, count))
+	{
+		item->used = 1;
+		return;
+	}
+
+	item->used = 1;
+
+	item->hash = hash;
+	item->size = count;
+	item->data = (char *)zbx_realloc(item->data, count);
+	memcpy(item->data, buf, count);
+	item->written = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: write item value to binary history export file                    *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item identifier                              *
+ *             buf    - [IN] the serialized value                             *
+ *             count  - [IN] the value size                                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_history_export_write_value(zbx_uint64_t itemid, const char *buf, size_t count)
+{
+	zbx_export_item_t	*item;
+	size_t			size;
+	char			*error = NULL;
+
+	size = sizeof(zbx_uint32_t) + 1 + count;
+
+	if (NULL != (item = (zbx_export_item_t *)zbx_hashset_search(&history_mmap->items, &itemid)))
+		size += sizeof(zbx_uint32_t) + 1 + item->size;
+
+	if (FAIL == export_mmap_prepare(history_mmap, size, &error))
+	{
+		export_mmap_log_error(error);
+		zbx_free(error);
+		return;
+	}
+
+	if (NULL != item && 0 == item->written)
+	{
+		export_mmap_put(history_mmap, ZBX_EXPORT_RECORD_ITEM, item->data, item->size);
+		item->written = 1;
+	}
+
+	export_mmap_put(history_mmap, ZBX_EXPORT_RECORD_VALUE, buf, count);
+}
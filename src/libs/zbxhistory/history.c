@@ -26,6 +26,8 @@ ZBX_VECTOR_IMPL(history_record, zbx_history_record_t)
 
 extern char	*CONFIG_HISTORY_STORAGE_URL;
 extern char	*CONFIG_HISTORY_STORAGE_OPTS;
+extern char	*CONFIG_HISTORY_FILE_DIR;
+extern char	*CONFIG_HISTORY_FILE_OPTS;
 
 zbx_history_iface_t	history_ifaces[ITEM_VALUE_TYPE_MAX];
 
@@ -48,7 +50,12 @@ int	zbx_history_init(char **error)
 
 	for (i = 0; i < ITEM_VALUE_TYPE_MAX; i++)
 	{
-		if (NULL == CONFIG_HISTORY_STORAGE_URL || NULL == strstr(CONFIG_HISTORY_STORAGE_OPTS, opts[i]))
+		if (NULL != CONFIG_HISTORY_FILE_DIR && NULL != strstr(CONFIG_HISTORY_FILE_OPTS, opts[i]) &&
+				(ITEM_VALUE_TYPE_FLOAT == i || ITEM_VALUE_TYPE_UINT64 == i))
+		{
+			ret = zbx_history_file_init(&history_ifaces[i], i, error);
+		}
+		else if (NULL == CONFIG_HISTORY_STORAGE_URL || NULL == strstr(CONFIG_HISTORY_STORAGE_OPTS, opts[i]))
 			ret = zbx_history_sql_init(&history_ifaces[i], i, error);
 		else
 			ret = zbx_history_elastic_init(&history_ifaces[i], i, error);
@@ -88,10 +95,14 @@ void	zbx_history_destroy(void)
  *                                                                                  *
  * Comments: add history values to the configured storage backends                  *
  *                                                                                  *
+ *           FLUSH_ASYNC is returned in ret_flush if the values are still being     *
+ *           written in background, zbx_history_wait() must be called to get the    *
+ *           result before the values can be treated as stored.                     *
+ *                                                                                  *
  ************************************************************************************/
 int	zbx_history_add_values(const zbx_vector_ptr_t *history, int *ret_flush)
 {
-	int	i, flags = 0;
+	int	i, flags = 0, ret;
 
 	*ret_flush = FLUSH_SUCCEED;
 
@@ -111,14 +122,37 @@ int	zbx_history_add_values(const zbx_vector_ptr_t *history, int *ret_flush)
 
 		if (0 != (flags & (1 << i)))
 		{
-			if (FLUSH_DUPL_REJECTED == (*ret_flush = writer->flush(writer)))
+			if (FLUSH_SUCCEED == (ret = writer->flush(writer)) || FLUSH_FAIL == *ret_flush)
+				continue;
+
+			if (FLUSH_DUPL_REJECTED == (*ret_flush = ret))
 				break;
 		}
 	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
-	return (FLUSH_SUCCEED == *ret_flush ? SUCCEED : FAIL);
+	return (FLUSH_SUCCEED == *ret_flush || FLUSH_ASYNC == *ret_flush ? SUCCEED : FAIL);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: waits until the values sent with zbx_history_add_values() are stored    *
+ *                                                                                  *
+ * Return value: SUCCEED - the values were stored                                   *
+ *               FAIL    - failed to store the values                               *
+ *                                                                                  *
+ * Comments: History storage backends might write values asynchronously, so this    *
+ *           function must be called before reading the new values back.            *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_wait(void)
+{
+#ifdef HAVE_POSTGRESQL
+	return zbx_history_sql_wait();
+#else
+	return SUCCEED;
+#endif
 }
 
 /************************************************************************************
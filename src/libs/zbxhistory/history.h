@@ -44,6 +44,7 @@ struct zbx_history_iface
 	union
 	{
 		void				*elastic_data;
+		void				*file_data;
 		zbx_history_func_t		sql_history_func;
 	} data;
 	zbx_history_destroy_func_t	destroy;
@@ -54,10 +55,16 @@ struct zbx_history_iface
 
 /* SQL hist */
 int	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+#ifdef HAVE_POSTGRESQL
+int	zbx_history_sql_wait(void);
+#endif
 
 /* elastic hist */
 int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
 void	zbx_elastic_version_extract(struct zbx_json *json);
 zbx_uint32_t	zbx_elastic_version_get(void);
 
+/* file hist */
+int	zbx_history_file_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+
 #endif
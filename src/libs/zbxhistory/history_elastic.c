@@ -25,6 +25,10 @@
 
 #include "history.h"
 
+#ifdef HAVE_ZLIB
+#include "zlib.h"
+#endif
+
 /* curl_multi_wait() is supported starting with version 7.28.0 (0x071c00) */
 #if defined(HAVE_LIBCURL) && LIBCURL_VERSION_NUM >= 0x071c00
 
@@ -37,6 +41,8 @@ const char	*value_type_str[] = {"dbl", "str", "log", "uint", "text"};
 
 extern char	*CONFIG_HISTORY_STORAGE_URL;
 extern int	CONFIG_HISTORY_STORAGE_PIPELINES;
+extern zbx_uint64_t	CONFIG_HISTORY_STORAGE_BULK_SIZE;
+extern int	CONFIG_HISTORY_STORAGE_COMPRESSION;
 
 static zbx_uint32_t	ZBX_ELASTIC_SVERSION = ZBX_DBVERSION_UNDEFINED;
 
@@ -44,22 +50,10 @@ typedef struct
 {
 	char	*base_url;
 	char	*post_url;
-	char	*buf;
 	CURL	*handle;
 }
 zbx_elastic_data_t;
 
-typedef struct
-{
-	unsigned char		initialized;
-	zbx_vector_ptr_t	ifaces;
-
-	CURLM			*handle;
-}
-zbx_elastic_writer_t;
-
-static zbx_elastic_writer_t	writer;
-
 typedef struct
 {
 	char	*data;
@@ -77,7 +71,34 @@ typedef struct
 }
 zbx_curlpage_t;
 
-static zbx_curlpage_t	page_w[ITEM_VALUE_TYPE_MAX];
+/* bulk request, limited by HistoryStorageBulkSize */
+typedef struct
+{
+	char		*buf;
+	size_t		buf_alloc;
+	size_t		buf_offset;
+
+	/* the request body size before compression */
+	size_t		size;
+
+	CURL		*handle;
+	zbx_curlpage_t	page;
+}
+zbx_elastic_bulk_t;
+
+typedef struct
+{
+	unsigned char		initialized;
+	zbx_vector_ptr_t	bulks;
+
+	struct curl_slist	*headers;
+	struct curl_slist	*headers_gzip;
+
+	CURLM			*handle;
+}
+zbx_elastic_writer_t;
+
+static zbx_elastic_writer_t	writer;
 
 static size_t	curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
@@ -229,14 +250,10 @@ static void	elastic_close(zbx_history_iface_t *hist)
 {
 	zbx_elastic_data_t	*data = hist->data.elastic_data;
 
-	zbx_free(data->buf);
 	zbx_free(data->post_url);
 
 	if (NULL != data->handle)
 	{
-		if (NULL != writer.handle)
-			curl_multi_remove_handle(writer.handle, data->handle);
-
 		curl_easy_cleanup(data->handle);
 		data->handle = NULL;
 	}
@@ -326,7 +343,7 @@ static void	elastic_writer_init(void)
 	if (0 != writer.initialized)
 		return;
 
-	zbx_vector_ptr_create(&writer.ifaces);
+	zbx_vector_ptr_create(&writer.bulks);
 
 	if (NULL == (writer.handle = curl_multi_init()))
 	{
@@ -334,9 +351,33 @@ static void	elastic_writer_init(void)
 		exit(EXIT_FAILURE);
 	}
 
+	writer.headers = curl_slist_append(NULL, "Content-Type: application/x-ndjson");
+	writer.headers_gzip = curl_slist_append(NULL, "Content-Type: application/x-ndjson");
+	writer.headers_gzip = curl_slist_append(writer.headers_gzip, "Content-Encoding: gzip");
+
 	writer.initialized = 1;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: frees bulk request                                                      *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_free(zbx_elastic_bulk_t *bulk)
+{
+	if (NULL != bulk->handle)
+	{
+		if (NULL != writer.handle)
+			curl_multi_remove_handle(writer.handle, bulk->handle);
+
+		curl_easy_cleanup(bulk->handle);
+	}
+
+	zbx_free(bulk->page.page.data);
+	zbx_free(bulk->buf);
+	zbx_free(bulk);
+}
+
 /************************************************************************************
  *                                                                                  *
  * Purpose: releases initialized elastic writer by freeing allocated resources and  *
@@ -347,74 +388,217 @@ static void	elastic_writer_release(void)
 {
 	int	i;
 
-	for (i = 0; i < writer.ifaces.values_num; i++)
-		elastic_close((zbx_history_iface_t *)writer.ifaces.values[i]);
+	for (i = 0; i < writer.bulks.values_num; i++)
+		elastic_bulk_free((zbx_elastic_bulk_t *)writer.bulks.values[i]);
 
 	curl_multi_cleanup(writer.handle);
 	writer.handle = NULL;
 
-	zbx_vector_ptr_destroy(&writer.ifaces);
+	curl_slist_free_all(writer.headers);
+	curl_slist_free_all(writer.headers_gzip);
+
+	zbx_vector_ptr_destroy(&writer.bulks);
 
 	writer.initialized = 0;
 }
 
+#ifdef HAVE_ZLIB
 /************************************************************************************
  *                                                                                  *
- * Purpose: adds history storage interface to be flushed later                      *
+ * Purpose: replaces bulk request body with its gzip compressed version             *
  *                                                                                  *
- * Parameters: db_insert - [IN] bulk insert data                                    *
+ * Return value: SUCCEED - the body was compressed                                  *
+ *               FAIL    - otherwise, the body is left uncompressed                 *
  *                                                                                  *
  ************************************************************************************/
-static void	elastic_writer_add_iface(zbx_history_iface_t *hist)
+static int	elastic_bulk_compress(zbx_elastic_bulk_t *bulk)
+{
+	z_stream	strm;
+	char		*out;
+	size_t		out_alloc;
+	int		rc;
+
+	memset(&strm, 0, sizeof(strm));
+
+	/* add 16 to window bits to write gzip header and trailer instead of zlib wrapper */
+	if (Z_OK != deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY))
+		return FAIL;
+
+	out_alloc = deflateBound(&strm, (uLong)bulk->buf_offset);
+	out = (char *)zbx_malloc(NULL, out_alloc);
+
+	strm.next_in = (Bytef *)bulk->buf;
+	strm.avail_in = (uInt)bulk->buf_offset;
+	strm.next_out = (Bytef *)out;
+	strm.avail_out = (uInt)out_alloc;
+
+	rc = deflate(&strm, Z_FINISH);
+	deflateEnd(&strm);
+
+	if (Z_STREAM_END != rc)
+	{
+		zbx_free(out);
+		return FAIL;
+	}
+
+	zbx_free(bulk->buf);
+	bulk->buf = out;
+	bulk->buf_alloc = out_alloc;
+	bulk->buf_offset = strm.total_out;
+
+	return SUCCEED;
+}
+#endif
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: appends JSON string with escaped special characters to bulk request     *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_add_string(zbx_elastic_bulk_t *bulk, const char *str)
+{
+	const char	*ptr;
+
+	zbx_chrcpy_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, '"');
+
+	for (ptr = str; '\0' != *ptr; ptr++)
+	{
+		char	buf[8];
+
+		switch (*ptr)
+		{
+			case '"':
+			case '\\':
+				buf[0] = '\\';
+				buf[1] = *ptr;
+				buf[2] = '\0';
+				break;
+			case '\n':
+				zbx_strlcpy(buf, "\\n", sizeof(buf));
+				break;
+			case '\r':
+				zbx_strlcpy(buf, "\\r", sizeof(buf));
+				break;
+			case '\t':
+				zbx_strlcpy(buf, "\\t", sizeof(buf));
+				break;
+			default:
+				if (0x20 > (unsigned char)*ptr)
+				{
+					zbx_snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)(unsigned char)*ptr);
+					break;
+				}
+
+				continue;
+		}
+
+		zbx_strncpy_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, str, (size_t)(ptr - str));
+		zbx_strcpy_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, buf);
+		str = ptr + 1;
+	}
+
+	zbx_strncpy_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, str, (size_t)(ptr - str));
+	zbx_chrcpy_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, '"');
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: appends history value document to bulk request                          *
+ *                                                                                  *
+ * Comments: The document is written directly into request buffer instead of        *
+ *           building it with json functions, the field layout matches documents    *
+ *           written by previous versions.                                          *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_add_value(zbx_elastic_bulk_t *bulk, const ZBX_DC_HISTORY *h)
+{
+	zbx_snprintf_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, "{\"itemid\":" ZBX_FS_UI64 ",\"value\":",
+			h->itemid);
+	elastic_bulk_add_string(bulk, history_value2str(h));
+
+	if (ITEM_VALUE_TYPE_LOG == h->value_type)
+	{
+		const zbx_log_value_t	*log = h->value.log;
+
+		zbx_snprintf_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, ",\"timestamp\":%d,\"source\":",
+				log->timestamp);
+		elastic_bulk_add_string(bulk, ZBX_NULL2EMPTY_STR(log->source));
+		zbx_snprintf_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, ",\"severity\":%d,\"logeventid\":%d",
+				log->severity, log->logeventid);
+	}
+
+	zbx_snprintf_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, ",\"clock\":%d,\"ns\":%d,\"ttl\":%d}\n",
+			h->ts.sec, h->ts.ns, h->ttl);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: adds bulk request to be flushed later                                   *
+ *                                                                                  *
+ * Parameters: hist - [IN] the history storage interface                            *
+ *             bulk - [IN] the bulk request, freed on failure                       *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_writer_add_bulk(zbx_history_iface_t *hist, zbx_elastic_bulk_t *bulk)
 {
 	zbx_elastic_data_t	*data = hist->data.elastic_data;
+	struct curl_slist	*headers;
+	char			*post_url;
 	CURLoption		opt;
 	CURLcode		err;
 
 	elastic_writer_init();
 
-	if (NULL == (data->handle = curl_easy_init()))
+	bulk->size = bulk->buf_offset;
+	headers = writer.headers;
+
+#ifdef HAVE_ZLIB
+	if (1 == CONFIG_HISTORY_STORAGE_COMPRESSION)
 	{
-		zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
-		return;
+		if (SUCCEED == elastic_bulk_compress(bulk))
+			headers = writer.headers_gzip;
+		else
+			zabbix_log(LOG_LEVEL_WARNING, "cannot compress elasticsearch bulk request, sending it as is");
 	}
+#endif
 
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_URL, data->post_url)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POST, 1L)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POSTFIELDS, data->buf)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_WRITEFUNCTION,
-					curl_write_cb)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_WRITEDATA,
-					&page_w[hist->value_type].page)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_FAILONERROR, 1L)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_ERRORBUFFER,
-					page_w[hist->value_type].errbuf)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = ZBX_CURLOPT_ACCEPT_ENCODING, "")))
+	if (NULL == (bulk->handle = curl_easy_init()))
 	{
-		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)opt, curl_easy_strerror(err));
-		goto out;
+		zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
+		elastic_bulk_free(bulk);
+		return;
 	}
 
-	*page_w[hist->value_type].errbuf = '\0';
+	post_url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
 
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_PRIVATE, &page_w[hist->value_type])))
+	if (CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_URL, post_url)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_POST, 1L)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_POSTFIELDS, bulk->buf)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_POSTFIELDSIZE,
+					(long)bulk->buf_offset)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_HTTPHEADER, headers)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_WRITEFUNCTION,
+					curl_write_cb)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_WRITEDATA, &bulk->page.page)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_FAILONERROR, 1L)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_ERRORBUFFER,
+					bulk->page.errbuf)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = CURLOPT_PRIVATE, &bulk->page)) ||
+			CURLE_OK != (err = curl_easy_setopt(bulk->handle, opt = ZBX_CURLOPT_ACCEPT_ENCODING, "")))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)opt, curl_easy_strerror(err));
-		goto out;
+		zbx_free(post_url);
+		elastic_bulk_free(bulk);
+		return;
 	}
 
-	page_w[hist->value_type].page.offset = 0;
-
-	if (0 < page_w[hist->value_type].page.alloc)
-		*page_w[hist->value_type].page.data = '\0';
+	zbx_free(post_url);
 
-	curl_multi_add_handle(writer.handle, data->handle);
+	*bulk->page.errbuf = '\0';
 
-	zbx_vector_ptr_append(&writer.ifaces, hist);
+	curl_multi_add_handle(writer.handle, bulk->handle);
 
-	return;
-out:
-	elastic_close(hist);
+	zbx_vector_ptr_append(&writer.bulks, bulk);
 }
 
 /************************************************************************************
@@ -424,11 +608,11 @@ out:
  ************************************************************************************/
 static int	elastic_writer_flush(void)
 {
-	struct curl_slist	*curl_headers = NULL;
 	int			i, running, previous, msgnum;
 	CURLMsg			*msg;
 	zbx_vector_ptr_t	retries;
-	CURLcode		err;
+	zbx_hc_storage_stats_t	stats;
+	double			time_start;
 	int			ret = SUCCEED;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -440,24 +624,19 @@ static int	elastic_writer_flush(void)
 
 	zbx_vector_ptr_create(&retries);
 
-	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/x-ndjson");
+	memset(&stats, 0, sizeof(stats));
+	time_start = zbx_time();
 
-	for (i = 0; i < writer.ifaces.values_num; i++)
+	for (i = 0; i < writer.bulks.values_num; i++)
 	{
-		zbx_history_iface_t	*hist = (zbx_history_iface_t *)writer.ifaces.values[i];
-		zbx_elastic_data_t	*data = hist->data.elastic_data;
+		zbx_elastic_bulk_t	*bulk = (zbx_elastic_bulk_t *)writer.bulks.values[i];
 
-		if (CURLE_OK != (err = curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, curl_headers)))
-		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)CURLOPT_HTTPHEADER,
-					curl_easy_strerror(err));
-			ret = FAIL;
-			goto clean;
-		}
-
-		zabbix_log(LOG_LEVEL_DEBUG, "sending %s", data->buf);
+		stats.bytes += bulk->size;
+		stats.bytes_sent += bulk->buf_offset;
 	}
 
+	stats.requests = (zbx_uint64_t)writer.bulks.values_num;
+
 try_again:
 	previous = 0;
 
@@ -567,8 +746,13 @@ try_again:
 		sleep(ZBX_HISTORY_STORAGE_DOWN / 1000);
 		goto try_again;
 	}
-clean:
-	curl_slist_free_all(curl_headers);
+
+	stats.flushes = 1;
+	stats.time = stats.time_max = zbx_time() - time_start;
+	zbx_hc_update_storage_stats(&stats);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() requests:" ZBX_FS_UI64 " bytes:" ZBX_FS_UI64 " sent:" ZBX_FS_UI64
+			" time:" ZBX_FS_DBL, __func__, stats.requests, stats.bytes, stats.bytes_sent, stats.time);
 
 	zbx_vector_ptr_destroy(&retries);
 
@@ -859,28 +1043,23 @@ out:
  ************************************************************************************/
 static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t *history)
 {
-	zbx_elastic_data_t	*data = hist->data.elastic_data;
 	int			i, num = 0;
 	ZBX_DC_HISTORY		*h;
-	struct zbx_json		json_idx, json;
-	size_t			buf_alloc = 0, buf_offset = 0;
-	char			pipeline[14]; /* index name length + suffix "-pipeline" */
+	zbx_elastic_bulk_t	*bulk = NULL;
+	char			index[64];
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_json_init(&json_idx, ZBX_IDX_JSON_ALLOCATE);
-
-	zbx_json_addobject(&json_idx, "index");
-	zbx_json_addstring(&json_idx, "_index", value_type_str[hist->value_type], ZBX_JSON_TYPE_STRING);
-
 	if (1 == CONFIG_HISTORY_STORAGE_PIPELINES)
 	{
-		zbx_snprintf(pipeline, sizeof(pipeline), "%s-pipeline", value_type_str[hist->value_type]);
-		zbx_json_addstring(&json_idx, "pipeline", pipeline, ZBX_JSON_TYPE_STRING);
+		zbx_snprintf(index, sizeof(index), "{\"index\":{\"_index\":\"%s\",\"pipeline\":\"%s-pipeline\"}}\n",
+				value_type_str[hist->value_type], value_type_str[hist->value_type]);
+	}
+	else
+	{
+		zbx_snprintf(index, sizeof(index), "{\"index\":{\"_index\":\"%s\"}}\n",
+				value_type_str[hist->value_type]);
 	}
-
-	zbx_json_close(&json_idx);
-	zbx_json_close(&json_idx);
 
 	for (i = 0; i < history->values_num; i++)
 	{
@@ -889,44 +1068,27 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
 		if (hist->value_type != h->value_type)
 			continue;
 
-		zbx_json_init(&json, ZBX_JSON_ALLOCATE);
-
-		zbx_json_adduint64(&json, "itemid", h->itemid);
-
-		zbx_json_addstring(&json, "value", history_value2str(h), ZBX_JSON_TYPE_STRING);
-
-		if (ITEM_VALUE_TYPE_LOG == h->value_type)
+		if (NULL == bulk)
 		{
-			const zbx_log_value_t	*log;
-
-			log = h->value.log;
-
-			zbx_json_adduint64(&json, "timestamp", log->timestamp);
-			zbx_json_addstring(&json, "source", ZBX_NULL2EMPTY_STR(log->source), ZBX_JSON_TYPE_STRING);
-			zbx_json_adduint64(&json, "severity", log->severity);
-			zbx_json_adduint64(&json, "logeventid", log->logeventid);
+			bulk = (zbx_elastic_bulk_t *)zbx_malloc(NULL, sizeof(zbx_elastic_bulk_t));
+			memset(bulk, 0, sizeof(zbx_elastic_bulk_t));
 		}
 
-		zbx_json_adduint64(&json, "clock", h->ts.sec);
-		zbx_json_adduint64(&json, "ns", h->ts.ns);
-		zbx_json_adduint64(&json, "ttl", h->ttl);
-
-		zbx_json_close(&json);
+		zbx_strcpy_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, index);
+		elastic_bulk_add_value(bulk, h);
 
-		zbx_snprintf_alloc(&data->buf, &buf_alloc, &buf_offset, "%s\n%s\n", json_idx.buffer, json.buffer);
-
-		zbx_json_free(&json);
+		/* start parallel request when the bulk size limit is reached */
+		if (CONFIG_HISTORY_STORAGE_BULK_SIZE <= bulk->buf_offset)
+		{
+			elastic_writer_add_bulk(hist, bulk);
+			bulk = NULL;
+		}
 
 		num++;
 	}
 
-	if (num > 0)
-	{
-		data->post_url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
-		elastic_writer_add_iface(hist);
-	}
-
-	zbx_json_free(&json_idx);
+	if (NULL != bulk)
+		elastic_writer_add_bulk(hist, bulk);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
@@ -976,7 +1138,6 @@ int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	memset(data, 0, sizeof(zbx_elastic_data_t));
 	data->base_url = zbx_strdup(NULL, CONFIG_HISTORY_STORAGE_URL);
 	zbx_rtrim(data->base_url, "/");
-	data->buf = NULL;
 	data->post_url = NULL;
 	data->handle = NULL;
 
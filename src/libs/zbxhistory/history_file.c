@@ -0,0 +1,1225 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "log.h"
+#include "zbxalgo.h"
+#include "dbcache.h"
+#include "zbxhistory.h"
+
+#include "history.h"
+
+/* Numeric history is stored in append-only segment files:                          */
+/*                                                                                  */
+/*   <HistoryFileDir>/<table>/<YYYYMMDD>/<pid>.dat - data blocks                    */
+/*   <HistoryFileDir>/<table>/<YYYYMMDD>/<pid>.idx - block index                    */
+/*   <HistoryFileDir>/<table>/<YYYYMMDD>/<pid>.iix - item index                     */
+/*                                                                                  */
+/* Every history syncer writes its own segment files, one block per flush and day.  */
+/* A block consists of header, item directory sorted by itemid and item data. Item  */
+/* data is stored by columns - clocks, nanoseconds and values, all encoded as       */
+/* variable length integers. Clocks and unsigned values are delta encoded, floating */
+/* point values are xor encoded with the previous value. The index entry is written */
+/* after the block, so readers see only completely written blocks.                  */
+/*                                                                                  */
+/* Item index is built by readers for the days before the current day. It lists the */
+/* item data locations of the indexed blocks sorted by itemid, so values of one     */
+/* item are read without going through all block directories. Blocks appended      */
+/* after the item index was built are read through the block index until the item  */
+/* index is rebuilt.                                                                */
+
+#define ZBX_HF_BLOCK_MAGIC	0x5a424846	/* "ZBHF" */
+#define ZBX_HF_ITEM_INDEX_MAGIC	0x5a424949	/* "ZBII" */
+#define ZBX_HF_ITEM_INDEX_BATCH	64
+#define ZBX_HF_DAY_LEN		8		/* YYYYMMDD */
+
+extern char	*CONFIG_HISTORY_FILE_DIR;
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_timespec_t	ts;
+	history_value_t	value;
+}
+zbx_hf_value_t;
+
+ZBX_VECTOR_DECL(hf_value, zbx_hf_value_t)
+ZBX_VECTOR_IMPL(hf_value, zbx_hf_value_t)
+
+typedef struct
+{
+	/* the table name, used as data directory name */
+	const char		*table;
+
+	/* the values waiting to be flushed */
+	zbx_vector_hf_value_t	values;
+}
+zbx_hf_data_t;
+
+typedef struct
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	items_num;
+	zbx_uint32_t	values_num;
+	zbx_uint32_t	size;
+}
+zbx_hf_block_header_t;
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint32_t	offset;
+	zbx_uint32_t	values_num;
+}
+zbx_hf_block_item_t;
+
+typedef struct
+{
+	zbx_uint64_t	offset;
+	zbx_uint32_t	size;
+	zbx_uint32_t	items_num;
+	int		clock_min;
+	int		clock_max;
+}
+zbx_hf_index_t;
+
+typedef struct
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	blocks_num;	/* the number of indexed blocks */
+	zbx_uint64_t	entries_num;
+}
+zbx_hf_item_index_header_t;
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	offset;		/* the item data offset in data file */
+	zbx_uint32_t	size;
+	zbx_uint32_t	values_num;
+	int		clock_min;	/* the block clock range */
+	int		clock_max;
+}
+zbx_hf_item_index_t;
+
+ZBX_VECTOR_DECL(hf_item_index, zbx_hf_item_index_t)
+ZBX_VECTOR_IMPL(hf_item_index, zbx_hf_item_index_t)
+
+typedef struct
+{
+	unsigned char	*data;
+	size_t		alloc;
+	size_t		offset;
+}
+zbx_hf_buffer_t;
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * value encoding                                                                                                 *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+static void	hf_buffer_reserve(zbx_hf_buffer_t *buf, size_t size)
+{
+	if (buf->offset + size <= buf->alloc)
+		return;
+
+	while (buf->offset + size > buf->alloc)
+		buf->alloc = (0 == buf->alloc ? ZBX_KIBIBYTE : buf->alloc * 2);
+
+	buf->data = (unsigned char *)zbx_realloc(buf->data, buf->alloc);
+}
+
+static void	hf_write_uint(zbx_hf_buffer_t *buf, zbx_uint64_t value)
+{
+	hf_buffer_reserve(buf, 10);
+
+	while (0x80 <= value)
+	{
+		buf->data[buf->offset++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+
+	buf->data[buf->offset++] = (unsigned char)value;
+}
+
+static int	hf_read_uint(const unsigned char **ptr, const unsigned char *end, zbx_uint64_t *value)
+{
+	int	shift;
+
+	*value = 0;
+
+	for (shift = 0; shift < 64; shift += 7)
+	{
+		if (*ptr >= end)
+			return FAIL;
+
+		*value |= (zbx_uint64_t)(**ptr & 0x7f) << shift;
+
+		if (0 == (*(*ptr)++ & 0x80))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+static zbx_uint64_t	hf_zigzag_encode(zbx_uint64_t delta)
+{
+	return (delta << 1) ^ (0 != (delta >> 63) ? ~__UINT64_C(0) : 0);
+}
+
+static zbx_uint64_t	hf_zigzag_decode(zbx_uint64_t value)
+{
+	return (value >> 1) ^ (0 != (value & 1) ? ~__UINT64_C(0) : 0);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: write floating point value xor encoded with the previous value    *
+ *                                                                            *
+ * Comments: Only the significant bytes of xor result are written, prefixed   *
+ *           with the number of trailing zero bytes. Repeated values take one *
+ *           byte.                                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	hf_write_dbl(zbx_hf_buffer_t *buf, zbx_uint64_t bits, zbx_uint64_t prev)
+{
+	zbx_uint64_t	diff = bits ^ prev;
+	unsigned char	zeros = 0;
+
+	while (8 > zeros && 0 == (diff & 0xff))
+	{
+		diff >>= 8;
+		zeros++;
+	}
+
+	hf_buffer_reserve(buf, 1);
+	buf->data[buf->offset++] = zeros;
+
+	if (8 != zeros)
+		hf_write_uint(buf, diff);
+}
+
+static int	hf_read_dbl(const unsigned char **ptr, const unsigned char *end, zbx_uint64_t *bits)
+{
+	unsigned char	zeros;
+	zbx_uint64_t	diff;
+
+	if (*ptr >= end || 8 < (zeros = *(*ptr)++))
+		return FAIL;
+
+	if (8 == zeros)
+		return SUCCEED;
+
+	if (SUCCEED != hf_read_uint(ptr, end, &diff))
+		return FAIL;
+
+	*bits ^= diff << (zeros * 8);
+
+	return SUCCEED;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * segment files                                                                                                  *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+static void	hf_day_name(int clock, char *name, size_t name_len)
+{
+	time_t		day = (time_t)clock;
+	struct tm	*tm;
+
+	tm = gmtime(&day);
+	zbx_snprintf(name, name_len, "%04d%02d%02d", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+}
+
+static int	hf_mkdir(const char *path)
+{
+	if (0 != mkdir(path, 0755) && EEXIST != errno)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create history directory \"%s\": %s", path,
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+static int	hf_write_all(int fd, const void *data, size_t size, const char *path)
+{
+	const char	*ptr = (const char *)data;
+	ssize_t		n;
+
+	while (0 < size)
+	{
+		if (-1 == (n = write(fd, ptr, size)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			zabbix_log(LOG_LEVEL_WARNING, "cannot write history file \"%s\": %s", path,
+					zbx_strerror(errno));
+			return FAIL;
+		}
+
+		ptr += n;
+		size -= (size_t)n;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append one block of values to the day segment files               *
+ *                                                                            *
+ * Parameters: table      - [IN] the table name                               *
+ *             values     - [IN] the values of one day sorted by itemid and   *
+ *                               timestamp                                    *
+ *             values_num - [IN] the number of values                         *
+ *             value_type - [IN] the value type                               *
+ *                                                                            *
+ * Return value: SUCCEED - the block was written                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hf_write_block(const char *table, const zbx_hf_value_t *values, int values_num,
+		unsigned char value_type)
+{
+	zbx_hf_buffer_t		buf = {NULL, 0, 0};
+	zbx_hf_block_header_t	header;
+	zbx_hf_block_item_t	*item;
+	zbx_hf_index_t		index;
+	int			i, j, k, n, items_num = 0, fd, ret = FAIL;
+	char			day[ZBX_HF_DAY_LEN + 1], *path = NULL;
+	off_t			offset;
+
+	for (i = 0; i < values_num; i++)
+	{
+		if (0 == i || values[i].itemid != values[i - 1].itemid)
+			items_num++;
+	}
+
+	hf_buffer_reserve(&buf, sizeof(header) + items_num * sizeof(zbx_hf_block_item_t));
+	buf.offset = sizeof(header) + items_num * sizeof(zbx_hf_block_item_t);
+
+	index.clock_min = values[0].ts.sec;
+	index.clock_max = values[0].ts.sec;
+
+	for (i = 0, n = 0; i < values_num; i = j, n++)
+	{
+		zbx_uint64_t	prev = 0;
+
+		for (j = i; j < values_num && values[j].itemid == values[i].itemid; j++)
+		{
+			if (values[j].ts.sec < index.clock_min)
+				index.clock_min = values[j].ts.sec;
+
+			if (values[j].ts.sec > index.clock_max)
+				index.clock_max = values[j].ts.sec;
+		}
+
+		/* the directory is addressed after each item as buffer might have been reallocated */
+		item = (zbx_hf_block_item_t *)(buf.data + sizeof(header)) + n;
+		item->itemid = values[i].itemid;
+		item->offset = (zbx_uint32_t)buf.offset;
+		item->values_num = (zbx_uint32_t)(j - i);
+
+		for (k = i; k < j; k++)
+		{
+			hf_write_uint(&buf, hf_zigzag_encode((zbx_uint64_t)values[k].ts.sec - prev));
+			prev = (zbx_uint64_t)values[k].ts.sec;
+		}
+
+		for (k = i; k < j; k++)
+			hf_write_uint(&buf, (zbx_uint64_t)values[k].ts.ns);
+
+		for (k = i, prev = 0; k < j; k++)
+		{
+			if (ITEM_VALUE_TYPE_FLOAT == value_type)
+			{
+				zbx_uint64_t	bits;
+
+				memcpy(&bits, &values[k].value.dbl, sizeof(bits));
+				hf_write_dbl(&buf, bits, prev);
+				prev = bits;
+			}
+			else
+			{
+				hf_write_uint(&buf, hf_zigzag_encode(values[k].value.ui64 - prev));
+				prev = values[k].value.ui64;
+			}
+		}
+
+	}
+
+	header.magic = ZBX_HF_BLOCK_MAGIC;
+	header.items_num = (zbx_uint32_t)items_num;
+	header.values_num = (zbx_uint32_t)values_num;
+	header.size = (zbx_uint32_t)buf.offset;
+	memcpy(buf.data, &header, sizeof(header));
+
+	hf_day_name(values[0].ts.sec, day, sizeof(day));
+
+	path = zbx_dsprintf(path, "%s/%s", CONFIG_HISTORY_FILE_DIR, table);
+	if (SUCCEED != hf_mkdir(path))
+		goto out;
+
+	path = zbx_dsprintf(path, "%s/%s/%s", CONFIG_HISTORY_FILE_DIR, table, day);
+	if (SUCCEED != hf_mkdir(path))
+		goto out;
+
+	path = zbx_dsprintf(path, "%s/%s/%s/%d.dat", CONFIG_HISTORY_FILE_DIR, table, day, (int)getpid());
+
+	if (-1 == (fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0640)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history file \"%s\": %s", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	/* only this process appends to the file, so the end of file is the block offset */
+	if ((off_t)-1 == (offset = lseek(fd, 0, SEEK_END)) || SUCCEED != hf_write_all(fd, buf.data, buf.offset, path))
+	{
+		close(fd);
+		goto out;
+	}
+
+	close(fd);
+
+	index.offset = (zbx_uint64_t)offset;
+	index.size = (zbx_uint32_t)buf.offset;
+	index.items_num = (zbx_uint32_t)items_num;
+
+	path = zbx_dsprintf(path, "%s/%s/%s/%d.idx", CONFIG_HISTORY_FILE_DIR, table, day, (int)getpid());
+
+	if (-1 == (fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0640)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history file \"%s\": %s", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	ret = hf_write_all(fd, &index, sizeof(index), path);
+	close(fd);
+out:
+	zbx_free(path);
+	zbx_free(buf.data);
+
+	return ret;
+}
+
+static int	hf_item_index_itemid_compare(const void *d1, const void *d2)
+{
+	const zbx_hf_item_index_t	*e1 = (const zbx_hf_item_index_t *)d1;
+	const zbx_hf_item_index_t	*e2 = (const zbx_hf_item_index_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(e1->itemid, e2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item values from data file                                   *
+ *                                                                            *
+ * Parameters: fd         - [IN] the data file                                *
+ *             offset     - [IN] the item data offset                         *
+ *             size       - [IN] the item data size                           *
+ *             values_num - [IN] the number of item values                    *
+ *             start      - [IN] the period start timestamp (exclusive)       *
+ *             end        - [IN] the period end timestamp (inclusive)         *
+ *             value_type - [IN] the value type                               *
+ *             values     - [OUT] the item values                             *
+ *                                                                            *
+ * Return value: SUCCEED - the item data was read                             *
+ *               FAIL    - the item data is corrupted                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	hf_read_item_data(int fd, zbx_uint64_t offset, zbx_uint32_t size, zbx_uint32_t values_num,
+		int start, int end, unsigned char value_type, zbx_vector_history_record_t *values)
+{
+	unsigned char		*data;
+	const unsigned char	*ptr, *ptr_end;
+	zbx_uint64_t		value, clock = 0, prev = 0;
+	zbx_history_record_t	*records = NULL;
+	int			i, ret = FAIL;
+
+	data = (unsigned char *)zbx_malloc(NULL, size);
+
+	if ((ssize_t)size != pread(fd, data, size, (off_t)offset))
+		goto out;
+
+	ptr = data;
+	ptr_end = data + size;
+	records = (zbx_history_record_t *)zbx_malloc(NULL, values_num * sizeof(zbx_history_record_t));
+
+	for (i = 0; i < (int)values_num; i++)
+	{
+		if (SUCCEED != hf_read_uint(&ptr, ptr_end, &value))
+			goto out;
+
+		clock += hf_zigzag_decode(value);
+		records[i].timestamp.sec = (int)clock;
+	}
+
+	for (i = 0; i < (int)values_num; i++)
+	{
+		if (SUCCEED != hf_read_uint(&ptr, ptr_end, &value))
+			goto out;
+
+		records[i].timestamp.ns = (int)value;
+	}
+
+	for (i = 0; i < (int)values_num; i++)
+	{
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			if (SUCCEED != hf_read_dbl(&ptr, ptr_end, &prev))
+				goto out;
+
+			memcpy(&records[i].value.dbl, &prev, sizeof(prev));
+		}
+		else
+		{
+			if (SUCCEED != hf_read_uint(&ptr, ptr_end, &value))
+				goto out;
+
+			prev += hf_zigzag_decode(value);
+			records[i].value.ui64 = prev;
+		}
+	}
+
+	for (i = 0; i < (int)values_num; i++)
+	{
+		if (records[i].timestamp.sec <= start || records[i].timestamp.sec > end)
+			continue;
+
+		zbx_vector_history_record_append_ptr(values, &records[i]);
+	}
+
+	ret = SUCCEED;
+out:
+	zbx_free(records);
+	zbx_free(data);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item directory of one block of data file                     *
+ *                                                                            *
+ * Parameters: fd      - [IN] the data file                                   *
+ *             index   - [IN] the block index entry                           *
+ *             entries - [OUT] the item data locations of the block           *
+ *                                                                            *
+ * Return value: SUCCEED - the block directory was read                       *
+ *               FAIL    - the block is corrupted                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	hf_read_block_items(int fd, const zbx_hf_index_t *index, zbx_vector_hf_item_index_t *entries)
+{
+	zbx_hf_block_header_t	*header;
+	zbx_hf_block_item_t	*items;
+	zbx_hf_item_index_t	entry;
+	unsigned char		*data;
+	size_t			dir_size;
+	zbx_uint32_t		i, data_end;
+	int			ret = FAIL;
+
+	dir_size = sizeof(zbx_hf_block_header_t) + index->items_num * sizeof(zbx_hf_block_item_t);
+
+	if (dir_size > index->size)
+		return FAIL;
+
+	data = (unsigned char *)zbx_malloc(NULL, dir_size);
+
+	if ((ssize_t)dir_size != pread(fd, data, dir_size, (off_t)index->offset))
+		goto out;
+
+	header = (zbx_hf_block_header_t *)data;
+	items = (zbx_hf_block_item_t *)(data + sizeof(zbx_hf_block_header_t));
+
+	if (ZBX_HF_BLOCK_MAGIC != header->magic || index->items_num != header->items_num ||
+			index->size != header->size)
+	{
+		goto out;
+	}
+
+	for (i = 0; i < header->items_num; i++)
+	{
+		data_end = (i + 1 < header->items_num ? items[i + 1].offset : header->size);
+
+		if (items[i].offset < dir_size || items[i].offset >= data_end || data_end > header->size)
+			goto out;
+
+		entry.itemid = items[i].itemid;
+		entry.offset = index->offset + items[i].offset;
+		entry.size = data_end - items[i].offset;
+		entry.values_num = items[i].values_num;
+		entry.clock_min = index->clock_min;
+		entry.clock_max = index->clock_max;
+		zbx_vector_hf_item_index_append(entries, entry);
+	}
+
+	ret = SUCCEED;
+out:
+	zbx_free(data);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item values from one block of data file                      *
+ *                                                                            *
+ * Parameters: fd         - [IN] the data file                                *
+ *             index      - [IN] the block index entry                        *
+ *             itemid     - [IN] the item                                     *
+ *             start      - [IN] the period start timestamp (exclusive)       *
+ *             end        - [IN] the period end timestamp (inclusive)         *
+ *             value_type - [IN] the value type                               *
+ *             values     - [OUT] the item values                             *
+ *                                                                            *
+ * Return value: SUCCEED - the block was read                                 *
+ *               FAIL    - the block is corrupted                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	hf_read_block(int fd, const zbx_hf_index_t *index, zbx_uint64_t itemid, int start, int end,
+		unsigned char value_type, zbx_vector_history_record_t *values)
+{
+	zbx_vector_hf_item_index_t	entries;
+	zbx_hf_item_index_t		entry_local;
+	int				i, ret;
+
+	zbx_vector_hf_item_index_create(&entries);
+
+	entry_local.itemid = itemid;
+
+	/* block directory is sorted by itemid */
+	if (SUCCEED == (ret = hf_read_block_items(fd, index, &entries)) && FAIL != (i =
+			zbx_vector_hf_item_index_bsearch(&entries, entry_local, hf_item_index_itemid_compare)))
+	{
+		const zbx_hf_item_index_t	*entry = &entries.values[i];
+
+		ret = hf_read_item_data(fd, entry->offset, entry->size, entry->values_num, start, end, value_type,
+				values);
+	}
+
+	zbx_vector_hf_item_index_destroy(&entries);
+
+	return ret;
+}
+
+static int	hf_item_index_compare(const void *d1, const void *d2)
+{
+	const zbx_hf_item_index_t	*e1 = (const zbx_hf_item_index_t *)d1;
+	const zbx_hf_item_index_t	*e2 = (const zbx_hf_item_index_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(e1->itemid, e2->itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(e1->offset, e2->offset);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: build item index of segment file                                  *
+ *                                                                            *
+ * Parameters: path      - [IN] the item index file path                      *
+ *             fd        - [IN] the data file                                 *
+ *             index     - [IN] the block index                               *
+ *             index_num - [IN] the number of blocks                          *
+ *                                                                            *
+ * Return value: SUCCEED - the item index was written                         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The index is written to temporary file and renamed, so readers   *
+ *           never see partially written item index.                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hf_item_index_build(const char *path, int fd, const zbx_hf_index_t *index, int index_num)
+{
+	zbx_vector_hf_item_index_t	entries;
+	zbx_hf_item_index_header_t	header;
+	char				*tmp;
+	int				i, fd_tmp, ret = FAIL;
+
+	zbx_vector_hf_item_index_create(&entries);
+
+	for (i = 0; i < index_num; i++)
+	{
+		if (SUCCEED != hf_read_block_items(fd, &index[i], &entries))
+		{
+			zbx_vector_hf_item_index_destroy(&entries);
+			return FAIL;
+		}
+	}
+
+	zbx_vector_hf_item_index_sort(&entries, hf_item_index_compare);
+
+	header.magic = ZBX_HF_ITEM_INDEX_MAGIC;
+	header.blocks_num = (zbx_uint32_t)index_num;
+	header.entries_num = (zbx_uint64_t)entries.values_num;
+
+	tmp = zbx_dsprintf(NULL, "%s.%d", path, (int)getpid());
+
+	if (-1 == (fd_tmp = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0640)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history file \"%s\": %s", tmp, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (SUCCEED == hf_write_all(fd_tmp, &header, sizeof(header), tmp) && SUCCEED == hf_write_all(fd_tmp,
+			entries.values, (size_t)entries.values_num * sizeof(zbx_hf_item_index_t), tmp))
+	{
+		ret = SUCCEED;
+	}
+
+	close(fd_tmp);
+
+	if (SUCCEED == ret && 0 != rename(tmp, path))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot rename history file \"%s\": %s", tmp, zbx_strerror(errno));
+		ret = FAIL;
+	}
+
+	if (SUCCEED != ret)
+		unlink(tmp);
+out:
+	zbx_free(tmp);
+	zbx_vector_hf_item_index_destroy(&entries);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item data locations from item index of segment file          *
+ *                                                                            *
+ * Parameters: path       - [IN] the item index file path                     *
+ *             itemid     - [IN] the item                                     *
+ *             blocks_num - [OUT] the number of indexed blocks                *
+ *             entries    - [OUT] the item data locations                     *
+ *                                                                            *
+ * Return value: SUCCEED - the item index was read                            *
+ *               FAIL    - the item index does not exist or is corrupted      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hf_item_index_read(const char *path, zbx_uint64_t itemid, int *blocks_num,
+		zbx_vector_hf_item_index_t *entries)
+{
+	zbx_hf_item_index_header_t	header;
+	zbx_hf_item_index_t		batch[ZBX_HF_ITEM_INDEX_BATCH];
+	zbx_uint64_t			lo, hi, mid;
+	zbx_stat_t			st;
+	ssize_t				n;
+	int				fd, i, ret = FAIL;
+
+	if (-1 == (fd = open(path, O_RDONLY)))
+		return FAIL;
+
+	if (0 != zbx_fstat(fd, &st) || (ssize_t)sizeof(header) != read(fd, &header, sizeof(header)) ||
+			ZBX_HF_ITEM_INDEX_MAGIC != header.magic ||
+			(zbx_uint64_t)st.st_size != sizeof(header) + header.entries_num * sizeof(zbx_hf_item_index_t))
+	{
+		goto out;
+	}
+
+	/* find the first entry of the item */
+	for (lo = 0, hi = header.entries_num; lo < hi;)
+	{
+		mid = lo + (hi - lo) / 2;
+
+		if ((ssize_t)sizeof(zbx_hf_item_index_t) != pread(fd, batch, sizeof(zbx_hf_item_index_t),
+				(off_t)(sizeof(header) + mid * sizeof(zbx_hf_item_index_t))))
+		{
+			goto out;
+		}
+
+		if (batch[0].itemid < itemid)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (; lo < header.entries_num; lo += (zbx_uint64_t)n)
+	{
+		n = MIN(ZBX_HF_ITEM_INDEX_BATCH, (ssize_t)(header.entries_num - lo));
+
+		if ((ssize_t)(n * sizeof(zbx_hf_item_index_t)) != pread(fd, batch, n * sizeof(zbx_hf_item_index_t),
+				(off_t)(sizeof(header) + lo * sizeof(zbx_hf_item_index_t))))
+		{
+			goto out;
+		}
+
+		for (i = 0; i < n && batch[i].itemid == itemid; i++)
+			zbx_vector_hf_item_index_append(entries, batch[i]);
+
+		if (i < n)
+			break;
+	}
+
+	*blocks_num = (int)header.blocks_num;
+	ret = SUCCEED;
+out:
+	close(fd);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item values from segment file using its item index           *
+ *                                                                            *
+ * Parameters: path       - [IN] the data file path                           *
+ *             fd         - [IN] the data file                                *
+ *             index      - [IN] the block index                              *
+ *             index_num  - [IN] the number of blocks                         *
+ *             itemid     - [IN] the item                                     *
+ *             start      - [IN] the period start timestamp (exclusive)       *
+ *             end        - [IN] the period end timestamp (inclusive)         *
+ *             value_type - [IN] the value type                               *
+ *             values     - [OUT] the item values                             *
+ *                                                                            *
+ * Return value: the number of blocks read through item index                 *
+ *                                                                            *
+ * Comments: The item index is (re)built if it does not cover all blocks.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	hf_read_day_indexed(const char *path, int fd, const zbx_hf_index_t *index, int index_num,
+		zbx_uint64_t itemid, int start, int end, unsigned char value_type, zbx_vector_history_record_t *values)
+{
+	zbx_vector_hf_item_index_t	entries;
+	char				*iix;
+	int				i, blocks_num = 0;
+
+	zbx_vector_hf_item_index_create(&entries);
+
+	iix = zbx_strdup(NULL, path);
+	memcpy(iix + strlen(iix) - 3, "iix", 3);
+
+	/* item index built by another process might cover more blocks, all indexed blocks are complete */
+	if (SUCCEED != hf_item_index_read(iix, itemid, &blocks_num, &entries) || blocks_num < index_num)
+	{
+		zbx_vector_hf_item_index_clear(&entries);
+		blocks_num = 0;
+
+		if (SUCCEED == hf_item_index_build(iix, fd, index, index_num) &&
+				SUCCEED != hf_item_index_read(iix, itemid, &blocks_num, &entries))
+		{
+			zbx_vector_hf_item_index_clear(&entries);
+			blocks_num = 0;
+		}
+	}
+
+	for (i = 0; i < entries.values_num; i++)
+	{
+		const zbx_hf_item_index_t	*entry = &entries.values[i];
+
+		if (entry->clock_max <= start || entry->clock_min > end)
+			continue;
+
+		if (SUCCEED != hf_read_item_data(fd, entry->offset, entry->size, entry->values_num, start, end,
+				value_type, values))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "corrupted history item data at offset " ZBX_FS_UI64
+					" in file \"%s\"", entry->offset, path);
+		}
+	}
+
+	zbx_free(iix);
+	zbx_vector_hf_item_index_destroy(&entries);
+
+	return blocks_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item values from all segment files of one day                *
+ *                                                                            *
+ * Parameters: table      - [IN] the table name                               *
+ *             day        - [IN] the day directory name                       *
+ *             closed     - [IN] 1 if the day is before the current day and   *
+ *                               item index can be built for it               *
+ *             itemid     - [IN] the item                                     *
+ *             start      - [IN] the period start timestamp (exclusive)       *
+ *             end        - [IN] the period end timestamp (inclusive)         *
+ *             value_type - [IN] the value type                               *
+ *             values     - [OUT] the item values                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	hf_read_day(const char *table, const char *day, int closed, zbx_uint64_t itemid, int start, int end,
+		unsigned char value_type, zbx_vector_history_record_t *values)
+{
+	char		*path = NULL, *dir = NULL;
+	DIR		*dp;
+	struct dirent	*d;
+	size_t		len;
+
+	dir = zbx_dsprintf(dir, "%s/%s/%s", CONFIG_HISTORY_FILE_DIR, table, day);
+
+	if (NULL == (dp = opendir(dir)))
+		goto out;
+
+	while (NULL != (d = readdir(dp)))
+	{
+		zbx_hf_index_t	*index = NULL;
+		zbx_stat_t	st;
+		int		fd, i, index_num;
+
+		if (4 > (len = strlen(d->d_name)) || 0 != strcmp(d->d_name + len - 4, ".idx"))
+			continue;
+
+		path = zbx_dsprintf(path, "%s/%s", dir, d->d_name);
+
+		if (-1 == (fd = open(path, O_RDONLY)))
+			continue;
+
+		/* ignore partially written index entry at the end of file */
+		if (0 == zbx_fstat(fd, &st) && 0 != (index_num = (int)(st.st_size / sizeof(zbx_hf_index_t))))
+		{
+			index = (zbx_hf_index_t *)zbx_malloc(NULL, index_num * sizeof(zbx_hf_index_t));
+
+			if ((ssize_t)(index_num * sizeof(zbx_hf_index_t)) != read(fd, index,
+					index_num * sizeof(zbx_hf_index_t)))
+			{
+				index_num = 0;
+			}
+		}
+		else
+			index_num = 0;
+
+		close(fd);
+
+		if (0 != index_num)
+		{
+			memcpy(path + strlen(path) - 3, "dat", 3);
+
+			if (-1 != (fd = open(path, O_RDONLY)))
+			{
+				int	blocks_num = 0;
+
+				if (0 != closed)
+				{
+					blocks_num = hf_read_day_indexed(path, fd, index, index_num, itemid, start, end,
+							value_type, values);
+				}
+
+				/* read the blocks not covered by item index */
+				for (i = blocks_num; i < index_num; i++)
+				{
+					if (index[i].clock_max <= start || index[i].clock_min > end)
+						continue;
+
+					if (SUCCEED != hf_read_block(fd, &index[i], itemid, start, end, value_type,
+							values))
+					{
+						zabbix_log(LOG_LEVEL_WARNING, "corrupted history block at offset "
+								ZBX_FS_UI64 " in file \"%s\"", index[i].offset, path);
+					}
+				}
+
+				close(fd);
+			}
+		}
+
+		zbx_free(index);
+	}
+
+	closedir(dp);
+out:
+	zbx_free(path);
+	zbx_free(dir);
+}
+
+static int	hf_day_compare_desc(const void *d1, const void *d2)
+{
+	return strcmp(*(const char * const *)d2, *(const char * const *)d1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get day directories of the table                                  *
+ *                                                                            *
+ * Parameters: table - [IN] the table name                                    *
+ *             days  - [OUT] the day directory names, newest first            *
+ *                                                                            *
+ ******************************************************************************/
+static void	hf_get_days(const char *table, zbx_vector_str_t *days)
+{
+	char		*dir;
+	DIR		*dp;
+	struct dirent	*d;
+
+	dir = zbx_dsprintf(NULL, "%s/%s", CONFIG_HISTORY_FILE_DIR, table);
+
+	if (NULL != (dp = opendir(dir)))
+	{
+		while (NULL != (d = readdir(dp)))
+		{
+			if (ZBX_HF_DAY_LEN != strlen(d->d_name) || SUCCEED != is_uint31(d->d_name, NULL))
+				continue;
+
+			zbx_vector_str_append(days, zbx_strdup(NULL, d->d_name));
+		}
+
+		closedir(dp);
+	}
+
+	zbx_vector_str_sort(days, hf_day_compare_desc);
+
+	zbx_free(dir);
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * history interface support                                                                                      *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+static int	hf_value_compare(const void *d1, const void *d2)
+{
+	const zbx_hf_value_t	*v1 = (const zbx_hf_value_t *)d1;
+	const zbx_hf_value_t	*v2 = (const zbx_hf_value_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(v1->ts.sec / SEC_PER_DAY, v2->ts.sec / SEC_PER_DAY);
+	ZBX_RETURN_IF_NOT_EQUAL(v1->itemid, v2->itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(v1->ts.sec, v2->ts.sec);
+	ZBX_RETURN_IF_NOT_EQUAL(v1->ts.ns, v2->ts.ns);
+
+	return 0;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: destroys history storage interface                                      *
+ *                                                                                  *
+ * Parameters:  hist - [IN] the history storage interface                           *
+ *                                                                                  *
+ ************************************************************************************/
+static void	file_destroy(zbx_history_iface_t *hist)
+{
+	zbx_hf_data_t	*data = (zbx_hf_data_t *)hist->data.file_data;
+
+	zbx_vector_hf_value_destroy(&data->values);
+	zbx_free(data);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: gets item history data from history storage                             *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              itemid  - [IN] the itemid                                           *
+ *              start   - [IN] the period start timestamp                           *
+ *              count   - [IN] the number of values to read                         *
+ *              end     - [IN] the period end timestamp                             *
+ *              values  - [OUT] the item history data values                        *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
+ *           all values from the specified interval if count is zero. When count    *
+ *           is specified all values of the oldest returned second are read to      *
+ *           ensure that data is cached by seconds.                                 *
+ *                                                                                  *
+ ************************************************************************************/
+static int	file_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
+		zbx_vector_history_record_t *values)
+{
+	zbx_hf_data_t			*data = (zbx_hf_data_t *)hist->data.file_data;
+	zbx_vector_str_t		days;
+	zbx_vector_history_record_t	records;
+	char				start_day[ZBX_HF_DAY_LEN + 1], end_day[ZBX_HF_DAY_LEN + 1],
+					today[ZBX_HF_DAY_LEN + 1];
+	int				i, num;
+
+	if (0 >= end)
+		end = INT_MAX;
+
+	zbx_vector_str_create(&days);
+	zbx_history_record_vector_create(&records);
+
+	hf_day_name(0 < start ? start + 1 : 0, start_day, sizeof(start_day));
+	hf_day_name(INT_MAX == end ? ZBX_JAN_2038 : end, end_day, sizeof(end_day));
+	hf_day_name((int)time(NULL), today, sizeof(today));
+
+	hf_get_days(data->table, &days);
+
+	/* days are sorted newest first, so values are read backwards until enough values are found */
+	for (i = 0; i < days.values_num; i++)
+	{
+		if (0 < strcmp(days.values[i], end_day))
+			continue;
+
+		if (0 > strcmp(days.values[i], start_day))
+			break;
+
+		hf_read_day(data->table, days.values[i], 0 > strcmp(days.values[i], today), itemid, start, end,
+				hist->value_type, &records);
+
+		if (0 < count && count <= records.values_num)
+			break;
+	}
+
+	zbx_vector_history_record_sort(&records, (zbx_compare_func_t)zbx_history_record_compare_desc_func);
+
+	num = records.values_num;
+
+	if (0 < count && count < num)
+	{
+		/* keep all values of the last returned second */
+		for (num = count; num < records.values_num; num++)
+		{
+			if (records.values[num].timestamp.sec != records.values[count - 1].timestamp.sec)
+				break;
+		}
+	}
+
+	zbx_vector_history_record_append_array(values, records.values, num);
+
+	zbx_vector_history_record_destroy(&records);
+	zbx_vector_str_clear_ext(&days, zbx_str_free);
+	zbx_vector_str_destroy(&days);
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: sends history data to the storage                                       *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              history - [IN] the history data vector (may have mixed value types) *
+ *                                                                                  *
+ ************************************************************************************/
+static int	file_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t *history)
+{
+	zbx_hf_data_t	*data = (zbx_hf_data_t *)hist->data.file_data;
+	int		i, num = 0;
+
+	for (i = 0; i < history->values_num; i++)
+	{
+		const ZBX_DC_HISTORY	*h = (const ZBX_DC_HISTORY *)history->values[i];
+		zbx_hf_value_t		value;
+
+		if (h->value_type != hist->value_type)
+			continue;
+
+		value.itemid = h->itemid;
+		value.ts = h->ts;
+		value.value = h->value;
+
+		zbx_vector_hf_value_append(&data->values, value);
+		num++;
+	}
+
+	return num;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: flushes the history data to storage                                     *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *                                                                                  *
+ * Comments: The values are written as one block per day they belong to. Values of  *
+ *           the days that failed to be written are kept and written with the next  *
+ *           flush.                                                                 *
+ *                                                                                  *
+ ************************************************************************************/
+static int	file_flush(zbx_history_iface_t *hist)
+{
+	zbx_hf_data_t	*data = (zbx_hf_data_t *)hist->data.file_data;
+	int		i, j, values_num = 0, ret = FLUSH_SUCCEED;
+
+	zbx_vector_hf_value_sort(&data->values, hf_value_compare);
+
+	for (i = 0; i < data->values.values_num; i = j)
+	{
+		int	day = data->values.values[i].ts.sec / SEC_PER_DAY;
+
+		for (j = i + 1; j < data->values.values_num && day == data->values.values[j].ts.sec / SEC_PER_DAY;
+				j++)
+			;
+
+		if (SUCCEED == hf_write_block(data->table, &data->values.values[i], j - i, hist->value_type))
+			continue;
+
+		/* keep the values that were not written for the next flush */
+		if (values_num != i)
+		{
+			memmove(&data->values.values[values_num], &data->values.values[i],
+					(size_t)(j - i) * sizeof(zbx_hf_value_t));
+		}
+
+		values_num += j - i;
+		ret = FLUSH_FAIL;
+	}
+
+	data->values.values_num = values_num;
+
+	return ret;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: initializes history storage interface                                   *
+ *                                                                                  *
+ * Parameters:  hist       - [IN] the history storage interface                     *
+ *              value_type - [IN] the target value type                             *
+ *              error      - [OUT] the error message                                *
+ *                                                                                  *
+ * Return value: SUCCEED - the history storage interface was initialized            *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_file_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	zbx_hf_data_t	*data;
+
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+	{
+		*error = zbx_strdup(*error, "file history backend supports only numeric value types");
+		return FAIL;
+	}
+
+	if (0 != access(CONFIG_HISTORY_FILE_DIR, W_OK | X_OK))
+	{
+		*error = zbx_dsprintf(*error, "cannot access history directory \"%s\": %s", CONFIG_HISTORY_FILE_DIR,
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	data = (zbx_hf_data_t *)zbx_malloc(NULL, sizeof(zbx_hf_data_t));
+	data->table = (ITEM_VALUE_TYPE_FLOAT == value_type ? "history" : "history_uint");
+	zbx_vector_hf_value_create(&data->values);
+
+	hist->value_type = value_type;
+	hist->data.file_data = data;
+	hist->destroy = file_destroy;
+	hist->add_values = file_add_values;
+	hist->flush = file_flush;
+	hist->get_values = file_get_values;
+	hist->requires_trends = 1;
+
+	return SUCCEED;
+}
@@ -29,11 +29,19 @@ typedef struct
 {
 	unsigned char		initialized;
 	zbx_vector_ptr_t	dbinserts;
+#ifdef HAVE_POSTGRESQL
+	/* statements of the batch being written asynchronously */
+	char			*sql;
+	size_t			sql_alloc;
+	size_t			sql_offset;
+#endif
 }
 zbx_sql_writer_t;
 
 static zbx_sql_writer_t	writer;
 
+extern int	CONFIG_HISTORY_ASYNC_WRITE;
+
 typedef void (*vc_str2value_func_t)(history_value_t *value, DB_ROW row);
 
 /* history table data */
@@ -145,6 +153,75 @@ static void	sql_writer_add_dbinsert(zbx_db_insert_t *db_insert)
 	zbx_vector_ptr_append(&writer.dbinserts, db_insert);
 }
 
+#ifdef HAVE_POSTGRESQL
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: waits until the asynchronously written history batch is stored         *
+ *                                                                                  *
+ * Return value: SUCCEED - the batch was stored or there was no batch in progress   *
+ *               FAIL    - failed to store the batch                                *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_sql_wait(void)
+{
+	int	ret = SUCCEED;
+
+	if (0 == writer.sql_offset)
+		return SUCCEED;
+
+	if (ZBX_DB_OK != DBasync_wait())
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write history to database");
+		ret = FAIL;
+	}
+
+	writer.sql_offset = 0;
+
+	return ret;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: sends bulk insert data to database without waiting for completion       *
+ *                                                                                  *
+ * Return value: SUCCEED - the data was sent                                        *
+ *               FAIL    - failed to send data, it must be flushed synchronously    *
+ *                                                                                  *
+ * Comments: The values are inserted over a separate database connection while the  *
+ *           history syncer continues with item and trend updates. Duplicate values *
+ *           are skipped by the database instead of failing the whole batch.        *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_writer_flush_async(void)
+{
+	int	i;
+
+	zbx_history_sql_wait();
+
+	for (i = 0; i < writer.dbinserts.values_num; i++)
+	{
+		zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)writer.dbinserts.values[i];
+
+		if (0 == db_insert->rows.values_num)
+			continue;
+
+		zbx_db_insert_format_sql(db_insert, &writer.sql, &writer.sql_alloc, &writer.sql_offset);
+		zbx_strcpy_alloc(&writer.sql, &writer.sql_alloc, &writer.sql_offset, " on conflict do nothing;\n");
+	}
+
+	if (0 == writer.sql_offset)
+		return SUCCEED;
+
+	if (ZBX_DB_OK != DBasync_execute(writer.sql))
+	{
+		writer.sql_offset = 0;
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+#endif
+
 /************************************************************************************
  *                                                                                  *
  * Purpose: flushes bulk insert data into database                                  *
@@ -159,6 +236,13 @@ static int	sql_writer_flush(void)
 	if (0 == writer.initialized)
 		return SUCCEED;
 
+#ifdef HAVE_POSTGRESQL
+	if (0 != CONFIG_HISTORY_ASYNC_WRITE && SUCCEED == sql_writer_flush_async())
+	{
+		sql_writer_release();
+		return 0 != writer.sql_offset ? FLUSH_ASYNC : FLUSH_SUCCEED;
+	}
+#endif
 	do
 	{
 		DBbegin();
@@ -328,33 +412,44 @@ static void	add_history_log(const zbx_vector_ptr_t *history)
 static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
 		int seconds, int end_timestamp)
 {
-	char			*sql = NULL;
+	char			*sql = NULL, params_buf[3][MAX_ID_LEN + 1];
 	size_t			sql_alloc = 0, sql_offset = 0;
+	const char		*params[3] = {params_buf[0], params_buf[1], params_buf[2]};
+	int			params_num;
 	DB_RESULT		result;
 	DB_ROW			row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
 
+	/* the same few statements are executed for all items, pass values as parameters to prepare them once */
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select clock,ns,%s"
 			" from %s"
-			" where itemid=" ZBX_FS_UI64,
-			table->fields, table->name, itemid);
+			" where itemid=$1",
+			table->fields, table->name);
+
+	zbx_snprintf(params_buf[0], sizeof(params_buf[0]), ZBX_FS_UI64, itemid);
 
 	if (ZBX_JAN_2038 == end_timestamp)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d", end_timestamp - seconds);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>$2");
+		zbx_snprintf(params_buf[1], sizeof(params_buf[1]), "%d", end_timestamp - seconds);
+		params_num = 2;
 	}
 	else if (1 == seconds)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=$2");
+		zbx_snprintf(params_buf[1], sizeof(params_buf[1]), "%d", end_timestamp);
+		params_num = 2;
 	}
 	else
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d and clock<=%d",
-				end_timestamp - seconds, end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>$2 and clock<=$3");
+		zbx_snprintf(params_buf[1], sizeof(params_buf[1]), "%d", end_timestamp - seconds);
+		zbx_snprintf(params_buf[2], sizeof(params_buf[2]), "%d", end_timestamp);
+		params_num = 3;
 	}
 
-	result = DBselect("%s", sql);
+	result = DBselect_prepared(sql, params_num, params);
 
 	zbx_free(sql);
 
@@ -96,6 +96,7 @@ extern int	CONFIG_JAVAPOLLER_FORKS;
 extern int	CONFIG_HTTPPOLLER_FORKS;
 extern int	CONFIG_TRAPPER_FORKS;
 extern int	CONFIG_SNMPTRAPPER_FORKS;
+extern int	CONFIG_SNMPTRAPWORKER_FORKS;
 extern int	CONFIG_PROXYPOLLER_FORKS;
 extern int	CONFIG_ESCALATOR_FORKS;
 extern int	CONFIG_HISTSYNCER_FORKS;
@@ -157,6 +158,8 @@ int	get_process_type_forks(unsigned char proc_type)
 			return CONFIG_TRAPPER_FORKS;
 		case ZBX_PROCESS_TYPE_SNMPTRAPPER:
 			return CONFIG_SNMPTRAPPER_FORKS;
+		case ZBX_PROCESS_TYPE_SNMPTRAPWORKER:
+			return CONFIG_SNMPTRAPWORKER_FORKS;
 		case ZBX_PROCESS_TYPE_PROXYPOLLER:
 			return CONFIG_PROXYPOLLER_FORKS;
 		case ZBX_PROCESS_TYPE_ESCALATOR:
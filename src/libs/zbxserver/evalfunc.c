@@ -1167,6 +1167,432 @@ static void	count_one_str(int *count, int op, const char *value, const char *pat
 	}
 }
 
+/* history functions with incremental window state */
+#define ZBX_WINDOW_FUNC_COUNT		0
+#define ZBX_WINDOW_FUNC_SUM		1
+#define ZBX_WINDOW_FUNC_MIN		2
+#define ZBX_WINDOW_FUNC_MAX		3
+#define ZBX_WINDOW_FUNC_PERCENTILE	4
+
+/* the window state is dropped if it was not accessed for this period */
+#define ZBX_WINDOW_STATE_TTL		SEC_PER_HOUR
+
+/* the maximum memory used by window states of one process, functions are */
+/* calculated from item values when the window state does not fit         */
+#define ZBX_WINDOW_STATES_SIZE_MAX	(64 * ZBX_MEBIBYTE)
+
+/* aggregate state of item values in time based window (from, last] */
+typedef struct
+{
+	zbx_uint64_t			itemid;
+	int				func;
+	int				seconds;
+	int				time_shift;
+
+	unsigned char			value_type;
+
+	/* the value cache item revision the state was calculated from */
+	zbx_uint64_t			revision;
+
+	/* the window start (exclusive) */
+	zbx_timespec_t			from;
+
+	/* the timestamp of the newest value accounted in the state */
+	zbx_timespec_t			last;
+
+	/* count/sum - the number and sum of window values */
+	int				values_num;
+	history_value_t			sum;
+
+	/* min/max - monotonic deque of values in ascending timestamp order, */
+	/* percentile - values sorted by value                               */
+	zbx_vector_history_record_t	values;
+
+	/* the number of incremental updates since the state was recalculated */
+	int				updates;
+
+	time_t				lastaccess;
+}
+zbx_eval_window_t;
+
+static zbx_hashset_t	eval_windows;
+static time_t		eval_windows_clean_time;
+static size_t		eval_windows_size;
+
+static zbx_hash_t	eval_window_hash(const void *d)
+{
+	const zbx_eval_window_t	*window = (const zbx_eval_window_t *)d;
+	zbx_hash_t		hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&window->itemid);
+	hash = ZBX_DEFAULT_HASH_ALGO(&window->func, sizeof(window->func), hash);
+	hash = ZBX_DEFAULT_HASH_ALGO(&window->seconds, sizeof(window->seconds), hash);
+
+	return ZBX_DEFAULT_HASH_ALGO(&window->time_shift, sizeof(window->time_shift), hash);
+}
+
+static int	eval_window_compare(const void *d1, const void *d2)
+{
+	const zbx_eval_window_t	*w1 = (const zbx_eval_window_t *)d1;
+	const zbx_eval_window_t	*w2 = (const zbx_eval_window_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(w1->itemid, w2->itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(w1->func, w2->func);
+	ZBX_RETURN_IF_NOT_EQUAL(w1->seconds, w2->seconds);
+
+	return w1->time_shift - w2->time_shift;
+}
+
+static size_t	eval_window_size(const zbx_eval_window_t *window)
+{
+	return sizeof(zbx_eval_window_t) + sizeof(zbx_history_record_t) * (size_t)window->values.values_alloc;
+}
+
+static void	eval_window_clean(zbx_eval_window_t *window)
+{
+	eval_windows_size -= eval_window_size(window);
+	zbx_vector_history_record_destroy(&window->values);
+}
+
+static void	eval_window_reset(zbx_eval_window_t *window, const zbx_timespec_t *from)
+{
+	window->from = *from;
+	window->last = *from;
+	window->values_num = 0;
+	window->updates = 0;
+	memset(&window->sum, 0, sizeof(window->sum));
+	zbx_vector_history_record_clear(&window->values);
+}
+
+static int	eval_window_value_compare(const zbx_eval_window_t *window, const zbx_history_record_t *v1,
+		const zbx_history_record_t *v2)
+{
+	if (ITEM_VALUE_TYPE_FLOAT == window->value_type)
+		return history_record_float_compare(v1, v2);
+
+	return history_record_uint64_compare(v1, v2);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add value to window state                                         *
+ *                                                                            *
+ * Comments: Values must be added in ascending timestamp order.               *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_window_add_value(zbx_eval_window_t *window, const zbx_history_record_t *value)
+{
+	int	index;
+
+	switch (window->func)
+	{
+		case ZBX_WINDOW_FUNC_COUNT:
+			window->values_num++;
+			break;
+		case ZBX_WINDOW_FUNC_SUM:
+			window->values_num++;
+
+			if (ITEM_VALUE_TYPE_FLOAT == window->value_type)
+				window->sum.dbl += value->value.dbl;
+			else
+				window->sum.ui64 += value->value.ui64;
+			break;
+		case ZBX_WINDOW_FUNC_MIN:
+			while (0 != window->values.values_num && 0 <= eval_window_value_compare(window,
+					&window->values.values[window->values.values_num - 1], value))
+			{
+				window->values.values_num--;
+			}
+			zbx_vector_history_record_append_ptr(&window->values, (zbx_history_record_t *)value);
+			break;
+		case ZBX_WINDOW_FUNC_MAX:
+			while (0 != window->values.values_num && 0 >= eval_window_value_compare(window,
+					&window->values.values[window->values.values_num - 1], value))
+			{
+				window->values.values_num--;
+			}
+			zbx_vector_history_record_append_ptr(&window->values, (zbx_history_record_t *)value);
+			break;
+		case ZBX_WINDOW_FUNC_PERCENTILE:
+			if (ITEM_VALUE_TYPE_FLOAT == window->value_type)
+			{
+				index = zbx_vector_history_record_nearestindex(&window->values, *value,
+						(zbx_compare_func_t)history_record_float_compare);
+			}
+			else
+			{
+				index = zbx_vector_history_record_nearestindex(&window->values, *value,
+						(zbx_compare_func_t)history_record_uint64_compare);
+			}
+
+			zbx_vector_history_record_append_ptr(&window->values, (zbx_history_record_t *)value);
+			memmove(&window->values.values[index + 1], &window->values.values[index],
+					sizeof(zbx_history_record_t) * (size_t)(window->values.values_num - index - 1));
+			window->values.values[index] = *value;
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove value that left the window from window state               *
+ *                                                                            *
+ * Comments: Min/max deques are expired by timestamp in eval_window_expire(). *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_window_remove_value(zbx_eval_window_t *window, const zbx_history_record_t *value)
+{
+	int	index;
+
+	if (ZBX_WINDOW_FUNC_PERCENTILE != window->func)
+	{
+		window->values_num--;
+
+		if (ZBX_WINDOW_FUNC_COUNT == window->func)
+			return;
+
+		if (ITEM_VALUE_TYPE_FLOAT == window->value_type)
+			window->sum.dbl -= value->value.dbl;
+		else
+			window->sum.ui64 -= value->value.ui64;
+
+		return;
+	}
+
+	if (ITEM_VALUE_TYPE_FLOAT == window->value_type)
+	{
+		index = zbx_vector_history_record_nearestindex(&window->values, *value,
+				(zbx_compare_func_t)history_record_float_compare);
+	}
+	else
+	{
+		index = zbx_vector_history_record_nearestindex(&window->values, *value,
+				(zbx_compare_func_t)history_record_uint64_compare);
+	}
+
+	if (index < window->values.values_num &&
+			0 == eval_window_value_compare(window, &window->values.values[index], value))
+	{
+		zbx_vector_history_record_remove(&window->values, index);
+	}
+	else
+		THIS_SHOULD_NEVER_HAPPEN;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add values newer than the last accounted value up to the window   *
+ *          end to window state                                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_window_append(zbx_eval_window_t *window, const zbx_timespec_t *ts)
+{
+	zbx_vector_history_record_t	values;
+	int				i, ret = FAIL;
+
+	zbx_history_record_vector_create(&values);
+
+	if (FAIL == zbx_vc_get_values(window->itemid, window->value_type, &values, ts->sec - window->last.sec + 1, 0,
+			ts))
+	{
+		goto out;
+	}
+
+	/* value cache returns values in descending timestamp order */
+	for (i = values.values_num - 1; 0 <= i; i--)
+	{
+		if (0 >= zbx_timespec_compare(&values.values[i].timestamp, &window->last))
+			continue;
+
+		eval_window_add_value(window, &values.values[i]);
+		window->last = values.values[i].timestamp;
+	}
+
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, window->value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove values up to the new window start from window state        *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_window_expire(zbx_eval_window_t *window, const zbx_timespec_t *from)
+{
+	zbx_vector_history_record_t	values;
+	int				i, ret = FAIL;
+
+	if (0 <= zbx_timespec_compare(from, &window->last))
+	{
+		eval_window_reset(window, from);
+		return SUCCEED;
+	}
+
+	if (ZBX_WINDOW_FUNC_MIN == window->func || ZBX_WINDOW_FUNC_MAX == window->func)
+	{
+		for (i = 0; i < window->values.values_num; i++)
+		{
+			if (0 < zbx_timespec_compare(&window->values.values[i].timestamp, from))
+				break;
+		}
+
+		if (0 != i)
+		{
+			memmove(window->values.values, &window->values.values[i],
+					sizeof(zbx_history_record_t) * (size_t)(window->values.values_num - i));
+			window->values.values_num -= i;
+		}
+
+		window->from = *from;
+
+		return SUCCEED;
+	}
+
+	if (0 == zbx_timespec_compare(from, &window->from))
+		return SUCCEED;
+
+	zbx_history_record_vector_create(&values);
+
+	if (FAIL == zbx_vc_get_values(window->itemid, window->value_type, &values, from->sec - window->from.sec + 1, 0,
+			from))
+	{
+		goto out;
+	}
+
+	for (i = 0; i < values.values_num; i++)
+	{
+		if (0 < zbx_timespec_compare(&values.values[i].timestamp, &window->from))
+			eval_window_remove_value(window, &values.values[i]);
+	}
+
+	window->from = *from;
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, window->value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove window states that were not used for a while              *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_windows_clean(time_t now)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_eval_window_t	*window;
+
+	zbx_hashset_iter_reset(&eval_windows, &iter);
+
+	while (NULL != (window = (zbx_eval_window_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (window->lastaccess + ZBX_WINDOW_STATE_TTL < now)
+			zbx_hashset_iter_remove(&iter);
+	}
+
+	eval_windows_clean_time = now;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get aggregate state of item values in time based window           *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             func       - [IN] the aggregate function (ZBX_WINDOW_FUNC_*)   *
+ *             seconds    - [IN] the window length                            *
+ *             time_shift - [IN] the window time shift                        *
+ *             ts         - [IN] the window end (after time shift applied)    *
+ *                                                                            *
+ * Return value: The window state or NULL if it cannot be used - item values  *
+ *               are not cached or cannot be retrieved, or window states      *
+ *               would exceed ZBX_WINDOW_STATES_SIZE_MAX. In this case the    *
+ *               function must be calculated from item values.                *
+ *                                                                            *
+ * Comments: The state is kept between evaluations in the process memory.     *
+ *           When the window moves forward and the cached item data was not   *
+ *           changed (see zbx_vc_get_item_revision()) the state is updated    *
+ *           only with values that entered or left the window, otherwise it   *
+ *           is recalculated from all window values.                          *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_eval_window_t	*eval_window_get(const DC_ITEM *item, int func, int seconds, int time_shift,
+		const zbx_timespec_t *ts)
+{
+	zbx_eval_window_t	*window, window_local;
+	zbx_uint64_t		revision;
+	zbx_timespec_t		from = {ts->sec - seconds, ts->ns};
+	time_t			now;
+	size_t			size;
+	int			ret;
+
+	if (SUCCEED != zbx_vc_get_item_revision(item->itemid, item->value_type, &revision))
+		return NULL;
+
+	if (0 == eval_windows.num_slots)
+	{
+		zbx_hashset_create_ext(&eval_windows, 100, eval_window_hash, eval_window_compare,
+				(zbx_clean_func_t)eval_window_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC,
+				ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	now = time(NULL);
+
+	if (eval_windows_clean_time + ZBX_WINDOW_STATE_TTL < now)
+		eval_windows_clean(now);
+
+	window_local.itemid = item->itemid;
+	window_local.func = func;
+	window_local.seconds = seconds;
+	window_local.time_shift = time_shift;
+
+	if (NULL == (window = (zbx_eval_window_t *)zbx_hashset_search(&eval_windows, &window_local)))
+	{
+		if (ZBX_WINDOW_STATES_SIZE_MAX <= eval_windows_size + sizeof(zbx_eval_window_t))
+			return NULL;
+
+		window = (zbx_eval_window_t *)zbx_hashset_insert(&eval_windows, &window_local, sizeof(window_local));
+		zbx_vector_history_record_create(&window->values);
+		window->value_type = item->value_type;
+		eval_window_reset(window, &from);
+		eval_windows_size += eval_window_size(window);
+	}
+	else if (revision != window->revision || item->value_type != window->value_type ||
+			0 > zbx_timespec_compare(&from, &window->from) ||
+			0 > zbx_timespec_compare(ts, &window->last) ||
+			(ZBX_WINDOW_FUNC_SUM == func && ITEM_VALUE_TYPE_FLOAT == item->value_type &&
+			window->updates > window->values_num))
+	{
+		/* floating point sums are also recalculated periodically to drop accumulated rounding errors */
+		window->value_type = item->value_type;
+		eval_window_reset(window, &from);
+	}
+	else if (SUCCEED != eval_window_expire(window, &from))
+		goto fail;
+	else
+		window->updates++;
+
+	window->lastaccess = now;
+	window->revision = revision;
+
+	size = eval_window_size(window);
+	ret = eval_window_append(window, ts);
+	eval_windows_size += eval_window_size(window) - size;
+
+	/* drop the state that does not fit, the function is calculated from item values instead */
+	if (SUCCEED != ret || ZBX_WINDOW_STATES_SIZE_MAX < eval_windows_size)
+		goto fail;
+
+	return window;
+fail:
+	zbx_hashset_remove_direct(&eval_windows, window);
+
+	return NULL;
+}
+
 /* flags for evaluate_COUNT() */
 #define COUNT_ALL	0
 #define COUNT_UNIQUE	1
@@ -1210,6 +1636,7 @@ static int	evaluate_COUNT(zbx_variant_t *value, const DC_ITEM *item, const char
 	zbx_vector_ptr_t		regexps;
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			ts_end = *ts;
+	zbx_eval_window_t		*window;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() params:%s", __func__, ZBX_NULL2EMPTY_STR(parameters));
 
@@ -1389,6 +1816,17 @@ static int	evaluate_COUNT(zbx_variant_t *value, const DC_ITEM *item, const char
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	/* all values are counted if both pattern and operator are empty or "" is searched in text values */
+	if (ZBX_VALUE_SECONDS == arg1_type && COUNT_ALL == unique && '\0' == *pattern &&
+			(NULL == operator || '\0' == *operator || OP_LIKE == op || OP_REGEXP == op ||
+			OP_IREGEXP == op) &&
+			NULL != (window = eval_window_get(item, ZBX_WINDOW_FUNC_COUNT, seconds, time_shift, &ts_end)))
+	{
+		zbx_variant_set_dbl(value, MIN(window->values_num, limit));
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1539,6 +1977,7 @@ static int	evaluate_SUM(zbx_variant_t *value, const DC_ITEM *item, const char *p
 	zbx_vector_history_record_t	values;
 	history_value_t			result;
 	zbx_timespec_t			ts_end = *ts;
+	zbx_eval_window_t		*window;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1577,6 +2016,14 @@ static int	evaluate_SUM(zbx_variant_t *value, const DC_ITEM *item, const char *p
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	if (ZBX_VALUE_SECONDS == arg1_type &&
+			NULL != (window = eval_window_get(item, ZBX_WINDOW_FUNC_SUM, seconds, time_shift, &ts_end)))
+	{
+		zbx_history_value2variant(&window->sum, item->value_type, value);
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1630,6 +2077,7 @@ static int	evaluate_AVG(zbx_variant_t *value, const DC_ITEM *item, const char *p
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			ts_end = *ts;
+	zbx_eval_window_t		*window;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1668,6 +2116,25 @@ static int	evaluate_AVG(zbx_variant_t *value, const DC_ITEM *item, const char *p
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	if (ZBX_VALUE_SECONDS == arg1_type &&
+			NULL != (window = eval_window_get(item, ZBX_WINDOW_FUNC_SUM, seconds, time_shift, &ts_end)))
+	{
+		if (0 == window->values_num)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "result for AVG is empty");
+			*error = zbx_strdup(*error, "not enough data");
+			goto out;
+		}
+
+		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+			zbx_variant_set_dbl(value, window->sum.dbl / window->values_num);
+		else
+			zbx_variant_set_dbl(value, (double)window->sum.ui64 / window->values_num);
+
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1774,6 +2241,7 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const DC_ITEM *item, const
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			ts_end = *ts;
+	zbx_eval_window_t		*window;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1812,6 +2280,23 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const DC_ITEM *item, const
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	if (ZBX_VALUE_SECONDS == arg1_type && NULL != (window = eval_window_get(item,
+			EVALUATE_MIN == min_or_max ? ZBX_WINDOW_FUNC_MIN : ZBX_WINDOW_FUNC_MAX, seconds, time_shift,
+			&ts_end)))
+	{
+		/* the first value in deque is the window minimum/maximum */
+		if (0 == window->values.values_num)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "result for MIN or MAX is empty");
+			*error = zbx_strdup(*error, "not enough data");
+			goto out;
+		}
+
+		zbx_history_value2variant(&window->values.values[0].value, item->value_type, value);
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1885,6 +2370,7 @@ static int	evaluate_PERCENTILE(zbx_variant_t  *value, const DC_ITEM *item, const
 	double				percentage;
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			ts_end = *ts;
+	zbx_eval_window_t		*window;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1930,6 +2416,29 @@ static int	evaluate_PERCENTILE(zbx_variant_t  *value, const DC_ITEM *item, const
 		goto out;
 	}
 
+	if (ZBX_VALUE_SECONDS == arg1_type &&
+			NULL != (window = eval_window_get(item, ZBX_WINDOW_FUNC_PERCENTILE, seconds, time_shift,
+			&ts_end)))
+	{
+		int	index;
+
+		if (0 == window->values.values_num)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "result for PERCENTILE is empty");
+			*error = zbx_strdup(*error, "not enough data");
+			goto out;
+		}
+
+		if (0 == percentage)
+			index = 1;
+		else
+			index = (int)ceil(window->values.values_num * (percentage / 100));
+
+		zbx_history_value2variant(&window->values.values[index - 1].value, item->value_type, value);
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -3870,6 +4379,12 @@ int	evaluate_function(zbx_variant_t *value, const DC_ITEM *item, const char *fun
 #undef MONODEC
 #undef EVALUATE_MIN
 #undef EVALUATE_MAX
+#undef ZBX_WINDOW_FUNC_COUNT
+#undef ZBX_WINDOW_FUNC_SUM
+#undef ZBX_WINDOW_FUNC_MIN
+#undef ZBX_WINDOW_FUNC_MAX
+#undef ZBX_WINDOW_FUNC_PERCENTILE
+#undef ZBX_WINDOW_STATE_TTL
 
 /******************************************************************************
  *                                                                            *
@@ -43,6 +43,62 @@ zbx_rootcause_t;
 ZBX_VECTOR_DECL(rootcause, zbx_rootcause_t)
 ZBX_VECTOR_IMPL(rootcause, zbx_rootcause_t)
 
+/* item data used by trigger and item based event macros */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	hostid;
+	zbx_uint64_t	proxy_hostid;
+	zbx_uint64_t	valuemapid;
+	char		*name;
+	char		*key;
+	char		*units;
+	char		*error;
+	/* item and host descriptions are not kept in configuration cache, */
+	/* they are read from database when first requested                */
+	char		*description;
+	char		*host_description;
+	unsigned char	value_type;
+}
+zbx_macro_item_t;
+
+typedef struct
+{
+	zbx_uint64_t	hostid;
+	char		*host;
+	/* proxy description is not kept in configuration cache, it's read from database when first requested */
+	char		*description;
+}
+zbx_macro_proxy_t;
+
+typedef struct
+{
+	zbx_uint64_t	triggerid;
+	char		*error;
+}
+zbx_macro_trigger_t;
+
+/* Data used to resolve macros of a single event. It's kept between macro substitutions */
+/* of the same event, so messages rendered for multiple operations, recipients and      */
+/* media types share it. The data is dropped when macros without event or of another    */
+/* event are substituted or it gets older than the default configuration cache update  */
+/* period.                                                                             */
+typedef struct
+{
+	zbx_uint64_t	eventid;
+	time_t		created;
+	zbx_hashset_t	items;
+	zbx_hashset_t	proxies;
+	zbx_hashset_t	triggers;
+}
+zbx_macro_context_t;
+
+#define ZBX_MACRO_CONTEXT_TTL	SEC_PER_MIN
+
+static zbx_macro_context_t	macro_context;
+static int			macro_context_created = 0;
+static int			macro_context_depth = 0;
+
 /* The following definitions are used to identify the request field */
 /* for various value getters grouped by their scope:                */
 
@@ -183,34 +239,209 @@ static int	get_problem_update_actions(const DB_ACKNOWLEDGE *ack, int actions, ch
 	return SUCCEED;
 }
 
+static void	macro_item_clean(zbx_macro_item_t *item)
+{
+	zbx_free(item->name);
+	zbx_free(item->key);
+	zbx_free(item->units);
+	zbx_free(item->error);
+	zbx_free(item->description);
+	zbx_free(item->host_description);
+}
+
+static void	macro_proxy_clean(zbx_macro_proxy_t *proxy)
+{
+	zbx_free(proxy->host);
+	zbx_free(proxy->description);
+}
+
+static void	macro_trigger_clean(zbx_macro_trigger_t *trigger)
+{
+	zbx_free(trigger->error);
+}
+
+static void	macro_context_create(void)
+{
+	if (0 != macro_context_created)
+		return;
+
+	zbx_hashset_create_ext(&macro_context.items, 10, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			(zbx_clean_func_t)macro_item_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&macro_context.proxies, 10, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)macro_proxy_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&macro_context.triggers, 10, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)macro_trigger_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	macro_context.eventid = 0;
+	macro_context.created = 0;
+	macro_context_created = 1;
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: request host name by hostid                                       *
+ * Purpose: prepare data context for substituting macros of the event         *
  *                                                                            *
- * Return value: upon successful completion return SUCCEED                    *
- *               otherwise FAIL                                               *
+ * Parameters: event - [IN] the event, can be NULL                            *
+ *                                                                            *
+ * Comments: Data loaded for the same event is kept, otherwise the context is *
+ *           reset.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	macro_context_set(const ZBX_DB_EVENT *event)
+{
+	zbx_uint64_t	eventid;
+	time_t		now;
+
+	macro_context_create();
+
+	eventid = (NULL != event ? event->eventid : 0);
+	now = time(NULL);
+
+	if (0 != eventid && eventid == macro_context.eventid && ZBX_MACRO_CONTEXT_TTL > now - macro_context.created)
+		return;
+
+	if (0 != macro_context.items.num_data)
+		zbx_hashset_clear(&macro_context.items);
+
+	if (0 != macro_context.proxies.num_data)
+		zbx_hashset_clear(&macro_context.proxies);
+
+	if (0 != macro_context.triggers.num_data)
+		zbx_hashset_clear(&macro_context.triggers);
+
+	macro_context.eventid = eventid;
+	macro_context.created = now;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item data used by event macros, reading it from configuration *
+ *          cache if the item is not in event macro context yet              *
+ *                                                                            *
+ * Return value: the item data or NULL if the item was not found              *
  *                                                                            *
  ******************************************************************************/
-static int	DBget_host_value(zbx_uint64_t hostid, char **replace_to, const char *field_name)
+static zbx_macro_item_t	*macro_item_get(zbx_uint64_t itemid)
+{
+	zbx_macro_item_t	*item, item_local;
+	DC_ITEM			dc_item;
+	int			errcode;
+
+	macro_context_create();
+
+	if (NULL != (item = (zbx_macro_item_t *)zbx_hashset_search(&macro_context.items, &itemid)))
+		return item;
+
+	DCconfig_get_items_by_itemids(&dc_item, &itemid, &errcode, 1);
+
+	if (SUCCEED == errcode && SUCCEED == zbx_dc_get_item_name(itemid, &item_local.name))
+	{
+		item_local.itemid = itemid;
+		item_local.hostid = dc_item.host.hostid;
+		item_local.proxy_hostid = dc_item.host.proxy_hostid;
+		item_local.valuemapid = dc_item.valuemapid;
+		item_local.key = zbx_strdup(NULL, dc_item.key_orig);
+		item_local.units = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(dc_item.units));
+		item_local.error = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(dc_item.error));
+		item_local.description = NULL;
+		item_local.host_description = NULL;
+		item_local.value_type = dc_item.value_type;
+
+		item = (zbx_macro_item_t *)zbx_hashset_insert(&macro_context.items, &item_local, sizeof(item_local));
+	}
+
+	DCconfig_clean_items(&dc_item, &errcode, 1);
+
+	return item;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item and host descriptions from database if not read yet     *
+ *                                                                            *
+ ******************************************************************************/
+static void	macro_item_get_descriptions(zbx_macro_item_t *item)
 {
 	DB_RESULT	result;
 	DB_ROW		row;
-	int		ret = FAIL;
+
+	if (NULL != item->description)
+		return;
 
 	result = DBselect(
-			"select %s"
-			" from hosts"
-			" where hostid=" ZBX_FS_UI64,
-			field_name, hostid);
+			"select i.description,h.description"
+			" from items i,hosts h"
+			" where i.hostid=h.hostid"
+				" and i.itemid=" ZBX_FS_UI64,
+			item->itemid);
 
 	if (NULL != (row = DBfetch(result)))
 	{
-		*replace_to = zbx_strdup(*replace_to, row[0]);
-		ret = SUCCEED;
+		item->description = zbx_strdup(NULL, row[0]);
+		item->host_description = zbx_strdup(NULL, row[1]);
+	}
+	else
+	{
+		item->description = zbx_strdup(NULL, "");
+		item->host_description = zbx_strdup(NULL, "");
 	}
 	DBfree_result(result);
+}
 
-	return ret;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: request proxy name or description by hostid                      *
+ *                                                                            *
+ * Return value: upon successful completion return SUCCEED                    *
+ *               otherwise FAIL                                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBget_proxy_value(zbx_uint64_t hostid, char **replace_to, int request)
+{
+	zbx_macro_proxy_t	*proxy, proxy_local;
+	DB_RESULT		result;
+	DB_ROW			row;
+	int			status;
+
+	macro_context_create();
+
+	if (NULL == (proxy = (zbx_macro_proxy_t *)zbx_hashset_search(&macro_context.proxies, &hostid)))
+	{
+		if (SUCCEED != zbx_dc_get_proxy_name_type_by_id(hostid, &status, &proxy_local.host))
+			return FAIL;
+
+		proxy_local.hostid = hostid;
+		proxy_local.description = NULL;
+
+		proxy = (zbx_macro_proxy_t *)zbx_hashset_insert(&macro_context.proxies, &proxy_local,
+				sizeof(proxy_local));
+	}
+
+	switch (request)
+	{
+		case ZBX_REQUEST_PROXY_NAME:
+			*replace_to = zbx_strdup(*replace_to, proxy->host);
+			return SUCCEED;
+		case ZBX_REQUEST_PROXY_DESCRIPTION:
+			if (NULL == proxy->description)
+			{
+				result = DBselect("select description from hosts where hostid=" ZBX_FS_UI64, hostid);
+
+				if (NULL != (row = DBfetch(result)))
+					proxy->description = zbx_strdup(NULL, row[0]);
+				else
+					proxy->description = zbx_strdup(NULL, "");
+				DBfree_result(result);
+			}
+
+			*replace_to = zbx_strdup(*replace_to, proxy->description);
+			return SUCCEED;
+	}
+
+	return FAIL;
 }
 
 /******************************************************************************
@@ -536,11 +767,9 @@ static void	zbx_substitute_macros_in_item_key(DC_ITEM *dc_item, char **replace_t
  ******************************************************************************/
 static int	DBget_item_value(zbx_uint64_t itemid, char **replace_to, int request)
 {
-	DB_RESULT	result;
-	DB_ROW		row;
-	DC_ITEM		dc_item;
-	zbx_uint64_t	proxy_hostid;
-	int		ret = FAIL, errcode;
+	zbx_macro_item_t	*item;
+	DC_ITEM			dc_item;
+	int			ret = FAIL, errcode;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -557,105 +786,83 @@ static int	DBget_item_value(zbx_uint64_t itemid, char **replace_to, int request)
 			return get_host_value(itemid, replace_to, request);
 	}
 
-	result = DBselect(
-			"select h.proxy_hostid,h.description,i.itemid,i.name,i.key_,i.description,i.value_type,ir.error"
-			" from items i"
-				" join hosts h on h.hostid=i.hostid"
-				" left join item_rtdata ir on ir.itemid=i.itemid"
-			" where i.itemid=" ZBX_FS_UI64, itemid);
+	if (NULL == (item = macro_item_get(itemid)))
+		goto out;
 
-	if (NULL != (row = DBfetch(result)))
+	switch (request)
 	{
-		switch (request)
-		{
-			case ZBX_REQUEST_HOST_DESCRIPTION:
-				*replace_to = zbx_strdup(*replace_to, row[1]);
-				ret = SUCCEED;
-				break;
-			case ZBX_REQUEST_ITEM_ID:
-				*replace_to = zbx_strdup(*replace_to, row[2]);
-				ret = SUCCEED;
-				break;
-			case ZBX_REQUEST_ITEM_NAME:
-				*replace_to = zbx_strdup(*replace_to, row[3]);
-				ret = SUCCEED;
-				break;
-			case ZBX_REQUEST_ITEM_KEY:
-				DCconfig_get_items_by_itemids(&dc_item, &itemid, &errcode, 1);
-
-				if (SUCCEED == errcode)
-				{
-					zbx_substitute_macros_in_item_key(&dc_item, replace_to);
-					ret = SUCCEED;
-				}
-
-				DCconfig_clean_items(&dc_item, &errcode, 1);
-				break;
-			case ZBX_REQUEST_ITEM_DESCRIPTION:
-				DCconfig_get_items_by_itemids(&dc_item, &itemid, &errcode, 1);
-
-				if (SUCCEED == errcode)
-				{
-					zbx_dc_um_handle_t	*um_handle;
+		case ZBX_REQUEST_HOST_DESCRIPTION:
+			macro_item_get_descriptions(item);
+			*replace_to = zbx_strdup(*replace_to, item->host_description);
+			ret = SUCCEED;
+			break;
+		case ZBX_REQUEST_ITEM_ID:
+			*replace_to = zbx_dsprintf(*replace_to, ZBX_FS_UI64, item->itemid);
+			ret = SUCCEED;
+			break;
+		case ZBX_REQUEST_ITEM_NAME:
+			*replace_to = zbx_strdup(*replace_to, item->name);
+			ret = SUCCEED;
+			break;
+		case ZBX_REQUEST_ITEM_KEY:
+			DCconfig_get_items_by_itemids(&dc_item, &itemid, &errcode, 1);
 
-					um_handle = zbx_dc_open_user_macros();
-					*replace_to = zbx_strdup(NULL, row[5]);
+			if (SUCCEED == errcode)
+			{
+				zbx_substitute_macros_in_item_key(&dc_item, replace_to);
+				ret = SUCCEED;
+			}
 
-					(void)zbx_dc_expand_user_macros(um_handle, replace_to, &dc_item.host.hostid, 1,
-							NULL);
+			DCconfig_clean_items(&dc_item, &errcode, 1);
+			break;
+		case ZBX_REQUEST_ITEM_DESCRIPTION:
+			{
+				zbx_dc_um_handle_t	*um_handle;
 
-					zbx_dc_close_user_macros(um_handle);
-					ret = SUCCEED;
-				}
+				macro_item_get_descriptions(item);
 
-				DCconfig_clean_items(&dc_item, &errcode, 1);
-				break;
-			case ZBX_REQUEST_ITEM_NAME_ORIG:
-				*replace_to = zbx_strdup(*replace_to, row[3]);
-				ret = SUCCEED;
-				break;
-			case ZBX_REQUEST_ITEM_KEY_ORIG:
-				*replace_to = zbx_strdup(*replace_to, row[4]);
-				ret = SUCCEED;
-				break;
-			case ZBX_REQUEST_ITEM_DESCRIPTION_ORIG:
-				*replace_to = zbx_strdup(*replace_to, row[5]);
-				ret = SUCCEED;
-				break;
-			case ZBX_REQUEST_PROXY_NAME:
-				ZBX_DBROW2UINT64(proxy_hostid, row[0]);
+				um_handle = zbx_dc_open_user_macros();
+				*replace_to = zbx_strdup(*replace_to, item->description);
 
-				if (0 == proxy_hostid)
-				{
-					*replace_to = zbx_strdup(*replace_to, "");
-					ret = SUCCEED;
-				}
-				else
-					ret = DBget_host_value(proxy_hostid, replace_to, "host");
-				break;
-			case ZBX_REQUEST_PROXY_DESCRIPTION:
-				ZBX_DBROW2UINT64(proxy_hostid, row[0]);
+				(void)zbx_dc_expand_user_macros(um_handle, replace_to, &item->hostid, 1, NULL);
 
-				if (0 == proxy_hostid)
-				{
-					*replace_to = zbx_strdup(*replace_to, "");
-					ret = SUCCEED;
-				}
-				else
-					ret = DBget_host_value(proxy_hostid, replace_to, "description");
-				break;
-			case ZBX_REQUEST_ITEM_VALUETYPE:
-				*replace_to = zbx_strdup(*replace_to, row[6]);
+				zbx_dc_close_user_macros(um_handle);
 				ret = SUCCEED;
-				break;
-			case ZBX_REQUEST_ITEM_ERROR:
-				*replace_to = zbx_strdup(*replace_to, FAIL == DBis_null(row[7]) ? row[7] : "");
+			}
+			break;
+		case ZBX_REQUEST_ITEM_NAME_ORIG:
+			*replace_to = zbx_strdup(*replace_to, item->name);
+			ret = SUCCEED;
+			break;
+		case ZBX_REQUEST_ITEM_KEY_ORIG:
+			*replace_to = zbx_strdup(*replace_to, item->key);
+			ret = SUCCEED;
+			break;
+		case ZBX_REQUEST_ITEM_DESCRIPTION_ORIG:
+			macro_item_get_descriptions(item);
+			*replace_to = zbx_strdup(*replace_to, item->description);
+			ret = SUCCEED;
+			break;
+		case ZBX_REQUEST_PROXY_NAME:
+		case ZBX_REQUEST_PROXY_DESCRIPTION:
+			if (0 == item->proxy_hostid)
+			{
+				*replace_to = zbx_strdup(*replace_to, "");
 				ret = SUCCEED;
-				break;
-		}
+			}
+			else
+				ret = DBget_proxy_value(item->proxy_hostid, replace_to, request);
+			break;
+		case ZBX_REQUEST_ITEM_VALUETYPE:
+			*replace_to = zbx_dsprintf(*replace_to, "%d", (int)item->value_type);
+			ret = SUCCEED;
+			break;
+		case ZBX_REQUEST_ITEM_ERROR:
+			*replace_to = zbx_strdup(*replace_to, item->error);
+			ret = SUCCEED;
+			break;
 	}
-	DBfree_result(result);
-
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -663,22 +870,35 @@ static int	DBget_item_value(zbx_uint64_t itemid, char **replace_to, int request)
 
 static int	DBget_trigger_error(const ZBX_DB_TRIGGER *trigger, char **replace_to)
 {
-	int		ret = SUCCEED;
-	DB_RESULT	result;
-	DB_ROW		row;
+	int			ret = SUCCEED;
+	DB_RESULT		result;
+	DB_ROW			row;
+	zbx_macro_trigger_t	*macro_trigger, macro_trigger_local;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (NULL == (result = DBselect("select error from triggers where triggerid=" ZBX_FS_UI64,
-			trigger->triggerid)))
+	macro_context_create();
+
+	if (NULL == (macro_trigger = (zbx_macro_trigger_t *)zbx_hashset_search(&macro_context.triggers,
+			&trigger->triggerid)))
 	{
-		ret = FAIL;
-		goto out;
-	}
+		if (NULL == (result = DBselect("select error from triggers where triggerid=" ZBX_FS_UI64,
+				trigger->triggerid)))
+		{
+			ret = FAIL;
+			goto out;
+		}
 
-	*replace_to = zbx_strdup(*replace_to, (NULL == (row = DBfetch(result))) ?  "" : row[0]);
+		macro_trigger_local.triggerid = trigger->triggerid;
+		macro_trigger_local.error = zbx_strdup(NULL, (NULL == (row = DBfetch(result))) ?  "" : row[0]);
 
-	DBfree_result(result);
+		DBfree_result(result);
+
+		macro_trigger = (zbx_macro_trigger_t *)zbx_hashset_insert(&macro_context.triggers,
+				&macro_trigger_local, sizeof(macro_trigger_local));
+	}
+
+	*replace_to = zbx_strdup(*replace_to, macro_trigger->error);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1013,44 +1233,31 @@ out:
  ******************************************************************************/
 static int	DBitem_get_value(zbx_uint64_t itemid, char **lastvalue, int raw, zbx_timespec_t *ts)
 {
-	DB_RESULT	result;
-	DB_ROW		row;
-	int		ret = FAIL;
+	const zbx_macro_item_t	*item;
+	int			ret = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	result = DBselect(
-			"select value_type,valuemapid,units"
-			" from items"
-			" where itemid=" ZBX_FS_UI64,
-			itemid);
-
-	if (NULL != (row = DBfetch(result)))
+	if (NULL != (item = macro_item_get(itemid)))
 	{
-		unsigned char		value_type;
-		zbx_uint64_t		valuemapid;
 		zbx_history_record_t	vc_value;
 
-		value_type = (unsigned char)atoi(row[0]);
-		ZBX_DBROW2UINT64(valuemapid, row[1]);
-
-		if (SUCCEED == zbx_vc_get_value(itemid, value_type, ts, &vc_value))
+		if (SUCCEED == zbx_vc_get_value(itemid, item->value_type, ts, &vc_value))
 		{
 			char	tmp[MAX_BUFFER_LEN];
 
 			zbx_vc_flush_stats();
-			zbx_history_value_print(tmp, sizeof(tmp), &vc_value.value, value_type);
-			zbx_history_record_clear(&vc_value, value_type);
+			zbx_history_value_print(tmp, sizeof(tmp), &vc_value.value, item->value_type);
+			zbx_history_record_clear(&vc_value, item->value_type);
 
 			if (0 == raw)
-				zbx_format_value(tmp, sizeof(tmp), valuemapid, row[2], value_type);
+				zbx_format_value(tmp, sizeof(tmp), item->valuemapid, item->units, item->value_type);
 
 			*lastvalue = zbx_strdup(*lastvalue, tmp);
 
 			ret = SUCCEED;
 		}
 	}
-	DBfree_result(result);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -2668,6 +2875,10 @@ static int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const ZBX
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() data:'%s'", __func__, *data);
 
+	/* nested substitutions (item key parameters, cause event macros) keep the outer context */
+	if (0 == macro_context_depth++)
+		macro_context_set(event);
+
 	if (0 != (macro_type & (MACRO_TYPE_TRIGGER_DESCRIPTION | MACRO_TYPE_EVENT_NAME)))
 		token_search |= ZBX_TOKEN_SEARCH_REFERENCES;
 
@@ -3476,9 +3687,14 @@ static int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const ZBX
 						ZBX_DBROW2UINT64(proxy_hostid, replace_to);
 
 						if (0 == proxy_hostid)
+						{
 							replace_to = zbx_strdup(replace_to, "");
+						}
 						else
-							ret = DBget_host_value(proxy_hostid, &replace_to, "host");
+						{
+							ret = DBget_proxy_value(proxy_hostid, &replace_to,
+									ZBX_REQUEST_PROXY_NAME);
+						}
 					}
 				}
 				else if (0 == strcmp(m, MVAR_PROXY_DESCRIPTION))
@@ -3496,8 +3712,8 @@ static int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const ZBX
 						}
 						else
 						{
-							ret = DBget_host_value(proxy_hostid, &replace_to,
-									"description");
+							ret = DBget_proxy_value(proxy_hostid, &replace_to,
+									ZBX_REQUEST_PROXY_DESCRIPTION);
 						}
 					}
 				}
@@ -3577,9 +3793,14 @@ static int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const ZBX
 						ZBX_DBROW2UINT64(proxy_hostid, replace_to);
 
 						if (0 == proxy_hostid)
+						{
 							replace_to = zbx_strdup(replace_to, "");
+						}
 						else
-							ret = DBget_host_value(proxy_hostid, &replace_to, "host");
+						{
+							ret = DBget_proxy_value(proxy_hostid, &replace_to,
+									ZBX_REQUEST_PROXY_NAME);
+						}
 					}
 				}
 				else if (0 == strcmp(m, MVAR_PROXY_DESCRIPTION))
@@ -3597,8 +3818,8 @@ static int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const ZBX
 						}
 						else
 						{
-							ret = DBget_host_value(proxy_hostid, &replace_to,
-									"description");
+							ret = DBget_proxy_value(proxy_hostid, &replace_to,
+									ZBX_REQUEST_PROXY_DESCRIPTION);
 						}
 					}
 				}
@@ -4741,6 +4962,8 @@ static int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const ZBX
 
 	zbx_dc_close_user_macros(um_handle);
 out:
+	macro_context_depth--;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End %s() data:'%s'", __func__, *data);
 
 	return res;
@@ -4935,6 +5158,7 @@ void	zbx_determine_items_in_expressions(zbx_vector_ptr_t *trigger_order, const z
 typedef struct
 {
 	/* input data */
+	zbx_uint64_t	canonicalid;
 	zbx_uint64_t	itemid;
 	char		*function;
 	char		*parameter;
@@ -4959,9 +5183,7 @@ static zbx_hash_t	func_hash_func(const void *data)
 	const zbx_func_t	*func = (const zbx_func_t *)data;
 	zbx_hash_t		hash;
 
-	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&func->itemid);
-	hash = ZBX_DEFAULT_STRING_HASH_ALGO(func->function, strlen(func->function), hash);
-	hash = ZBX_DEFAULT_STRING_HASH_ALGO(func->parameter, strlen(func->parameter), hash);
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&func->canonicalid);
 	hash = ZBX_DEFAULT_HASH_ALGO(&func->timespec.sec, sizeof(func->timespec.sec), hash);
 	hash = ZBX_DEFAULT_HASH_ALGO(&func->timespec.ns, sizeof(func->timespec.ns), hash);
 
@@ -4972,16 +5194,9 @@ static int	func_compare_func(const void *d1, const void *d2)
 {
 	const zbx_func_t	*func1 = (const zbx_func_t *)d1;
 	const zbx_func_t	*func2 = (const zbx_func_t *)d2;
-	int			ret;
-
-	ZBX_RETURN_IF_NOT_EQUAL(func1->itemid, func2->itemid);
-
-	if (0 != (ret = strcmp(func1->function, func2->function)))
-		return ret;
-
-	if (0 != (ret = strcmp(func1->parameter, func2->parameter)))
-		return ret;
 
+	/* functions with equal item, name and normalized parameters share canonical identifier */
+	ZBX_RETURN_IF_NOT_EQUAL(func1->canonicalid, func2->canonicalid);
 	ZBX_RETURN_IF_NOT_EQUAL(func1->timespec.sec, func2->timespec.sec);
 	ZBX_RETURN_IF_NOT_EQUAL(func1->timespec.ns, func2->timespec.ns);
 
@@ -5004,8 +5219,8 @@ static void	func_clean(void *ptr)
  * Purpose: prepare hashset of functions to evaluate                          *
  *                                                                            *
  * Parameters: functionids - [IN] function identifiers                        *
- *             funcs       - [OUT] functions indexed by itemid, name,         *
- *                                 parameter, timestamp                       *
+ *             funcs       - [OUT] functions indexed by canonical function    *
+ *                                 identifier and timestamp                   *
  *             ifuncs      - [OUT] function index by functionid               *
  *             trigger     - [IN] vector of triggers, sorted by triggerid     *
  *                                                                            *
@@ -5035,6 +5250,7 @@ static void	zbx_populate_function_items(const zbx_vector_uint64_t *functionids,
 		if (SUCCEED != errcodes[i])
 			continue;
 
+		func_local.canonicalid = functions[i].canonicalid;
 		func_local.itemid = functions[i].itemid;
 
 		if (FAIL != (j = zbx_vector_ptr_bsearch(triggers, &functions[i].triggerid,
@@ -6754,3 +6970,7 @@ int	zbx_host_macro_index(const char *macro)
 
 	return -1;
 }
+
+#ifdef HAVE_TESTS
+#	include "../../../tests/libs/zbxserver/macro_context_test.c"
+#endif
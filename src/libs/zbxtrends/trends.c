@@ -406,6 +406,50 @@ int	zbx_trends_parse_nextcheck(time_t from, const char *period_shift, time_t *ne
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: select trends data of the specified period                        *
+ *                                                                            *
+ * Parameters: fields - [IN] the fields to select                             *
+ *             table  - [IN] the trends table name                            *
+ *             itemid - [IN] the itemid                                       *
+ *             start  - [IN] the period start time                            *
+ *             end    - [IN] the period end time                              *
+ *                                                                            *
+ * Return value: the select result                                            *
+ *                                                                            *
+ * Comments: Item and period are passed as parameters, so the statement is    *
+ *           prepared only once for all items.                                *
+ *                                                                            *
+ ******************************************************************************/
+static DB_RESULT	trends_select(const char *fields, const char *table, zbx_uint64_t itemid, int start, int end)
+{
+	DB_RESULT	result;
+	char		*sql = NULL, params_buf[3][MAX_ID_LEN + 1];
+	size_t		sql_alloc = 0, sql_offset = 0;
+	const char	*params[3] = {params_buf[0], params_buf[1], params_buf[2]};
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select %s from %s where itemid=$1", fields, table);
+	zbx_snprintf(params_buf[0], sizeof(params_buf[0]), ZBX_FS_UI64, itemid);
+	zbx_snprintf(params_buf[1], sizeof(params_buf[1]), "%d", start);
+
+	if (start != end)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>=$2 and clock<=$3");
+		zbx_snprintf(params_buf[2], sizeof(params_buf[2]), "%d", end);
+		result = DBselect_prepared(sql, 3, params);
+	}
+	else
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=$2");
+		result = DBselect_prepared(sql, 2, params);
+	}
+
+	zbx_free(sql);
+
+	return result;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate expression with trends data                              *
@@ -430,30 +474,9 @@ static zbx_trend_state_t	trends_eval(const char *table, zbx_uint64_t itemid, int
 {
 	DB_RESULT		result;
 	DB_ROW			row;
-	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0;
 	zbx_trend_state_t	state;
 
-	if (start != end)
-	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-				"select %s from %s"
-				" where itemid=" ZBX_FS_UI64
-					" and clock>=%d"
-					" and clock<=%d",
-				eval_multi, table, itemid, start, end);
-	}
-	else
-	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-				"select %s from %s"
-				" where itemid=" ZBX_FS_UI64
-					" and clock=%d",
-				eval_single, table, itemid, start);
-	}
-
-	result = DBselect("%s", sql);
-	zbx_free(sql);
+	result = trends_select(start != end ? eval_multi : eval_single, table, itemid, start, end);
 
 	if (NULL != (row = DBfetch(result)) && SUCCEED != DBis_null(row[0]))
 	{
@@ -488,20 +511,10 @@ static zbx_trend_state_t	trends_eval_avg(const char *table, zbx_uint64_t itemid,
 {
 	DB_RESULT		result;
 	DB_ROW			row;
-	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0;
 	zbx_trend_state_t	state;
 	double			avg, num, num2, avg2;
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select value_avg,num from %s where itemid=" ZBX_FS_UI64,
-			table, itemid);
-	if (start != end)
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>=%d and clock<=%d", start, end);
-	else
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", start);
-
-	result = DBselect("%s", sql);
-	zbx_free(sql);
+	result = trends_select("value_avg,num", table, itemid, start, end);
 
 	if (NULL != (row = DBfetch(result)))
 	{
@@ -547,19 +560,9 @@ static zbx_trend_state_t	trends_eval_sum(const char *table, zbx_uint64_t itemid,
 {
 	DB_RESULT	result;
 	DB_ROW		row;
-	char		*sql = NULL;
-	size_t		sql_alloc = 0, sql_offset = 0;
 	double		sum = 0;
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select value_avg,num from %s where itemid=" ZBX_FS_UI64,
-			table, itemid);
-	if (start != end)
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>=%d and clock<=%d", start, end);
-	else
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", start);
-
-	result = DBselect("%s", sql);
-	zbx_free(sql);
+	result = trends_select("value_avg,num", table, itemid, start, end);
 
 	while (NULL != (row = DBfetch(result)))
 		sum += atof(row[0]) * atof(row[1]);
@@ -21,6 +21,7 @@
 
 #include "zbxcomms.h"
 #include "zbxconf.h"
+#include "zbxjson.h"
 #include "sysinfo.h"
 #include "log.h"
 
@@ -41,62 +42,206 @@ extern ZBX_THREAD_LOCAL int		server_num, process_num;
 static volatile sig_atomic_t	need_update_userparam;
 #endif
 
-static void	process_listener(zbx_socket_t *s)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes batched passive check request                           *
+ *                                                                            *
+ * Parameters: s         - [IN] the socket                                    *
+ *             jp        - [IN] the request                                   *
+ *             keepalive - [IN] see process_request()                         *
+ *                                                                            *
+ * Return value: SUCCEED - the response was sent                              *
+ *               FAIL    - an error occurred                                  *
+ *                                                                            *
+ * Comments: request:                                                         *
+ *             {"request":"passive checks","data":[{"key":"k1"},...]}         *
+ *           response contains results in the same order:                     *
+ *             {"data":[{"value":"v1"},{"error":"e2"},...]}                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_batch_request(zbx_socket_t *s, const struct zbx_json_parse *jp, int keepalive)
 {
-	AGENT_RESULT	result;
-	char		**value = NULL;
-	int		ret;
+	struct zbx_json_parse	jp_data, jp_row;
+	struct zbx_json		j;
+	const char		*p = NULL;
+	char			*key = NULL, **value;
+	size_t			key_alloc = 0;
+	int			ret;
+	AGENT_RESULT		result;
 
-	if (SUCCEED == (ret = zbx_tcp_recv_to(s, CONFIG_TIMEOUT)))
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+
+	if (SUCCEED != zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data))
 	{
-		zbx_rtrim(s->buffer, "\r\n");
+		zbx_json_addstring(&j, ZBX_PROTO_TAG_ERROR, zbx_json_strerror(), ZBX_JSON_TYPE_STRING);
+		goto out;
+	}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
+	zbx_json_addarray(&j, ZBX_PROTO_TAG_DATA);
 
-		init_result(&result);
+	while (NULL != (p = zbx_json_next(&jp_data, p)))
+	{
+		zbx_json_addobject(&j, NULL);
 
-		if (SUCCEED == process(s->buffer, PROCESS_WITH_ALIAS, &result))
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_row) || SUCCEED != zbx_json_value_by_name_dyn(&jp_row,
+				ZBX_PROTO_TAG_KEY, &key, &key_alloc, NULL))
 		{
-			if (NULL != (value = GET_TEXT_RESULT(&result)))
-			{
-				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
-				ret = zbx_tcp_send_to(s, *value, CONFIG_TIMEOUT);
-			}
+			zbx_json_addstring(&j, ZBX_PROTO_TAG_ERROR, "Invalid item request format.",
+					ZBX_JSON_TYPE_STRING);
+			zbx_json_close(&j);
+			continue;
 		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", key);
+
+		init_result(&result);
+
+		if (SUCCEED == process(key, PROCESS_WITH_ALIAS, &result) && NULL != (value = GET_TEXT_RESULT(&result)))
+			zbx_json_addstring(&j, ZBX_PROTO_TAG_VALUE, *value, ZBX_JSON_TYPE_STRING);
+		else if (NULL != (value = GET_MSG_RESULT(&result)))
+			zbx_json_addstring(&j, ZBX_PROTO_TAG_ERROR, *value, ZBX_JSON_TYPE_STRING);
 		else
+			zbx_json_addstring(&j, ZBX_PROTO_TAG_ERROR, "Not supported by Zabbix Agent", ZBX_JSON_TYPE_STRING);
+
+		free_result(&result);
+		zbx_json_close(&j);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", j.buffer);
+
+	ret = zbx_tcp_send_ext(s, j.buffer, j.buffer_size, (size_t)keepalive, ZBX_TCP_PROTOCOL, CONFIG_TIMEOUT);
+
+	zbx_json_free(&j);
+	zbx_free(key);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes passive check request received into socket buffer      *
+ *          and sends back the response                                       *
+ *                                                                            *
+ * Parameters: s         - [IN] the socket                                    *
+ *             keepalive - [IN] the number of seconds connection is kept      *
+ *                              open for the next request, 0 if connection    *
+ *                              will be closed after the response             *
+ *                                                                            *
+ * Return value: SUCCEED - the response was sent                              *
+ *               FAIL    - an error occurred                                  *
+ *                                                                            *
+ * Comments: keepalive is sent back in the reserved field of the response     *
+ *           header, so server knows if it can reuse the connection           *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_request(zbx_socket_t *s, int keepalive)
+{
+	AGENT_RESULT		result;
+	char			**value = NULL, request[MAX_STRING_LEN];
+	int			ret = SUCCEED;
+	struct zbx_json_parse	jp;
+
+	/* item keys cannot start with '{', so such requests are batched requests of newer servers */
+	if ('{' == *s->buffer && SUCCEED == zbx_json_open(s->buffer, &jp) &&
+			SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_REQUEST, request, sizeof(request), NULL) &&
+			0 == strcmp(request, ZBX_PROTO_VALUE_GET_PASSIVE_CHECKS))
+	{
+		return process_batch_request(s, &jp, keepalive);
+	}
+
+	zbx_rtrim(s->buffer, "\r\n");
+
+	zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
+
+	init_result(&result);
+
+	if (SUCCEED == process(s->buffer, PROCESS_WITH_ALIAS, &result))
+	{
+		if (NULL != (value = GET_TEXT_RESULT(&result)))
 		{
-			value = GET_MSG_RESULT(&result);
+			zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
+			ret = zbx_tcp_send_ext(s, *value, strlen(*value), (size_t)keepalive, ZBX_TCP_PROTOCOL,
+					CONFIG_TIMEOUT);
+		}
+	}
+	else
+	{
+		value = GET_MSG_RESULT(&result);
 
-			if (NULL != value)
-			{
-				static char	*buffer = NULL;
-				static size_t	buffer_alloc = 256;
-				size_t		buffer_offset = 0;
+		if (NULL != value)
+		{
+			static char	*buffer = NULL;
+			static size_t	buffer_alloc = 256;
+			size_t		buffer_offset = 0;
 
-				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]", *value);
+			zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]", *value);
 
-				if (NULL == buffer)
-					buffer = (char *)zbx_malloc(buffer, buffer_alloc);
+			if (NULL == buffer)
+				buffer = (char *)zbx_malloc(buffer, buffer_alloc);
 
-				zbx_strncpy_alloc(&buffer, &buffer_alloc, &buffer_offset,
-						ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED));
-				buffer_offset++;
-				zbx_strcpy_alloc(&buffer, &buffer_alloc, &buffer_offset, *value);
+			zbx_strncpy_alloc(&buffer, &buffer_alloc, &buffer_offset,
+					ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED));
+			buffer_offset++;
+			zbx_strcpy_alloc(&buffer, &buffer_alloc, &buffer_offset, *value);
 
-				ret = zbx_tcp_send_bytes_to(s, buffer, buffer_offset, CONFIG_TIMEOUT);
-			}
-			else
-			{
-				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED "]");
+			ret = zbx_tcp_send_ext(s, buffer, buffer_offset, (size_t)keepalive, ZBX_TCP_PROTOCOL,
+					CONFIG_TIMEOUT);
+		}
+		else
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED "]");
 
-				ret = zbx_tcp_send_to(s, ZBX_NOTSUPPORTED, CONFIG_TIMEOUT);
-			}
+			ret = zbx_tcp_send_ext(s, ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED),
+					(size_t)keepalive, ZBX_TCP_PROTOCOL, CONFIG_TIMEOUT);
 		}
+	}
 
-		free_result(&result);
+	free_result(&result);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serves passive check requests over accepted connection            *
+ *                                                                            *
+ * Parameters: s - [IN] the socket                                            *
+ *                                                                            *
+ * Comments: Server requests persistent connection by setting the number of   *
+ *           idle seconds in the reserved field of request header. The        *
+ *           connection is then kept open for the next request for at most    *
+ *           Timeout seconds, or until a new connection is waiting to be      *
+ *           accepted, so idle connections cannot occupy all listeners.       *
+ *           Requests without the reserved field set are served as before -   *
+ *           one request per connection.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_listener(zbx_socket_t *s)
+{
+	int	ret, keepalive, requests = 0;
+
+	while (SUCCEED == (ret = zbx_tcp_recv_to(s, CONFIG_TIMEOUT)))
+	{
+		/* server closed persistent connection */
+		if (0 != requests && 0 == s->read_bytes)
+			break;
+
+		keepalive = (int)MIN(s->reserved, (zbx_uint64_t)CONFIG_TIMEOUT);
+
+		if (SUCCEED != (ret = process_request(s, keepalive)) || 0 == keepalive || !ZBX_IS_RUNNING())
+			break;
+#ifndef _WINDOWS
+		if (1 == need_update_userparam)
+			break;
+#endif
+		requests++;
+
+		if (SUCCEED != zbx_tcp_wait_request(s, keepalive))
+			break;
 	}
 
-	if (FAIL == ret)
+	/* idle persistent connection timing out is not an error */
+	if (FAIL == ret && 0 == requests)
 		zabbix_log(LOG_LEVEL_DEBUG, "Process listener error: %s", zbx_socket_strerror());
 }
 
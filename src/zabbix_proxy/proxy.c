@@ -104,7 +104,8 @@ const char	*help_message[] = {
 	"                                 heartbeat sender, history syncer, housekeeper,",
 	"                                 http poller, icmp pinger, ipmi manager,",
 	"                                 ipmi poller, java poller, poller,",
-	"                                 self-monitoring, snmp trapper, task manager,",
+	"                                 self-monitoring, snmp trapper, snmp trap worker,",
+	"                                 task manager,",
 	"                                 trapper, unreachable poller, vmware collector,"
 	"                                 availability manager, odbc poller)",
 	"        process-type,N           Process type and number (e.g., poller,3)",
@@ -163,6 +164,7 @@ int	CONFIG_HTTPPOLLER_FORKS		= 1;
 int	CONFIG_IPMIPOLLER_FORKS		= 0;
 int	CONFIG_TRAPPER_FORKS		= 5;
 int	CONFIG_SNMPTRAPPER_FORKS	= 0;
+int	CONFIG_SNMPTRAPWORKER_FORKS	= 0;
 int	CONFIG_JAVAPOLLER_FORKS		= 0;
 int	CONFIG_SELFMON_FORKS		= 1;
 int	CONFIG_PROXYPOLLER_FORKS	= 0;
@@ -191,6 +193,10 @@ int	CONFIG_LISTEN_PORT		= ZBX_DEFAULT_SERVER_PORT;
 char	*CONFIG_LISTEN_IP		= NULL;
 char	*CONFIG_SOURCE_IP		= NULL;
 int	CONFIG_TRAPPER_TIMEOUT		= 300;
+int	CONFIG_MAX_CONNECTIONS_PER_TRAPPER	= 0;
+int	CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT	= 0;
+int	CONFIG_AGENT_CONNECTION_MAX_REQUESTS	= 100;
+int	CONFIG_AGENT_BATCH_MAX_ITEMS		= 1;
 
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
 int	CONFIG_PROXY_LOCAL_BUFFER	= 0;
@@ -248,6 +254,7 @@ char	*CONFIG_DB_TLS_CIPHER		= NULL;
 char	*CONFIG_DB_TLS_CIPHER_13	= NULL;
 char	*CONFIG_EXPORT_DIR		= NULL;
 char	*CONFIG_EXPORT_TYPE		= NULL;
+char	*CONFIG_EXPORT_FORMAT		= NULL;
 int	CONFIG_DBPORT			= 0;
 int	CONFIG_ALLOW_UNSUPPORTED_DB_VERSIONS = 0;
 int	CONFIG_ENABLE_REMOTE_COMMANDS	= 0;
@@ -267,6 +274,7 @@ int	CONFIG_JAVA_GATEWAY_PORT	= ZBX_DEFAULT_GATEWAY_PORT;
 char	*CONFIG_SSH_KEY_LOCATION	= NULL;
 
 int	CONFIG_LOG_SLOW_QUERIES		= 0;	/* ms; 0 - disable */
+int	CONFIG_DB_PREPARED_STATEMENTS	= 0;
 
 /* zabbix server startup time */
 int	CONFIG_SERVER_STARTUP_TIME	= 0;
@@ -309,6 +317,11 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+zbx_uint64_t	CONFIG_HISTORY_STORAGE_BULK_SIZE	= 5 * ZBX_MEBIBYTE;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION	= 0;
+int	CONFIG_HISTORY_ASYNC_WRITE		= 0;
+char	*CONFIG_HISTORY_FILE_DIR		= NULL;
+char	*CONFIG_HISTORY_FILE_OPTS		= NULL;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 int	CONFIG_TCP_MAX_BACKLOG_SIZE	= SOMAXCONN;
@@ -401,6 +414,11 @@ int	get_process_info_by_thread(int local_server_num, unsigned char *local_proces
 		*local_process_type = ZBX_PROCESS_TYPE_SNMPTRAPPER;
 		*local_process_num = local_server_num - server_count + CONFIG_SNMPTRAPPER_FORKS;
 	}
+	else if (local_server_num <= (server_count += CONFIG_SNMPTRAPWORKER_FORKS))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_SNMPTRAPWORKER;
+		*local_process_num = local_server_num - server_count + CONFIG_SNMPTRAPWORKER_FORKS;
+	}
 	else if (local_server_num <= (server_count += CONFIG_SELFMON_FORKS))
 	{
 		*local_process_type = ZBX_PROCESS_TYPE_SELFMON;
@@ -581,6 +599,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 == CONFIG_SNMPTRAPPER_FORKS && 0 != CONFIG_SNMPTRAPWORKER_FORKS)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"StartSNMPTrapWorkers\" configuration parameter must be 0"
+				" if SNMP trapper is not started");
+		err = 1;
+	}
+
 	if ((NULL == CONFIG_JAVA_GATEWAY || '\0' == *CONFIG_JAVA_GATEWAY) && 0 < CONFIG_JAVAPOLLER_FORKS)
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "\"JavaGateway\" configuration parameter is not specified or empty");
@@ -727,6 +752,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"StartSNMPTrapper",		&CONFIG_SNMPTRAPPER_FORKS,		TYPE_INT,
 			PARM_OPT,	0,			1},
+		{"StartSNMPTrapWorkers",	&CONFIG_SNMPTRAPWORKER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			100},
 		{"CacheSize",			&CONFIG_CONF_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(64) * ZBX_GIBIBYTE},
 		{"HistoryCacheSize",		&CONFIG_HISTORY_CACHE_SIZE,		TYPE_UINT64,
@@ -755,6 +782,14 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	1,			30},
 		{"TrapperTimeout",		&CONFIG_TRAPPER_TIMEOUT,		TYPE_INT,
 			PARM_OPT,	1,			300},
+		{"MaxConnectionsPerTrapper",	&CONFIG_MAX_CONNECTIONS_PER_TRAPPER,	TYPE_INT,
+			PARM_OPT,	0,			10000},
+		{"AgentConnectionIdleTimeout",	&CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT,	TYPE_INT,
+			PARM_OPT,	0,			30},
+		{"AgentConnectionMaxRequests",	&CONFIG_AGENT_CONNECTION_MAX_REQUESTS,	TYPE_INT,
+			PARM_OPT,	1,			100000},
+		{"AgentBatchMaxItems",		&CONFIG_AGENT_BATCH_MAX_ITEMS,		TYPE_INT,
+			PARM_OPT,	1,			MAX_POLLER_ITEMS},
 		{"UnreachablePeriod",		&CONFIG_UNREACHABLE_PERIOD,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
 		{"UnreachableDelay",		&CONFIG_UNREACHABLE_DELAY,		TYPE_INT,
@@ -823,6 +858,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&CONFIG_LOG_SLOW_QUERIES,		TYPE_INT,
 			PARM_OPT,	0,			3600000},
+		{"DBPreparedStatements",	&CONFIG_DB_PREPARED_STATEMENTS,		TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"LoadModulePath",		&CONFIG_LOAD_MODULE_PATH,		TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"LoadModule",			&CONFIG_LOAD_MODULE,			TYPE_MULTISTRING,
@@ -1346,7 +1383,7 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 			+ CONFIG_POLLER_FORKS + CONFIG_UNREACHABLE_POLLER_FORKS + CONFIG_TRAPPER_FORKS
 			+ CONFIG_PINGER_FORKS + CONFIG_HOUSEKEEPER_FORKS + CONFIG_HTTPPOLLER_FORKS
 			+ CONFIG_DISCOVERER_FORKS + CONFIG_HISTSYNCER_FORKS + CONFIG_IPMIPOLLER_FORKS
-			+ CONFIG_JAVAPOLLER_FORKS + CONFIG_SNMPTRAPPER_FORKS + CONFIG_SELFMON_FORKS
+			+ CONFIG_JAVAPOLLER_FORKS + CONFIG_SNMPTRAPPER_FORKS + CONFIG_SNMPTRAPWORKER_FORKS + CONFIG_SELFMON_FORKS
 			+ CONFIG_VMWARE_FORKS + CONFIG_IPMIMANAGER_FORKS + CONFIG_TASKMANAGER_FORKS
 			+ CONFIG_PREPROCMAN_FORKS + CONFIG_PREPROCESSOR_FORKS + CONFIG_AVAILMAN_FORKS
 			+ CONFIG_ODBCPOLLER_FORKS;
@@ -1436,6 +1473,9 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 			case ZBX_PROCESS_TYPE_SNMPTRAPPER:
 				zbx_thread_start(snmptrapper_thread, &thread_args, &threads[i]);
 				break;
+			case ZBX_PROCESS_TYPE_SNMPTRAPWORKER:
+				zbx_thread_start(snmptrap_worker_thread, &thread_args, &threads[i]);
+				break;
 			case ZBX_PROCESS_TYPE_SELFMON:
 				zbx_thread_start(selfmon_thread, &thread_args, &threads[i]);
 				break;
@@ -114,6 +114,7 @@ static void	get_object_ids(const zbx_vector_ptr_t *esc_events, zbx_vector_uint64
 		zbx_vector_uint64_append(objectids, event->objectid);
 	}
 
+	zbx_vector_uint64_sort(objectids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 	zbx_vector_uint64_uniq(objectids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
@@ -131,11 +132,8 @@ static void	get_object_ids(const zbx_vector_ptr_t *esc_events, zbx_vector_uint64
  ******************************************************************************/
 static int	check_host_group_condition(const zbx_vector_ptr_t *esc_events, zbx_condition_t *condition)
 {
-	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0;
-	DB_RESULT		result;
-	DB_ROW			row;
-	zbx_vector_uint64_t	objectids, groupids;
+	int			i, found;
+	zbx_vector_uint64_t	objectids, group_objectids;
 	zbx_uint64_t		condition_value;
 
 	if (CONDITION_OPERATOR_EQUAL != condition->op && CONDITION_OPERATOR_NOT_EQUAL != condition->op)
@@ -144,59 +142,25 @@ static int	check_host_group_condition(const zbx_vector_ptr_t *esc_events, zbx_co
 	ZBX_STR2UINT64(condition_value, condition->value);
 
 	zbx_vector_uint64_create(&objectids);
-	zbx_vector_uint64_create(&groupids);
+	zbx_vector_uint64_create(&group_objectids);
 
 	get_object_ids(esc_events, &objectids);
-	zbx_dc_get_nested_hostgroupids(&condition_value, 1, &groupids);
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-		"select distinct f.triggerid"
-		" from hosts_groups hg,hosts h,items i,functions f"
-		" where hg.hostid=h.hostid"
-			" and h.hostid=i.hostid"
-			" and i.itemid=f.itemid"
-			" and");
-
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "f.triggerid",
-			objectids.values, objectids.values_num);
-
-	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and");
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "hg.groupid", groupids.values, groupids.values_num);
-
-	result = DBselect("%s", sql);
-
-	while (NULL != (row = DBfetch(result)))
-	{
-		zbx_uint64_t	objectid;
+	/* host group membership is resolved from configuration cache */
+	zbx_dc_get_hostgroup_triggerids(condition_value, &objectids, &group_objectids);
+	zbx_vector_uint64_sort(&group_objectids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-		ZBX_STR2UINT64(objectid, row[0]);
-		if (CONDITION_OPERATOR_NOT_EQUAL == condition->op)
-		{
-			int	index;
-
-			if (FAIL != (index = zbx_vector_uint64_search(&objectids, objectid,
-					ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
-			{
-				zbx_vector_uint64_remove_noorder(&objectids, index);
-			}
-		}
-		else
-			add_condition_match(esc_events, condition, objectid, EVENT_OBJECT_TRIGGER);
-
-	}
-	DBfree_result(result);
-
-	if (CONDITION_OPERATOR_NOT_EQUAL == condition->op)
+	for (i = 0; i < objectids.values_num; i++)
 	{
-		int	i;
+		found = (FAIL != zbx_vector_uint64_bsearch(&group_objectids, objectids.values[i],
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC));
 
-		for (i = 0; i < objectids.values_num; i++)
+		if ((CONDITION_OPERATOR_EQUAL == condition->op) == found)
 			add_condition_match(esc_events, condition, objectids.values[i], EVENT_OBJECT_TRIGGER);
 	}
 
-	zbx_vector_uint64_destroy(&groupids);
+	zbx_vector_uint64_destroy(&group_objectids);
 	zbx_vector_uint64_destroy(&objectids);
-	zbx_free(sql);
 
 	return SUCCEED;
 }
@@ -3064,6 +3028,144 @@ static void	prepare_actions_conditions_eval(zbx_vector_ptr_t *actions, zbx_hashs
 	}
 }
 
+/* actions that may match an escalation event */
+typedef struct
+{
+	zbx_uint64_t		eventid;
+	zbx_vector_ptr_t	actions;
+}
+zbx_event_actions_t;
+
+static void	event_actions_clean(zbx_event_actions_t *event_actions)
+{
+	zbx_vector_ptr_destroy(&event_actions->actions);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get events that can match action based on the conditions that    *
+ *          must be true for the action to match                              *
+ *                                                                            *
+ * Parameters: action   - [IN] the action with evaluated conditions           *
+ *             eventids - [OUT] the sorted candidate event identifiers        *
+ *                                                                            *
+ * Return value: SUCCEED - the candidate events were found, other events      *
+ *                         cannot match the action                            *
+ *               FAIL    - the action conditions do not limit events          *
+ *                                                                            *
+ * Comments: With 'and' evaluation every condition is required, with 'and/or' *
+ *           evaluation at least one condition of each type is required. The  *
+ *           smallest set of events matching a required condition group is    *
+ *           returned.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	action_get_candidate_eventids(const zbx_action_eval_t *action, zbx_vector_uint64_t *eventids)
+{
+	int			i, j, ret = FAIL;
+	zbx_vector_uint64_t	group_eventids;
+	const zbx_condition_t	*condition, *next;
+
+	if (CONDITION_EVAL_TYPE_AND != action->evaltype && CONDITION_EVAL_TYPE_AND_OR != action->evaltype)
+		return FAIL;
+
+	zbx_vector_uint64_create(&group_eventids);
+
+	for (i = 0; i < action->conditions.values_num; i = j)
+	{
+		condition = (const zbx_condition_t *)action->conditions.values[i];
+
+		zbx_vector_uint64_clear(&group_eventids);
+		zbx_vector_uint64_append_array(&group_eventids, condition->eventids.values,
+				condition->eventids.values_num);
+
+		/* assume conditions are sorted by type */
+		for (j = i + 1; j < action->conditions.values_num; j++)
+		{
+			next = (const zbx_condition_t *)action->conditions.values[j];
+
+			if (CONDITION_EVAL_TYPE_AND == action->evaltype || next->conditiontype != condition->conditiontype)
+				break;
+
+			zbx_vector_uint64_append_array(&group_eventids, next->eventids.values, next->eventids.values_num);
+		}
+
+		zbx_vector_uint64_sort(&group_eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&group_eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		if (FAIL == ret || group_eventids.values_num < eventids->values_num)
+		{
+			zbx_vector_uint64_clear(eventids);
+			zbx_vector_uint64_append_array(eventids, group_eventids.values, group_eventids.values_num);
+			ret = SUCCEED;
+		}
+	}
+
+	zbx_vector_uint64_destroy(&group_eventids);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: index actions by escalation events they can match                 *
+ *                                                                            *
+ * Parameters: actions       - [IN] the actions with evaluated conditions     *
+ *             esc_events    - [IN] the escalation events by event source     *
+ *             event_actions - [OUT] the candidate actions by event id        *
+ *                                                                            *
+ * Comments: Actions are added to each event in the order they are listed,    *
+ *           so events are matched to actions in the same order as when all   *
+ *           actions are checked.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	index_actions_by_events(const zbx_vector_ptr_t *actions, const zbx_vector_ptr_t *esc_events,
+		zbx_hashset_t *event_actions)
+{
+	int			i, j;
+	zbx_vector_uint64_t	eventids;
+	zbx_event_actions_t	*event_action, event_action_local;
+
+	zbx_vector_uint64_create(&eventids);
+
+	for (i = 0; i < actions->values_num; i++)
+	{
+		zbx_action_eval_t	*action = (zbx_action_eval_t *)actions->values[i];
+
+		if (EVENT_SOURCE_COUNT <= action->eventsource)
+			continue;
+
+		zbx_vector_uint64_clear(&eventids);
+
+		if (SUCCEED != action_get_candidate_eventids(action, &eventids))
+		{
+			const zbx_vector_ptr_t	*source_events = &esc_events[action->eventsource];
+
+			for (j = 0; j < source_events->values_num; j++)
+			{
+				zbx_vector_uint64_append(&eventids,
+						((const ZBX_DB_EVENT *)source_events->values[j])->eventid);
+			}
+		}
+
+		for (j = 0; j < eventids.values_num; j++)
+		{
+			event_action_local.eventid = eventids.values[j];
+
+			if (NULL == (event_action = (zbx_event_actions_t *)zbx_hashset_search(event_actions,
+					&event_action_local)))
+			{
+				event_action = (zbx_event_actions_t *)zbx_hashset_insert(event_actions,
+						&event_action_local, sizeof(event_action_local));
+				zbx_vector_ptr_create(&event_action->actions);
+			}
+
+			zbx_vector_ptr_append(&event_action->actions, action);
+		}
+	}
+
+	zbx_vector_uint64_destroy(&eventids);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: process all actions of each event in a list                       *
@@ -3079,7 +3181,7 @@ void	process_actions(const zbx_vector_ptr_t *events, const zbx_vector_uint64_pai
 	zbx_vector_ptr_t		actions;
 	zbx_vector_ptr_t 		new_escalations;
 	zbx_vector_uint64_pair_t	rec_escalations;
-	zbx_hashset_t			uniq_conditions[EVENT_SOURCE_COUNT];
+	zbx_hashset_t			uniq_conditions[EVENT_SOURCE_COUNT], event_actions;
 	zbx_vector_ptr_t		esc_events[EVENT_SOURCE_COUNT];
 	zbx_hashset_iter_t		iter;
 	zbx_condition_t			*condition;
@@ -3118,23 +3220,31 @@ void	process_actions(const zbx_vector_ptr_t *events, const zbx_vector_uint64_pai
 
 	zbx_dc_close_user_macros(um_handle);
 
+	zbx_hashset_create_ext(&event_actions, events->values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)event_actions_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	index_actions_by_events(&actions, esc_events, &event_actions);
+
 	/* 1. All event sources: match PROBLEM events to action conditions, add them to 'new_escalations' list.      */
 	/* 2. EVENT_SOURCE_DISCOVERY, EVENT_SOURCE_AUTOREGISTRATION: execute operations (except command and message  */
 	/*    operations) for events that match action conditions.                                                   */
 	for (i = 0; i < events->values_num; i++)
 	{
-		int		j;
+		int			j;
 		const ZBX_DB_EVENT	*event;
+		zbx_event_actions_t	*event_action;
 
 		if (FAIL == is_escalation_event((event = (const ZBX_DB_EVENT *)events->values[i])))
 			continue;
 
-		for (j = 0; j < actions.values_num; j++)
-		{
-			zbx_action_eval_t	*action = (zbx_action_eval_t *)actions.values[j];
+		/* check only actions that can match the event */
+		if (NULL == (event_action = (zbx_event_actions_t *)zbx_hashset_search(&event_actions, &event->eventid)))
+			continue;
 
-			if (action->eventsource != event->source)
-				continue;
+		for (j = 0; j < event_action->actions.values_num; j++)
+		{
+			zbx_action_eval_t	*action = (zbx_action_eval_t *)event_action->actions.values[j];
 
 			if (SUCCEED == check_action_conditions(event->eventid, action))
 			{
@@ -3156,6 +3266,8 @@ void	process_actions(const zbx_vector_ptr_t *events, const zbx_vector_uint64_pai
 		}
 	}
 
+	zbx_hashset_destroy(&event_actions);
+
 	for (i = 0; i < EVENT_SOURCE_COUNT; i++)
 	{
 		zbx_vector_ptr_destroy(&esc_events[i]);
@@ -3540,3 +3652,7 @@ void	free_db_action(DB_ACTION *action)
 	zbx_free(action->name);
 	zbx_free(action);
 }
+
+#ifdef HAVE_TESTS
+#	include "../../tests/zabbix_server/actions/actions_test.c"
+#endif
@@ -56,6 +56,9 @@ extern int	CONFIG_ESCALATOR_FORKS;
 #define ZBX_ROLE_RULE_TYPE_STR		1
 #define ZBX_ROLE_RULE_TYPE_SERVICEID	3
 
+#define ZBX_USER_PERM_RIGHTS		0x01
+#define ZBX_USER_PERM_TAG_FILTERS	0x02
+
 #define ZBX_SERVICES_RULE_PREFIX	"services."
 
 typedef struct
@@ -104,6 +107,36 @@ typedef enum
 }
 zbx_vc_item_update_type_t;
 
+/* user permission data, cached for one escalator cycle */
+typedef struct
+{
+	zbx_uint64_t			userid;
+	zbx_uint64_t			roleid;
+	char				*timezone;
+	int				type;
+
+	/* host group id, permission pairs sorted by host group id */
+	zbx_vector_uint64_pair_t	rights;
+
+	zbx_vector_ptr_t		tag_filters;
+
+	/* the loaded permission data, see ZBX_USER_PERM_* defines */
+	unsigned char			flags;
+}
+zbx_user_perm_t;
+
+/* host groups of trigger or item, cached for one escalator cycle */
+typedef struct
+{
+	zbx_uint64_t		objectid;
+	zbx_vector_uint64_t	groupids;
+}
+zbx_object_hostgroups_t;
+
+static zbx_hashset_t	user_perms;
+static zbx_hashset_t	trigger_hostgroups;
+static zbx_hashset_t	item_hostgroups;
+
 static void	zbx_tag_filter_free(zbx_tag_filter_t *tag_filter)
 {
 	zbx_free(tag_filter->tag);
@@ -111,6 +144,148 @@ static void	zbx_tag_filter_free(zbx_tag_filter_t *tag_filter)
 	zbx_free(tag_filter);
 }
 
+static void	user_perm_clean(zbx_user_perm_t *perm)
+{
+	zbx_free(perm->timezone);
+	zbx_vector_uint64_pair_destroy(&perm->rights);
+	zbx_vector_ptr_clear_ext(&perm->tag_filters, (zbx_clean_func_t)zbx_tag_filter_free);
+	zbx_vector_ptr_destroy(&perm->tag_filters);
+}
+
+static void	object_hostgroups_clean(zbx_object_hostgroups_t *hostgroups)
+{
+	zbx_vector_uint64_destroy(&hostgroups->groupids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes permission cache                                      *
+ *                                                                            *
+ * Comments: The permission cache is used to avoid repeated permission        *
+ *           queries when the same users are notified about multiple events.  *
+ *           It's cleared at the end of every escalator cycle, so permission  *
+ *           changes made during a cycle are applied by the next cycle.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	perm_cache_init(void)
+{
+	zbx_hashset_create_ext(&user_perms, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			(zbx_clean_func_t)user_perm_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&trigger_hostgroups, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)object_hostgroups_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&item_hostgroups, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)object_hostgroups_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+}
+
+static void	perm_cache_clear(void)
+{
+	zbx_hashset_clear(&user_perms);
+	zbx_hashset_clear(&trigger_hostgroups);
+	zbx_hashset_clear(&item_hostgroups);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets cached user permission data, reading user information from   *
+ *          database if the user is not cached yet                            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_user_perm_t	*user_perm_get(zbx_uint64_t userid)
+{
+	zbx_user_perm_t	*perm, perm_local;
+	DB_RESULT	result;
+	DB_ROW		row;
+
+	if (NULL != (perm = (zbx_user_perm_t *)zbx_hashset_search(&user_perms, &userid)))
+		return perm;
+
+	perm_local.userid = userid;
+	perm_local.roleid = 0;
+	perm_local.timezone = NULL;
+	perm_local.type = -1;
+	perm_local.flags = 0;
+
+	result = DBselect("select r.type,u.roleid,u.timezone from users u,role r where u.roleid=r.roleid and"
+			" userid=" ZBX_FS_UI64, userid);
+
+	if (NULL != (row = DBfetch(result)) && FAIL == DBis_null(row[0]))
+	{
+		perm_local.type = atoi(row[0]);
+		ZBX_STR2UINT64(perm_local.roleid, row[1]);
+		perm_local.timezone = zbx_strdup(NULL, row[2]);
+	}
+
+	DBfree_result(result);
+
+	perm = (zbx_user_perm_t *)zbx_hashset_insert(&user_perms, &perm_local, sizeof(perm_local));
+	zbx_vector_uint64_pair_create(&perm->rights);
+	zbx_vector_ptr_create(&perm->tag_filters);
+
+	return perm;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets host groups of trigger or item                               *
+ *                                                                            *
+ * Parameters: object   - [IN] EVENT_OBJECT_TRIGGER or EVENT_OBJECT_ITEM      *
+ *             objectid - [IN] the trigger or item identifier                 *
+ *                                                                            *
+ * Return value: the sorted host group identifiers                            *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_vector_uint64_t	*get_object_hostgroupids(int object, zbx_uint64_t objectid)
+{
+	zbx_hashset_t		*cache;
+	zbx_object_hostgroups_t	*hostgroups, hostgroups_local;
+	DB_RESULT		result;
+	DB_ROW			row;
+	zbx_uint64_t		hostgroupid;
+
+	cache = (EVENT_OBJECT_TRIGGER == object ? &trigger_hostgroups : &item_hostgroups);
+
+	if (NULL != (hostgroups = (zbx_object_hostgroups_t *)zbx_hashset_search(cache, &objectid)))
+		return &hostgroups->groupids;
+
+	hostgroups_local.objectid = objectid;
+	hostgroups = (zbx_object_hostgroups_t *)zbx_hashset_insert(cache, &hostgroups_local,
+			sizeof(hostgroups_local));
+	zbx_vector_uint64_create(&hostgroups->groupids);
+
+	if (EVENT_OBJECT_TRIGGER == object)
+	{
+		result = DBselect(
+				"select distinct hg.groupid from items i"
+				" join functions f on i.itemid=f.itemid"
+				" join hosts_groups hg on hg.hostid = i.hostid"
+					" and f.triggerid=" ZBX_FS_UI64,
+				objectid);
+	}
+	else
+	{
+		result = DBselect(
+				"select hg.groupid from items i"
+				" join hosts_groups hg on hg.hostid=i.hostid"
+				" where i.itemid=" ZBX_FS_UI64,
+				objectid);
+	}
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(hostgroupid, row[0]);
+		zbx_vector_uint64_append(&hostgroups->groupids, hostgroupid);
+	}
+	DBfree_result(result);
+
+	zbx_vector_uint64_sort(&hostgroups->groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&hostgroups->groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	return &hostgroups->groupids;
+}
+
 extern ZBX_THREAD_LOCAL unsigned char	process_type;
 extern unsigned char			program_type;
 extern ZBX_THREAD_LOCAL int		server_num, process_num;
@@ -122,25 +297,19 @@ static void	add_message_alert(const ZBX_DB_EVENT *event, const ZBX_DB_EVENT *r_e
 
 static int	get_user_info(zbx_uint64_t userid, zbx_uint64_t *roleid, char **user_timezone)
 {
-	int		user_type = -1;
-	DB_RESULT	result;
-	DB_ROW		row;
+	const zbx_user_perm_t	*perm;
 
-	*user_timezone = NULL;
+	perm = user_perm_get(userid);
 
-	result = DBselect("select r.type,u.roleid,u.timezone from users u,role r where u.roleid=r.roleid and"
-			" userid=" ZBX_FS_UI64, userid);
+	*user_timezone = NULL;
 
-	if (NULL != (row = DBfetch(result)) && FAIL == DBis_null(row[0]))
+	if (-1 != perm->type)
 	{
-		user_type = atoi(row[0]);
-		ZBX_STR2UINT64(*roleid, row[1]);
-		*user_timezone = zbx_strdup(NULL, row[2]);
+		*roleid = perm->roleid;
+		*user_timezone = zbx_strdup(NULL, perm->timezone);
 	}
 
-	DBfree_result(result);
-
-	return user_type;
+	return perm->type;
 }
 
 /******************************************************************************
@@ -153,33 +322,57 @@ static int	get_user_info(zbx_uint64_t userid, zbx_uint64_t *roleid, char **user_
  *                   or permission otherwise                                  *
  *                                                                            *
  ******************************************************************************/
-static int	get_hostgroups_permission(zbx_uint64_t userid, zbx_vector_uint64_t *hostgroupids)
+static int	get_hostgroups_permission(zbx_uint64_t userid, const zbx_vector_uint64_t *hostgroupids)
 {
-	int		perm = PERM_DENY;
-	char		*sql = NULL;
-	size_t		sql_alloc = 0, sql_offset = 0;
-	DB_RESULT	result;
-	DB_ROW		row;
+	int			i, index, perm = PERM_DENY, found = 0;
+	zbx_user_perm_t		*user_perm;
+	zbx_uint64_pair_t	pair;
+	DB_RESULT		result;
+	DB_ROW			row;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (0 == hostgroupids->values_num)
 		goto out;
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select min(r.permission)"
-			" from rights r"
-			" join users_groups ug on ug.usrgrpid=r.groupid"
-				" where ug.userid=" ZBX_FS_UI64 " and", userid);
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "r.id",
-			hostgroupids->values, hostgroupids->values_num);
-	result = DBselect("%s", sql);
+	user_perm = user_perm_get(userid);
 
-	if (NULL != (row = DBfetch(result)) && FAIL == DBis_null(row[0]))
-		perm = atoi(row[0]);
+	if (0 == (user_perm->flags & ZBX_USER_PERM_RIGHTS))
+	{
+		result = DBselect(
+				"select r.id,min(r.permission)"
+				" from rights r"
+				" join users_groups ug on ug.usrgrpid=r.groupid"
+					" where ug.userid=" ZBX_FS_UI64
+				" group by r.id", userid);
 
-	DBfree_result(result);
-	zbx_free(sql);
+		while (NULL != (row = DBfetch(result)))
+		{
+			ZBX_STR2UINT64(pair.first, row[0]);
+			pair.second = (zbx_uint64_t)atoi(row[1]);
+			zbx_vector_uint64_pair_append(&user_perm->rights, pair);
+		}
+		DBfree_result(result);
+
+		zbx_vector_uint64_pair_sort(&user_perm->rights, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		user_perm->flags |= ZBX_USER_PERM_RIGHTS;
+	}
+
+	for (i = 0; i < hostgroupids->values_num; i++)
+	{
+		pair.first = hostgroupids->values[i];
+
+		if (FAIL == (index = zbx_vector_uint64_pair_bsearch(&user_perm->rights, pair,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+		{
+			continue;
+		}
+
+		if (0 == found || (int)user_perm->rights.values[index].second < perm)
+			perm = (int)user_perm->rights.values[index].second;
+
+		found = 1;
+	}
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_permission_string(perm));
 
@@ -199,49 +392,53 @@ out:
  *               FAIL    - user does not have access                          *
  *                                                                            *
  ******************************************************************************/
-static int	check_tag_based_permission(zbx_uint64_t userid, zbx_vector_uint64_t *hostgroupids,
+static int	check_tag_based_permission(zbx_uint64_t userid, const zbx_vector_uint64_t *hostgroupids,
 		const ZBX_DB_EVENT *event)
 {
-	char			*sql = NULL, hostgroupid[ZBX_MAX_UINT64_LEN + 1];
-	size_t			sql_alloc = 0, sql_offset = 0;
+	char			hostgroupid[ZBX_MAX_UINT64_LEN + 1];
 	DB_RESULT		result;
 	DB_ROW			row;
 	int			ret = FAIL, i;
-	zbx_vector_ptr_t	tag_filters;
+	zbx_vector_ptr_t	*tag_filters;
 	zbx_tag_filter_t	*tag_filter;
 	zbx_condition_t		condition;
+	zbx_user_perm_t		*user_perm;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_vector_ptr_create(&tag_filters);
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select tf.groupid,tf.tag,tf.value from tag_filter tf"
-			" join users_groups ug on ug.usrgrpid=tf.usrgrpid"
-				" where ug.userid=" ZBX_FS_UI64, userid);
-	result = DBselect("%s order by tf.groupid", sql);
+	user_perm = user_perm_get(userid);
+	tag_filters = &user_perm->tag_filters;
 
-	while (NULL != (row = DBfetch(result)))
+	if (0 == (user_perm->flags & ZBX_USER_PERM_TAG_FILTERS))
 	{
-		tag_filter = (zbx_tag_filter_t *)zbx_malloc(NULL, sizeof(zbx_tag_filter_t));
-		ZBX_STR2UINT64(tag_filter->hostgroupid, row[0]);
-		tag_filter->tag = zbx_strdup(NULL, row[1]);
-		tag_filter->value = zbx_strdup(NULL, row[2]);
-		zbx_vector_ptr_append(&tag_filters, tag_filter);
+		result = DBselect("select tf.groupid,tf.tag,tf.value from tag_filter tf"
+				" join users_groups ug on ug.usrgrpid=tf.usrgrpid"
+					" where ug.userid=" ZBX_FS_UI64
+				" order by tf.groupid", userid);
+
+		while (NULL != (row = DBfetch(result)))
+		{
+			tag_filter = (zbx_tag_filter_t *)zbx_malloc(NULL, sizeof(zbx_tag_filter_t));
+			ZBX_STR2UINT64(tag_filter->hostgroupid, row[0]);
+			tag_filter->tag = zbx_strdup(NULL, row[1]);
+			tag_filter->value = zbx_strdup(NULL, row[2]);
+			zbx_vector_ptr_append(tag_filters, tag_filter);
+		}
+		DBfree_result(result);
+
+		user_perm->flags |= ZBX_USER_PERM_TAG_FILTERS;
 	}
-	zbx_free(sql);
-	DBfree_result(result);
 
-	if (0 < tag_filters.values_num)
+	if (0 < tag_filters->values_num)
 		condition.op = CONDITION_OPERATOR_EQUAL;
 	else
 		ret = SUCCEED;
 
-	for (i = 0; i < tag_filters.values_num && SUCCEED != ret; i++)
+	for (i = 0; i < tag_filters->values_num && SUCCEED != ret; i++)
 	{
-		tag_filter = (zbx_tag_filter_t *)tag_filters.values[i];
+		tag_filter = (zbx_tag_filter_t *)tag_filters->values[i];
 
-		if (FAIL == zbx_vector_uint64_search(hostgroupids, tag_filter->hostgroupid,
+		if (FAIL == zbx_vector_uint64_bsearch(hostgroupids, tag_filter->hostgroupid,
 				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
 		{
 			continue;
@@ -270,8 +467,6 @@ static int	check_tag_based_permission(zbx_uint64_t userid, zbx_vector_uint64_t *
 		else
 			ret = SUCCEED;
 	}
-	zbx_vector_ptr_clear_ext(&tag_filters, (zbx_clean_func_t)zbx_tag_filter_free);
-	zbx_vector_ptr_destroy(&tag_filters);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -288,11 +483,9 @@ static int	check_tag_based_permission(zbx_uint64_t userid, zbx_vector_uint64_t *
  ******************************************************************************/
 static int	get_trigger_permission(zbx_uint64_t userid, const ZBX_DB_EVENT *event, char **user_timezone)
 {
-	int			perm = PERM_DENY;
-	DB_RESULT		result;
-	DB_ROW			row;
-	zbx_vector_uint64_t	hostgroupids;
-	zbx_uint64_t		hostgroupid, roleid;
+	int				perm = PERM_DENY;
+	const zbx_vector_uint64_t	*hostgroupids;
+	zbx_uint64_t			roleid;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -302,31 +495,13 @@ static int	get_trigger_permission(zbx_uint64_t userid, const ZBX_DB_EVENT *event
 		goto out;
 	}
 
-	zbx_vector_uint64_create(&hostgroupids);
-
-	result = DBselect(
-			"select distinct hg.groupid from items i"
-			" join functions f on i.itemid=f.itemid"
-			" join hosts_groups hg on hg.hostid = i.hostid"
-				" and f.triggerid=" ZBX_FS_UI64,
-			event->objectid);
-
-	while (NULL != (row = DBfetch(result)))
-	{
-		ZBX_STR2UINT64(hostgroupid, row[0]);
-		zbx_vector_uint64_append(&hostgroupids, hostgroupid);
-	}
-	DBfree_result(result);
-
-	zbx_vector_uint64_sort(&hostgroupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	hostgroupids = get_object_hostgroupids(EVENT_OBJECT_TRIGGER, event->objectid);
 
-	if (PERM_DENY < (perm = get_hostgroups_permission(userid, &hostgroupids)) &&
-			FAIL == check_tag_based_permission(userid, &hostgroupids, event))
+	if (PERM_DENY < (perm = get_hostgroups_permission(userid, hostgroupids)) &&
+			FAIL == check_tag_based_permission(userid, hostgroupids, event))
 	{
 		perm = PERM_DENY;
 	}
-
-	zbx_vector_uint64_destroy(&hostgroupids);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_permission_string(perm));
 
@@ -343,39 +518,19 @@ out:
  ******************************************************************************/
 static int	get_item_permission(zbx_uint64_t userid, zbx_uint64_t itemid, char **user_timezone)
 {
-	DB_RESULT		result;
-	DB_ROW			row;
-	int			perm = PERM_DENY;
-	zbx_vector_uint64_t	hostgroupids;
-	zbx_uint64_t		hostgroupid, roleid;
+	int		perm = PERM_DENY;
+	zbx_uint64_t	roleid;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_vector_uint64_create(&hostgroupids);
-	zbx_vector_uint64_sort(&hostgroupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
 	if (USER_TYPE_SUPER_ADMIN == get_user_info(userid, &roleid, user_timezone))
 	{
 		perm = PERM_READ_WRITE;
 		goto out;
 	}
 
-	result = DBselect(
-			"select hg.groupid from items i"
-			" join hosts_groups hg on hg.hostid=i.hostid"
-			" where i.itemid=" ZBX_FS_UI64,
-			itemid);
-
-	while (NULL != (row = DBfetch(result)))
-	{
-		ZBX_STR2UINT64(hostgroupid, row[0]);
-		zbx_vector_uint64_append(&hostgroupids, hostgroupid);
-	}
-	DBfree_result(result);
-
-	perm = get_hostgroups_permission(userid, &hostgroupids);
+	perm = get_hostgroups_permission(userid, get_object_hostgroupids(EVENT_OBJECT_ITEM, itemid));
 out:
-	zbx_vector_uint64_destroy(&hostgroupids);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_permission_string(perm));
 
@@ -3416,6 +3571,8 @@ ZBX_THREAD_ENTRY(escalator_thread, args)
 
 	DBconnect(ZBX_DB_CONNECT_NORMAL);
 
+	perm_cache_init();
+
 	while (ZBX_IS_RUNNING())
 	{
 		sec = zbx_time();
@@ -3441,6 +3598,7 @@ ZBX_THREAD_ENTRY(escalator_thread, args)
 				cfg.default_timezone);
 
 		zbx_config_clean(&cfg);
+		perm_cache_clear();
 		total_sec += zbx_time() - sec;
 
 		sleeptime = calculate_sleeptime(nextcheck, CONFIG_ESCALATOR_FREQUENCY);
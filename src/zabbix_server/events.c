@@ -639,53 +639,6 @@ static ZBX_DB_EVENT	*get_event_by_source_object_id(int source, int object, zbx_u
 	return NULL;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: checks if the event matches the specified host group              *
- *          (including nested groups)                                         *
- *                                                                            *
- * Parameters: event   - [IN] the new event to check                          *
- *             groupid - [IN] the group id to match                           *
- *                                                                            *
- * Return value: SUCCEED - the group matches                                  *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	correlation_match_event_hostgroup(const ZBX_DB_EVENT *event, zbx_uint64_t groupid)
-{
-	DB_RESULT		result;
-	int			ret = FAIL;
-	zbx_vector_uint64_t	groupids;
-	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0;
-
-	zbx_vector_uint64_create(&groupids);
-	zbx_dc_get_nested_hostgroupids(&groupid, 1, &groupids);
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select hg.groupid"
-				" from hstgrp g,hosts_groups hg,items i,functions f"
-				" where f.triggerid=" ZBX_FS_UI64
-				" and i.itemid=f.itemid"
-				" and hg.hostid=i.hostid"
-				" and",
-				event->objectid);
-
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "hg.groupid", groupids.values,
-			groupids.values_num);
-
-	result = DBselect("%s", sql);
-
-	if (NULL != DBfetch(result))
-		ret = SUCCEED;
-
-	DBfree_result(result);
-	zbx_free(sql);
-	zbx_vector_uint64_destroy(&groupids);
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: checks if the correlation condition matches the new event         *
@@ -745,7 +698,7 @@ static const char	*correlation_condition_match_new_event(zbx_corr_condition_t *c
 			break;
 
 		case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
-			ret =  correlation_match_event_hostgroup(event, condition->data.group.groupid);
+			ret = zbx_dc_check_trigger_hostgroup(event->objectid, condition->data.group.groupid);
 
 			if (CONDITION_OPERATOR_NOT_EQUAL == condition->data.group.op)
 				return (SUCCEED == ret ? "0" : "1");
@@ -757,47 +710,657 @@ static const char	*correlation_condition_match_new_event(zbx_corr_condition_t *c
 			{
 				tag = (zbx_tag_t *)event->tags.values[i];
 
-				if (0 == strcmp(tag->tag, condition->data.tag_pair.newtag))
-					return (SUCCEED == old_value) ? ZBX_UNKNOWN_STR "0" : "0";
+				if (0 == strcmp(tag->tag, condition->data.tag_pair.newtag))
+					return (SUCCEED == old_value) ? ZBX_UNKNOWN_STR "0" : "0";
+			}
+			break;
+	}
+
+	return "0";
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the correlation rule might match the new event          *
+ *                                                                            *
+ * Parameters: correlation - [IN] the correlation rule to check               *
+ *             event       - [IN] the new event to match                      *
+ *             old_value   - [IN] SUCCEED - the old event conditions may      *
+ *                                          match event                       *
+ *                                FAIL    - the old event conditions never    *
+ *                                          match event                       *
+ *                                                                            *
+ * Return value: CORRELATION_MATCH     - the correlation rule match           *
+ *               CORRELATION_MAY_MATCH - the correlation rule might match     *
+ *                                       depending on old events              *
+ *               CORRELATION_NO_MATCH  - the correlation rule doesn't match   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_correlation_match_result_t	correlation_match_new_event(zbx_correlation_t *correlation,
+		const ZBX_DB_EVENT *event, int old_value)
+{
+	char				*expression, error[256];
+	const char			*value;
+	zbx_token_t			token;
+	int				pos = 0;
+	zbx_uint64_t			conditionid;
+	zbx_strloc_t			*loc;
+	zbx_corr_condition_t		*condition;
+	double				result;
+	zbx_correlation_match_result_t	ret = CORRELATION_NO_MATCH;
+
+	if ('\0' == *correlation->formula)
+		return CORRELATION_MAY_MATCH;
+
+	expression = zbx_strdup(NULL, correlation->formula);
+
+	for (; SUCCEED == zbx_token_find(expression, pos, &token, ZBX_TOKEN_SEARCH_BASIC); pos++)
+	{
+		if (ZBX_TOKEN_OBJECTID != token.type)
+			continue;
+
+		loc = &token.data.objectid.name;
+
+		if (SUCCEED != is_uint64_n(expression + loc->l, loc->r - loc->l + 1, &conditionid))
+			continue;
+
+		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions,
+				&conditionid)))
+			goto out;
+
+		value = correlation_condition_match_new_event(condition, event, old_value);
+
+		zbx_replace_string(&expression, token.loc.l, &token.loc.r, value);
+		pos = token.loc.r;
+	}
+
+	if (SUCCEED == zbx_evaluate_unknown(expression, &result, error, sizeof(error)))
+	{
+		if (result == ZBX_UNKNOWN)
+			ret = CORRELATION_MAY_MATCH;
+		else if (SUCCEED == zbx_double_compare(result, 1))
+			ret = CORRELATION_MATCH;
+	}
+
+out:
+	zbx_free(expression);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if correlation has operations to change old events         *
+ *                                                                            *
+ * Parameters: correlation - [IN] the correlation to check                    *
+ *                                                                            *
+ * Return value: SUCCEED - correlation has operations to change old events    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	correlation_has_old_event_operation(const zbx_correlation_t *correlation)
+{
+	int				i;
+	const zbx_corr_operation_t	*operation;
+
+	for (i = 0; i < correlation->operations.values_num; i++)
+	{
+		operation = (zbx_corr_operation_t *)correlation->operations.values[i];
+
+		switch (operation->type)
+		{
+			case ZBX_CORR_OPERATION_CLOSE_OLD:
+				return SUCCEED;
+		}
+	}
+
+	return FAIL;
+}
+
+/* open problem tag, used by correlation problem index */
+typedef struct
+{
+	zbx_uint64_t	eventid;
+	char		*tag;
+	char		*value;
+}
+zbx_corr_problem_tag_t;
+
+/* problem tag name index entry */
+typedef struct
+{
+	const char		*tag;
+	zbx_vector_ptr_t	problem_tags;
+}
+zbx_corr_tag_t;
+
+/* problem tag name and value index entry */
+typedef struct
+{
+	const char		*tag;
+	const char		*value;
+	zbx_vector_uint64_t	eventids;
+}
+zbx_corr_tag_value_t;
+
+/* the minimum number of new events in batch to index open problems, smaller */
+/* batches are matched against open problems with per event sql queries      */
+#define ZBX_CORR_INDEX_EVENTS_MIN	100
+
+/* flag to cache state of problem table during event correlation */
+typedef enum
+{
+	/* unknown state, not initialized */
+	ZBX_PROBLEM_STATE_UNKNOWN = -1,
+	/* all problems are resolved */
+	ZBX_PROBLEM_STATE_RESOLVED,
+	/* at least one open problem exists */
+	ZBX_PROBLEM_STATE_OPEN
+}
+zbx_problem_state_t;
+
+/* open problems indexed by tags referenced in old event correlation conditions */
+typedef struct
+{
+	/* the problem table state, checked on first request */
+	zbx_problem_state_t		state;
+
+	/* open problems are loaded and indexed only for large event batches */
+	unsigned char			index;
+
+	/* open problem eventid, objectid pairs sorted by eventid */
+	zbx_vector_uint64_pair_t	problems;
+	zbx_vector_ptr_t		problem_tags;
+
+	zbx_hashset_t			tags;
+	zbx_hashset_t			tag_values;
+}
+zbx_corr_problems_t;
+
+/* correlation condition match result for the new event */
+typedef struct
+{
+	zbx_uint64_t		conditionid;
+
+	/* the condition value for conditions not depending on old events, otherwise -1 */
+	int			value;
+
+	/* the sorted ids of problems matching old event condition */
+	zbx_vector_uint64_t	eventids;
+
+	/* the old event condition is negated (not equal, not like operators) */
+	unsigned char		negate;
+}
+zbx_corr_condition_match_t;
+
+static zbx_hash_t	corr_tag_hash(const void *data)
+{
+	const zbx_corr_tag_t	*tag = (const zbx_corr_tag_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(tag->tag);
+}
+
+static int	corr_tag_compare(const void *d1, const void *d2)
+{
+	const zbx_corr_tag_t	*tag1 = (const zbx_corr_tag_t *)d1;
+	const zbx_corr_tag_t	*tag2 = (const zbx_corr_tag_t *)d2;
+
+	return strcmp(tag1->tag, tag2->tag);
+}
+
+static void	corr_tag_clean(zbx_corr_tag_t *tag)
+{
+	zbx_vector_ptr_destroy(&tag->problem_tags);
+}
+
+static zbx_hash_t	corr_tag_value_hash(const void *data)
+{
+	const zbx_corr_tag_value_t	*tag = (const zbx_corr_tag_value_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(tag->tag);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(tag->value, strlen(tag->value), hash);
+}
+
+static int	corr_tag_value_compare(const void *d1, const void *d2)
+{
+	const zbx_corr_tag_value_t	*tag1 = (const zbx_corr_tag_value_t *)d1;
+	const zbx_corr_tag_value_t	*tag2 = (const zbx_corr_tag_value_t *)d2;
+	int				ret;
+
+	if (0 != (ret = strcmp(tag1->tag, tag2->tag)))
+		return ret;
+
+	return strcmp(tag1->value, tag2->value);
+}
+
+static void	corr_tag_value_clean(zbx_corr_tag_value_t *tag)
+{
+	zbx_vector_uint64_destroy(&tag->eventids);
+}
+
+static void	corr_problem_tag_free(zbx_corr_problem_tag_t *ptag)
+{
+	zbx_free(ptag->tag);
+	zbx_free(ptag->value);
+	zbx_free(ptag);
+}
+
+static void	corr_condition_match_free(zbx_corr_condition_match_t *match)
+{
+	zbx_vector_uint64_destroy(&match->eventids);
+	zbx_free(match);
+}
+
+static void	correlation_problems_init(zbx_corr_problems_t *problems, unsigned char index)
+{
+	problems->state = ZBX_PROBLEM_STATE_UNKNOWN;
+	problems->index = index;
+
+	zbx_vector_uint64_pair_create(&problems->problems);
+	zbx_vector_ptr_create(&problems->problem_tags);
+
+	zbx_hashset_create_ext(&problems->tags, 100, corr_tag_hash, corr_tag_compare,
+			(zbx_clean_func_t)corr_tag_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&problems->tag_values, 100, corr_tag_value_hash, corr_tag_value_compare,
+			(zbx_clean_func_t)corr_tag_value_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC,
+			ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+}
+
+static void	correlation_problems_destroy(zbx_corr_problems_t *problems)
+{
+	zbx_hashset_destroy(&problems->tag_values);
+	zbx_hashset_destroy(&problems->tags);
+
+	zbx_vector_ptr_clear_ext(&problems->problem_tags, (zbx_clean_func_t)corr_problem_tag_free);
+	zbx_vector_ptr_destroy(&problems->problem_tags);
+	zbx_vector_uint64_pair_destroy(&problems->problems);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets names of tags used by old event correlation conditions       *
+ *                                                                            *
+ * Parameters: tags - [OUT] the tag names                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_get_old_event_tags(zbx_vector_str_t *tags)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_corr_condition_t	*condition;
+
+	zbx_hashset_iter_reset(&correlation_rules.conditions, &iter);
+	while (NULL != (condition = (zbx_corr_condition_t *)zbx_hashset_iter_next(&iter)))
+	{
+		switch (condition->type)
+		{
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+				zbx_vector_str_append(tags, condition->data.tag.tag);
+				break;
+			case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+				zbx_vector_str_append(tags, condition->data.tag_value.tag);
+				break;
+			case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+				zbx_vector_str_append(tags, condition->data.tag_pair.oldtag);
+				break;
+		}
+	}
+
+	zbx_vector_str_sort(tags, ZBX_DEFAULT_STR_COMPARE_FUNC);
+	zbx_vector_str_uniq(tags, ZBX_DEFAULT_STR_COMPARE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if there are open trigger problems and, for large event    *
+ *          batches, loads them and indexes their tags used by correlation    *
+ *          conditions                                                        *
+ *                                                                            *
+ * Parameters: problems - [IN/OUT] the problem index                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_problems_load(zbx_corr_problems_t *problems)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_pair_t	pair;
+	zbx_vector_str_t	tags;
+	zbx_corr_problem_tag_t	*ptag;
+	zbx_corr_tag_t		*tag, tag_local;
+	zbx_corr_tag_value_t	*tag_value, tag_value_local;
+	zbx_hashset_iter_t	iter;
+
+	if (0 == problems->index)
+	{
+		result = DBselectN("select eventid from problem"
+				" where r_eventid is null and source="
+				ZBX_STR(EVENT_SOURCE_TRIGGERS), 1);
+
+		if (NULL == DBfetch(result))
+			problems->state = ZBX_PROBLEM_STATE_RESOLVED;
+		else
+			problems->state = ZBX_PROBLEM_STATE_OPEN;
+		DBfree_result(result);
+
+		return;
+	}
+
+	result = DBselect("select eventid,objectid from problem"
+			" where r_eventid is null and source=" ZBX_STR(EVENT_SOURCE_TRIGGERS));
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(pair.first, row[0]);
+		ZBX_STR2UINT64(pair.second, row[1]);
+		zbx_vector_uint64_pair_append(&problems->problems, pair);
+	}
+	DBfree_result(result);
+
+	if (0 == problems->problems.values_num)
+	{
+		problems->state = ZBX_PROBLEM_STATE_RESOLVED;
+		return;
+	}
+
+	problems->state = ZBX_PROBLEM_STATE_OPEN;
+
+	zbx_vector_uint64_pair_sort(&problems->problems, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_vector_str_create(&tags);
+	correlation_get_old_event_tags(&tags);
+
+	if (0 == tags.values_num)
+		goto out;
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select pt.eventid,pt.tag,pt.value"
+			" from problem p,problem_tag pt"
+			" where p.eventid=pt.eventid"
+				" and p.r_eventid is null"
+				" and p.source=" ZBX_STR(EVENT_SOURCE_TRIGGERS)
+				" and");
+	DBadd_str_condition_alloc(&sql, &sql_alloc, &sql_offset, "pt.tag", (const char **)tags.values,
+			tags.values_num);
+
+	result = DBselect("%s", sql);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ptag = (zbx_corr_problem_tag_t *)zbx_malloc(NULL, sizeof(zbx_corr_problem_tag_t));
+		ZBX_STR2UINT64(ptag->eventid, row[0]);
+		ptag->tag = zbx_strdup(NULL, row[1]);
+		ptag->value = zbx_strdup(NULL, row[2]);
+		zbx_vector_ptr_append(&problems->problem_tags, ptag);
+
+		tag_local.tag = ptag->tag;
+
+		if (NULL == (tag = (zbx_corr_tag_t *)zbx_hashset_search(&problems->tags, &tag_local)))
+		{
+			tag = (zbx_corr_tag_t *)zbx_hashset_insert(&problems->tags, &tag_local, sizeof(tag_local));
+			zbx_vector_ptr_create(&tag->problem_tags);
+		}
+
+		zbx_vector_ptr_append(&tag->problem_tags, ptag);
+
+		tag_value_local.tag = ptag->tag;
+		tag_value_local.value = ptag->value;
+
+		if (NULL == (tag_value = (zbx_corr_tag_value_t *)zbx_hashset_search(&problems->tag_values,
+				&tag_value_local)))
+		{
+			tag_value = (zbx_corr_tag_value_t *)zbx_hashset_insert(&problems->tag_values, &tag_value_local,
+					sizeof(tag_value_local));
+			zbx_vector_uint64_create(&tag_value->eventids);
+		}
+
+		zbx_vector_uint64_append(&tag_value->eventids, ptag->eventid);
+	}
+	DBfree_result(result);
+
+	zbx_hashset_iter_reset(&problems->tag_values, &iter);
+	while (NULL != (tag_value = (zbx_corr_tag_value_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_vector_uint64_sort(&tag_value->eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&tag_value->eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	zbx_free(sql);
+out:
+	zbx_vector_str_destroy(&tags);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: matches value prefix against sql like pattern                     *
+ *                                                                            *
+ * Parameters: value   - [IN] the value to match                              *
+ *             pattern - [IN] the like pattern with implicit trailing '%'     *
+ *                                                                            *
+ * Return value: SUCCEED - the value prefix matches pattern                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: '%' matches any sequence of characters, '_' matches a single     *
+ *           character and '\' escapes the following pattern character,       *
+ *           the same as the database like operator does.                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	correlation_like_match_prefix(const char *value, const char *pattern)
+{
+	while ('\0' != *pattern)
+	{
+		switch (*pattern)
+		{
+			case '%':
+				pattern++;
+
+				for (;; value++)
+				{
+					if (SUCCEED == correlation_like_match_prefix(value, pattern))
+						return SUCCEED;
+
+					if ('\0' == *value)
+						return FAIL;
+				}
+			case '_':
+				if ('\0' == *value)
+					return FAIL;
+
+				value += zbx_utf8_char_len(value);
+				pattern++;
+				continue;
+			case '\\':
+				if ('\0' != pattern[1])
+					pattern++;
+				ZBX_FALLTHROUGH;
+			default:
+				if (*value != *pattern)
+					return FAIL;
+
+				value++;
+				pattern++;
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if value matches old event tag value like condition        *
+ *                                                                            *
+ * Parameters: value   - [IN] the problem tag value                           *
+ *             pattern - [IN] the condition value                             *
+ *                                                                            *
+ * Return value: SUCCEED - the value matches sql like '%pattern%'             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	correlation_like_match(const char *value, const char *pattern)
+{
+	for (;; value++)
+	{
+		if (SUCCEED == correlation_like_match_prefix(value, pattern))
+			return SUCCEED;
+
+		if ('\0' == *value)
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds ids of problems having the tag with the specified value      *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlation_problems_add_tag_value(const zbx_corr_problems_t *problems, const char *tag,
+		const char *value, zbx_vector_uint64_t *eventids)
+{
+	zbx_corr_tag_value_t	*tag_value, tag_value_local;
+
+	tag_value_local.tag = tag;
+	tag_value_local.value = value;
+
+	if (NULL != (tag_value = (zbx_corr_tag_value_t *)zbx_hashset_search(&problems->tag_values, &tag_value_local)))
+		zbx_vector_uint64_append_array(eventids, tag_value->eventids.values, tag_value->eventids.values_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: matches correlation condition against the new event and indexed   *
+ *          open problems                                                     *
+ *                                                                            *
+ * Parameters: condition - [IN] the correlation condition                     *
+ *             event     - [IN] the new event                                 *
+ *             problems  - [IN] the open problem index                        *
+ *                                                                            *
+ * Return value: the condition match result                                   *
+ *                                                                            *
+ * Comments: Conditions on old events are resolved to the set of matching     *
+ *           problems with tag index lookups. Negated conditions store the    *
+ *           set of problems matching the positive condition.                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_corr_condition_match_t	*correlation_condition_match(zbx_corr_condition_t *condition,
+		const ZBX_DB_EVENT *event, const zbx_corr_problems_t *problems)
+{
+	int				i;
+	zbx_tag_t			*tag;
+	zbx_corr_tag_t			*ctag, ctag_local;
+	zbx_corr_problem_tag_t		*ptag;
+	zbx_corr_condition_match_t	*match;
+	zbx_corr_condition_tag_value_t	*cond;
+
+	match = (zbx_corr_condition_match_t *)zbx_malloc(NULL, sizeof(zbx_corr_condition_match_t));
+	match->conditionid = condition->corr_conditionid;
+	match->value = -1;
+	match->negate = 0;
+	zbx_vector_uint64_create(&match->eventids);
+
+	switch (condition->type)
+	{
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+			ctag_local.tag = condition->data.tag.tag;
+
+			if (NULL != (ctag = (zbx_corr_tag_t *)zbx_hashset_search(&problems->tags, &ctag_local)))
+			{
+				for (i = 0; i < ctag->problem_tags.values_num; i++)
+				{
+					ptag = (zbx_corr_problem_tag_t *)ctag->problem_tags.values[i];
+					zbx_vector_uint64_append(&match->eventids, ptag->eventid);
+				}
+			}
+			break;
+
+		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+			for (i = 0; i < event->tags.values_num; i++)
+			{
+				tag = (zbx_tag_t *)event->tags.values[i];
+
+				if (0 == strcmp(tag->tag, condition->data.tag_pair.newtag))
+				{
+					correlation_problems_add_tag_value(problems, condition->data.tag_pair.oldtag,
+							tag->value, &match->eventids);
+				}
+			}
+			break;
+
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+			cond = &condition->data.tag_value;
+
+			switch (cond->op)
+			{
+				case CONDITION_OPERATOR_NOT_EQUAL:
+					match->negate = 1;
+					ZBX_FALLTHROUGH;
+				case CONDITION_OPERATOR_EQUAL:
+					correlation_problems_add_tag_value(problems, cond->tag, cond->value,
+							&match->eventids);
+					break;
+				case CONDITION_OPERATOR_NOT_LIKE:
+					match->negate = 1;
+					ZBX_FALLTHROUGH;
+				case CONDITION_OPERATOR_LIKE:
+					ctag_local.tag = cond->tag;
+
+					if (NULL == (ctag = (zbx_corr_tag_t *)zbx_hashset_search(&problems->tags,
+							&ctag_local)))
+					{
+						break;
+					}
+
+					for (i = 0; i < ctag->problem_tags.values_num; i++)
+					{
+						ptag = (zbx_corr_problem_tag_t *)ctag->problem_tags.values[i];
+
+						if (SUCCEED == correlation_like_match(ptag->value, cond->value))
+							zbx_vector_uint64_append(&match->eventids, ptag->eventid);
+					}
+					break;
 			}
 			break;
+
+		default:
+			match->value = ('1' == *correlation_condition_match_new_event(condition, event, SUCCEED));
+			return match;
 	}
 
-	return "0";
+	zbx_vector_uint64_sort(&match->eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&match->eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	return match;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: checks if the correlation rule might match the new event          *
+ * Purpose: checks if correlation rule matches the new event and open problem *
  *                                                                            *
- * Parameters: correlation - [IN] the correlation rule to check               *
- *             event       - [IN] the new event to match                      *
- *             old_value   - [IN] SUCCEED - the old event conditions may      *
- *                                          match event                       *
- *                                FAIL    - the old event conditions never    *
- *                                          match event                       *
+ * Parameters: correlation - [IN] the correlation rule                        *
+ *             matches     - [IN] the correlation condition match results     *
+ *                                sorted by condition id                      *
+ *             eventid     - [IN] the open problem id, 0 to match a problem   *
+ *                                without any tags used by the rule           *
  *                                                                            *
- * Return value: CORRELATION_MATCH     - the correlation rule match           *
- *               CORRELATION_MAY_MATCH - the correlation rule might match     *
- *                                       depending on old events              *
- *               CORRELATION_NO_MATCH  - the correlation rule doesn't match   *
+ * Return value: SUCCEED - the correlation rule matches                       *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static zbx_correlation_match_result_t	correlation_match_new_event(zbx_correlation_t *correlation,
-		const ZBX_DB_EVENT *event, int old_value)
+static int	correlation_match_problem(const zbx_correlation_t *correlation, const zbx_vector_ptr_t *matches,
+		zbx_uint64_t eventid)
 {
 	char				*expression, error[256];
 	const char			*value;
 	zbx_token_t			token;
-	int				pos = 0;
+	int				pos = 0, index, ret = FAIL;
 	zbx_uint64_t			conditionid;
 	zbx_strloc_t			*loc;
-	zbx_corr_condition_t		*condition;
+	zbx_corr_condition_match_t	*match;
 	double				result;
-	zbx_correlation_match_result_t	ret = CORRELATION_NO_MATCH;
 
 	if ('\0' == *correlation->formula)
-		return CORRELATION_MAY_MATCH;
+		return SUCCEED;
 
 	expression = zbx_strdup(NULL, correlation->formula);
 
@@ -811,24 +1374,37 @@ static zbx_correlation_match_result_t	correlation_match_new_event(zbx_correlatio
 		if (SUCCEED != is_uint64_n(expression + loc->l, loc->r - loc->l + 1, &conditionid))
 			continue;
 
-		if (NULL == (condition = (zbx_corr_condition_t *)zbx_hashset_search(&correlation_rules.conditions,
-				&conditionid)))
+		if (FAIL == (index = zbx_vector_ptr_bsearch(matches, &conditionid,
+				ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
+		{
 			goto out;
+		}
 
-		value = correlation_condition_match_new_event(condition, event, old_value);
+		match = (zbx_corr_condition_match_t *)matches->values[index];
+
+		if (-1 != match->value)
+		{
+			value = (0 != match->value ? "1" : "0");
+		}
+		else
+		{
+			int	found;
+
+			found = (0 != eventid && FAIL != zbx_vector_uint64_bsearch(&match->eventids, eventid,
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC));
+
+			value = (found != match->negate ? "1" : "0");
+		}
 
 		zbx_replace_string(&expression, token.loc.l, &token.loc.r, value);
 		pos = token.loc.r;
 	}
 
-	if (SUCCEED == zbx_evaluate_unknown(expression, &result, error, sizeof(error)))
+	if (SUCCEED == zbx_evaluate_unknown(expression, &result, error, sizeof(error)) &&
+			SUCCEED == zbx_double_compare(result, 1))
 	{
-		if (result == ZBX_UNKNOWN)
-			ret = CORRELATION_MAY_MATCH;
-		else if (SUCCEED == zbx_double_compare(result, 1))
-			ret = CORRELATION_MATCH;
+		ret = SUCCEED;
 	}
-
 out:
 	zbx_free(expression);
 
@@ -837,31 +1413,73 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: checks if correlation has operations to change old events         *
+ * Purpose: finds open problems matching correlation rule for the new event   *
  *                                                                            *
- * Parameters: correlation - [IN] the correlation to check                    *
+ * Parameters: correlation - [IN] the correlation rule                        *
+ *             event       - [IN] the new event                               *
+ *             problems    - [IN] the open problem index                      *
+ *             eventids    - [OUT] the sorted ids of matching problems        *
  *                                                                            *
- * Return value: SUCCEED - correlation has operations to change old events    *
- *               FAIL    - otherwise                                          *
+ * Comments: All problems without tags referenced by correlation conditions   *
+ *           evaluate the same, so only problems found by tag index lookups   *
+ *           are checked individually unless such problems match too.         *
  *                                                                            *
  ******************************************************************************/
-static int	correlation_has_old_event_operation(const zbx_correlation_t *correlation)
+static void	correlation_get_matching_problems(const zbx_correlation_t *correlation, const ZBX_DB_EVENT *event,
+		const zbx_corr_problems_t *problems, zbx_vector_uint64_t *eventids)
 {
 	int				i;
-	const zbx_corr_operation_t	*operation;
+	zbx_vector_ptr_t		matches;
+	zbx_vector_uint64_t		candidates;
+	zbx_corr_condition_match_t	*match;
 
-	for (i = 0; i < correlation->operations.values_num; i++)
+	zbx_vector_ptr_create(&matches);
+	zbx_vector_uint64_create(&candidates);
+
+	for (i = 0; i < correlation->conditions.values_num; i++)
 	{
-		operation = (zbx_corr_operation_t *)correlation->operations.values[i];
+		match = correlation_condition_match((zbx_corr_condition_t *)correlation->conditions.values[i], event,
+				problems);
+		zbx_vector_ptr_append(&matches, match);
 
-		switch (operation->type)
+		if (-1 == match->value)
 		{
-			case ZBX_CORR_OPERATION_CLOSE_OLD:
-				return SUCCEED;
+			zbx_vector_uint64_append_array(&candidates, match->eventids.values,
+					match->eventids.values_num);
 		}
 	}
 
-	return FAIL;
+	zbx_vector_ptr_sort(&matches, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+
+	zbx_vector_uint64_sort(&candidates, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&candidates, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	if (SUCCEED == correlation_match_problem(correlation, &matches, 0))
+	{
+		/* problems without referenced tags match, others must be checked individually */
+		for (i = 0; i < problems->problems.values_num; i++)
+		{
+			zbx_uint64_t	eventid = problems->problems.values[i].first;
+
+			if (FAIL == zbx_vector_uint64_bsearch(&candidates, eventid, ZBX_DEFAULT_UINT64_COMPARE_FUNC) ||
+					SUCCEED == correlation_match_problem(correlation, &matches, eventid))
+			{
+				zbx_vector_uint64_append(eventids, eventid);
+			}
+		}
+	}
+	else
+	{
+		for (i = 0; i < candidates.values_num; i++)
+		{
+			if (SUCCEED == correlation_match_problem(correlation, &matches, candidates.values[i]))
+				zbx_vector_uint64_append(eventids, candidates.values[i]);
+		}
+	}
+
+	zbx_vector_uint64_destroy(&candidates);
+	zbx_vector_ptr_clear_ext(&matches, (zbx_clean_func_t)corr_condition_match_free);
+	zbx_vector_ptr_destroy(&matches);
 }
 
 /******************************************************************************
@@ -1141,25 +1759,125 @@ typedef enum
 }
 zbx_correlation_scope_t;
 
-/* flag to cache state of problem table during event correlation */
-typedef enum
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes correlation rules for the new event and open problems    *
+ *          found with tag index lookups                                      *
+ *                                                                            *
+ * Parameters: event    - [IN] the new event                                  *
+ *             corr_old - [IN] the correlation rules to match open problems   *
+ *             problems - [IN] the open problem index                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlate_event_by_problem_index(ZBX_DB_EVENT *event, const zbx_vector_ptr_t *corr_old,
+		const zbx_corr_problems_t *problems)
 {
-	/* unknown state, not initialized */
-	ZBX_PROBLEM_STATE_UNKNOWN = -1,
-	/* all problems are resolved */
-	ZBX_PROBLEM_STATE_RESOLVED,
-	/* at least one open problem exists */
-	ZBX_PROBLEM_STATE_OPEN
+	int			i, j, index;
+	zbx_correlation_t	*correlation;
+	zbx_vector_uint64_t	eventids;
+	zbx_uint64_pair_t	pair;
+
+	zbx_vector_uint64_create(&eventids);
+
+	for (i = 0; i < corr_old->values_num; i++)
+	{
+		correlation = (zbx_correlation_t *)corr_old->values[i];
+
+		zbx_vector_uint64_clear(&eventids);
+		correlation_get_matching_problems(correlation, event, problems, &eventids);
+
+		for (j = 0; j < eventids.values_num; j++)
+		{
+			/* check if this event is not already recovered by another correlation rule */
+			if (NULL != zbx_hashset_search(&correlation_cache, &eventids.values[j]))
+				continue;
+
+			pair.first = eventids.values[j];
+
+			if (FAIL == (index = zbx_vector_uint64_pair_bsearch(&problems->problems, pair,
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+			{
+				continue;
+			}
+
+			correlation_execute_operations(correlation, event, eventids.values[j],
+					problems->problems.values[index].second);
+		}
+	}
+
+	zbx_vector_uint64_destroy(&eventids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes correlation rules for the new event and open problems    *
+ *          selected from database                                            *
+ *                                                                            *
+ * Parameters: event    - [IN] the new event                                  *
+ *             corr_old - [IN] the correlation rules to match open problems,  *
+ *                             sorted by correlationid                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	correlate_event_by_problem_sql(ZBX_DB_EVENT *event, const zbx_vector_ptr_t *corr_old)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	int			i;
+	zbx_correlation_t	*correlation;
+	char			*sql = NULL;
+	const char		*delim = "";
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t		eventid, correlationid, objectid;
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select p.eventid,p.objectid,c.correlationid"
+							" from correlation c,problem p"
+							" where p.r_eventid is null"
+							" and p.source=" ZBX_STR(EVENT_SOURCE_TRIGGERS)
+							" and (");
+
+	for (i = 0; i < corr_old->values_num; i++)
+	{
+		correlation = (zbx_correlation_t *)corr_old->values[i];
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, delim);
+		correlation_add_event_filter(&sql, &sql_alloc, &sql_offset, correlation, event);
+		delim = " or ";
+	}
+
+	zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
+	result = DBselect("%s", sql);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(eventid, row[0]);
+
+		/* check if this event is not already recovered by another correlation rule */
+		if (NULL != zbx_hashset_search(&correlation_cache, &eventid))
+			continue;
+
+		ZBX_STR2UINT64(correlationid, row[2]);
+
+		if (FAIL == (i = zbx_vector_ptr_bsearch(corr_old, &correlationid, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			continue;
+		}
+
+		ZBX_STR2UINT64(objectid, row[1]);
+		correlation_execute_operations((zbx_correlation_t *)corr_old->values[i], event, eventid, objectid);
+	}
+
+	DBfree_result(result);
+	zbx_free(sql);
 }
-zbx_problem_state_t;
 
 /******************************************************************************
  *                                                                            *
  * Purpose: find problem events that must be recovered by global correlation  *
  *          rules and check if the new event must be closed                   *
  *                                                                            *
- * Parameters: event         - [IN] the new event                             *
- *             problem_state - [IN/OUT] problem state cache variable          *
+ * Parameters: event    - [IN] the new event                                  *
+ *             problems - [IN/OUT] the open problem index, loaded on demand   *
  *                                                                            *
  * Comments: The correlation data (zbx_event_recovery_t) of events that       *
  *           must be closed are added to event_correlation hashset            *
@@ -1167,19 +1885,16 @@ zbx_problem_state_t;
  *           The global event correlation matching is done in two parts:      *
  *             1) exclude correlations that can't possibly match the event    *
  *                based on new event tag/value/group conditions               *
- *             2) assemble sql statement to select problems/correlations      *
- *                based on the rest correlation conditions                    *
+ *             2) match open problems against the rest correlation conditions *
+ *                with tag index lookups for large event batches or with sql  *
+ *                statement otherwise                                         *
  *                                                                            *
  ******************************************************************************/
-static void	correlate_event_by_global_rules(ZBX_DB_EVENT *event, zbx_problem_state_t *problem_state)
+static void	correlate_event_by_global_rules(ZBX_DB_EVENT *event, zbx_corr_problems_t *problems)
 {
 	int			i;
 	zbx_correlation_t	*correlation;
 	zbx_vector_ptr_t	corr_old, corr_new;
-	char			*sql = NULL;
-	const char		*delim = "";
-	size_t			sql_alloc = 0, sql_offset = 0;
-	zbx_uint64_t		eventid, correlationid, objectid;
 
 	zbx_vector_ptr_create(&corr_old);
 	zbx_vector_ptr_create(&corr_new);
@@ -1207,22 +1922,10 @@ static void	correlate_event_by_global_rules(ZBX_DB_EVENT *event, zbx_problem_sta
 
 		if (ZBX_CHECK_OLD_EVENTS == scope)
 		{
-			if (ZBX_PROBLEM_STATE_UNKNOWN == *problem_state)
-			{
-				DB_RESULT	result;
-
-				result = DBselectN("select eventid from problem"
-						" where r_eventid is null and source="
-						ZBX_STR(EVENT_SOURCE_TRIGGERS), 1);
-
-				if (NULL == DBfetch(result))
-					*problem_state = ZBX_PROBLEM_STATE_RESOLVED;
-				else
-					*problem_state = ZBX_PROBLEM_STATE_OPEN;
-				DBfree_result(result);
-			}
+			if (ZBX_PROBLEM_STATE_UNKNOWN == problems->state)
+				correlation_problems_load(problems);
 
-			if (ZBX_PROBLEM_STATE_RESOLVED == *problem_state)
+			if (ZBX_PROBLEM_STATE_RESOLVED == problems->state)
 			{
 				/* with no open problems all conditions involving old events will fail       */
 				/* so there is no need to check old events. Instead re-check if correlation  */
@@ -1240,60 +1943,19 @@ static void	correlate_event_by_global_rules(ZBX_DB_EVENT *event, zbx_problem_sta
 	if (0 != corr_new.values_num)
 	{
 		/* Process correlations that matches new event and does not use or affect old events. */
-		/* Those correlations can be executed directly, without checking database.            */
+		/* Those correlations can be executed directly, without checking old events.          */
 		for (i = 0; i < corr_new.values_num; i++)
 			correlation_execute_operations((zbx_correlation_t *)corr_new.values[i], event, 0, 0);
 	}
 
 	if (0 != corr_old.values_num)
 	{
-		DB_RESULT	result;
-		DB_ROW		row;
-
 		/* Process correlations that matches new event and either uses old events in conditions */
 		/* or has operations involving old events.                                              */
-
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select p.eventid,p.objectid,c.correlationid"
-								" from correlation c,problem p"
-								" where p.r_eventid is null"
-								" and p.source=" ZBX_STR(EVENT_SOURCE_TRIGGERS)
-								" and (");
-
-		for (i = 0; i < corr_old.values_num; i++)
-		{
-			correlation = (zbx_correlation_t *)corr_old.values[i];
-
-			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, delim);
-			correlation_add_event_filter(&sql, &sql_alloc, &sql_offset, correlation, event);
-			delim = " or ";
-		}
-
-		zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
-		result = DBselect("%s", sql);
-
-		while (NULL != (row = DBfetch(result)))
-		{
-			ZBX_STR2UINT64(eventid, row[0]);
-
-			/* check if this event is not already recovered by another correlation rule */
-			if (NULL != zbx_hashset_search(&correlation_cache, &eventid))
-				continue;
-
-			ZBX_STR2UINT64(correlationid, row[2]);
-
-			if (FAIL == (i = zbx_vector_ptr_bsearch(&corr_old, &correlationid,
-					ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
-			{
-				THIS_SHOULD_NEVER_HAPPEN;
-				continue;
-			}
-
-			ZBX_STR2UINT64(objectid, row[1]);
-			correlation_execute_operations((zbx_correlation_t *)corr_old.values[i], event, eventid, objectid);
-		}
-
-		DBfree_result(result);
-		zbx_free(sql);
+		if (0 != problems->index)
+			correlate_event_by_problem_index(event, &corr_old, problems);
+		else
+			correlate_event_by_problem_sql(event, &corr_old);
 	}
 
 	zbx_vector_ptr_destroy(&corr_new);
@@ -1308,9 +1970,9 @@ static void	correlate_event_by_global_rules(ZBX_DB_EVENT *event, zbx_problem_sta
  ******************************************************************************/
 static void	correlate_events_by_global_rules(zbx_vector_ptr_t *trigger_events, zbx_vector_ptr_t *trigger_diff)
 {
-	int			i, index;
+	int			i, index, events_num = 0;
 	zbx_trigger_diff_t	*diff;
-	zbx_problem_state_t	problem_state = ZBX_PROBLEM_STATE_UNKNOWN;
+	zbx_corr_problems_t	problems;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() events:%d", __func__, correlation_cache.num_data);
 
@@ -1319,6 +1981,15 @@ static void	correlate_events_by_global_rules(zbx_vector_ptr_t *trigger_events, z
 	if (0 == correlation_rules.correlations.values_num)
 		goto out;
 
+	/* loading all open problems pays off only when matching many new events */
+	for (i = 0; i < trigger_events->values_num; i++)
+	{
+		if (0 != (ZBX_FLAGS_DB_EVENT_CREATE & ((ZBX_DB_EVENT *)trigger_events->values[i])->flags))
+			events_num++;
+	}
+
+	correlation_problems_init(&problems, ZBX_CORR_INDEX_EVENTS_MIN <= events_num ? 1 : 0);
+
 	/* process global correlation and queue the events that must be closed */
 	for (i = 0; i < trigger_events->values_num; i++)
 	{
@@ -1327,7 +1998,7 @@ static void	correlate_events_by_global_rules(zbx_vector_ptr_t *trigger_events, z
 		if (0 == (ZBX_FLAGS_DB_EVENT_CREATE & event->flags))
 			continue;
 
-		correlate_event_by_global_rules(event, &problem_state);
+		correlate_event_by_global_rules(event, &problems);
 
 		/* force value recalculation based on open problems for triggers with */
 		/* events closed by 'close new' correlation operation                */
@@ -1342,6 +2013,7 @@ static void	correlate_events_by_global_rules(zbx_vector_ptr_t *trigger_events, z
 		}
 	}
 
+	correlation_problems_destroy(&problems);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -1408,10 +2080,12 @@ static void	flush_correlation_queue(zbx_vector_ptr_t *trigger_diff, zbx_vector_u
 		char			*sql = NULL;
 		size_t			sql_alloc = 0, sql_offset = 0;
 		zbx_trigger_diff_t	*diff;
+		zbx_vector_ptr_t	trigger_diff_new;
 
 		/* get locked trigger data - needed for trigger diff and event generation */
 
 		zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 		triggers = (DC_TRIGGER *)zbx_malloc(NULL, sizeof(DC_TRIGGER) * triggerids.values_num);
 		errcodes = (int *)zbx_malloc(NULL, sizeof(int) * triggerids.values_num);
@@ -1420,6 +2094,8 @@ static void	flush_correlation_queue(zbx_vector_ptr_t *trigger_diff, zbx_vector_u
 
 		/* add missing diffs to the trigger changeset */
 
+		zbx_vector_ptr_create(&trigger_diff_new);
+
 		for (i = 0; i < triggerids.values_num; i++)
 		{
 			if (SUCCEED != errcodes[i])
@@ -1430,12 +2106,9 @@ static void	flush_correlation_queue(zbx_vector_ptr_t *trigger_diff, zbx_vector_u
 			if (FAIL == (index = zbx_vector_ptr_bsearch(trigger_diff, &triggerids.values[i],
 					ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
 			{
-				zbx_append_trigger_diff(trigger_diff, trigger->triggerid, trigger->priority,
+				zbx_append_trigger_diff(&trigger_diff_new, trigger->triggerid, trigger->priority,
 						ZBX_FLAGS_TRIGGER_DIFF_RECALCULATE_PROBLEM_COUNT, trigger->value,
 						TRIGGER_STATE_NORMAL, 0, NULL);
-
-				/* TODO: should we store trigger diffs in hashset rather than vector? */
-				zbx_vector_ptr_sort(trigger_diff, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
 			}
 			else
 			{
@@ -1444,6 +2117,15 @@ static void	flush_correlation_queue(zbx_vector_ptr_t *trigger_diff, zbx_vector_u
 			}
 		}
 
+		/* trigger ids are unique, so the new diffs can be merged and sorted once */
+		if (0 != trigger_diff_new.values_num)
+		{
+			zbx_vector_ptr_append_array(trigger_diff, trigger_diff_new.values, trigger_diff_new.values_num);
+			zbx_vector_ptr_sort(trigger_diff, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+		}
+
+		zbx_vector_ptr_destroy(&trigger_diff_new);
+
 		/* get correlated eventids that are still open (unresolved) */
 
 		zbx_hashset_iter_reset(&correlation_cache, &iter);
@@ -2347,6 +3029,50 @@ static void	event_problem_free(zbx_event_problem_t *problem)
 	zbx_free(problem);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares cached problem events by source trigger and event ids    *
+ *                                                                            *
+ ******************************************************************************/
+static int	event_problem_compare_by_triggerid(const void *d1, const void *d2)
+{
+	const zbx_event_problem_t	*p1 = *(const zbx_event_problem_t * const *)d1;
+	const zbx_event_problem_t	*p2 = *(const zbx_event_problem_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->triggerid, p2->triggerid);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->eventid, p2->eventid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the first cached problem event of the specified trigger     *
+ *                                                                            *
+ * Parameters: problems  - [IN] the problem events, sorted by trigger id      *
+ *             triggerid - [IN] the source trigger id                         *
+ *                                                                            *
+ * Return value: index of the first problem event or problems->values_num if  *
+ *               the trigger has no open problems                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	event_problem_lower_bound(const zbx_vector_ptr_t *problems, zbx_uint64_t triggerid)
+{
+	int	lo = 0, hi = problems->values_num, mid;
+
+	while (lo < hi)
+	{
+		mid = lo + (hi - lo) / 2;
+
+		if (((const zbx_event_problem_t *)problems->values[mid])->triggerid < triggerid)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: frees trigger dependency                                          *
@@ -2484,7 +3210,11 @@ static void	process_trigger_events(zbx_vector_ptr_t *trigger_events, zbx_vector_
 	if (0 != triggerids.values_num)
 	{
 		zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 		get_open_problems(&triggerids, &problems);
+
+		/* index problems by source trigger, keeping the recovery order by event id */
+		zbx_vector_ptr_sort(&problems, event_problem_compare_by_triggerid);
 	}
 
 	/* get trigger dependency data */
@@ -2497,6 +3227,7 @@ static void	process_trigger_events(zbx_vector_ptr_t *trigger_events, zbx_vector_
 	}
 
 	zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 	zbx_dc_get_trigger_dependencies(&triggerids, &deps);
 
 	/* process trigger events */
@@ -2505,7 +3236,7 @@ static void	process_trigger_events(zbx_vector_ptr_t *trigger_events, zbx_vector_
 	{
 		event = (ZBX_DB_EVENT *)trigger_events->values[i];
 
-		if (FAIL == (index = zbx_vector_ptr_search(trigger_diff, &event->objectid,
+		if (FAIL == (index = zbx_vector_ptr_bsearch(trigger_diff, &event->objectid,
 				ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
@@ -2543,15 +3274,15 @@ static void	process_trigger_events(zbx_vector_ptr_t *trigger_events, zbx_vector_
 			/* with trigger correlation disabled the recovery event recovers */
 			/* all problem events generated by the same trigger and sets     */
 			/* trigger value to OK                                           */
-			for (j = 0; j < problems.values_num; j++)
+			for (j = event_problem_lower_bound(&problems, event->objectid); j < problems.values_num; j++)
 			{
 				problem = (zbx_event_problem_t *)problems.values[j];
 
-				if (problem->triggerid == event->objectid)
-				{
-					recover_event(problem->eventid, EVENT_SOURCE_TRIGGERS, EVENT_OBJECT_TRIGGER,
-							event->objectid);
-				}
+				if (problem->triggerid != event->objectid)
+					break;
+
+				recover_event(problem->eventid, EVENT_SOURCE_TRIGGERS, EVENT_OBJECT_TRIGGER,
+						event->objectid);
 			}
 
 			diff->value = TRIGGER_VALUE_OK;
@@ -2567,23 +3298,21 @@ static void	process_trigger_events(zbx_vector_ptr_t *trigger_events, zbx_vector_
 			value = TRIGGER_VALUE_OK;
 			event->flags = ZBX_FLAGS_DB_EVENT_UNSET;
 
-			for (j = 0; j < problems.values_num; j++)
+			for (j = event_problem_lower_bound(&problems, event->objectid); j < problems.values_num; j++)
 			{
 				problem = (zbx_event_problem_t *)problems.values[j];
 
-				if (problem->triggerid == event->objectid)
-				{
-					if (SUCCEED == match_tag(event->trigger.correlation_tag,
-							&problem->tags, &event->tags))
-					{
-						recover_event(problem->eventid, EVENT_SOURCE_TRIGGERS,
-								EVENT_OBJECT_TRIGGER, event->objectid);
-						event->flags = ZBX_FLAGS_DB_EVENT_CREATE;
-					}
-					else
-						value = TRIGGER_VALUE_PROBLEM;
+				if (problem->triggerid != event->objectid)
+					break;
 
+				if (SUCCEED == match_tag(event->trigger.correlation_tag, &problem->tags, &event->tags))
+				{
+					recover_event(problem->eventid, EVENT_SOURCE_TRIGGERS, EVENT_OBJECT_TRIGGER,
+							event->objectid);
+					event->flags = ZBX_FLAGS_DB_EVENT_CREATE;
 				}
+				else
+					value = TRIGGER_VALUE_PROBLEM;
 			}
 
 			diff->value = value;
@@ -2645,7 +3374,7 @@ static void	process_internal_events_dependency(zbx_vector_ptr_t *internal_events
 	{
 		event = (ZBX_DB_EVENT *)internal_events->values[i];
 
-		if (FAIL == (index = zbx_vector_ptr_search(trigger_diff, &event->objectid,
+		if (FAIL == (index = zbx_vector_ptr_bsearch(trigger_diff, &event->objectid,
 				ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
@@ -2694,6 +3423,8 @@ int	zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *trig
 	int			i, processed_num = 0;
 	zbx_uint64_t		eventid;
 	zbx_vector_ptr_t	internal_problem_events, internal_ok_events, trigger_events, internal_events;
+	double			sec, sec_internal = 0, sec_trigger = 0, sec_correlation = 0, sec_flush = 0,
+				sec_update = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() events_num:" ZBX_FS_SIZE_T, __func__, (zbx_fs_size_t)events.values_num);
 
@@ -2754,6 +3485,8 @@ int	zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *trig
 			}
 		}
 
+		sec = zbx_time();
+
 		if (0 != internal_events.values_num)
 			process_internal_events_dependency(&internal_events, &trigger_events, trigger_diff);
 
@@ -2763,17 +3496,35 @@ int	zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *trig
 		if (0 != internal_problem_events.values_num || 0 != internal_ok_events.values_num)
 			process_internal_events_without_actions(&internal_problem_events, &internal_ok_events);
 
+		sec_internal = zbx_time() - sec;
+
 		if (0 != trigger_events.values_num)
 		{
+			sec = zbx_time();
 			process_trigger_events(&trigger_events, trigger_diff);
+			sec_trigger = zbx_time() - sec;
+
+			sec = zbx_time();
 			correlate_events_by_global_rules(&trigger_events, trigger_diff);
 			flush_correlation_queue(trigger_diff, triggerids_lock);
+			sec_correlation = zbx_time() - sec;
 		}
 
+		sec = zbx_time();
 		processed_num = flush_events();
+		sec_flush = zbx_time() - sec;
 
 		if (0 != trigger_events.values_num)
+		{
+			sec = zbx_time();
 			update_trigger_changes(trigger_diff);
+			sec_update = zbx_time() - sec;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() events:%d internal:" ZBX_FS_DBL " sec, trigger:" ZBX_FS_DBL
+				" sec, correlation:" ZBX_FS_DBL " sec, flush:" ZBX_FS_DBL " sec, trigger changes:"
+				ZBX_FS_DBL " sec", __func__, events.values_num, sec_internal, sec_trigger,
+				sec_correlation, sec_flush, sec_update);
 
 		zbx_vector_ptr_destroy(&trigger_events);
 		zbx_vector_ptr_destroy(&internal_ok_events);
@@ -0,0 +1,90 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "history_partitions.h"
+
+#include "common.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees partition definition                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+static int	hk_partition_compare(const void *d1, const void *d2)
+{
+	const zbx_hk_partition_t	*p1 = *(const zbx_hk_partition_t * const *)d1;
+	const zbx_hk_partition_t	*p2 = *(const zbx_hk_partition_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->from, p2->from);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->to, p2->to);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get partitions holding only data older than the specified time    *
+ *                                                                            *
+ * Parameters: partitions - [IN/OUT] the table partitions, sorted by range    *
+ *             keep_from  - [IN] the timestamp of the oldest data to keep     *
+ *             expired    - [OUT] the expired partitions, oldest first        *
+ *                                                                            *
+ * Return value: the timestamp before which there is no data left in the      *
+ *               table after expired partitions are dropped or 0 if there are *
+ *               no expired partitions or the table has a partition without   *
+ *               upper bound (default or MAXVALUE partition)                  *
+ *                                                                            *
+ * Comments: Default or MAXVALUE partition receives the data not matching    *
+ *           other partitions, so with such partition the old data is still   *
+ *           removed with per item deletes.                                   *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_partitions_get_expired(zbx_vector_ptr_t *partitions, int keep_from, zbx_vector_ptr_t *expired)
+{
+	int			i, bound = 0, unbounded = 0;
+	zbx_hk_partition_t	*partition;
+
+	zbx_vector_ptr_sort(partitions, hk_partition_compare);
+
+	for (i = 0; i < partitions->values_num; i++)
+	{
+		partition = (zbx_hk_partition_t *)partitions->values[i];
+
+		if (INT_MAX == partition->to)
+		{
+			unbounded = 1;
+			continue;
+		}
+
+		/* partitions do not overlap, so the expired partitions are the oldest ones */
+		if (partition->to > keep_from)
+			continue;
+
+		zbx_vector_ptr_append(expired, partition);
+		bound = partition->to;
+	}
+
+	return 0 == unbounded ? bound : 0;
+}
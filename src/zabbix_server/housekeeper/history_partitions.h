@@ -0,0 +1,36 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_HISTORY_PARTITIONS_H
+#define ZABBIX_HISTORY_PARTITIONS_H
+
+#include "zbxalgo.h"
+
+typedef struct
+{
+	char	*name;
+	int	from;	/* INT_MIN if the partition has no lower bound */
+	int	to;	/* INT_MAX if the partition has no upper bound */
+}
+zbx_hk_partition_t;
+
+void	hk_partition_free(zbx_hk_partition_t *partition);
+int	hk_partitions_get_expired(zbx_vector_ptr_t *partitions, int keep_from, zbx_vector_ptr_t *expired);
+
+#endif
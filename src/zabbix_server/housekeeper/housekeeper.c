@@ -25,6 +25,7 @@
 #include "zbxrtc.h"
 
 #include "history_compress.h"
+#include "history_partitions.h"
 #include "../../libs/zbxdbcache/valuecache.h"
 
 
@@ -39,6 +40,9 @@ static int	hk_period;
 /* the maximum number of housekeeping periods to be removed per single housekeeping cycle */
 #define HK_MAX_DELETE_PERIODS		4
 
+/* the number of days to create daily history/trends partitions in advance */
+#define HK_PARTITION_DAYS_AHEAD		7
+
 /* global configuration data containing housekeeping configuration */
 static zbx_config_t	cfg;
 
@@ -153,6 +157,9 @@ typedef struct
 
 	/* the item delete queue */
 	zbx_vector_ptr_t	delete_queue;
+
+	/* the longest history period of items stored in target table */
+	int			history_max;
 }
 zbx_hk_history_rule_t;
 
@@ -347,6 +354,9 @@ static void	hk_history_item_update(zbx_hk_history_rule_t *rules, zbx_hk_history_
 			}
 		}
 
+		if (history > rule->history_max)
+			rule->history_max = history;
+
 		hk_history_delete_queue_append(rule, now, item_record, history);
 	}
 }
@@ -399,12 +409,14 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period '%s' for itemid '%s'",
 						tmp, row[0]);
+				rule->history_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 
 			if (0 != history && (ZBX_HK_HISTORY_MIN > history || ZBX_HK_PERIOD_MAX < history))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period for itemid '%s'", row[0]);
+				rule->history_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 
@@ -430,11 +442,13 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period '%s' for itemid '%s'",
 						tmp, row[0]);
+				rule->history_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 			else if (0 != trends && (ZBX_HK_TRENDS_MIN > trends || ZBX_HK_PERIOD_MAX < trends))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period for itemid '%s'", row[0]);
+				rule->history_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 
@@ -474,6 +488,8 @@ static void	hk_history_delete_queue_prepare_all(zbx_hk_history_rule_t *rules, in
 	/* prepare history item cache (hashset containing itemid:min_clock values) */
 	for (rule = rules; NULL != rule->table; rule++)
 	{
+		rule->history_max = 0;
+
 		if (ZBX_HK_MODE_REGULAR == *rule->poption_mode)
 		{
 			if (0 == rule->item_cache.num_slots)
@@ -568,6 +584,219 @@ out:
 #endif
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parse partition bound value                                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_bound(const char *value)
+{
+	if (0 == strcmp(value, "MINVALUE"))
+		return INT_MIN;
+
+	if (0 == strcmp(value, "MAXVALUE"))
+		return INT_MAX;
+
+	return atoi(value);
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get range partitions of natively partitioned table                *
+ *                                                                            *
+ * Parameters: table      - [IN] the history (trends) table name              *
+ *             partitions - [OUT] the partitions with clock ranges            *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned                           *
+ *               FAIL    - the table is not partitioned                       *
+ *                                                                            *
+ * Comments: MINVALUE bound is returned as INT_MIN and MAXVALUE bound as      *
+ *           INT_MAX. Default partition on PostgreSQL is returned with both   *
+ *           bounds unlimited.                                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_get(const char *table, zbx_vector_ptr_t *partitions)
+{
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	DB_RESULT		result;
+	DB_ROW			row;
+	int			ret = FAIL;
+	zbx_hk_partition_t	*partition;
+#	if defined(HAVE_MYSQL)
+	int			from = 0;
+#	endif
+
+#	if defined(HAVE_POSTGRESQL)
+	result = DBselect(
+			"select c.relname,pg_get_expr(c.relpartbound,c.oid)"
+			" from pg_partitioned_table pt"
+				" join pg_class p on p.oid=pt.partrelid"
+				" left join pg_inherits i on i.inhparent=p.oid"
+				" left join pg_class c on c.oid=i.inhrelid"
+			" where p.relname='%s'"
+				" and p.relnamespace=(select oid from pg_namespace where nspname=current_schema())",
+			table);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		char	from[32], to[32];
+
+		ret = SUCCEED;
+
+		if (SUCCEED == DBis_null(row[0]))
+			continue;
+
+		if (0 == strcmp(row[1], "DEFAULT"))
+		{
+			zbx_strlcpy(from, "MINVALUE", sizeof(from));
+			zbx_strlcpy(to, "MAXVALUE", sizeof(to));
+		}
+		else if (2 != sscanf(row[1], "FOR VALUES FROM (%31[^)]) TO (%31[^)])", from, to))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "unsupported bound \"%s\" of partition \"%s\"", row[1], row[0]);
+			continue;
+		}
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, row[0]);
+		partition->from = hk_partition_bound(from);
+		partition->to = hk_partition_bound(to);
+		zbx_vector_ptr_append(partitions, partition);
+	}
+#	else
+	result = DBselect(
+			"select partition_name,partition_description"
+			" from information_schema.partitions"
+			" where table_schema=database()"
+				" and table_name='%s'"
+				" and partition_method='RANGE'"
+			" order by partition_ordinal_position",
+			table);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ret = SUCCEED;
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, row[0]);
+		partition->from = from;
+		partition->to = (0 == strcmp(row[1], "MAXVALUE") ? INT_MAX : atoi(row[1]));
+		zbx_vector_ptr_append(partitions, partition);
+
+		from = partition->to;
+	}
+#	endif
+	DBfree_result(result);
+
+	return ret;
+#else
+	ZBX_UNUSED(table);
+	ZBX_UNUSED(partitions);
+
+	return FAIL;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create daily partitions in advance and drop expired partitions of *
+ *          natively partitioned history (trends) table                       *
+ *                                                                            *
+ * Parameters: rule       - [IN] the history housekeeping rule                *
+ *             partitions - [IN] the existing table partitions                *
+ *             now        - [IN] the current timestamp                        *
+ *                                                                            *
+ * Return value: the timestamp before which the data of all items is removed  *
+ *               by dropping partitions or 0 if the data must still be        *
+ *               removed with per item deletes                                *
+ *                                                                            *
+ * Comments: Partitions are dropped only when they are older than the longest *
+ *           history period of the items stored in the table, so items with   *
+ *           shorter periods still must be cleaned up with per item deletes.  *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_update(const zbx_hk_history_rule_t *rule, zbx_vector_ptr_t *partitions, int now)
+{
+	int			i, j, from, to, keep_from, bound;
+	zbx_hk_partition_t	*partition;
+	char			name[9];
+	time_t			day;
+	struct tm		*tm;
+	zbx_vector_ptr_t	expired;
+
+	for (i = 0; i < HK_PARTITION_DAYS_AHEAD; i++)
+	{
+		from = now - now % SEC_PER_DAY + i * SEC_PER_DAY;
+		to = from + SEC_PER_DAY;
+
+		for (j = 0; j < partitions->values_num; j++)
+		{
+			partition = (zbx_hk_partition_t *)partitions->values[j];
+
+#if defined(HAVE_MYSQL)
+			/* range partitions can only be added after the last partition */
+			if (partition->to > from)
+				break;
+#else
+			/* default partition does not prevent creating partitions for new data */
+			if (INT_MIN == partition->from && INT_MAX == partition->to)
+				continue;
+
+			if (partition->from < to && from < partition->to)
+				break;
+#endif
+		}
+
+		if (j != partitions->values_num)
+			continue;
+
+		day = (time_t)from;
+		tm = gmtime(&day);
+		zbx_snprintf(name, sizeof(name), "%04d%02d%02d", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+
+#if defined(HAVE_MYSQL)
+		DBexecute("alter table %s add partition (partition p%s values less than (%d))", rule->table, name, to);
+#else
+		DBexecute("create table %s_p%s partition of %s for values from (%d) to (%d)", rule->table, name,
+				rule->table, from, to);
+#endif
+	}
+
+	if (0 == rule->history_max)
+		return 0;
+
+	keep_from = now - rule->history_max;
+
+	zbx_vector_ptr_create(&expired);
+
+	bound = hk_partitions_get_expired(partitions, keep_from, &expired);
+
+	for (i = 0; i < expired.values_num; i++)
+	{
+		partition = (zbx_hk_partition_t *)expired.values[i];
+
+#if defined(HAVE_MYSQL)
+		if (ZBX_DB_OK > DBexecute("alter table %s drop partition %s", rule->table, partition->name))
+#else
+		if (ZBX_DB_OK > DBexecute("drop table %s", partition->name))
+#endif
+		{
+			/* the data of the partition that was not dropped must be removed with deletes */
+			bound = 0;
+			break;
+		}
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() table:%s dropped %d of %d partitions older than %d, removed data before %d",
+			__func__, rule->table, i, expired.values_num, keep_from, bound);
+
+	zbx_vector_ptr_destroy(&expired);
+
+	return bound;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: performs housekeeping for history and trends tables               *
@@ -577,11 +806,14 @@ out:
  ******************************************************************************/
 static int	housekeeping_history_and_trends(int now)
 {
-	int			deleted = 0, i, rc;
+	int			deleted = 0, i, rc, keep_from;
 	zbx_hk_history_rule_t	*rule;
+	zbx_vector_ptr_t	partitions;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __func__, now);
 
+	zbx_vector_ptr_create(&partitions);
+
 	/* prepare delete queues for all history housekeeping rules */
 	hk_history_delete_queue_prepare_all(hk_history_rules, now);
 
@@ -602,6 +834,16 @@ static int	housekeeping_history_and_trends(int now)
 			continue;
 		}
 
+		/* Natively range partitioned tables are maintained by creating daily partitions in advance */
+		/* and dropping partitions older than the longest item history period. Items with shorter  */
+		/* history periods are cleaned up with the delete queue.                                   */
+		if (SUCCEED == hk_partitions_get(rule->table, &partitions))
+			keep_from = hk_partitions_update(rule, &partitions, now);
+		else
+			keep_from = 0;
+
+		zbx_vector_ptr_clear_ext(&partitions, (zbx_clean_func_t)hk_partition_free);
+
 		/* process delete queue for the housekeeping rule */
 
 		zbx_vector_ptr_sort(&rule->delete_queue, hk_item_update_cache_compare);
@@ -610,6 +852,9 @@ static int	housekeeping_history_and_trends(int now)
 		{
 			zbx_hk_delete_queue_t	*item_record = (zbx_hk_delete_queue_t *)rule->delete_queue.values[i];
 
+			if (item_record->min_clock <= keep_from)
+				continue;
+
 			rc = DBexecute("delete from %s where itemid=" ZBX_FS_UI64 " and clock<%d",
 					rule->table, item_record->itemid, item_record->min_clock);
 			if (ZBX_DB_OK < rc)
@@ -620,6 +865,8 @@ static int	housekeeping_history_and_trends(int now)
 		hk_history_delete_queue_clear(rule);
 	}
 
+	zbx_vector_ptr_destroy(&partitions);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, deleted);
 
 	return deleted;
@@ -20,51 +20,72 @@
 #include "checks_agent.h"
 
 #include "log.h"
+#include "zbxjson.h"
 
 #if !(defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
 extern unsigned char	program_type;
 #endif
 
+/* persistent connection to agent interface, reused by subsequent requests of the same poller */
+typedef struct
+{
+	zbx_uint64_t	interfaceid;
+	zbx_socket_t	*s;
+	char		*addr;
+	char		*tls_arg1;
+	char		*tls_arg2;
+	unsigned int	tls_connect;
+	unsigned short	port;
+	int		requests;
+	int		idle_timeout;
+	time_t		lastaccess;
+}
+zbx_agent_conn_t;
+
+static zbx_hashset_t	agent_conns;
+
+/* agent interface that replied to batched request as to unknown item key */
+typedef struct
+{
+	zbx_uint64_t	interfaceid;
+	time_t		lastcheck;
+}
+zbx_agent_nobatch_t;
+
+static zbx_hashset_t	agent_nobatch;
+
+#define ZBX_AGENT_BATCH_RECHECK_PERIOD	SEC_PER_HOUR
+
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieve data from Zabbix agent                                   *
+ * Purpose: get TLS connection arguments of the item host                     *
  *                                                                            *
- * Parameters: item - item we are interested in                               *
+ * Parameters: item     - [IN] the item                                       *
+ *             tls_arg1 - [OUT] issuer or PSK identity                        *
+ *             tls_arg2 - [OUT] subject or PSK                                *
+ *             result   - [OUT] the error message on failure                  *
  *                                                                            *
- * Return value: SUCCEED - data successfully retrieved and stored in result   *
- *                         and result_str (as string)                         *
- *               NETWORK_ERROR - network related error occurred               *
- *               NOTSUPPORTED - item not supported by the agent               *
- *               AGENT_ERROR - uncritical error on agent side occurred        *
- *               FAIL - otherwise                                             *
- *                                                                            *
- * Comments: error will contain error message                                 *
+ * Return value: SUCCEED - the arguments were retrieved                       *
+ *               CONFIG_ERROR - invalid or unsupported TLS configuration      *
  *                                                                            *
  ******************************************************************************/
-int	get_value_agent(const DC_ITEM *item, AGENT_RESULT *result)
+static int	agent_get_tls_args(const DC_ITEM *item, const char **tls_arg1, const char **tls_arg2,
+		AGENT_RESULT *result)
 {
-	zbx_socket_t	s;
-	const char	*tls_arg1, *tls_arg2;
-	int		ret = SUCCEED;
-	ssize_t		received_len;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' key:'%s' conn:'%s'", __func__, item->host.host,
-			item->interface.addr, item->key, zbx_tcp_connection_type_name(item->host.tls_connect));
-
 	switch (item->host.tls_connect)
 	{
 		case ZBX_TCP_SEC_UNENCRYPTED:
-			tls_arg1 = NULL;
-			tls_arg2 = NULL;
+			*tls_arg1 = NULL;
+			*tls_arg2 = NULL;
 			break;
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 		case ZBX_TCP_SEC_TLS_CERT:
-			tls_arg1 = item->host.tls_issuer;
-			tls_arg2 = item->host.tls_subject;
+			*tls_arg1 = item->host.tls_issuer;
+			*tls_arg2 = item->host.tls_subject;
 			break;
 		case ZBX_TCP_SEC_TLS_PSK:
-			tls_arg1 = item->host.tls_psk_identity;
-			tls_arg2 = item->host.tls_psk;
+			*tls_arg1 = item->host.tls_psk_identity;
+			*tls_arg2 = item->host.tls_psk;
 			break;
 #else
 		case ZBX_TCP_SEC_TLS_CERT:
@@ -72,48 +93,80 @@ int	get_value_agent(const DC_ITEM *item, AGENT_RESULT *result)
 			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "A TLS connection is configured to be used with agent"
 					" but support for TLS was not compiled into %s.",
 					get_program_type_string(program_type)));
-			ret = CONFIG_ERROR;
-			goto out;
+			return CONFIG_ERROR;
 #endif
 		default:
 			THIS_SHOULD_NEVER_HAPPEN;
 			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid TLS connection parameters."));
-			ret = CONFIG_ERROR;
-			goto out;
+			return CONFIG_ERROR;
 	}
 
-	if (SUCCEED == zbx_tcp_connect(&s, CONFIG_SOURCE_IP, item->interface.addr, item->interface.port, 0,
-			item->host.tls_connect, tls_arg1, tls_arg2))
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "Sending [%s]", item->key);
+	return SUCCEED;
+}
 
-		if (SUCCEED != zbx_tcp_send(&s, item->key))
-			ret = NETWORK_ERROR;
-		else if (FAIL != (received_len = zbx_tcp_recv_ext(&s, 0, 0)))
-			ret = SUCCEED;
-		else if (SUCCEED == zbx_alarm_timed_out())
-			ret = TIMEOUT_ERROR;
-		else
-			ret = NETWORK_ERROR;
-	}
-	else
-		ret = NETWORK_ERROR;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send item key to agent and receive the response                   *
+ *                                                                            *
+ * Parameters: s            - [IN] the connected socket                       *
+ *             key          - [IN] the item key                               *
+ *             keepalive    - [IN] the number of idle seconds agent is asked  *
+ *                                 to keep connection open after response,    *
+ *                                 0 - agent closes the connection            *
+ *             received_len - [OUT] the number of received bytes              *
+ *                                                                            *
+ * Return value: SUCCEED - response was received                              *
+ *               NETWORK_ERROR - network related error occurred               *
+ *               TIMEOUT_ERROR - request timed out                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_request(zbx_socket_t *s, const char *key, int keepalive, ssize_t *received_len)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "Sending [%s]", key);
+
+	if (SUCCEED != zbx_tcp_send_ext(s, key, strlen(key), (size_t)keepalive, ZBX_TCP_PROTOCOL, 0))
+		return NETWORK_ERROR;
+
+	if (FAIL != (*received_len = zbx_tcp_recv_ext(s, 0, 0)))
+		return SUCCEED;
+
+	if (SUCCEED == zbx_alarm_timed_out())
+		return TIMEOUT_ERROR;
 
+	return NETWORK_ERROR;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: convert agent response to item result                             *
+ *                                                                            *
+ * Parameters: item         - [IN] the item                                   *
+ *             s            - [IN] the socket with received response          *
+ *             received_len - [IN] the number of received bytes               *
+ *             ret          - [IN] the request result                         *
+ *             result       - [OUT] the item result                           *
+ *                                                                            *
+ * Return value: see get_value_agent()                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_parse_response(const DC_ITEM *item, const zbx_socket_t *s, ssize_t received_len, int ret,
+		AGENT_RESULT *result)
+{
 	if (SUCCEED == ret)
 	{
-		zabbix_log(LOG_LEVEL_DEBUG, "get value from agent result: '%s'", s.buffer);
+		zabbix_log(LOG_LEVEL_DEBUG, "get value from agent result: '%s'", s->buffer);
 
-		if (0 == strcmp(s.buffer, ZBX_NOTSUPPORTED))
+		if (0 == strcmp(s->buffer, ZBX_NOTSUPPORTED))
 		{
 			/* 'ZBX_NOTSUPPORTED\0<error message>' */
-			if (sizeof(ZBX_NOTSUPPORTED) < s.read_bytes)
-				SET_MSG_RESULT(result, zbx_dsprintf(NULL, "%s", s.buffer + sizeof(ZBX_NOTSUPPORTED)));
+			if (sizeof(ZBX_NOTSUPPORTED) < s->read_bytes)
+				SET_MSG_RESULT(result, zbx_dsprintf(NULL, "%s", s->buffer + sizeof(ZBX_NOTSUPPORTED)));
 			else
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Not supported by Zabbix Agent"));
 
 			ret = NOTSUPPORTED;
 		}
-		else if (0 == strcmp(s.buffer, ZBX_ERROR))
+		else if (0 == strcmp(s->buffer, ZBX_ERROR))
 		{
 			SET_MSG_RESULT(result, zbx_strdup(NULL, "Zabbix Agent non-critical error"));
 			ret = AGENT_ERROR;
@@ -126,14 +179,530 @@ int	get_value_agent(const DC_ITEM *item, AGENT_RESULT *result)
 			ret = NETWORK_ERROR;
 		}
 		else
-			set_result_type(result, ITEM_VALUE_TYPE_TEXT, s.buffer);
+			set_result_type(result, ITEM_VALUE_TYPE_TEXT, s->buffer);
 	}
 	else
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Get value from agent failed: %s", zbx_socket_strerror()));
 
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieve data from Zabbix agent                                   *
+ *                                                                            *
+ * Parameters: item - item we are interested in                               *
+ *                                                                            *
+ * Return value: SUCCEED - data successfully retrieved and stored in result   *
+ *                         and result_str (as string)                         *
+ *               NETWORK_ERROR - network related error occurred               *
+ *               NOTSUPPORTED - item not supported by the agent               *
+ *               AGENT_ERROR - uncritical error on agent side occurred        *
+ *               FAIL - otherwise                                             *
+ *                                                                            *
+ * Comments: error will contain error message                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	get_value_agent(const DC_ITEM *item, AGENT_RESULT *result)
+{
+	zbx_socket_t	s;
+	const char	*tls_arg1, *tls_arg2;
+	int		ret;
+	ssize_t		received_len = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' key:'%s' conn:'%s'", __func__, item->host.host,
+			item->interface.addr, item->key, zbx_tcp_connection_type_name(item->host.tls_connect));
+
+	if (SUCCEED != (ret = agent_get_tls_args(item, &tls_arg1, &tls_arg2, result)))
+		goto out;
+
+	if (SUCCEED == zbx_tcp_connect(&s, CONFIG_SOURCE_IP, item->interface.addr, item->interface.port, 0,
+			item->host.tls_connect, tls_arg1, tls_arg2))
+	{
+		ret = agent_request(&s, item->key, 0, &received_len);
+	}
+	else
+		ret = NETWORK_ERROR;
+
+	ret = agent_parse_response(item, &s, received_len, ret, result);
+
 	zbx_tcp_close(&s);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
 }
+
+static void	agent_conn_close(zbx_agent_conn_t *conn)
+{
+	zbx_tcp_close(conn->s);
+	zbx_free(conn->s);
+	zbx_free(conn->addr);
+	zbx_free(conn->tls_arg1);
+	zbx_free(conn->tls_arg2);
+}
+
+static void	agent_conn_remove(zbx_agent_conn_t *conn)
+{
+	agent_conn_close(conn);
+	zbx_hashset_remove_direct(&agent_conns, conn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if cached connection can be reused for the item             *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_conn_usable(const zbx_agent_conn_t *conn, const DC_ITEM *item, const char *tls_arg1,
+		const char *tls_arg2, time_t now)
+{
+	if (now - conn->lastaccess >= conn->idle_timeout)
+		return FAIL;
+
+	if (conn->port != item->interface.port || conn->tls_connect != item->host.tls_connect)
+		return FAIL;
+
+	if (0 != strcmp(conn->addr, item->interface.addr))
+		return FAIL;
+
+	if (0 != zbx_strcmp_null(conn->tls_arg1, tls_arg1) || 0 != zbx_strcmp_null(conn->tls_arg2, tls_arg2))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send request to agent reusing connection of the previous request *
+ *          to the same interface                                             *
+ *                                                                            *
+ * Parameters: item         - [IN] the item defining the interface            *
+ *             tls_arg1     - [IN] issuer or PSK identity                     *
+ *             tls_arg2     - [IN] subject or PSK                             *
+ *             request      - [IN] the request                                *
+ *             conn         - [OUT] the connection with received response     *
+ *             keepalive    - [OUT] the idle timeout requested from agent     *
+ *             received_len - [OUT] the number of received bytes              *
+ *                                                                            *
+ * Return value: SUCCEED - response was received                              *
+ *               NETWORK_ERROR - network related error occurred               *
+ *               TIMEOUT_ERROR - request timed out                            *
+ *                                                                            *
+ * Comments: Agent is asked to keep connection open by sending the idle       *
+ *           timeout in the reserved field of request header. Agent replies   *
+ *           with the idle timeout it honors or 0 if it closes the connection *
+ *           (older agents always reply with 0). A reused connection might    *
+ *           have been closed by agent meanwhile, so on network error the     *
+ *           request is retried once over a new connection.                   *
+ *           The connection must be released with agent_conn_release().       *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_conn_request(const DC_ITEM *item, const char *tls_arg1, const char *tls_arg2,
+		const char *request, zbx_agent_conn_t **conn, int *keepalive, ssize_t *received_len)
+{
+	zbx_agent_conn_t	conn_local;
+	int			ret;
+	time_t			now;
+
+	if (NULL == agent_conns.slots)
+	{
+		zbx_hashset_create(&agent_conns, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	now = time(NULL);
+
+	if (NULL != (*conn = (zbx_agent_conn_t *)zbx_hashset_search(&agent_conns, &item->interface.interfaceid)))
+	{
+		if (SUCCEED == agent_conn_usable(*conn, item, tls_arg1, tls_arg2, now))
+		{
+			*keepalive = (*conn)->requests + 1 < CONFIG_AGENT_CONNECTION_MAX_REQUESTS ?
+					CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT : 0;
+
+			ret = agent_request((*conn)->s, request, *keepalive, received_len);
+
+			if (TIMEOUT_ERROR == ret || (SUCCEED == ret && 0 != *received_len))
+				return ret;
+
+			zabbix_log(LOG_LEVEL_DEBUG, "%s() connection to [%s]:%hu was closed by agent, reconnecting",
+					__func__, (*conn)->addr, (*conn)->port);
+		}
+
+		agent_conn_remove(*conn);
+	}
+
+	conn_local.interfaceid = item->interface.interfaceid;
+	conn_local.s = (zbx_socket_t *)zbx_malloc(NULL, sizeof(zbx_socket_t));
+	conn_local.addr = zbx_strdup(NULL, item->interface.addr);
+	conn_local.port = item->interface.port;
+	conn_local.tls_connect = item->host.tls_connect;
+	conn_local.tls_arg1 = (NULL != tls_arg1 ? zbx_strdup(NULL, tls_arg1) : NULL);
+	conn_local.tls_arg2 = (NULL != tls_arg2 ? zbx_strdup(NULL, tls_arg2) : NULL);
+	conn_local.requests = 0;
+	conn_local.idle_timeout = 0;
+	conn_local.lastaccess = now;
+
+	*conn = (zbx_agent_conn_t *)zbx_hashset_insert(&agent_conns, &conn_local, sizeof(conn_local));
+	*keepalive = 1 < CONFIG_AGENT_CONNECTION_MAX_REQUESTS ? CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT : 0;
+
+	if (SUCCEED != zbx_tcp_connect((*conn)->s, CONFIG_SOURCE_IP, (*conn)->addr, (*conn)->port, 0,
+			(*conn)->tls_connect, (*conn)->tls_arg1, (*conn)->tls_arg2))
+	{
+		return NETWORK_ERROR;
+	}
+
+	return agent_request((*conn)->s, request, *keepalive, received_len);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: keep connection for the next request if agent agreed to it,      *
+ *          close it otherwise                                                *
+ *                                                                            *
+ * Parameters: conn      - [IN] the connection                                *
+ *             keepalive - [IN] the idle timeout requested from agent         *
+ *             ret       - [IN] the request result                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_conn_release(zbx_agent_conn_t *conn, int keepalive, int ret)
+{
+	if ((SUCCEED == ret || NOTSUPPORTED == ret || AGENT_ERROR == ret) && 0 != keepalive &&
+			0 != conn->s->reserved)
+	{
+		conn->requests++;
+		conn->idle_timeout = (int)MIN(conn->s->reserved, (zbx_uint64_t)keepalive);
+		conn->lastaccess = time(NULL);
+		return;
+	}
+
+	agent_conn_remove(conn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieve data from Zabbix agent reusing connection of the         *
+ *          previous request to the same interface                            *
+ *                                                                            *
+ * Parameters: item - item we are interested in                               *
+ *                                                                            *
+ * Return value: see get_value_agent()                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	get_value_agent_persistent(const DC_ITEM *item, AGENT_RESULT *result)
+{
+	zbx_agent_conn_t	*conn;
+	const char		*tls_arg1, *tls_arg2;
+	int			ret, keepalive;
+	ssize_t			received_len = 0;
+
+	if (0 == CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT)
+		return get_value_agent(item, result);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' key:'%s' conn:'%s'", __func__, item->host.host,
+			item->interface.addr, item->key, zbx_tcp_connection_type_name(item->host.tls_connect));
+
+	if (SUCCEED != (ret = agent_get_tls_args(item, &tls_arg1, &tls_arg2, result)))
+		goto out;
+
+	ret = agent_conn_request(item, tls_arg1, tls_arg2, item->key, &conn, &keepalive, &received_len);
+	ret = agent_parse_response(item, conn->s, received_len, ret, result);
+	agent_conn_release(conn, keepalive, ret);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if agent interface was found not to support batched       *
+ *          requests recently                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_batch_supported(zbx_uint64_t interfaceid, time_t now)
+{
+	zbx_agent_nobatch_t	*nobatch;
+
+	if (NULL == agent_nobatch.slots)
+	{
+		zbx_hashset_create(&agent_nobatch, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	if (NULL == (nobatch = (zbx_agent_nobatch_t *)zbx_hashset_search(&agent_nobatch, &interfaceid)))
+		return SUCCEED;
+
+	/* recheck periodically in case agent has been upgraded */
+	if (now - nobatch->lastcheck >= ZBX_AGENT_BATCH_RECHECK_PERIOD)
+	{
+		zbx_hashset_remove_direct(&agent_nobatch, nobatch);
+		return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stop sending batched requests to agent interface for a while    *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_batch_disable(zbx_uint64_t interfaceid, time_t now)
+{
+	zbx_agent_nobatch_t	nobatch_local;
+
+	nobatch_local.interfaceid = interfaceid;
+	nobatch_local.lastcheck = now;
+	zbx_hashset_insert(&agent_nobatch, &nobatch_local, sizeof(nobatch_local));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parse batched agent response                                      *
+ *                                                                            *
+ * Parameters: items    - [IN] the requested items                            *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [IN/OUT] the item error codes                       *
+ *             num      - [IN] the number of items                            *
+ *             data     - [IN] the response                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the response was parsed                            *
+ *               FAIL - the response is not batched response                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_parse_batch_response(const DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num,
+		const char *data)
+{
+	struct zbx_json_parse	jp, jp_data, jp_row;
+	const char		*p = NULL;
+	char			*value = NULL;
+	size_t			value_alloc = 0;
+	int			i;
+
+	if (SUCCEED != zbx_json_open(data, &jp) || SUCCEED != zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_DATA,
+			&jp_data))
+	{
+		return FAIL;
+	}
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (NULL == (p = zbx_json_next(&jp_data, p)) || SUCCEED != zbx_json_brackets_open(p, &jp_row))
+		{
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, "Missing value in batched agent response."));
+			errcodes[i] = NETWORK_ERROR;
+		}
+		else if (SUCCEED == zbx_json_value_by_name_dyn(&jp_row, ZBX_PROTO_TAG_VALUE, &value, &value_alloc,
+				NULL))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "get value from agent result: '%s'", value);
+			set_result_type(&results[i], ITEM_VALUE_TYPE_TEXT, value);
+		}
+		else if (SUCCEED == zbx_json_value_by_name_dyn(&jp_row, ZBX_PROTO_TAG_ERROR, &value, &value_alloc,
+				NULL))
+		{
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, value));
+			errcodes[i] = NOTSUPPORTED;
+		}
+		else
+		{
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, "Invalid value in batched agent response."));
+			errcodes[i] = NETWORK_ERROR;
+		}
+	}
+
+	zbx_free(value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieve values of multiple items of the same agent interface    *
+ *          in one request                                                    *
+ *                                                                            *
+ * Parameters: items    - [IN] the items of the same interface                *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [IN/OUT] the item error codes, only items with      *
+ *                                 SUCCEED error code are requested           *
+ *             num      - [IN] the number of items                            *
+ *                                                                            *
+ * Comments: Agents not supporting batched requests return ZBX_NOTSUPPORTED   *
+ *           for the request, in which case items are requested one by one   *
+ *           and the interface is not sent batched requests for a while.      *
+ *           The same is done when batched request times out, as the agent    *
+ *           processes keys sequentially and a single slow key must not make  *
+ *           the whole interface unavailable. When items are requested one by *
+ *           one, network errors and timeouts are assumed to affect the whole *
+ *           interface and are reported for the remaining items without       *
+ *           requesting them, so an unresponsive agent blocks the poller for  *
+ *           at most two timeouts.                                            *
+ *                                                                            *
+ ******************************************************************************/
+void	get_values_agent(const DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num)
+{
+	zbx_agent_conn_t	*conn;
+	struct zbx_json		j;
+	const char		*tls_arg1, *tls_arg2;
+	int			i, ret, keepalive, first = -1, requested = 0;
+	ssize_t			received_len = 0;
+	time_t			now;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' num:%d", __func__, items[0].host.host,
+			items[0].interface.addr, num);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (-1 == first)
+			first = i;
+
+		requested++;
+	}
+
+	now = time(NULL);
+
+	if (2 > requested || SUCCEED != agent_batch_supported(items[first].interface.interfaceid, now))
+		goto single;
+
+	if (SUCCEED != (ret = agent_get_tls_args(&items[first], &tls_arg1, &tls_arg2, &results[first])))
+		goto fail;
+
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addstring(&j, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_GET_PASSIVE_CHECKS, ZBX_JSON_TYPE_STRING);
+	zbx_json_addarray(&j, ZBX_PROTO_TAG_DATA);
+
+	for (i = first; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		zbx_json_addobject(&j, NULL);
+		zbx_json_addstring(&j, ZBX_PROTO_TAG_KEY, items[i].key, ZBX_JSON_TYPE_STRING);
+		zbx_json_close(&j);
+	}
+
+	zbx_json_close(&j);
+
+	zbx_alarm_on(CONFIG_TIMEOUT);
+	ret = agent_conn_request(&items[first], tls_arg1, tls_arg2, j.buffer, &conn, &keepalive, &received_len);
+	zbx_alarm_off();
+
+	zbx_json_free(&j);
+
+	if (SUCCEED == ret && 0 != received_len && '{' == *conn->s->buffer &&
+			SUCCEED == agent_parse_batch_response(items, results, errcodes, num, conn->s->buffer))
+	{
+		agent_conn_release(conn, keepalive, ret);
+		goto out;
+	}
+
+	if (SUCCEED == ret && 0 == strcmp(conn->s->buffer, ZBX_NOTSUPPORTED))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "agent at [%s]:%hu does not support batched requests",
+				items[first].interface.addr, items[first].interface.port);
+
+		agent_batch_disable(items[first].interface.interfaceid, now);
+		agent_conn_release(conn, keepalive, NOTSUPPORTED);
+		goto single;
+	}
+
+	if (TIMEOUT_ERROR == ret)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "batched request of %d items to agent at [%s]:%hu timed out,"
+				" requesting items one by one", requested, items[first].interface.addr,
+				items[first].interface.port);
+
+		agent_batch_disable(items[first].interface.interfaceid, now);
+		agent_conn_remove(conn);
+		goto single;
+	}
+
+	ret = agent_parse_response(&items[first], conn->s, received_len, ret, &results[first]);
+	agent_conn_remove(conn);
+
+	if (SUCCEED == ret)
+	{
+		UNSET_RESULT_EXCLUDING(&results[first], AR_MESSAGE);
+		SET_MSG_RESULT(&results[first], zbx_strdup(NULL, "Invalid batched agent response."));
+		ret = NETWORK_ERROR;
+	}
+fail:
+	/* request errors apply to all items of the interface */
+	for (i = first; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (i != first)
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, results[first].msg));
+
+		errcodes[i] = ret;
+	}
+
+	goto out;
+single:
+	for (i = 0, first = -1; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (-1 != first)
+		{
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, results[first].msg));
+			errcodes[i] = errcodes[first];
+			continue;
+		}
+
+		zbx_alarm_on(CONFIG_TIMEOUT);
+		errcodes[i] = get_value_agent_persistent(&items[i], &results[i]);
+		zbx_alarm_off();
+
+		if (NETWORK_ERROR == errcodes[i] || TIMEOUT_ERROR == errcodes[i])
+			first = i;
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: close persistent agent connections idle for longer than agreed   *
+ *                                                                            *
+ * Parameters: now - [IN] the current time                                    *
+ *                                                                            *
+ * Return value: number of seconds until the next kept connection must be     *
+ *               closed or -1 if there are no kept connections                *
+ *                                                                            *
+ ******************************************************************************/
+int	close_idle_agent_connections(time_t now)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_agent_conn_t	*conn;
+	int			idle, next_close = -1;
+
+	if (NULL == agent_conns.slots)
+		return -1;
+
+	zbx_hashset_iter_reset(&agent_conns, &iter);
+
+	while (NULL != (conn = (zbx_agent_conn_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if ((idle = (int)(now - conn->lastaccess)) < conn->idle_timeout)
+		{
+			if (-1 == next_close || conn->idle_timeout - idle < next_close)
+				next_close = conn->idle_timeout - idle;
+			continue;
+		}
+
+		agent_conn_close(conn);
+		zbx_hashset_iter_remove(&iter);
+	}
+
+	return next_close;
+}
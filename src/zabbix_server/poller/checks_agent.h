@@ -24,7 +24,12 @@
 #include "module.h"
 
 extern char	*CONFIG_SOURCE_IP;
+extern int	CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT;
+extern int	CONFIG_AGENT_CONNECTION_MAX_REQUESTS;
 
 int	get_value_agent(const DC_ITEM *item, AGENT_RESULT *result);
+int	get_value_agent_persistent(const DC_ITEM *item, AGENT_RESULT *result);
+void	get_values_agent(const DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num);
+int	close_idle_agent_connections(time_t now);
 
 #endif
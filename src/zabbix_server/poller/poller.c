@@ -275,7 +275,7 @@ static int	get_value(DC_ITEM *item, AGENT_RESULT *result, zbx_vector_ptr_t *add_
 	{
 		case ITEM_TYPE_ZABBIX:
 			zbx_alarm_on(CONFIG_TIMEOUT);
-			res = get_value_agent(item, result);
+			res = get_value_agent_persistent(item, result);
 			zbx_alarm_off();
 			break;
 		case ITEM_TYPE_SIMPLE:
@@ -705,6 +705,11 @@ void	zbx_check_items(DC_ITEM *items, int *errcodes, int num, AGENT_RESULT *resul
 		get_values_java(ZBX_JAVA_GATEWAY_REQUEST_JMX, items, results, errcodes, num);
 		zbx_alarm_off();
 	}
+	else if (ITEM_TYPE_ZABBIX == items[0].type && 1 < num)
+	{
+		/* agent checks set timeouts per request */
+		get_values_agent(items, results, errcodes, num);
+	}
 	else if (1 == num)
 	{
 		if (SUCCEED == errcodes[0])
@@ -926,7 +931,7 @@ exit:
 
 ZBX_THREAD_ENTRY(poller_thread, args)
 {
-	int			nextcheck, sleeptime = -1, processed = 0, old_processed = 0;
+	int			nextcheck, sleeptime = -1, processed = 0, old_processed = 0, next_close;
 	double			sec, total_sec = 0.0, old_total_sec = 0.0;
 	time_t			last_stat_time;
 	unsigned char		poller_type;
@@ -979,8 +984,14 @@ ZBX_THREAD_ENTRY(poller_thread, args)
 		processed += get_values(poller_type, &nextcheck);
 		total_sec += zbx_time() - sec;
 
+		next_close = close_idle_agent_connections(time(NULL));
+
 		sleeptime = calculate_sleeptime(nextcheck, POLLER_DELAY);
 
+		/* wake up to close persistent agent connections even if there are no items to poll */
+		if (-1 != next_close && next_close < sleeptime)
+			sleeptime = next_close;
+
 		if (0 != sleeptime || STAT_INTERVAL <= time(NULL) - last_stat_time)
 		{
 			if (0 == sleeptime)
@@ -132,7 +132,8 @@ const char	*help_message[] = {
 	"                                  ipmi manager, ipmi poller, java poller,",
 	"                                  poller, preprocessing manager,",
 	"                                  preprocessing worker, proxy poller,",
-	"                                  self-monitoring, snmp trapper, task manager,",
+	"                                  self-monitoring, snmp trapper, snmp trap worker,",
+	"                                  task manager,",
 	"                                  timer, trapper, unreachable poller,",
 	"                                  vmware collector, history poller,",
 	"                                  availability manager, service manager, odbc poller)",
@@ -196,6 +197,7 @@ int	CONFIG_IPMIPOLLER_FORKS		= 0;
 int	CONFIG_TIMER_FORKS		= 1;
 int	CONFIG_TRAPPER_FORKS		= 5;
 int	CONFIG_SNMPTRAPPER_FORKS	= 0;
+int	CONFIG_SNMPTRAPWORKER_FORKS	= 0;
 int	CONFIG_JAVAPOLLER_FORKS		= 0;
 int	CONFIG_ESCALATOR_FORKS		= 1;
 int	CONFIG_SELFMON_FORKS		= 1;
@@ -224,6 +226,10 @@ int	CONFIG_LISTEN_PORT		= ZBX_DEFAULT_SERVER_PORT;
 char	*CONFIG_LISTEN_IP		= NULL;
 char	*CONFIG_SOURCE_IP		= NULL;
 int	CONFIG_TRAPPER_TIMEOUT		= 300;
+int	CONFIG_MAX_CONNECTIONS_PER_TRAPPER	= 0;
+int	CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT	= 0;
+int	CONFIG_AGENT_CONNECTION_MAX_REQUESTS	= 100;
+int	CONFIG_AGENT_BATCH_MAX_ITEMS		= 1;
 char	*CONFIG_SERVER			= NULL;		/* not used in zabbix_server, required for linking */
 
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
@@ -278,6 +284,7 @@ char	*CONFIG_DB_TLS_CIPHER		= NULL;
 char	*CONFIG_DB_TLS_CIPHER_13	= NULL;
 char	*CONFIG_EXPORT_DIR		= NULL;
 char	*CONFIG_EXPORT_TYPE		= NULL;
+char	*CONFIG_EXPORT_FORMAT		= NULL;
 int	CONFIG_DBPORT			= 0;
 int	CONFIG_ALLOW_UNSUPPORTED_DB_VERSIONS = 0;
 int	CONFIG_ENABLE_REMOTE_COMMANDS	= 0;
@@ -292,6 +299,7 @@ int	CONFIG_JAVA_GATEWAY_PORT	= ZBX_DEFAULT_GATEWAY_PORT;
 char	*CONFIG_SSH_KEY_LOCATION	= NULL;
 
 int	CONFIG_LOG_SLOW_QUERIES		= 0;	/* ms; 0 - disable */
+int	CONFIG_DB_PREPARED_STATEMENTS	= 0;
 
 int	CONFIG_SERVER_STARTUP_TIME	= 0;	/* zabbix server startup time */
 
@@ -346,6 +354,11 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+zbx_uint64_t	CONFIG_HISTORY_STORAGE_BULK_SIZE	= 5 * ZBX_MEBIBYTE;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION	= 0;
+int	CONFIG_HISTORY_ASYNC_WRITE		= 0;
+char	*CONFIG_HISTORY_FILE_DIR		= NULL;
+char	*CONFIG_HISTORY_FILE_OPTS		= NULL;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 int	CONFIG_TCP_MAX_BACKLOG_SIZE	= SOMAXCONN;
@@ -460,6 +473,11 @@ int	get_process_info_by_thread(int local_server_num, unsigned char *local_proces
 		*local_process_type = ZBX_PROCESS_TYPE_SNMPTRAPPER;
 		*local_process_num = local_server_num - server_count + CONFIG_SNMPTRAPPER_FORKS;
 	}
+	else if (local_server_num <= (server_count += CONFIG_SNMPTRAPWORKER_FORKS))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_SNMPTRAPWORKER;
+		*local_process_num = local_server_num - server_count + CONFIG_SNMPTRAPWORKER_FORKS;
+	}
 	else if (local_server_num <= (server_count += CONFIG_PROXYPOLLER_FORKS))
 	{
 		*local_process_type = ZBX_PROCESS_TYPE_PROXYPOLLER;
@@ -587,6 +605,8 @@ static void	zbx_set_defaults(void)
 	if (NULL == CONFIG_HISTORY_STORAGE_OPTS)
 		CONFIG_HISTORY_STORAGE_OPTS = zbx_strdup(CONFIG_HISTORY_STORAGE_OPTS, "uint,dbl,str,log,text");
 #endif
+	if (NULL == CONFIG_HISTORY_FILE_OPTS)
+		CONFIG_HISTORY_FILE_OPTS = zbx_strdup(CONFIG_HISTORY_FILE_OPTS, "uint,dbl");
 
 #ifdef HAVE_SQLITE3
 	CONFIG_MAX_HOUSEKEEPER_DELETE = 0;
@@ -629,6 +649,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 == CONFIG_SNMPTRAPPER_FORKS && 0 != CONFIG_SNMPTRAPWORKER_FORKS)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"StartSNMPTrapWorkers\" configuration parameter must be 0"
+				" if SNMP trapper is not started");
+		err = 1;
+	}
+
 	if ((NULL == CONFIG_JAVA_GATEWAY || '\0' == *CONFIG_JAVA_GATEWAY) && 0 < CONFIG_JAVAPOLLER_FORKS)
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "\"JavaGateway\" configuration parameter is not specified or empty");
@@ -688,12 +715,18 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	err |= (FAIL == check_cfg_feature_str("HistoryStorageTypes", CONFIG_HISTORY_STORAGE_OPTS, "cURL library"));
 	err |= (FAIL == check_cfg_feature_int("HistoryStorageDateIndex", CONFIG_HISTORY_STORAGE_PIPELINES,
 			"cURL library"));
+	err |= (FAIL == check_cfg_feature_int("HistoryStorageCompression", CONFIG_HISTORY_STORAGE_COMPRESSION,
+			"cURL library"));
 	err |= (FAIL == check_cfg_feature_str("Vault", CONFIG_VAULT, "cURL library"));
 	err |= (FAIL == check_cfg_feature_str("VaultToken", CONFIG_VAULTTOKEN, "cURL library"));
 	err |= (FAIL == check_cfg_feature_str("VaultDBPath", CONFIG_VAULTDBPATH, "cURL library"));
 
 	err |= (FAIL == check_cfg_feature_int("StartReportWriters", CONFIG_REPORTWRITER_FORKS, "cURL library"));
 #endif
+#if !defined(HAVE_POSTGRESQL)
+	err |= (FAIL == check_cfg_feature_int("HistoryAsyncWrite", CONFIG_HISTORY_ASYNC_WRITE, "PostgreSQL database"
+			" support"));
+#endif
 
 #if !defined(HAVE_LIBXML2) || !defined(HAVE_LIBCURL)
 	err |= (FAIL == check_cfg_feature_int("StartVMwareCollectors", CONFIG_VMWARE_FORKS, "VMware support"));
@@ -781,6 +814,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"StartSNMPTrapper",		&CONFIG_SNMPTRAPPER_FORKS,		TYPE_INT,
 			PARM_OPT,	0,			1},
+		{"StartSNMPTrapWorkers",	&CONFIG_SNMPTRAPWORKER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			100},
 		{"CacheSize",			&CONFIG_CONF_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(64) * ZBX_GIBIBYTE},
 		{"HistoryCacheSize",		&CONFIG_HISTORY_CACHE_SIZE,		TYPE_UINT64,
@@ -809,6 +844,14 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	1,			30},
 		{"TrapperTimeout",		&CONFIG_TRAPPER_TIMEOUT,		TYPE_INT,
 			PARM_OPT,	1,			300},
+		{"MaxConnectionsPerTrapper",	&CONFIG_MAX_CONNECTIONS_PER_TRAPPER,	TYPE_INT,
+			PARM_OPT,	0,			10000},
+		{"AgentConnectionIdleTimeout",	&CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT,	TYPE_INT,
+			PARM_OPT,	0,			30},
+		{"AgentConnectionMaxRequests",	&CONFIG_AGENT_CONNECTION_MAX_REQUESTS,	TYPE_INT,
+			PARM_OPT,	1,			100000},
+		{"AgentBatchMaxItems",		&CONFIG_AGENT_BATCH_MAX_ITEMS,		TYPE_INT,
+			PARM_OPT,	1,			MAX_POLLER_ITEMS},
 		{"UnreachablePeriod",		&CONFIG_UNREACHABLE_PERIOD,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
 		{"UnreachableDelay",		&CONFIG_UNREACHABLE_DELAY,		TYPE_INT,
@@ -879,6 +922,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&CONFIG_LOG_SLOW_QUERIES,		TYPE_INT,
 			PARM_OPT,	0,			3600000},
+		{"DBPreparedStatements",	&CONFIG_DB_PREPARED_STATEMENTS,		TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"StartProxyPollers",		&CONFIG_PROXYPOLLER_FORKS,		TYPE_INT,
 			PARM_OPT,	0,			250},
 		{"ProxyConfigFrequency",	&CONFIG_PROXYCONFIG_FREQUENCY,		TYPE_INT,
@@ -941,10 +986,22 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"HistoryStorageDateIndex",	&CONFIG_HISTORY_STORAGE_PIPELINES,	TYPE_INT,
 			PARM_OPT,	0,			1},
+		{"HistoryStorageBulkSize",	&CONFIG_HISTORY_STORAGE_BULK_SIZE,	TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	100 * ZBX_MEBIBYTE},
+		{"HistoryStorageCompression",	&CONFIG_HISTORY_STORAGE_COMPRESSION,	TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"HistoryAsyncWrite",		&CONFIG_HISTORY_ASYNC_WRITE,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"HistoryFileDir",		&CONFIG_HISTORY_FILE_DIR,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"HistoryFileTypes",		&CONFIG_HISTORY_FILE_OPTS,		TYPE_STRING_LIST,
+			PARM_OPT,	0,			0},
 		{"ExportDir",			&CONFIG_EXPORT_DIR,			TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"ExportType",			&CONFIG_EXPORT_TYPE,			TYPE_STRING_LIST,
 			PARM_OPT,	0,			0},
+		{"ExportFormat",		&CONFIG_EXPORT_FORMAT,			TYPE_STRING,
+			PARM_OPT,	0,			0},
 		{"ExportFileSize",		&CONFIG_EXPORT_FILE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	ZBX_MEBIBYTE,	ZBX_GIBIBYTE},
 		{"StartLLDProcessors",		&CONFIG_LLDWORKER_FORKS,		TYPE_INT,
@@ -1341,7 +1398,7 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 			+ CONFIG_LLDMANAGER_FORKS + CONFIG_LLDWORKER_FORKS + CONFIG_ALERTDB_FORKS
 			+ CONFIG_HISTORYPOLLER_FORKS + CONFIG_AVAILMAN_FORKS + CONFIG_REPORTMANAGER_FORKS
 			+ CONFIG_REPORTWRITER_FORKS + CONFIG_SERVICEMAN_FORKS + CONFIG_TRIGGERHOUSEKEEPER_FORKS
-			+ CONFIG_ODBCPOLLER_FORKS;
+			+ CONFIG_ODBCPOLLER_FORKS + CONFIG_SNMPTRAPWORKER_FORKS;
 	threads = (pid_t *)zbx_calloc(threads, (size_t)threads_num, sizeof(pid_t));
 	threads_flags = (int *)zbx_calloc(threads_flags, (size_t)threads_num, sizeof(int));
 
@@ -1451,6 +1508,9 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 			case ZBX_PROCESS_TYPE_SNMPTRAPPER:
 				zbx_thread_start(snmptrapper_thread, &thread_args, &threads[i]);
 				break;
+			case ZBX_PROCESS_TYPE_SNMPTRAPWORKER:
+				zbx_thread_start(snmptrap_worker_thread, &thread_args, &threads[i]);
+				break;
 			case ZBX_PROCESS_TYPE_PROXYPOLLER:
 				zbx_thread_start(proxypoller_thread, &thread_args, &threads[i]);
 				break;
@@ -26,14 +26,54 @@
 #include "zbxserver.h"
 #include "zbxregexp.h"
 #include "preproc.h"
+#include "zbxipcservice.h"
+#include "zbxserialize.h"
+
+#define ZBX_SNMPTRAP_BATCH_SIZE		(64 * ZBX_KIBIBYTE)	/* batch size sent to worker at once */
+#define ZBX_SNMPTRAP_QUEUE_SIZE		(16 * ZBX_MEBIBYTE)	/* queued trap size when file reading is paused */
+#define ZBX_SNMPTRAP_REGEXP_CACHE_MAX	1000
+
+#define STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
+				/* once in STAT_INTERVAL seconds */
+
+/* traps of the same source address are queued to the same worker to keep their order */
+typedef struct
+{
+	zbx_ipc_client_t	*client;
+	unsigned char		*data;
+	zbx_uint32_t		data_alloc;
+	zbx_uint32_t		data_offset;
+	off_t			data_pos;	/* trap file position of the first queued trap */
+	off_t			busy_pos;	/* trap file position of the first trap being processed */
+	int			busy;		/* batch was sent and worker has not finished processing it */
+}
+zbx_snmptrap_worker_t;
+
+/* compiled regular expression of snmptrap[] item key */
+typedef struct
+{
+	char		*pattern;
+	zbx_regexp_t	*regexp;	/* NULL if pattern is invalid */
+}
+zbx_snmptrap_regexp_t;
 
 static int	trap_fd = -1;
 static off_t	trap_lastsize;
+static off_t	trap_lastsize_db;	/* trap file position saved in database */
 static ino_t	trap_ino = 0;
 static char	*buffer = NULL;
 static int	offset = 0;
 static int	force = 0;
 
+static zbx_snmptrap_worker_t	*workers = NULL;
+static int			workers_num = 0;
+static zbx_uint32_t		queued_size = 0;
+
+static zbx_hashset_t		regexp_cache;
+
+/* throughput statistics since the last process title update */
+static zbx_uint64_t	traps_read = 0, traps_processed = 0, traps_unmatched = 0;
+
 extern ZBX_THREAD_LOCAL unsigned char	process_type;
 extern unsigned char			program_type;
 extern ZBX_THREAD_LOCAL int		server_num, process_num;
@@ -58,13 +98,120 @@ static void	DBget_lastsize(void)
 	DBfree_result(result);
 
 	DBcommit();
+
+	trap_lastsize_db = trap_lastsize;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: save trap file position up to which all traps are processed       *
+ *                                                                            *
+ * Comments: Traps queued to workers or being processed by them are not       *
+ *           considered processed, so they are read again after restart.      *
+ *           Unfinished trap at the end of read data is read again as well.   *
+ *                                                                            *
+ ******************************************************************************/
 static void	DBupdate_lastsize(void)
 {
+	off_t	lastsize;
+	int	i;
+
+	lastsize = trap_lastsize - offset;
+
+	for (i = 0; i < workers_num; i++)
+	{
+		if (0 != workers[i].data_offset && workers[i].data_pos < lastsize)
+			lastsize = workers[i].data_pos;
+
+		if (0 != workers[i].busy && workers[i].busy_pos < lastsize)
+			lastsize = workers[i].busy_pos;
+	}
+
+	if (lastsize == trap_lastsize_db)
+		return;
+
 	DBbegin();
-	DBexecute("update globalvars set snmp_lastsize=%lld", (long long int)trap_lastsize);
+	DBexecute("update globalvars set snmp_lastsize=%lld", (long long int)lastsize);
 	DBcommit();
+
+	trap_lastsize_db = lastsize;
+}
+
+static zbx_hash_t	snmptrap_regexp_hash(const void *data)
+{
+	const zbx_snmptrap_regexp_t	*re = (const zbx_snmptrap_regexp_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(re->pattern);
+}
+
+static int	snmptrap_regexp_compare(const void *d1, const void *d2)
+{
+	const zbx_snmptrap_regexp_t	*re1 = (const zbx_snmptrap_regexp_t *)d1;
+	const zbx_snmptrap_regexp_t	*re2 = (const zbx_snmptrap_regexp_t *)d2;
+
+	return strcmp(re1->pattern, re2->pattern);
+}
+
+static void	snmptrap_regexp_clear(void *data)
+{
+	zbx_snmptrap_regexp_t	*re = (zbx_snmptrap_regexp_t *)data;
+
+	zbx_free(re->pattern);
+
+	if (NULL != re->regexp)
+		zbx_regexp_free(re->regexp);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: match trap against regular expression of snmptrap[] item          *
+ *                                                                            *
+ * Parameters: trap    - [IN] the trap                                        *
+ *             pattern - [IN] the regular expression                          *
+ *                                                                            *
+ * Return value: ZBX_REGEXP_MATCH    - the trap matches                       *
+ *               ZBX_REGEXP_NO_MATCH - the trap does not match                *
+ *               FAIL                - invalid regular expression             *
+ *                                                                            *
+ * Comments: Regular expressions are compiled once and cached, because the   *
+ *           same few expressions are matched against every trap.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmptrap_regexp_match(const char *trap, const char *pattern)
+{
+	zbx_snmptrap_regexp_t	*re, re_local;
+	const char		*err_msg = NULL;
+
+	if (NULL == regexp_cache.slots)
+	{
+		zbx_hashset_create_ext(&regexp_cache, 0, snmptrap_regexp_hash, snmptrap_regexp_compare,
+				snmptrap_regexp_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	re_local.pattern = (char *)pattern;
+
+	if (NULL == (re = (zbx_snmptrap_regexp_t *)zbx_hashset_search(&regexp_cache, &re_local)))
+	{
+		/* item keys rarely change, simply start over if the cache grows too large */
+		if (ZBX_SNMPTRAP_REGEXP_CACHE_MAX <= regexp_cache.num_data)
+			zbx_hashset_clear(&regexp_cache);
+
+		re_local.pattern = zbx_strdup(NULL, pattern);
+
+		if (SUCCEED != zbx_regexp_compile(pattern, &re_local.regexp, &err_msg))
+		{
+			re_local.regexp = NULL;
+			zbx_regexp_err_msg_free(err_msg);
+		}
+
+		re = (zbx_snmptrap_regexp_t *)zbx_hashset_insert(&regexp_cache, &re_local, sizeof(re_local));
+	}
+
+	if (NULL == re->regexp)
+		return FAIL;
+
+	return 0 == zbx_regexp_match_precompiled(trap, re->regexp) ? ZBX_REGEXP_MATCH : ZBX_REGEXP_NO_MATCH;
 }
 
 /******************************************************************************
@@ -143,10 +290,13 @@ static int	process_trap_for_interface(zbx_uint64_t interfaceid, char *trap, zbx_
 					errcodes[i] = NOTSUPPORTED;
 					goto next;
 				}
+
+				regexp_ret = regexp_match_ex(&regexps, trap, regex, ZBX_CASE_SENSITIVE);
 			}
+			else
+				regexp_ret = snmptrap_regexp_match(trap, regex);
 
-			if (ZBX_REGEXP_NO_MATCH == (regexp_ret = regexp_match_ex(&regexps, trap, regex,
-					ZBX_CASE_SENSITIVE)))
+			if (ZBX_REGEXP_NO_MATCH == regexp_ret)
 			{
 				goto next;
 			}
@@ -230,31 +380,28 @@ next:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: process a single trap                                             *
+ * Purpose: add trap to matching items of all interfaces with the address    *
  *                                                                            *
  * Parameters: addr - [IN] address of the target interface(s)                 *
- *             begin - [IN] beginning of the trap message                     *
- *             end - [IN] end of the trap message                             *
+ *             trap - [IN] the trap message                                   *
+ *             ts   - [IN] the trap receiving time                            *
  *                                                                            *
  ******************************************************************************/
-static void	process_trap(const char *addr, char *begin, char *end)
+static void	process_trap_value(const char *addr, char *trap, zbx_timespec_t *ts)
 {
-	zbx_timespec_t	ts;
 	zbx_uint64_t	*interfaceids = NULL;
 	int		count, i, ret = FAIL;
-	char		*trap = NULL;
-
-	zbx_timespec(&ts);
-	trap = zbx_dsprintf(trap, "%s%s", begin, end);
 
 	count = DCconfig_get_snmp_interfaceids_by_addr(addr, &interfaceids);
 
 	for (i = 0; i < count; i++)
 	{
-		if (SUCCEED == process_trap_for_interface(interfaceids[i], trap, &ts))
+		if (SUCCEED == process_trap_for_interface(interfaceids[i], trap, ts))
 			ret = SUCCEED;
 	}
 
+	traps_processed++;
+
 	if (FAIL == ret)
 	{
 		zbx_config_t	cfg;
@@ -265,9 +412,120 @@ static void	process_trap(const char *addr, char *begin, char *end)
 			zabbix_log(LOG_LEVEL_WARNING, "unmatched trap received from \"%s\": %s", addr, trap);
 
 		zbx_config_clean(&cfg);
+
+		traps_unmatched++;
 	}
 
 	zbx_free(interfaceids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queue trap to the worker processing traps of its source address  *
+ *                                                                            *
+ * Parameters: addr - [IN] the trap source address                            *
+ *             trap - [IN] the trap message                                   *
+ *             ts   - [IN] the trap receiving time                            *
+ *             pos  - [IN] the trap position in trap file                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	queue_trap(const char *addr, const char *trap, const zbx_timespec_t *ts, off_t pos)
+{
+	zbx_snmptrap_worker_t	*worker;
+	zbx_uint32_t		data_len = 0, addr_len, trap_len;
+	unsigned char		*ptr;
+
+	worker = &workers[ZBX_DEFAULT_STRING_HASH_FUNC(addr) % (zbx_uint32_t)workers_num];
+
+	zbx_serialize_prepare_str(data_len, addr);
+	zbx_serialize_prepare_str(data_len, trap);
+	zbx_serialize_prepare_value(data_len, ts->sec);
+	zbx_serialize_prepare_value(data_len, ts->ns);
+
+	if (worker->data_alloc - worker->data_offset < data_len)
+	{
+		while (worker->data_alloc - worker->data_offset < data_len)
+			worker->data_alloc += ZBX_SNMPTRAP_BATCH_SIZE;
+
+		worker->data = (unsigned char *)zbx_realloc(worker->data, worker->data_alloc);
+	}
+
+	if (0 == worker->data_offset)
+		worker->data_pos = pos;
+
+	ptr = worker->data + worker->data_offset;
+	ptr += zbx_serialize_str(ptr, addr, addr_len);
+	ptr += zbx_serialize_str(ptr, trap, trap_len);
+	ptr += zbx_serialize_value(ptr, ts->sec);
+	(void)zbx_serialize_value(ptr, ts->ns);
+
+	worker->data_offset += data_len;
+	queued_size += data_len;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send queued traps to workers that are not busy                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	send_traps(void)
+{
+	int			i;
+	zbx_snmptrap_worker_t	*worker;
+
+	for (i = 0; i < workers_num; i++)
+	{
+		worker = &workers[i];
+
+		if (NULL == worker->client || 0 != worker->busy || 0 == worker->data_offset)
+			continue;
+
+		if (FAIL == zbx_ipc_client_send(worker->client, ZBX_IPC_SNMPTRAPPER_TRAPS, worker->data,
+				worker->data_offset))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot send SNMP traps to worker");
+			exit(EXIT_FAILURE);
+		}
+
+		queued_size -= worker->data_offset;
+		worker->data_offset = 0;
+		worker->busy_pos = worker->data_pos;
+		worker->busy = 1;
+
+		/* release memory after trap storms */
+		if (ZBX_SNMPTRAP_BATCH_SIZE < worker->data_alloc)
+		{
+			worker->data_alloc = ZBX_SNMPTRAP_BATCH_SIZE;
+			worker->data = (unsigned char *)zbx_realloc(worker->data, worker->data_alloc);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process a single trap                                             *
+ *                                                                            *
+ * Parameters: addr - [IN] address of the target interface(s)                 *
+ *             begin - [IN] beginning of the trap message                     *
+ *             end - [IN] end of the trap message                             *
+ *             pos - [IN] the trap position in trap file                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_trap(const char *addr, char *begin, char *end, off_t pos)
+{
+	zbx_timespec_t	ts;
+	char		*trap = NULL;
+
+	zbx_timespec(&ts);
+	trap = zbx_dsprintf(trap, "%s%s", begin, end);
+
+	if (0 != workers_num)
+		queue_trap(addr, trap, &ts, pos);
+	else
+		process_trap_value(addr, trap, &ts);
+
+	traps_read++;
+
 	zbx_free(trap);
 }
 
@@ -279,9 +537,13 @@ static void	process_trap(const char *addr, char *begin, char *end)
 static void	parse_traps(int flag)
 {
 	char	*c, *line, *begin = NULL, *end = NULL, *addr = NULL, *pzbegin, *pzaddr = NULL, *pzdate = NULL;
+	off_t	pos;
 
 	c = line = buffer;
 
+	/* trap file position of the buffer start, the buffer holds data up to the last read position */
+	pos = trap_lastsize - (off_t)strlen(buffer);
+
 	while ('\0' != *c)
 	{
 		if ('\n' == *c)
@@ -312,7 +574,7 @@ static void	parse_traps(int flag)
 			*pzdate = '\0';
 			*pzaddr = '\0';
 
-			process_trap(addr, begin, end);
+			process_trap(addr, begin, end, pos + (begin - buffer));
 			end = NULL;
 		}
 
@@ -364,7 +626,7 @@ static void	parse_traps(int flag)
 			*pzdate = '\0';
 			*pzaddr = '\0';
 
-			process_trap(addr, begin, end);
+			process_trap(addr, begin, end, pos + (begin - buffer));
 			offset = 0;
 			*buffer = '\0';
 		}
@@ -436,8 +698,8 @@ static int	read_traps(void)
 	{
 		buffer[nbytes + offset] = '\0';
 		trap_lastsize += nbytes;
-		DBupdate_lastsize();
 		parse_traps(0);
+		DBupdate_lastsize();
 	}
 out:
 	zbx_free(error);
@@ -456,11 +718,18 @@ out:
  ******************************************************************************/
 static void	close_trap_file(void)
 {
+	int	i;
+
 	if (-1 != trap_fd)
 		close(trap_fd);
 
 	trap_fd = -1;
 	trap_lastsize = 0;
+
+	/* traps of the closed file cannot be read again, they are tracked as the beginning of the new file */
+	for (i = 0; i < workers_num; i++)
+		workers[i].data_pos = workers[i].busy_pos = 0;
+
 	DBupdate_lastsize();
 }
 
@@ -579,6 +848,147 @@ static int	get_latest_data(void)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: register SNMP trap worker                                         *
+ *                                                                            *
+ * Parameters: client  - [IN] the connected worker IPC client                 *
+ *             message - [IN] the received message                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmptrapper_register_worker(zbx_ipc_client_t *client, const zbx_ipc_message_t *message)
+{
+	pid_t	ppid;
+	int	i;
+
+	memcpy(&ppid, message->data, sizeof(ppid));
+
+	if (ppid != getppid())
+	{
+		zbx_ipc_client_close(client);
+		zabbix_log(LOG_LEVEL_DEBUG, "refusing connection from foreign process");
+		return;
+	}
+
+	for (i = 0; i < workers_num; i++)
+	{
+		if (NULL == workers[i].client)
+		{
+			workers[i].client = client;
+			return;
+		}
+	}
+
+	THIS_SHOULD_NEVER_HAPPEN;
+	exit(EXIT_FAILURE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process trap batch completion message from SNMP trap worker       *
+ *                                                                            *
+ * Parameters: client  - [IN] the worker IPC client                           *
+ *             message - [IN] the received message                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmptrapper_process_done(zbx_ipc_client_t *client, const zbx_ipc_message_t *message)
+{
+	int		i;
+	zbx_uint64_t	processed_num, unmatched_num;
+	unsigned char	*ptr = message->data;
+
+	ptr += zbx_deserialize_value(ptr, &processed_num);
+	(void)zbx_deserialize_value(ptr, &unmatched_num);
+
+	traps_processed += processed_num;
+	traps_unmatched += unmatched_num;
+
+	for (i = 0; i < workers_num; i++)
+	{
+		if (client == workers[i].client)
+		{
+			workers[i].busy = 0;
+			break;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive messages from SNMP trap workers and dispatch queued traps *
+ *                                                                            *
+ * Parameters: service - [IN] the SNMP trapper IPC service                    *
+ *             period  - [IN] the maximum time to wait for messages           *
+ *                                                                            *
+ * Return value: time spent waiting for messages                              *
+ *                                                                            *
+ * Comments: Returns early when trap file reading was paused because of too   *
+ *           many queued traps and workers have caught up. Keeps receiving    *
+ *           after the period has passed while there are pending messages.    *
+ *                                                                            *
+ ******************************************************************************/
+static double	snmptrapper_dispatch(zbx_ipc_service_t *service, double period)
+{
+	zbx_ipc_client_t	*client;
+	zbx_ipc_message_t	*message;
+	zbx_timespec_t		timeout;
+	double			time_start, time_now, time_left, time_idle = 0;
+	int			ret, paused, received;
+
+	paused = (ZBX_SNMPTRAP_QUEUE_SIZE <= queued_size);
+	time_start = time_now = zbx_time();
+
+	do
+	{
+		send_traps();
+
+		if (0 != paused && ZBX_SNMPTRAP_QUEUE_SIZE / 2 > queued_size)
+			break;
+
+		if (0 > (time_left = period - (time_now - time_start)))
+			time_left = 0;
+
+		timeout.sec = (int)time_left;
+		timeout.ns = (int)((time_left - timeout.sec) * 1000000000);
+
+		update_selfmon_counter(ZBX_PROCESS_STATE_IDLE);
+		ret = zbx_ipc_service_recv(service, &timeout, &client, &message);
+		update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
+
+		if (ZBX_IPC_RECV_IMMEDIATE != ret)
+			time_idle += zbx_time() - time_now;
+
+		if (NULL != message)
+		{
+			received = 1;
+
+			switch (message->code)
+			{
+				case ZBX_IPC_SNMPTRAPPER_REGISTER:
+					snmptrapper_register_worker(client, message);
+					break;
+				case ZBX_IPC_SNMPTRAPPER_DONE:
+					snmptrapper_process_done(client, message);
+					break;
+			}
+
+			zbx_ipc_message_free(message);
+		}
+		else
+			received = 0;
+
+		if (NULL != client)
+			zbx_ipc_client_release(client);
+
+		time_now = zbx_time();
+	}
+	while (ZBX_IS_RUNNING() && (period > time_now - time_start || 0 != received));
+
+	DBupdate_lastsize();
+
+	return time_idle;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: SNMP trap reader's entry point                                    *
@@ -586,7 +996,9 @@ static int	get_latest_data(void)
  ******************************************************************************/
 ZBX_THREAD_ENTRY(snmptrapper_thread, args)
 {
-	double	sec;
+	double			sec, time_stat, time_idle = 0;
+	zbx_ipc_service_t	service;
+	char			*error = NULL;
 
 	process_type = ((zbx_thread_args_t *)args)->process_type;
 	server_num = ((zbx_thread_args_t *)args)->server_num;
@@ -597,6 +1009,19 @@ ZBX_THREAD_ENTRY(snmptrapper_thread, args)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() trapfile:'%s'", __func__, CONFIG_SNMPTRAP_FILE);
 
+	if (0 != CONFIG_SNMPTRAPWORKER_FORKS)
+	{
+		if (FAIL == zbx_ipc_service_start(&service, ZBX_IPC_SERVICE_SNMPTRAPPER, &error))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot start SNMP trapper service: %s", error);
+			zbx_free(error);
+			exit(EXIT_FAILURE);
+		}
+
+		workers_num = CONFIG_SNMPTRAPWORKER_FORKS;
+		workers = (zbx_snmptrap_worker_t *)zbx_calloc(NULL, (size_t)workers_num, sizeof(zbx_snmptrap_worker_t));
+	}
+
 	update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
 
 	zbx_setproctitle("%s [connecting to the database]", get_process_type_string(process_type));
@@ -608,21 +1033,42 @@ ZBX_THREAD_ENTRY(snmptrapper_thread, args)
 	buffer = (char *)zbx_malloc(buffer, MAX_BUFFER_LEN);
 	*buffer = '\0';
 
+	time_stat = zbx_time();
+
 	while (ZBX_IS_RUNNING())
 	{
 		sec = zbx_time();
 		zbx_update_env(sec);
 
-		zbx_setproctitle("%s [processing data]", get_process_type_string(process_type));
+		if (STAT_INTERVAL < sec - time_stat)
+		{
+			zbx_setproctitle("%s [read " ZBX_FS_UI64 " traps, processed " ZBX_FS_UI64 " traps, unmatched "
+					ZBX_FS_UI64 " traps, queued %u bytes, idle " ZBX_FS_DBL " sec during " ZBX_FS_DBL
+					" sec]", get_process_type_string(process_type), traps_read, traps_processed,
+					traps_unmatched, queued_size, time_idle, sec - time_stat);
+
+			time_stat = sec;
+			time_idle = 0;
+			traps_read = traps_processed = traps_unmatched = 0;
+		}
 
-		while (ZBX_IS_RUNNING() && SUCCEED == get_latest_data())
+		while (ZBX_IS_RUNNING() && ZBX_SNMPTRAP_QUEUE_SIZE > queued_size && SUCCEED == get_latest_data())
+		{
 			read_traps();
-		sec = zbx_time() - sec;
 
-		zbx_setproctitle("%s [processed data in " ZBX_FS_DBL " sec, idle 1 sec]",
-				get_process_type_string(process_type), sec);
+			if (0 != workers_num)
+				time_idle += snmptrapper_dispatch(&service, 0);
+		}
 
-		zbx_sleep_loop(1);
+		if (0 != workers_num)
+		{
+			time_idle += snmptrapper_dispatch(&service, 1);
+		}
+		else
+		{
+			time_idle += 1;
+			zbx_sleep_loop(1);
+		}
 	}
 
 	zbx_free(buffer);
@@ -635,3 +1081,125 @@ ZBX_THREAD_ENTRY(snmptrapper_thread, args)
 	while (1)
 		zbx_sleep(SEC_PER_MIN);
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process traps received from SNMP trap reader                      *
+ *                                                                            *
+ * Parameters: message - [IN] the message with serialized traps               *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmptrap_worker_process_traps(const zbx_ipc_message_t *message)
+{
+	const unsigned char	*ptr = message->data;
+	char			*addr = NULL, *trap = NULL;
+	zbx_uint32_t		addr_len, trap_len;
+	zbx_timespec_t		ts;
+
+	while ((zbx_uint32_t)(ptr - message->data) < message->size)
+	{
+		ptr += zbx_deserialize_str(ptr, &addr, addr_len);
+		ptr += zbx_deserialize_str(ptr, &trap, trap_len);
+		ptr += zbx_deserialize_value(ptr, &ts.sec);
+		ptr += zbx_deserialize_value(ptr, &ts.ns);
+
+		process_trap_value(addr, trap, &ts);
+
+		zbx_free(addr);
+		zbx_free(trap);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: SNMP trap worker's entry point                                    *
+ *                                                                            *
+ ******************************************************************************/
+ZBX_THREAD_ENTRY(snmptrap_worker_thread, args)
+{
+	char			*error = NULL;
+	zbx_ipc_socket_t	socket;
+	zbx_ipc_message_t	message;
+	double			time_stat, time_idle = 0, time_now, time_read;
+	zbx_uint64_t		processed_num = 0, unmatched_num = 0;
+	unsigned char		data[sizeof(zbx_uint64_t) * 2], *ptr;
+	pid_t			ppid;
+
+	process_type = ((zbx_thread_args_t *)args)->process_type;
+	server_num = ((zbx_thread_args_t *)args)->server_num;
+	process_num = ((zbx_thread_args_t *)args)->process_num;
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(program_type),
+			server_num, get_process_type_string(process_type), process_num);
+
+	zbx_ipc_message_init(&message);
+
+	if (FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_SNMPTRAPPER, SEC_PER_MIN, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to SNMP trapper service: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
+	ppid = getppid();
+	zbx_ipc_socket_write(&socket, ZBX_IPC_SNMPTRAPPER_REGISTER, (unsigned char *)&ppid, sizeof(ppid));
+
+	time_stat = zbx_time();
+
+	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
+
+	update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
+
+	while (ZBX_IS_RUNNING())
+	{
+		time_now = zbx_time();
+
+		if (STAT_INTERVAL < time_now - time_stat)
+		{
+			zbx_setproctitle("%s #%d [processed " ZBX_FS_UI64 " traps, unmatched " ZBX_FS_UI64 " traps, idle "
+					ZBX_FS_DBL " sec during " ZBX_FS_DBL " sec]", get_process_type_string(process_type),
+					process_num, processed_num, unmatched_num, time_idle, time_now - time_stat);
+
+			time_stat = time_now;
+			time_idle = 0;
+			processed_num = 0;
+			unmatched_num = 0;
+		}
+
+		update_selfmon_counter(ZBX_PROCESS_STATE_IDLE);
+		if (SUCCEED != zbx_ipc_socket_read(&socket, &message))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot read SNMP trapper service request");
+			exit(EXIT_FAILURE);
+		}
+		update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
+
+		time_read = zbx_time();
+		time_idle += time_read - time_now;
+		zbx_update_env(time_read);
+
+		switch (message.code)
+		{
+			case ZBX_IPC_SNMPTRAPPER_TRAPS:
+				traps_processed = traps_unmatched = 0;
+				snmptrap_worker_process_traps(&message);
+
+				processed_num += traps_processed;
+				unmatched_num += traps_unmatched;
+
+				ptr = data;
+				ptr += zbx_serialize_value(ptr, traps_processed);
+				(void)zbx_serialize_value(ptr, traps_unmatched);
+
+				zbx_ipc_socket_write(&socket, ZBX_IPC_SNMPTRAPPER_DONE, data, sizeof(data));
+				break;
+		}
+
+		zbx_ipc_message_clean(&message);
+	}
+
+	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
+
+	while (1)
+		zbx_sleep(SEC_PER_MIN);
+}
@@ -22,9 +22,17 @@
 
 #include "zbxthreads.h"
 
+#define ZBX_IPC_SERVICE_SNMPTRAPPER	"snmptrapper"
+
+#define ZBX_IPC_SNMPTRAPPER_REGISTER	1
+#define ZBX_IPC_SNMPTRAPPER_TRAPS	2
+#define ZBX_IPC_SNMPTRAPPER_DONE	3
+
 extern char		*CONFIG_SNMPTRAP_FILE;
+extern int		CONFIG_SNMPTRAPWORKER_FORKS;
 extern ZBX_THREAD_LOCAL unsigned char	process_type;
 
 ZBX_THREAD_ENTRY(snmptrapper_thread, args);
+ZBX_THREAD_ENTRY(snmptrap_worker_thread, args);
 
 #endif
@@ -42,9 +42,14 @@
 #	include "zbxrtc.h"
 #endif
 
+#include <event.h>
+
 #define ZBX_MAX_SECTION_ENTRIES		4
 #define ZBX_MAX_ENTRY_ATTRIBUTES	3
 
+/* receive buffer size for incrementally processed requests */
+#define ZBX_TRAPPER_STREAM_CHUNK_SIZE	(4 * ZBX_MEBIBYTE)
+
 extern ZBX_THREAD_LOCAL unsigned char	process_type;
 extern unsigned char			program_type;
 extern ZBX_THREAD_LOCAL int		server_num, process_num;
@@ -1195,14 +1200,478 @@ static int	process_trap(zbx_socket_t *sock, char *s, ssize_t bytes_received, zbx
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: responds to agent/sender history data request processed while    *
+ *          it was being received                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	recv_history_stream(zbx_socket_t *sock, zbx_history_stream_t *stream)
+{
+	char	*info = NULL;
+	int	ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != (ret = zbx_history_stream_finish(stream, &info)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "received invalid \"%s\" request from \"%s\": %s",
+				zbx_history_stream_request(stream), sock->peer, info);
+	}
+	else if (!ZBX_IS_RUNNING())
+	{
+		info = zbx_strdup(info, "Zabbix server shutdown in progress");
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process \"%s\" request from \"%s\": %s",
+				zbx_history_stream_request(stream), sock->peer, info);
+		ret = FAIL;
+	}
+
+	zbx_send_response_same(sock, ret, info, CONFIG_TIMEOUT);
+
+	zbx_free(info);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+typedef struct
+{
+	zbx_socket_t		*sock;
+	zbx_history_stream_t	*stream;
+}
+zbx_trapper_stream_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes received part of large request to history stream parser   *
+ *                                                                            *
+ * Comments: The message size limit of process_trap() is checked before the   *
+ *           first part is parsed, so oversized requests are rejected before  *
+ *           any of their values are processed.                               *
+ *                                                                            *
+ ******************************************************************************/
+static ssize_t	trapper_history_stream_cb(const char *data, size_t len, zbx_uint64_t size, int last, void *arg)
+{
+	zbx_trapper_stream_t	*trapper_stream = (zbx_trapper_stream_t *)arg;
+
+	if (ZBX_GIBIBYTE < size)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "message size " ZBX_FS_UI64 " exceeds the maximum size " ZBX_FS_UI64
+				" for request received from \"%s\"", size, (zbx_uint64_t)ZBX_GIBIBYTE,
+				trapper_stream->sock->peer);
+		return FAIL;
+	}
+
+	return (ssize_t)zbx_history_stream_parse(trapper_stream->stream, data, len, last);
+}
+
 static void	process_trapper_child(zbx_socket_t *sock, zbx_timespec_t *ts)
 {
-	ssize_t	bytes_received;
+	ssize_t			bytes_received;
+	zbx_trapper_stream_t	stream;
+
+	/* large agent and sender history data requests are processed in batches while being received */
+	stream.sock = sock;
+	stream.stream = zbx_history_stream_create(sock, ts);
+
+	if (FAIL != (bytes_received = zbx_tcp_recv_stream(sock, CONFIG_TRAPPER_TIMEOUT, ZBX_TCP_LARGE,
+			ZBX_TRAPPER_STREAM_CHUNK_SIZE, trapper_history_stream_cb, &stream)))
+	{
+		if (SUCCEED == zbx_history_stream_started(stream.stream))
+			recv_history_stream(sock, stream.stream);
+		else
+			process_trap(sock, sock->buffer, bytes_received, ts);
+	}
+
+	zbx_history_stream_free(stream.stream);
+}
+
+#define ZBX_TRAPPER_CONN_STATE_HANDSHAKE	0
+#define ZBX_TRAPPER_CONN_STATE_RECV		1
+
+#define ZBX_TRAPPER_SEC_ACCEPT	(ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK | ZBX_TCP_SEC_UNENCRYPTED)
+
+typedef struct zbx_trapper_mux	zbx_trapper_mux_t;
+
+/* connection being accepted or received by multiplexed trapper */
+typedef struct
+{
+	zbx_socket_t		s;
+	zbx_tcp_recv_context_t	recv_context;
+	zbx_trapper_mux_t	*mux;
+	struct event		*event;
+	short			event_flags;
+	zbx_timespec_t		ts;
+	time_t			deadline;
+	ssize_t			bytes_received;
+	unsigned char		state;
+}
+zbx_trapper_conn_t;
+
+/* multiplexer of trapper connections */
+struct zbx_trapper_mux
+{
+	struct event_base	*ev;
+	struct event		*ev_timer;
+	struct event		*ev_listen[ZBX_SOCKET_COUNT];
+	int			listen_num;
+
+	/* connections with fully received requests, waiting for processing */
+	zbx_queue_ptr_t		ready;
+
+	int			connections_num;
+	int			connections_max;
+	unsigned char		accepting;
+};
+
+#if !defined(LIBEVENT_VERSION_NUMBER) || LIBEVENT_VERSION_NUMBER < 0x2000000
+typedef int evutil_socket_t;
+
+static struct event	*event_new(struct event_base *ev, evutil_socket_t fd, short what,
+		void(*cb_func)(int, short, void *), void *cb_arg)
+{
+	struct event	*event;
+
+	event = zbx_malloc(NULL, sizeof(struct event));
+	event_set(event, fd, what, cb_func, cb_arg);
+	event_base_set(ev, event);
+
+	return event;
+}
+
+static void	event_free(struct event *event)
+{
+	event_del(event);
+	zbx_free(event);
+}
+
+#endif
+
+static void	trapper_conn_process(zbx_trapper_conn_t *conn);
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables or disables accepting of new connections                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_mux_set_accepting(zbx_trapper_mux_t *mux, unsigned char accepting)
+{
+	int	i;
+
+	if (mux->accepting == accepting)
+		return;
+
+	for (i = 0; i < mux->listen_num; i++)
+	{
+		if (0 != accepting)
+			event_add(mux->ev_listen[i], NULL);
+		else
+			event_del(mux->ev_listen[i]);
+	}
+
+	mux->accepting = accepting;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: closes connection and releases its resources                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_conn_free(zbx_trapper_conn_t *conn)
+{
+	zbx_trapper_mux_t	*mux = conn->mux;
+
+	if (NULL != conn->event)
+		event_free(conn->event);
+
+	zbx_tcp_unaccept(&conn->s);
+	zbx_free(conn);
+
+	if (--mux->connections_num < mux->connections_max)
+		trapper_mux_set_accepting(mux, 1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handles socket events and timeouts of a connection                *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_conn_event_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_trapper_conn_t	*conn = (zbx_trapper_conn_t *)arg;
+
+	ZBX_UNUSED(fd);
+
+	if (0 != (what & EV_TIMEOUT))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "connection from %s timed out while %s", conn->s.peer,
+				ZBX_TRAPPER_CONN_STATE_HANDSHAKE == conn->state ? "accepting" : "receiving data");
+		trapper_conn_free(conn);
+		return;
+	}
+
+	trapper_conn_process(conn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for socket event before continuing to process connection    *
+ *                                                                            *
+ * Parameters: conn   - [IN] the connection                                   *
+ *             events - [IN] POLLIN or POLLOUT                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_conn_wait(zbx_trapper_conn_t *conn, short events)
+{
+	struct timeval	tv;
+	time_t		now;
+	short		event_flags;
+
+	if (conn->deadline <= (now = time(NULL)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "connection from %s timed out", conn->s.peer);
+		trapper_conn_free(conn);
+		return;
+	}
+
+	event_flags = (0 != (events & POLLOUT) ? EV_WRITE : EV_READ);
+
+	if (NULL != conn->event && event_flags != conn->event_flags)
+	{
+		event_free(conn->event);
+		conn->event = NULL;
+	}
+
+	if (NULL == conn->event)
+	{
+		conn->event = event_new(conn->mux->ev, conn->s.socket, event_flags, trapper_conn_event_cb, conn);
+		conn->event_flags = event_flags;
+	}
+
+	tv.tv_sec = conn->deadline - now;
+	tv.tv_usec = 0;
+	event_add(conn->event, &tv);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: continues TLS handshake or receiving of request data as far as    *
+ *          possible without blocking                                         *
+ *                                                                            *
+ * Comments: Connections with fully received requests are queued for          *
+ *           processing, failed connections are closed.                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_conn_process(zbx_trapper_conn_t *conn)
+{
+	short	events;
+
+	if (ZBX_TRAPPER_CONN_STATE_HANDSHAKE == conn->state)
+	{
+		if (SUCCEED != zbx_tcp_accept_handshake(&conn->s, ZBX_TRAPPER_SEC_ACCEPT, &events))
+		{
+			if (0 == events)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s",
+						zbx_socket_strerror());
+				trapper_conn_free(conn);
+			}
+			else
+				trapper_conn_wait(conn, events);
+
+			return;
+		}
+
+		/* get connection timestamp */
+		zbx_timespec(&conn->ts);
+
+		conn->state = ZBX_TRAPPER_CONN_STATE_RECV;
+		conn->deadline = time(NULL) + CONFIG_TRAPPER_TIMEOUT;
+		zbx_tcp_recv_context_init(&conn->s, &conn->recv_context, ZBX_TCP_LARGE);
+	}
+
+	if (FAIL == (conn->bytes_received = zbx_tcp_recv_context(&conn->s, &conn->recv_context, &events)))
+	{
+		if (0 == events)
+			trapper_conn_free(conn);
+		else
+			trapper_conn_wait(conn, events);
 
-	if (FAIL == (bytes_received = zbx_tcp_recv_ext(sock, CONFIG_TRAPPER_TIMEOUT, ZBX_TCP_LARGE)))
 		return;
+	}
+
+	if (NULL != conn->event)
+	{
+		event_free(conn->event);
+		conn->event = NULL;
+	}
+
+	zbx_queue_ptr_push(&conn->mux->ready, conn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: accepts pending connections on a listening socket                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_accept_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_trapper_mux_t	*mux = (zbx_trapper_mux_t *)arg;
+	zbx_trapper_conn_t	*conn;
+	short			events;
+
+	ZBX_UNUSED(what);
+
+	while (mux->connections_num < mux->connections_max)
+	{
+		conn = (zbx_trapper_conn_t *)zbx_malloc(NULL, sizeof(zbx_trapper_conn_t));
+
+		if (SUCCEED != zbx_tcp_accept_async(&conn->s, fd, &events))
+		{
+			if (0 == events)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s",
+						zbx_socket_strerror());
+			}
+
+			zbx_free(conn);
+			break;
+		}
+
+		conn->mux = mux;
+		conn->event = NULL;
+		conn->event_flags = 0;
+		conn->state = ZBX_TRAPPER_CONN_STATE_HANDSHAKE;
+		conn->deadline = time(NULL) + CONFIG_TIMEOUT;
+
+		mux->connections_num++;
+
+		trapper_conn_process(conn);
+	}
+
+	if (mux->connections_num >= mux->connections_max)
+		trapper_mux_set_accepting(mux, 0);
+}
+
+static void	trapper_timer_cb(evutil_socket_t fd, short what, void *arg)
+{
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+	ZBX_UNUSED(arg);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serves trapper connections multiplexing them in single process    *
+ *                                                                            *
+ * Parameters: s   - [IN] the listening sockets                               *
+ *             rtc - [IN] the RTC notification subscription socket            *
+ *                                                                            *
+ * Comments: TLS handshakes and receiving of requests are performed in        *
+ *           non-blocking mode for up to MaxConnectionsPerTrapper concurrent  *
+ *           connections. Fully received requests are processed one by one    *
+ *           in blocking mode, the same way as in single connection mode.     *
+ *                                                                            *
+ ******************************************************************************/
+#ifdef HAVE_NETSNMP
+static void	trapper_serve_multiplexed(zbx_socket_t *s, zbx_ipc_async_socket_t *rtc)
+#else
+static void	trapper_serve_multiplexed(zbx_socket_t *s)
+#endif
+{
+	zbx_trapper_mux_t	mux;
+	zbx_trapper_conn_t	*conn;
+	double			sec = 0.0;
+	int			i;
+
+	mux.ev = event_base_new();
+	mux.listen_num = 0;
+	mux.connections_num = 0;
+	mux.connections_max = CONFIG_MAX_CONNECTIONS_PER_TRAPPER;
+	mux.accepting = 0;
+	zbx_queue_ptr_create(&mux.ready);
+
+	for (i = 0; i < s->num_socks; i++)
+	{
+		if (SUCCEED != zbx_socket_set_nonblocking(s->sockets[i], 1))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot switch listening socket to non-blocking mode: %s",
+					zbx_socket_strerror());
+			exit(EXIT_FAILURE);
+		}
+
+		mux.ev_listen[mux.listen_num++] = event_new(mux.ev, s->sockets[i], EV_READ | EV_PERSIST,
+				trapper_accept_cb, &mux);
+	}
+
+	trapper_mux_set_accepting(&mux, 1);
+
+	mux.ev_timer = event_new(mux.ev, -1, 0, trapper_timer_cb, NULL);
+
+	while (ZBX_IS_RUNNING())
+	{
+#ifdef HAVE_NETSNMP
+		zbx_uint32_t	rtc_cmd;
+		unsigned char	*rtc_data;
+		int		snmp_reload = 0;
+#endif
+		struct timeval	tv;
+
+		zbx_setproctitle("%s #%d [processed data in " ZBX_FS_DBL " sec, %d connections in progress]",
+				get_process_type_string(process_type), process_num, sec, mux.connections_num);
+
+		update_selfmon_counter(ZBX_PROCESS_STATE_IDLE);
+
+		/* wake up at least once per second to check if the process must stop */
+		tv.tv_sec = 1;
+		tv.tv_usec = 0;
+		evtimer_add(mux.ev_timer, &tv);
+		event_base_loop(mux.ev, EVLOOP_ONCE);
+		zbx_update_env(zbx_time());
+
+		if (SUCCEED == zbx_queue_ptr_empty(&mux.ready))
+			continue;
+
+		update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
+
+		zbx_setproctitle("%s #%d [processing data]", get_process_type_string(process_type), process_num);
+#ifdef HAVE_NETSNMP
+		while (SUCCEED == zbx_rtc_wait(rtc, &rtc_cmd, &rtc_data, 0) && 0 != rtc_cmd)
+		{
+			if (ZBX_RTC_SNMP_CACHE_RELOAD == rtc_cmd && 0 == snmp_reload)
+			{
+				zbx_clear_cache_snmp(process_type, process_num);
+				snmp_reload = 1;
+			}
+			else if (ZBX_RTC_SHUTDOWN == rtc_cmd)
+				goto out;
+		}
+#endif
+		sec = zbx_time();
+
+		while (NULL != (conn = (zbx_trapper_conn_t *)zbx_queue_ptr_pop(&mux.ready)))
+		{
+			/* request processing expects blocking socket */
+			if (SUCCEED == zbx_socket_set_nonblocking(conn->s.socket, 0))
+				process_trap(&conn->s, conn->s.buffer, conn->bytes_received, &conn->ts);
+
+			trapper_conn_free(conn);
+		}
 
-	process_trap(sock, sock->buffer, bytes_received, ts);
+		sec = zbx_time() - sec;
+	}
+#ifdef HAVE_NETSNMP
+out:
+#endif
+	while (NULL != (conn = (zbx_trapper_conn_t *)zbx_queue_ptr_pop(&mux.ready)))
+		trapper_conn_free(conn);
+
+	zbx_queue_ptr_destroy(&mux.ready);
+
+	for (i = 0; i < mux.listen_num; i++)
+		event_free(mux.ev_listen[i]);
+
+	event_free(mux.ev_timer);
+	event_base_free(mux.ev);
 }
 
 ZBX_THREAD_ENTRY(trapper_thread, args)
@@ -1238,6 +1707,16 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 	zbx_rtc_subscribe(&rtc, process_type, process_num);
 #endif
 
+	if (0 != CONFIG_MAX_CONNECTIONS_PER_TRAPPER)
+	{
+#ifdef HAVE_NETSNMP
+		trapper_serve_multiplexed(&s, &rtc);
+#else
+		trapper_serve_multiplexed(&s);
+#endif
+		goto out;
+	}
+
 	while (ZBX_IS_RUNNING())
 	{
 #ifdef HAVE_NETSNMP
@@ -1297,9 +1776,7 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 					zbx_socket_strerror());
 		}
 	}
-#ifdef HAVE_NETSNMP
 out:
-#endif
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
 	while (1)
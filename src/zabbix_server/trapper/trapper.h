@@ -24,6 +24,7 @@
 
 extern int	CONFIG_TIMEOUT;
 extern int	CONFIG_TRAPPER_TIMEOUT;
+extern int	CONFIG_MAX_CONNECTIONS_PER_TRAPPER;
 extern char	*CONFIG_STATS_ALLOWED_IP;
 
 #define ZBX_IPC_SERVICE_TRAPPER	"trapper"
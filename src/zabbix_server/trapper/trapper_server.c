@@ -27,9 +27,14 @@
 #include "../alerter/alerter_protocol.h"
 #include "zbxipcservice.h"
 #include "zbxcommshigh.h"
+#include "dbcache.h"
+#include "../../libs/zbxdbcache/valuecache.h"
 
 extern int	CONFIG_REPORTMANAGER_FORKS;
 
+#define ZBX_HISTORY_GET_ITEMS_MAX	1000
+#define ZBX_HISTORY_GET_PERIOD_MAX	SEC_PER_MONTH
+
 static void	trapper_process_report_test(zbx_socket_t *sock, const struct zbx_json_parse *jp)
 {
 	zbx_user_t		user;
@@ -213,6 +218,316 @@ fail:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove items the user has no read permission for                  *
+ *                                                                            *
+ * Parameters: user    - [IN] the user                                        *
+ *             itemids - [IN/OUT] the requested item identifiers              *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_history_filter_items(const zbx_user_t *user, zbx_vector_uint64_t *itemids)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_vector_uint64_t	permitted;
+	zbx_uint64_t		itemid;
+
+	if (USER_TYPE_SUPER_ADMIN == user->type || 0 == itemids->values_num)
+		return;
+
+	zbx_vector_uint64_create(&permitted);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select i.itemid from items i where");
+	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "i.itemid", itemids->values, itemids->values_num);
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			" and exists("
+				"select null"
+				" from hosts_groups hg,rights r,users_groups ug"
+				" where i.hostid=hg.hostid"
+					" and hg.groupid=r.id"
+					" and r.groupid=ug.usrgrpid"
+					" and ug.userid=" ZBX_FS_UI64
+				" group by hg.hostid"
+				" having min(r.permission)>=%d"
+			")",
+			user->userid, PERM_READ);
+
+	result = DBselect("%s", sql);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(itemid, row[0]);
+		zbx_vector_uint64_append(&permitted, itemid);
+	}
+	DBfree_result(result);
+
+	zbx_vector_uint64_sort(&permitted, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_clear(itemids);
+	zbx_vector_uint64_append_array(itemids, permitted.values, permitted.values_num);
+
+	zbx_vector_uint64_destroy(&permitted);
+	zbx_free(sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: write item history values as arrays of clock, ns and value        *
+ *          (followed by timestamp, source, severity and logeventid for log   *
+ *          values)                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_history_add_values(struct zbx_json *json, int value_type,
+		const zbx_vector_history_record_t *values)
+{
+	int	i;
+
+	zbx_json_addarray(json, ZBX_PROTO_TAG_VALUES);
+
+	for (i = 0; i < values->values_num; i++)
+	{
+		const zbx_history_record_t	*record = &values->values[i];
+
+		zbx_json_addarray(json, NULL);
+		zbx_json_addint64(json, NULL, record->timestamp.sec);
+		zbx_json_addint64(json, NULL, record->timestamp.ns);
+
+		switch (value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+				zbx_json_addfloat(json, NULL, record->value.dbl);
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				zbx_json_adduint64(json, NULL, record->value.ui64);
+				break;
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+				zbx_json_addstring(json, NULL, record->value.str, ZBX_JSON_TYPE_STRING);
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				zbx_json_addstring(json, NULL, record->value.log->value, ZBX_JSON_TYPE_STRING);
+				zbx_json_addint64(json, NULL, record->value.log->timestamp);
+				zbx_json_addstring(json, NULL, ZBX_NULL2EMPTY_STR(record->value.log->source),
+						ZBX_JSON_TYPE_STRING);
+				zbx_json_addint64(json, NULL, record->value.log->severity);
+				zbx_json_addint64(json, NULL, record->value.log->logeventid);
+				break;
+		}
+
+		zbx_json_close(json);
+	}
+
+	zbx_json_close(json);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read item history for the requested period                        *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             time_from  - [IN] the period start (inclusive)                 *
+ *             time_till  - [IN] the period end (inclusive)                   *
+ *             limit      - [IN] the maximum number of newest values to read, *
+ *                          0 - read all values                               *
+ *             values     - [OUT] the values in descending order              *
+ *                                                                            *
+ * Return value: SUCCEED - the values were read                               *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Value cache is used only when the period is already cached.      *
+ *           Older periods are read directly from history storage, so that    *
+ *           frontend requests do not load values, which are not needed by    *
+ *           server, into value cache.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	trapper_history_get_values(zbx_uint64_t itemid, int value_type, int time_from, int time_till,
+		int limit, zbx_vector_history_record_t *values)
+{
+	zbx_timespec_t	ts;
+	int		cached_from;
+
+	if (SUCCEED == zbx_vc_get_item_cached_from(itemid, value_type, &cached_from) && time_from >= cached_from)
+	{
+		ts.sec = time_till;
+		ts.ns = 999999999;
+
+		return zbx_vc_get_values(itemid, value_type, values, time_till - time_from + 1, limit, &ts);
+	}
+
+	if (SUCCEED != zbx_history_get_values(itemid, value_type, time_from - 1, limit, time_till, values))
+		return FAIL;
+
+	zbx_vector_history_record_sort(values, (zbx_compare_func_t)zbx_history_record_compare_desc_func);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process history request from frontend                             *
+ *                                                                            *
+ * Parameters: sock - [IN] the request socket                                 *
+ *             jp   - [IN] the request data                                   *
+ *                                                                            *
+ * Comments: Request data contains itemids, time_from and optional time_till  *
+ *           and limit (maximum number of values per item). The number of     *
+ *           items and the period length are limited. Periods already held by *
+ *           value cache are served without database queries.                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	trapper_process_history_get(zbx_socket_t *sock, const struct zbx_json_parse *jp)
+{
+	zbx_user_t			user;
+	struct zbx_json_parse		jp_data, jp_itemids;
+	struct zbx_json			json;
+	char				buffer[MAX_ID_LEN + 1], *error = NULL;
+	const char			*ptr;
+	int				i, time_from, time_till, limit = 0, *errcodes = NULL;
+	zbx_uint64_t			itemid;
+	zbx_vector_uint64_t		itemids;
+	DC_ITEM				*items = NULL;
+	zbx_vector_history_record_t	values;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_user_init(&user);
+	zbx_vector_uint64_create(&itemids);
+
+	if (FAIL == zbx_get_user_from_json(jp, &user, NULL))
+	{
+		zbx_send_response(sock, FAIL, "Permission denied.", CONFIG_TIMEOUT);
+		goto out;
+	}
+
+	if (SUCCEED != zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data))
+	{
+		error = zbx_dsprintf(NULL, "Cannot parse request tag: %s.", ZBX_PROTO_TAG_DATA);
+		goto fail;
+	}
+
+	if (SUCCEED != zbx_json_brackets_by_name(&jp_data, ZBX_PROTO_TAG_ITEMIDS, &jp_itemids))
+	{
+		error = zbx_dsprintf(NULL, "Cannot parse request tag: %s.", ZBX_PROTO_TAG_ITEMIDS);
+		goto fail;
+	}
+
+	for (ptr = NULL; NULL != (ptr = zbx_json_next_value(&jp_itemids, ptr, buffer, sizeof(buffer), NULL));)
+	{
+		if (SUCCEED != is_uint64(buffer, &itemid))
+		{
+			error = zbx_dsprintf(NULL, "Invalid item identifier \"%s\".", buffer);
+			goto fail;
+		}
+
+		zbx_vector_uint64_append(&itemids, itemid);
+	}
+
+	if (ZBX_HISTORY_GET_ITEMS_MAX < itemids.values_num)
+	{
+		error = zbx_dsprintf(NULL, "Too many items requested, maximum is %d.", ZBX_HISTORY_GET_ITEMS_MAX);
+		goto fail;
+	}
+
+	if (SUCCEED != zbx_json_value_by_name(&jp_data, ZBX_PROTO_TAG_TIME_FROM, buffer, sizeof(buffer), NULL) ||
+			SUCCEED != is_uint31(buffer, &time_from))
+	{
+		error = zbx_dsprintf(NULL, "Cannot parse request tag: %s.", ZBX_PROTO_TAG_TIME_FROM);
+		goto fail;
+	}
+
+	if (SUCCEED == zbx_json_value_by_name(&jp_data, ZBX_PROTO_TAG_TIME_TILL, buffer, sizeof(buffer), NULL))
+	{
+		if (SUCCEED != is_uint31(buffer, &time_till))
+		{
+			error = zbx_dsprintf(NULL, "Cannot parse request tag: %s.", ZBX_PROTO_TAG_TIME_TILL);
+			goto fail;
+		}
+	}
+	else
+		time_till = (int)time(NULL);
+
+	if (SUCCEED == zbx_json_value_by_name(&jp_data, ZBX_PROTO_TAG_LIMIT, buffer, sizeof(buffer), NULL) &&
+			SUCCEED != is_uint31(buffer, &limit))
+	{
+		error = zbx_dsprintf(NULL, "Cannot parse request tag: %s.", ZBX_PROTO_TAG_LIMIT);
+		goto fail;
+	}
+
+	if (time_from > time_till)
+	{
+		error = zbx_strdup(NULL, "Invalid time period.");
+		goto fail;
+	}
+
+	if (ZBX_HISTORY_GET_PERIOD_MAX < time_till - time_from)
+	{
+		error = zbx_dsprintf(NULL, "Time period is too long, maximum is %d seconds.",
+				ZBX_HISTORY_GET_PERIOD_MAX);
+		goto fail;
+	}
+
+	zbx_vector_uint64_sort(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	trapper_history_filter_items(&user, &itemids);
+
+	items = (DC_ITEM *)zbx_malloc(NULL, sizeof(DC_ITEM) * (size_t)itemids.values_num);
+	errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)itemids.values_num);
+
+	DCconfig_get_items_by_itemids_partial(items, itemids.values, errcodes, itemids.values_num, 0);
+
+	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addstring(&json, ZBX_PROTO_TAG_RESPONSE, ZBX_PROTO_VALUE_SUCCESS, ZBX_JSON_TYPE_STRING);
+	zbx_json_addarray(&json, ZBX_PROTO_TAG_DATA);
+
+	zbx_history_record_vector_create(&values);
+
+	for (i = 0; i < itemids.values_num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		zbx_json_addobject(&json, NULL);
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_ITEMID, itemids.values[i]);
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_TYPE, items[i].value_type);
+
+		if (SUCCEED == trapper_history_get_values(itemids.values[i], items[i].value_type, time_from, time_till,
+				limit, &values))
+		{
+			trapper_history_add_values(&json, items[i].value_type, &values);
+		}
+		else
+		{
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_ERROR, "Cannot read item history.",
+					ZBX_JSON_TYPE_STRING);
+		}
+
+		zbx_json_close(&json);
+		zbx_history_record_vector_clean(&values, items[i].value_type);
+	}
+
+	zbx_vector_history_record_destroy(&values);
+
+	DCconfig_clean_items(items, errcodes, (size_t)itemids.values_num);
+
+	(void)zbx_tcp_send_bytes_to(sock, json.buffer, json.buffer_size, CONFIG_TIMEOUT);
+	zbx_json_free(&json);
+	goto out;
+fail:
+	zbx_send_response(sock, FAIL, error, CONFIG_TIMEOUT);
+	zbx_free(error);
+out:
+	zbx_free(errcodes);
+	zbx_free(items);
+	zbx_vector_uint64_destroy(&itemids);
+	zbx_user_free(&user);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 int	trapper_process_request(const char *request, zbx_socket_t *sock, const struct zbx_json_parse *jp)
 {
 	if (0 == strcmp(request, ZBX_PROTO_VALUE_REPORT_TEST))
@@ -225,6 +540,11 @@ int	trapper_process_request(const char *request, zbx_socket_t *sock, const struc
 		trapper_process_alert_send(sock, jp);
 		return SUCCEED;
 	}
+	else if (0 == strcmp(request, ZBX_PROTO_VALUE_HISTORY_GET))
+	{
+		trapper_process_history_get(sock, jp);
+		return SUCCEED;
+	}
 
 	return FAIL;
 }
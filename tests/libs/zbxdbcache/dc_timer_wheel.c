@@ -0,0 +1,178 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "dbcache.h"
+#include "dbconfig.h"
+#include "dc_timer_wheel_test.h"
+
+void	*__wrap___zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, const void *old, size_t size);
+void	*__wrap___zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, void *old, size_t size);
+void	__wrap___zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *ptr);
+
+void	*__wrap___zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, const void *old, size_t size)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+	ZBX_UNUSED(old);
+
+	return zbx_malloc(NULL, size);
+}
+
+void	*__wrap___zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, void *old, size_t size)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	return zbx_realloc(old, size);
+}
+
+void	__wrap___zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *ptr)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	zbx_free(ptr);
+}
+
+static int	mock_get_time(zbx_mock_handle_t handle, const char *name)
+{
+	zbx_timespec_t		ts;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(zbx_mock_get_object_member_string(handle, name), &ts)))
+		fail_msg("Cannot read \"%s\" timestamp: %s", name, zbx_mock_error_string(err));
+
+	return ts.sec;
+}
+
+static void	mock_insert_timers(zbx_dc_timer_wheel_t *wheel, zbx_mock_handle_t htimers)
+{
+	zbx_mock_handle_t	htimer;
+	zbx_mock_error_t	err;
+	zbx_trigger_timer_t	*timer;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(htimers, &htimer))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read timer: %s", zbx_mock_error_string(err));
+
+		timer = (zbx_trigger_timer_t *)zbx_malloc(NULL, sizeof(zbx_trigger_timer_t));
+		memset(timer, 0, sizeof(zbx_trigger_timer_t));
+
+		timer->triggerid = zbx_mock_get_object_member_uint64(htimer, "triggerid");
+		timer->objectid = timer->triggerid;
+		timer->check_ts.sec = mock_get_time(htimer, "check");
+		timer->eval_ts = timer->check_ts;
+
+		dc_timer_wheel_insert_test(wheel, timer);
+	}
+}
+
+static void	mock_check_due_timers(zbx_dc_timer_wheel_t *wheel, zbx_mock_handle_t hstep, int step)
+{
+	zbx_mock_handle_t	htriggerids, htriggerid;
+	zbx_mock_error_t	err;
+	zbx_trigger_timer_t	*timer;
+	zbx_uint64_t		triggerid;
+	int			i = 0;
+	char			buffer[MAX_STRING_LEN];
+
+	htriggerids = zbx_mock_get_object_member_handle(hstep, "due");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(htriggerids, &htriggerid))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_uint64(htriggerid, &triggerid))
+			fail_msg("step #%d: cannot read due trigger identifier: %s", step, zbx_mock_error_string(err));
+
+		if (NULL == (timer = dc_timer_wheel_due_peek_test(wheel)))
+			fail_msg("step #%d: expected more than %d due timers", step, i);
+
+		zbx_snprintf(buffer, sizeof(buffer), "step #%d due timer #%d", step, i);
+		zbx_mock_assert_uint64_eq(buffer, triggerid, timer->triggerid);
+
+		dc_timer_wheel_due_pop_test(wheel);
+		zbx_free(timer);
+		i++;
+	}
+
+	if (NULL != dc_timer_wheel_due_peek_test(wheel))
+		fail_msg("step #%d: expected %d due timers", step, i);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_dc_timer_wheel_t	wheel;
+	zbx_mock_handle_t	hsteps, hstep, htimers;
+	zbx_mock_error_t	err;
+	zbx_vector_ptr_t	timers;
+	int			i, now, timers_num, step = 0;
+	char			buffer[MAX_STRING_LEN];
+
+	ZBX_UNUSED(state);
+
+	dc_timer_wheel_init_test(&wheel, mock_get_time(zbx_mock_get_parameter_handle("in"), "time"));
+
+	/* each step inserts timers, checks for due timers, advances wheel and pops the due timers */
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read step #%d: %s", step, zbx_mock_error_string(err));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "insert", &htimers))
+			mock_insert_timers(&wheel, htimers);
+
+		now = mock_get_time(hstep, "time");
+
+		zbx_snprintf(buffer, sizeof(buffer), "step #%d dc_timer_wheel_has_due()", step);
+		zbx_mock_assert_result_eq(buffer, zbx_mock_str_to_return_code(
+				zbx_mock_get_object_member_string(hstep, "has due")),
+				dc_timer_wheel_has_due_test(&wheel, now));
+
+		dc_timer_wheel_advance_test(&wheel, now);
+		mock_check_due_timers(&wheel, hstep, step);
+
+		step++;
+	}
+
+	timers_num = (int)zbx_mock_get_parameter_uint64("out.timers");
+	zbx_mock_assert_int_eq("timers left in wheel", timers_num, wheel.timers_num);
+
+	zbx_vector_ptr_create(&timers);
+	dc_timer_wheel_clear_test(&wheel, &timers);
+	zbx_mock_assert_int_eq("cleared timers", timers_num, timers.values_num);
+	zbx_vector_ptr_clear_ext(&timers, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&timers);
+
+	for (i = 0; i < ZBX_TIMER_WHEEL_SLOTS; i++)
+		zbx_vector_ptr_destroy(&wheel.slots[i]);
+
+	zbx_vector_ptr_destroy(&wheel.overflow);
+	zbx_binary_heap_destroy(&wheel.due);
+}
@@ -0,0 +1,31 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef DC_TIMER_WHEEL_TEST_H
+#define DC_TIMER_WHEEL_TEST_H
+
+void			dc_timer_wheel_init_test(zbx_dc_timer_wheel_t *wheel, int now);
+void			dc_timer_wheel_insert_test(zbx_dc_timer_wheel_t *wheel, zbx_trigger_timer_t *timer);
+void			dc_timer_wheel_advance_test(zbx_dc_timer_wheel_t *wheel, int now);
+int			dc_timer_wheel_has_due_test(const zbx_dc_timer_wheel_t *wheel, int now);
+zbx_trigger_timer_t	*dc_timer_wheel_due_peek_test(zbx_dc_timer_wheel_t *wheel);
+void			dc_timer_wheel_due_pop_test(zbx_dc_timer_wheel_t *wheel);
+void			dc_timer_wheel_clear_test(zbx_dc_timer_wheel_t *wheel, zbx_vector_ptr_t *timers);
+
+#endif /* DC_TIMER_WHEEL_TEST_H */
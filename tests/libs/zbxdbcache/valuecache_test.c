@@ -55,7 +55,8 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 	/* add item to cache if necessary */
 	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
 	{
-		zbx_vc_item_t   new_item = {.itemid = itemid, .value_type = value_type};
+		zbx_vc_item_t   new_item = {.itemid = itemid, .value_type = value_type,
+				.revision = ++vc_cache->revision};
 		item = zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(zbx_vc_item_t));
 	}
 
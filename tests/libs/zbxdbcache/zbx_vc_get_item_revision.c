@@ -0,0 +1,144 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxmutexs.h"
+#include "valuecache.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+extern zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
+
+#define VCMOCK_REVISION_NONE		0
+#define VCMOCK_REVISION_CHANGED		1
+#define VCMOCK_REVISION_UNCHANGED	2
+
+static int	vcmock_str_to_revision(const char *str)
+{
+	if (0 == strcmp(str, "none"))
+		return VCMOCK_REVISION_NONE;
+
+	if (0 == strcmp(str, "changed"))
+		return VCMOCK_REVISION_CHANGED;
+
+	if (0 == strcmp(str, "unchanged"))
+		return VCMOCK_REVISION_UNCHANGED;
+
+	fail_msg("Unknown revision state \"%s\"", str);
+
+	return FAIL;
+}
+
+static void	vcmock_add_values(zbx_mock_handle_t hvalues)
+{
+	zbx_vector_ptr_t	history;
+	int			ret_flush;
+
+	zbx_vector_ptr_create(&history);
+	zbx_vcmock_get_dc_history(hvalues, &history);
+
+	zbx_mock_assert_result_eq("zbx_vc_add_values()", SUCCEED, zbx_vc_add_values(&history, &ret_flush));
+
+	zbx_vector_ptr_clear_ext(&history, zbx_vcmock_free_dc_history);
+	zbx_vector_ptr_destroy(&history);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int			err, seconds, count, step = 0;
+	char			*error, buffer[MAX_STRING_LEN];
+	zbx_mock_handle_t	hsteps, hstep, hdata;
+	zbx_mock_error_t	mock_err;
+	zbx_uint64_t		itemid, revision, last_revision = 0;
+	unsigned char		value_type;
+	zbx_timespec_t		ts;
+
+	ZBX_UNUSED(state);
+
+	CONFIG_VALUE_CACHE_SIZE = ZBX_MEBIBYTE;
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_vc_init(&error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+	zbx_vcmock_ds_init();
+
+	if (FAIL == is_uint64(zbx_mock_get_parameter_string("in.itemid"), &itemid))
+		fail_msg("Invalid in.itemid value");
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in.value type"));
+
+	/* each step either caches item values or adds new values and checks how item revision changed */
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		if (ZBX_MOCK_SUCCESS != mock_err)
+			fail_msg("Cannot read step #%d: %s", step, zbx_mock_error_string(mock_err));
+
+		zbx_vcmock_set_time(hstep, "time");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "precache", &hdata))
+		{
+			zbx_vcmock_get_request_params(hdata, &itemid, &value_type, &seconds, &count, &ts);
+			zbx_vc_precache_values(itemid, value_type, seconds, count, &ts);
+		}
+		else
+			vcmock_add_values(zbx_mock_get_object_member_handle(hstep, "values"));
+
+		zbx_snprintf(buffer, sizeof(buffer), "step #%d zbx_vc_get_item_revision()", step);
+
+		switch (vcmock_str_to_revision(zbx_mock_get_object_member_string(hstep, "revision")))
+		{
+			case VCMOCK_REVISION_NONE:
+				zbx_mock_assert_result_eq(buffer, FAIL,
+						zbx_vc_get_item_revision(itemid, value_type, &revision));
+				break;
+			case VCMOCK_REVISION_CHANGED:
+				zbx_mock_assert_result_eq(buffer, SUCCEED,
+						zbx_vc_get_item_revision(itemid, value_type, &revision));
+
+				if (revision == last_revision)
+					fail_msg("step #%d: expected item revision to change", step);
+
+				last_revision = revision;
+				break;
+			case VCMOCK_REVISION_UNCHANGED:
+				zbx_mock_assert_result_eq(buffer, SUCCEED,
+						zbx_vc_get_item_revision(itemid, value_type, &revision));
+				zbx_mock_assert_uint64_eq(buffer, last_revision, revision);
+				break;
+		}
+
+		step++;
+	}
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
@@ -0,0 +1,66 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxcomms.h"
+#include "proxy.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_history_stream_t	*stream;
+	zbx_socket_t		sock;
+	zbx_timespec_t		ts = {0, 0};
+	zbx_mock_handle_t	hchunk;
+	const char		*request;
+	size_t			len, chunk_len, consumed;
+	int			expected_started;
+
+	ZBX_UNUSED(state);
+
+	memset(&sock, 0, sizeof(sock));
+	zbx_strlcpy(sock.peer, "127.0.0.1", sizeof(sock.peer));
+
+	request = zbx_mock_get_parameter_string("in.request");
+	len = strlen(request);
+	expected_started = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.started"));
+
+	stream = zbx_history_stream_create(&sock, &ts);
+
+	/* nothing must be consumed while the first data row is being received */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.chunk", &hchunk))
+	{
+		chunk_len = (size_t)zbx_mock_get_parameter_uint64("in.chunk");
+
+		zbx_mock_assert_uint64_eq("consumed from first chunk", 0,
+				zbx_history_stream_parse(stream, request, chunk_len, 0));
+		zbx_mock_assert_result_eq("started after first chunk", FAIL, zbx_history_stream_started(stream));
+	}
+
+	consumed = zbx_history_stream_parse(stream, request, len, 1);
+
+	zbx_mock_assert_result_eq("started", expected_started, zbx_history_stream_started(stream));
+	zbx_mock_assert_uint64_eq("consumed", SUCCEED == expected_started ? len : 0, consumed);
+
+	zbx_history_stream_free(stream);
+}
@@ -0,0 +1,253 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxalgo.h"
+#include "zbxhistory.h"
+#include "dbcache.h"
+
+#include "../../../src/libs/zbxhistory/history.h"
+
+extern char	*CONFIG_HISTORY_FILE_DIR;
+
+static void	hfmock_read_value(zbx_mock_handle_t hvalue, unsigned char value_type, history_value_t *value,
+		zbx_timespec_t *ts)
+{
+	const char		*data;
+	zbx_mock_error_t	err;
+
+	data = zbx_mock_get_object_member_string(hvalue, "value");
+
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		if (FAIL == is_uint64(data, &value->ui64))
+			fail_msg("Invalid uint64 value \"%s\"", data);
+	}
+	else
+		value->dbl = atof(data);
+
+	data = zbx_mock_get_object_member_string(hvalue, "ts");
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(data, ts)))
+		fail_msg("Invalid value timestamp \"%s\": %s", data, zbx_mock_error_string(err));
+}
+
+static void	hfmock_flush(zbx_history_iface_t *hist, zbx_mock_handle_t hvalues, int expected_ret)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_mock_error_t	err;
+	zbx_vector_ptr_t	history;
+	ZBX_DC_HISTORY		*h;
+
+	zbx_vector_ptr_create(&history);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read value: %s", zbx_mock_error_string(err));
+
+		h = (ZBX_DC_HISTORY *)zbx_malloc(NULL, sizeof(ZBX_DC_HISTORY));
+		memset(h, 0, sizeof(ZBX_DC_HISTORY));
+		h->itemid = zbx_mock_get_object_member_uint64(hvalue, "itemid");
+		h->value_type = hist->value_type;
+		hfmock_read_value(hvalue, hist->value_type, &h->value, &h->ts);
+		zbx_vector_ptr_append(&history, h);
+	}
+
+	zbx_mock_assert_int_eq("add_values()", history.values_num, hist->add_values(hist, &history));
+	zbx_mock_assert_int_eq("flush()", expected_ret, hist->flush(hist));
+
+	zbx_vector_ptr_clear_ext(&history, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&history);
+}
+
+static void	hfmock_query(zbx_history_iface_t *hist, zbx_mock_handle_t hquery)
+{
+	zbx_mock_handle_t		hvalues, hvalue;
+	zbx_mock_error_t		err;
+	zbx_vector_history_record_t	values;
+	zbx_history_record_t		expected;
+	zbx_timespec_t			start, end;
+	int				i = 0;
+	char				buffer[MAX_STRING_LEN];
+
+	zbx_history_record_vector_create(&values);
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(zbx_mock_get_object_member_string(hquery, "start"),
+			&start)))
+	{
+		fail_msg("Invalid query start: %s", zbx_mock_error_string(err));
+	}
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(zbx_mock_get_object_member_string(hquery, "end"),
+			&end)))
+	{
+		fail_msg("Invalid query end: %s", zbx_mock_error_string(err));
+	}
+
+	zbx_mock_assert_int_eq("get_values()", SUCCEED, hist->get_values(hist,
+			zbx_mock_get_object_member_uint64(hquery, "itemid"), start.sec,
+			zbx_mock_get_object_member_int(hquery, "count"), end.sec, &values));
+
+	hvalues = zbx_mock_get_object_member_handle(hquery, "values");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read expected value: %s", zbx_mock_error_string(err));
+
+		if (i >= values.values_num)
+			fail_msg("Expected more than %d values", values.values_num);
+
+		hfmock_read_value(hvalue, hist->value_type, &expected.value, &expected.timestamp);
+
+		zbx_snprintf(buffer, sizeof(buffer), "value #%d timestamp", i);
+		zbx_mock_assert_timespec_eq(buffer, &expected.timestamp, &values.values[i].timestamp);
+
+		zbx_snprintf(buffer, sizeof(buffer), "value #%d", i);
+
+		if (ITEM_VALUE_TYPE_UINT64 == hist->value_type)
+			zbx_mock_assert_uint64_eq(buffer, expected.value.ui64, values.values[i].value.ui64);
+		else
+			zbx_mock_assert_double_eq(buffer, expected.value.dbl, values.values[i].value.dbl);
+
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("number of values", i, values.values_num);
+
+	zbx_history_record_vector_destroy(&values, hist->value_type);
+}
+
+/* a regular file in place of day directory makes writing values of that day fail */
+static void	hfmock_block_day(zbx_history_iface_t *hist, const char *day, int block)
+{
+	const char	*table = (ITEM_VALUE_TYPE_FLOAT == hist->value_type ? "history" : "history_uint");
+	char		*path;
+	int		fd;
+
+	path = zbx_dsprintf(NULL, "%s/%s", CONFIG_HISTORY_FILE_DIR, table);
+
+	if (0 != mkdir(path, 0755) && EEXIST != errno)
+		fail_msg("Cannot create directory \"%s\": %s", path, zbx_strerror(errno));
+
+	path = zbx_dsprintf(path, "%s/%s/%s", CONFIG_HISTORY_FILE_DIR, table, day);
+
+	if (0 != block)
+	{
+		if (-1 == (fd = open(path, O_WRONLY | O_CREAT, 0640)))
+			fail_msg("Cannot create file \"%s\": %s", path, zbx_strerror(errno));
+
+		close(fd);
+	}
+	else if (0 != unlink(path))
+		fail_msg("Cannot remove file \"%s\": %s", path, zbx_strerror(errno));
+
+	zbx_free(path);
+}
+
+static void	hfmock_remove_dir(const char *path)
+{
+	DIR		*dp;
+	struct dirent	*d;
+	zbx_stat_t	st;
+	char		*child;
+
+	if (NULL != (dp = opendir(path)))
+	{
+		while (NULL != (d = readdir(dp)))
+		{
+			if (0 == strcmp(d->d_name, ".") || 0 == strcmp(d->d_name, ".."))
+				continue;
+
+			child = zbx_dsprintf(NULL, "%s/%s", path, d->d_name);
+
+			if (0 == zbx_stat(child, &st) && 0 != S_ISDIR(st.st_mode))
+				hfmock_remove_dir(child);
+			else
+				unlink(child);
+
+			zbx_free(child);
+		}
+
+		closedir(dp);
+	}
+
+	rmdir(path);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_history_iface_t	hist;
+	zbx_mock_handle_t	hsteps, hstep, hdata, hresult;
+	zbx_mock_error_t	err;
+	char			dir[] = "/tmp/zbx_history_file_XXXXXX", *error = NULL;
+	const char		*result;
+
+	ZBX_UNUSED(state);
+
+	if (NULL == mkdtemp(dir))
+		fail_msg("Cannot create temporary directory: %s", zbx_strerror(errno));
+
+	CONFIG_HISTORY_FILE_DIR = dir;
+
+	if (SUCCEED != zbx_history_file_init(&hist, zbx_mock_str_to_value_type(
+			zbx_mock_get_parameter_string("in.value_type")), &error))
+	{
+		fail_msg("Cannot initialize file history: %s", error);
+	}
+
+	/* the steps are executed in order, so data can be appended after item index is built */
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read step: %s", zbx_mock_error_string(err));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "flush", &hdata))
+		{
+			if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "result", &hresult) &&
+					ZBX_MOCK_SUCCESS == zbx_mock_string(hresult, &result) &&
+					0 == strcmp(result, "FAIL"))
+			{
+				hfmock_flush(&hist, hdata, FLUSH_FAIL);
+			}
+			else
+				hfmock_flush(&hist, hdata, FLUSH_SUCCEED);
+		}
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "block", &hdata))
+			hfmock_block_day(&hist, zbx_mock_get_object_member_string(hstep, "block"), 1);
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "unblock", &hdata))
+			hfmock_block_day(&hist, zbx_mock_get_object_member_string(hstep, "unblock"), 0);
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "query", &hdata))
+			hfmock_query(&hist, hdata);
+		else
+			fail_msg("Unknown step");
+	}
+
+	hist.destroy(&hist);
+
+	hfmock_remove_dir(dir);
+	CONFIG_HISTORY_FILE_DIR = NULL;
+}
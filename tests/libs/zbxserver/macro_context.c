@@ -0,0 +1,179 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "zbxserver.h"
+#include "dbcache.h"
+
+#include "macro_context_test.h"
+
+static int	cache_requests;
+
+void	__wrap_DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num);
+int	__wrap_zbx_dc_get_item_name(zbx_uint64_t itemid, char **name);
+int	__wrap_zbx_dc_get_proxy_name_type_by_id(zbx_uint64_t proxyid, int *status, char **name);
+
+static int	mock_get_item(zbx_uint64_t itemid, zbx_mock_handle_t *hitem)
+{
+	zbx_mock_handle_t	hitems;
+	zbx_mock_error_t	err;
+
+	hitems = zbx_mock_get_parameter_handle("in.items");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hitems, hitem))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read 'items' element: %s", zbx_mock_error_string(err));
+
+		if (itemid == zbx_mock_get_object_member_uint64(*hitem, "itemid"))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+void	__wrap_DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num)
+{
+	size_t			i;
+	zbx_mock_handle_t	hitem;
+
+	cache_requests++;
+
+	for (i = 0; i < num; i++)
+	{
+		memset(&items[i], 0, sizeof(DC_ITEM));
+
+		if (SUCCEED != mock_get_item(itemids[i], &hitem))
+		{
+			errcodes[i] = FAIL;
+			continue;
+		}
+
+		items[i].itemid = itemids[i];
+		items[i].host.hostid = zbx_mock_get_object_member_uint64(hitem, "hostid");
+		items[i].host.proxy_hostid = zbx_mock_get_object_member_uint64(hitem, "proxy_hostid");
+		zbx_strlcpy(items[i].key_orig, zbx_mock_get_object_member_string(hitem, "key"),
+				sizeof(items[i].key_orig));
+		items[i].value_type = (unsigned char)zbx_mock_get_object_member_uint64(hitem, "value_type");
+
+		if (ITEM_VALUE_TYPE_FLOAT == items[i].value_type || ITEM_VALUE_TYPE_UINT64 == items[i].value_type)
+			items[i].units = zbx_strdup(NULL, zbx_mock_get_object_member_string(hitem, "units"));
+
+		items[i].error = zbx_strdup(NULL, zbx_mock_get_object_member_string(hitem, "error"));
+		errcodes[i] = SUCCEED;
+	}
+}
+
+int	__wrap_zbx_dc_get_item_name(zbx_uint64_t itemid, char **name)
+{
+	zbx_mock_handle_t	hitem;
+
+	if (SUCCEED != mock_get_item(itemid, &hitem))
+		return FAIL;
+
+	*name = zbx_strdup(NULL, zbx_mock_get_object_member_string(hitem, "name"));
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_dc_get_proxy_name_type_by_id(zbx_uint64_t proxyid, int *status, char **name)
+{
+	zbx_mock_handle_t	hproxies, hproxy;
+	zbx_mock_error_t	err;
+
+	cache_requests++;
+
+	hproxies = zbx_mock_get_parameter_handle("in.proxies");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hproxies, &hproxy))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read 'proxies' element: %s", zbx_mock_error_string(err));
+
+		if (proxyid == zbx_mock_get_object_member_uint64(hproxy, "hostid"))
+		{
+			*status = HOST_STATUS_PROXY_ACTIVE;
+			*name = zbx_strdup(NULL, zbx_mock_get_object_member_string(hproxy, "host"));
+
+			return SUCCEED;
+		}
+	}
+
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hmacros, hmacro, hnested;
+	zbx_mock_error_t	err;
+	ZBX_DB_EVENT		event;
+	char			*value = NULL;
+	const char		*macro, *nested;
+	int			i, ret, expected_ret, is_nested;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+
+	memset(&event, 0, sizeof(event));
+
+	hmacros = zbx_mock_get_parameter_handle("in.macros");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hmacros, &hmacro))); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read 'macros' element #%d: %s", i, zbx_mock_error_string(err));
+
+		event.eventid = zbx_mock_get_object_member_uint64(hmacro, "eventid");
+		macro = zbx_mock_get_object_member_string(hmacro, "macro");
+		expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hmacro, "return"));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hmacro, "nested", &hnested) &&
+				ZBX_MOCK_SUCCESS == zbx_mock_string(hnested, &nested))
+		{
+			is_nested = (0 == strcmp(nested, "yes") ? 1 : 0);
+		}
+		else
+			is_nested = 0;
+
+		ret = macro_context_get_item_value_test(&event,
+				zbx_mock_get_object_member_uint64(hmacro, "itemid"), macro, is_nested, &value);
+
+		zbx_mock_assert_result_eq(macro, expected_ret, ret);
+
+		if (SUCCEED == ret)
+			zbx_mock_assert_str_eq(macro, zbx_mock_get_object_member_string(hmacro, "value"), value);
+
+		zbx_free(value);
+	}
+
+	zbx_mock_assert_int_eq("configuration cache requests", (int)zbx_mock_get_parameter_uint64("out.cache_requests"),
+			cache_requests);
+
+	zbx_mockdb_destroy();
+}
@@ -0,0 +1,64 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "macro_context_test.h"
+
+int	macro_context_get_item_value_test(const ZBX_DB_EVENT *event, zbx_uint64_t itemid, const char *macro,
+		int nested, char **value)
+{
+	int	request, ret;
+	char	*param;
+
+	if (0 == strcmp(macro, "ITEM.NAME"))
+		request = ZBX_REQUEST_ITEM_NAME;
+	else if (0 == strcmp(macro, "ITEM.KEY.ORIG"))
+		request = ZBX_REQUEST_ITEM_KEY_ORIG;
+	else if (0 == strcmp(macro, "ITEM.DESCRIPTION.ORIG"))
+		request = ZBX_REQUEST_ITEM_DESCRIPTION_ORIG;
+	else if (0 == strcmp(macro, "ITEM.VALUETYPE"))
+		request = ZBX_REQUEST_ITEM_VALUETYPE;
+	else if (0 == strcmp(macro, "ITEM.ERROR"))
+		request = ZBX_REQUEST_ITEM_ERROR;
+	else if (0 == strcmp(macro, "HOST.DESCRIPTION"))
+		request = ZBX_REQUEST_HOST_DESCRIPTION;
+	else if (0 == strcmp(macro, "PROXY.NAME"))
+		request = ZBX_REQUEST_PROXY_NAME;
+	else if (0 == strcmp(macro, "PROXY.DESCRIPTION"))
+		request = ZBX_REQUEST_PROXY_DESCRIPTION;
+	else
+		return FAIL;
+
+	if (0 == macro_context_depth++)
+		macro_context_set(event);
+
+	/* substitute macros in item key parameter like replace_key_param_cb() does */
+	if (0 != nested)
+	{
+		param = zbx_strdup(NULL, "parameter");
+		substitute_simple_macros_impl(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+				&param, MACRO_TYPE_ITEM_KEY, NULL, 0);
+		zbx_free(param);
+	}
+
+	ret = DBget_item_value(itemid, value, request);
+
+	macro_context_depth--;
+
+	return ret;
+}
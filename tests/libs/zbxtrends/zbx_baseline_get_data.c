@@ -30,6 +30,7 @@
 int	__wrap_DBis_null(const char *field);
 DB_ROW	__wrap_DBfetch(DB_RESULT result);
 DB_RESULT	__wrap_DBselect(const char *fmt, ...);
+DB_RESULT	__wrap_DBselect_prepared(const char *sql, int params_num, const char *const *params);
 zbx_trend_state_t	__wrap_zbx_trends_get_avg(const char *table, zbx_uint64_t itemid, int start, int end,
 		double *value);
 
@@ -51,6 +52,14 @@ DB_RESULT	__wrap_DBselect(const char *fmt, ...)
 	return NULL;
 }
 
+DB_RESULT	__wrap_DBselect_prepared(const char *sql, int params_num, const char *const *params)
+{
+	ZBX_UNUSED(sql);
+	ZBX_UNUSED(params_num);
+	ZBX_UNUSED(params);
+	return NULL;
+}
+
 static	zbx_mock_handle_t	hout;
 static int			iteration;
 
@@ -30,6 +30,7 @@
 int	__wrap_DBis_null(const char *field);
 DB_ROW	__wrap_DBfetch(DB_RESULT result);
 DB_RESULT	__wrap_DBselect(const char *fmt, ...);
+DB_RESULT	__wrap_DBselect_prepared(const char *sql, int params_num, const char *const *params);
 
 int	__wrap_DBis_null(const char *field)
 {
@@ -49,6 +50,14 @@ DB_RESULT	__wrap_DBselect(const char *fmt, ...)
 	return NULL;
 }
 
+DB_RESULT	__wrap_DBselect_prepared(const char *sql, int params_num, const char *const *params)
+{
+	ZBX_UNUSED(sql);
+	ZBX_UNUSED(params_num);
+	ZBX_UNUSED(params);
+	return NULL;
+}
+
 void	zbx_mock_test_entry(void **state)
 {
 	const char	*param;
@@ -52,7 +52,7 @@ void	__wrap___zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info,
 void	__wrap_zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info);
 int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int count, int end,
 		zbx_vector_history_record_t *values);
-int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history);
+int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history, int *ret_flush);
 int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
 int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
 void	__wrap_zbx_elastic_version_extract(void);
@@ -616,13 +616,13 @@ int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start
 	return SUCCEED;
 }
 
-int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history)
+int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history, int *ret_flush)
 {
 	int			i;
 	zbx_vcmock_ds_item_t	*item, item_local;
 	zbx_history_record_t	src, dst;
 
-	ZBX_UNUSED(history);
+	*ret_flush = FLUSH_SUCCEED;
 
 	for (i = 0; i < history->values_num; i++)
 	{
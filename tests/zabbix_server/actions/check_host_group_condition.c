@@ -0,0 +1,155 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "dbcache.h"
+#include "actions_test.h"
+
+static zbx_vector_uint64_t	group_triggerids;
+
+/* returns triggers belonging to the host group in the order listed in test data, */
+/* configuration cache does not guarantee any particular order either            */
+void	__wrap_zbx_dc_get_hostgroup_triggerids(zbx_uint64_t groupid, const zbx_vector_uint64_t *triggerids,
+		zbx_vector_uint64_t *group_triggerids_out)
+{
+	int	i;
+
+	ZBX_UNUSED(groupid);
+
+	for (i = 0; i < group_triggerids.values_num; i++)
+	{
+		if (FAIL != zbx_vector_uint64_search(triggerids, group_triggerids.values[i],
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			zbx_vector_uint64_append(group_triggerids_out, group_triggerids.values[i]);
+		}
+	}
+}
+
+static void	mock_read_ids(const char *path, zbx_vector_uint64_t *ids)
+{
+	zbx_mock_handle_t	hids, hid;
+	zbx_mock_error_t	err;
+	zbx_uint64_t		id;
+
+	hids = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hids, &hid))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_uint64(hid, &id))
+			fail_msg("cannot read ids from %s", path);
+
+		zbx_vector_uint64_append(ids, id);
+	}
+}
+
+static void	mock_read_events(const char *path, zbx_vector_ptr_t *events)
+{
+	zbx_mock_handle_t	hevents, hevent;
+	zbx_mock_error_t	err;
+	ZBX_DB_EVENT		*event;
+
+	hevents = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hevents, &hevent))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read events from %s", path);
+
+		event = (ZBX_DB_EVENT *)zbx_malloc(NULL, sizeof(ZBX_DB_EVENT));
+		memset(event, 0, sizeof(ZBX_DB_EVENT));
+
+		event->eventid = zbx_mock_get_object_member_uint64(hevent, "eventid");
+		event->objectid = zbx_mock_get_object_member_uint64(hevent, "triggerid");
+		event->source = EVENT_SOURCE_TRIGGERS;
+		event->object = EVENT_OBJECT_TRIGGER;
+
+		zbx_vector_ptr_append(events, event);
+	}
+}
+
+/* sorts events the same way as actions processing does before checking conditions */
+static int	mock_compare_events(const void *d1, const void *d2)
+{
+	const ZBX_DB_EVENT	*p1 = *(const ZBX_DB_EVENT * const *)d1;
+	const ZBX_DB_EVENT	*p2 = *(const ZBX_DB_EVENT * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->objectid, p2->objectid);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->object, p2->object);
+
+	return 0;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_ptr_t	events;
+	zbx_vector_uint64_t	eventids;
+	zbx_condition_t		condition;
+	const char		*op;
+	int			i, ret;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_uint64_create(&group_triggerids);
+	zbx_vector_ptr_create(&events);
+	zbx_vector_uint64_create(&eventids);
+
+	memset(&condition, 0, sizeof(condition));
+	zbx_vector_uint64_create(&condition.eventids);
+	condition.conditiontype = CONDITION_TYPE_HOST_GROUP;
+	condition.value = zbx_strdup(NULL, zbx_mock_get_parameter_string("in.groupid"));
+
+	op = zbx_mock_get_parameter_string("in.operator");
+
+	if (0 == strcmp(op, "equal"))
+		condition.op = CONDITION_OPERATOR_EQUAL;
+	else if (0 == strcmp(op, "not equal"))
+		condition.op = CONDITION_OPERATOR_NOT_EQUAL;
+	else
+		fail_msg("unsupported operator '%s'", op);
+
+	mock_read_ids("in.group_triggerids", &group_triggerids);
+	mock_read_events("in.events", &events);
+	zbx_vector_ptr_sort(&events, mock_compare_events);
+
+	ret = zbx_check_host_group_condition(&events, &condition);
+	zbx_mock_assert_result_eq("check_host_group_condition() return value", SUCCEED, ret);
+
+	mock_read_ids("out.eventids", &eventids);
+
+	zbx_vector_uint64_sort(&condition.eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_sort(&eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_mock_assert_int_eq("number of matching events", eventids.values_num, condition.eventids.values_num);
+
+	for (i = 0; i < eventids.values_num; i++)
+		zbx_mock_assert_uint64_eq("matching eventid", eventids.values[i], condition.eventids.values[i]);
+
+	zbx_free(condition.value);
+	zbx_vector_uint64_destroy(&condition.eventids);
+	zbx_vector_uint64_destroy(&eventids);
+	zbx_vector_ptr_clear_ext(&events, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&events);
+	zbx_vector_uint64_destroy(&group_triggerids);
+}
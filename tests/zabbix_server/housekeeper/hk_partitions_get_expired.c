@@ -0,0 +1,97 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_server/housekeeper/history_partitions.h"
+
+static int	mock_partition_bound(const char *value)
+{
+	if (0 == strcmp(value, "MINVALUE"))
+		return INT_MIN;
+
+	if (0 == strcmp(value, "MAXVALUE"))
+		return INT_MAX;
+
+	return atoi(value);
+}
+
+static void	mock_read_partitions(const char *path, zbx_vector_ptr_t *partitions)
+{
+	zbx_mock_handle_t	hpartitions, hpartition;
+	zbx_mock_error_t	err;
+	zbx_hk_partition_t	*partition;
+
+	hpartitions = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hpartitions, &hpartition))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read partition: %s", zbx_mock_error_string(err));
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, zbx_mock_get_object_member_string(hpartition, "name"));
+		partition->from = mock_partition_bound(zbx_mock_get_object_member_string(hpartition, "from"));
+		partition->to = mock_partition_bound(zbx_mock_get_object_member_string(hpartition, "to"));
+		zbx_vector_ptr_append(partitions, partition);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_ptr_t	partitions, expired;
+	zbx_mock_handle_t	hnames, hname;
+	zbx_mock_error_t	err;
+	int			bound, i = 0;
+	const char		*name;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_ptr_create(&partitions);
+	zbx_vector_ptr_create(&expired);
+
+	mock_read_partitions("in.partitions", &partitions);
+
+	bound = hk_partitions_get_expired(&partitions, atoi(zbx_mock_get_parameter_string("in.keep_from")),
+			&expired);
+
+	zbx_mock_assert_int_eq("bound", atoi(zbx_mock_get_parameter_string("out.bound")), bound);
+
+	hnames = zbx_mock_get_parameter_handle("out.expired");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hnames, &hname))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hname, &name)))
+			fail_msg("Cannot read expired partition name: %s", zbx_mock_error_string(err));
+
+		if (i >= expired.values_num)
+			fail_msg("Expected more than %d expired partitions", expired.values_num);
+
+		zbx_mock_assert_str_eq("expired partition", name, ((zbx_hk_partition_t *)expired.values[i++])->name);
+	}
+
+	zbx_mock_assert_int_eq("expired partition count", i, expired.values_num);
+
+	zbx_vector_ptr_destroy(&expired);
+	zbx_vector_ptr_clear_ext(&partitions, (zbx_clean_func_t)hk_partition_free);
+	zbx_vector_ptr_destroy(&partitions);
+}
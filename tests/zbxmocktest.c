@@ -41,6 +41,7 @@ int	CONFIG_IPMIPOLLER_FORKS		= 0;
 int	CONFIG_TIMER_FORKS		= 1;
 int	CONFIG_TRAPPER_FORKS		= 5;
 int	CONFIG_SNMPTRAPPER_FORKS	= 0;
+int	CONFIG_SNMPTRAPWORKER_FORKS	= 0;
 int	CONFIG_JAVAPOLLER_FORKS		= 0;
 int	CONFIG_ESCALATOR_FORKS		= 1;
 int	CONFIG_SELFMON_FORKS		= 1;
@@ -64,6 +65,9 @@ int	CONFIG_LISTEN_PORT		= 0;
 char	*CONFIG_LISTEN_IP		= NULL;
 char	*CONFIG_SOURCE_IP		= NULL;
 int	CONFIG_TRAPPER_TIMEOUT		= 300;
+int	CONFIG_AGENT_CONNECTION_IDLE_TIMEOUT	= 0;
+int	CONFIG_AGENT_CONNECTION_MAX_REQUESTS	= 100;
+int	CONFIG_AGENT_BATCH_MAX_ITEMS		= 1;
 
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
 int	CONFIG_MAX_HOUSEKEEPER_DELETE	= 5000;		/* applies for every separate field value */
@@ -116,6 +120,7 @@ char	*CONFIG_DB_TLS_CIPHER		= NULL;
 char	*CONFIG_DB_TLS_CIPHER_13	= NULL;
 char	*CONFIG_EXPORT_DIR		= NULL;
 char	*CONFIG_EXPORT_TYPE		= NULL;
+char	*CONFIG_EXPORT_FORMAT		= NULL;
 int	CONFIG_DBPORT			= 0;
 int	CONFIG_ENABLE_REMOTE_COMMANDS	= 0;
 int	CONFIG_LOG_REMOTE_COMMANDS	= 0;
@@ -129,6 +134,7 @@ int	CONFIG_JAVA_GATEWAY_PORT	= 0;
 char	*CONFIG_SSH_KEY_LOCATION	= NULL;
 
 int	CONFIG_LOG_SLOW_QUERIES		= 0;	/* ms; 0 - disable */
+int	CONFIG_DB_PREPARED_STATEMENTS	= 0;
 
 int	CONFIG_SERVER_STARTUP_TIME	= 0;	/* zabbix server startup time */
 
@@ -180,6 +186,11 @@ char	*CONFIG_SOCKET_PATH			= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+zbx_uint64_t	CONFIG_HISTORY_STORAGE_BULK_SIZE	= 5 * ZBX_MEBIBYTE;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION	= 0;
+int	CONFIG_HISTORY_ASYNC_WRITE		= 0;
+char	*CONFIG_HISTORY_FILE_DIR		= NULL;
+char	*CONFIG_HISTORY_FILE_OPTS		= NULL;
 
 /* not used in tests, defined for linking with comms.c */
 int	CONFIG_TCP_MAX_BACKLOG_SIZE	= SOMAXCONN;